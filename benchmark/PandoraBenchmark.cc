@@ -0,0 +1,321 @@
+/**
+ *  @file   MarlinPandora/benchmark/PandoraBenchmark.cc
+ *
+ *  @brief  Benchmark driver, timing the creators and pandora over synthetic events for a toy detector.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Global.h"
+#include "marlin/Processor.h"
+
+#include "Api/PandoraApi.h"
+
+#include "CaloHitCreator.h"
+#include "GeometryCreator.h"
+#include "GeometrySnapshot.h"
+#include "MCParticleCreator.h"
+#include "PfoCreator.h"
+#include "ProfilingAlgorithm.h"
+#include "SyntheticEventGenerator.h"
+#include "TrackCreator.h"
+#include "UserComponents.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+
+/**
+ *  @brief  BenchmarkStage enum, the timed stages of the per-event processing
+ */
+enum BenchmarkStage
+{
+    MC_PARTICLE_STAGE = 0,
+    TRACK_STAGE,
+    CALO_HIT_STAGE,
+    PANDORA_INPUT_STAGE,
+    PANDORA_PROCESS_STAGE,
+    PFO_STAGE,
+    N_BENCHMARK_STAGES
+};
+
+static const char *const BENCHMARK_STAGE_NAMES[N_BENCHMARK_STAGES] =
+{
+    "mc particle creator",
+    "track creator",
+    "calo hit creator",
+    "pandora inputs",
+    "pandora process event",
+    "pfo creator"
+};
+
+/**
+ *  @brief  Print the timing summary for a benchmark stage
+ *
+ *  @param  stageName the stage name
+ *  @param  seconds the total time spent in the stage
+ *  @param  nEvents the number of events
+ *  @param  nCaloHits the total number of calo hits
+ */
+void PrintStageSummary(const std::string &stageName, const double seconds, const unsigned int nEvents, const unsigned long long nCaloHits);
+
+/**
+ *  @brief  Print the usage message
+ *
+ *  @param  programName the program name
+ */
+void PrintUsage(const std::string &programName);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    SyntheticEventGenerator::Settings generatorSettings;
+    UserComponents::Settings userComponentSettings;
+    std::string settingsXmlFile;
+    unsigned int nEvents(100);
+    int option(0);
+
+    while ((option = getopt(argc, argv, "s:t:p:e:j:o:n:r:lg:h")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            settingsXmlFile = optarg;
+            break;
+        case 't':
+            if (std::string("single") == optarg)
+            {
+                generatorSettings.m_eventType = SyntheticEventGenerator::SINGLE_PARTICLE;
+            }
+            else if (std::string("jets") == optarg)
+            {
+                generatorSettings.m_eventType = SyntheticEventGenerator::MULTI_JET;
+            }
+            else
+            {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'p':
+            generatorSettings.m_particlePdg = std::atoi(optarg);
+            break;
+        case 'e':
+            generatorSettings.m_particleEnergy = std::atof(optarg);
+            generatorSettings.m_jetEnergy = std::atof(optarg);
+            break;
+        case 'j':
+            generatorSettings.m_nJets = std::max(1, std::atoi(optarg));
+            break;
+        case 'o':
+            generatorSettings.m_backgroundOccupancy = std::atof(optarg);
+            break;
+        case 'n':
+            nEvents = std::max(1, std::atoi(optarg));
+            break;
+        case 'r':
+            generatorSettings.m_randomSeed = std::atoi(optarg);
+            break;
+        case 'l':
+            userComponentSettings.m_useTablePseudoLayerPlugin = 1;
+            break;
+        case 'g':
+            userComponentSettings.m_nNonLinearityGridPoints = std::max(0, std::atoi(optarg));
+            break;
+        case 'h':
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    streamlog::out.init(std::cout, argv[0]);
+
+    // ATTN The geometry creator reads the toy detector from the global gear; the creators then see only the resulting geometry snapshot
+    gear::GearMgr *const pGearMgr(SyntheticEventGenerator::CreateGearMgr());
+    marlin::Global::GEAR = pGearMgr;
+
+    typedef std::vector<EVENT::LCEvent*> LCEventVector;
+    LCEventVector lcEventVector;
+    pandora::Pandora *pPandora(NULL);
+    int returnCode(0);
+
+    try
+    {
+        GeometryCreator::Settings geometryCreatorSettings;
+        CaloHitCreator::Settings caloHitCreatorSettings;
+        TrackCreator::Settings trackCreatorSettings;
+        MCParticleCreator::Settings mcParticleCreatorSettings;
+        SyntheticEventGenerator::SetCreatorSettings(geometryCreatorSettings, caloHitCreatorSettings, trackCreatorSettings,
+            mcParticleCreatorSettings);
+
+        GeometrySnapshot geometrySnapshot("PandoraBenchmark");
+        const GeometryCreator geometryCreator(geometryCreatorSettings);
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, geometryCreator.CreateGeometry(geometrySnapshot));
+
+        CaloHitCreator caloHitCreator(caloHitCreatorSettings, geometrySnapshot);
+        TrackCreator trackCreator(trackCreatorSettings, geometrySnapshot);
+        MCParticleCreator mcParticleCreator(mcParticleCreatorSettings, geometrySnapshot);
+
+        // Without a pandora settings file, only the creators are timed
+        const bool shouldRunPandora(!settingsXmlFile.empty());
+
+        PfoCreator::Settings pfoCreatorSettings;
+        pfoCreatorSettings.m_clusterCollectionName = "PandoraClusters";
+        pfoCreatorSettings.m_pfoCollectionName = "PandoraPFOs";
+        pfoCreatorSettings.m_startVertexCollectionName = "PandoraStartVertices";
+        pfoCreatorSettings.m_startVertexAlgName = "PandoraPFANew";
+
+        if (shouldRunPandora)
+        {
+            pPandora = new pandora::Pandora();
+            // ATTN The ExternalClustering and ExternalTrackClusterAssociation algorithms read lcio collections via the processor, so are unavailable in the benchmark
+            userComponentSettings.m_innerBField = SyntheticEventGenerator::GetInnerBField();
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, UserComponents::Register(*pPandora, userComponentSettings, geometrySnapshot));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, geometrySnapshot.CreatePandoraGeometry(*pPandora));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pPandora, settingsXmlFile));
+        }
+
+        PfoCreator pfoCreator(pfoCreatorSettings, pPandora);
+
+        // Event generation is excluded from the timing
+        SyntheticEventGenerator syntheticEventGenerator(generatorSettings);
+
+        for (unsigned int iEvent = 0; iEvent < nEvents; ++iEvent)
+            lcEventVector.push_back(syntheticEventGenerator.GenerateEvent(iEvent));
+
+        double stageSeconds[N_BENCHMARK_STAGES] = {0.};
+        unsigned long long nCaloHits(0);
+
+        for (LCEventVector::const_iterator iter = lcEventVector.begin(), iterEnd = lcEventVector.end(); iter != iterEnd; ++iter)
+        {
+            EVENT::LCEvent *const pLCEvent(*iter);
+            std::chrono::steady_clock::time_point stageTimes[N_BENCHMARK_STAGES + 1];
+            stageTimes[0] = std::chrono::steady_clock::now();
+
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, mcParticleCreator.CreateMCParticles(pLCEvent));
+            stageTimes[MC_PARTICLE_STAGE + 1] = std::chrono::steady_clock::now();
+
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, trackCreator.CreateTrackAssociations(pLCEvent));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, trackCreator.CreateTracks(pLCEvent));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, mcParticleCreator.CreateTrackToMCParticleRelationships(pLCEvent,
+                trackCreator.GetTrackVector()));
+            stageTimes[TRACK_STAGE + 1] = std::chrono::steady_clock::now();
+
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, caloHitCreator.CreateCaloHits(pLCEvent));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, mcParticleCreator.CreateCaloHitToMCParticleRelationships(pLCEvent,
+                caloHitCreator.GetCalorimeterHitVector(), caloHitCreator.GetSuperCellMemberMap()));
+            stageTimes[CALO_HIT_STAGE + 1] = std::chrono::steady_clock::now();
+
+            if (shouldRunPandora)
+            {
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, trackCreator.CreatePandoraTracks(*pPandora));
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, caloHitCreator.CreatePandoraCaloHits(*pPandora));
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, mcParticleCreator.CreatePandoraMCParticles(*pPandora));
+            }
+
+            stageTimes[PANDORA_INPUT_STAGE + 1] = std::chrono::steady_clock::now();
+
+            if (shouldRunPandora)
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPandora));
+
+            stageTimes[PANDORA_PROCESS_STAGE + 1] = std::chrono::steady_clock::now();
+
+            if (shouldRunPandora)
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pfoCreator.CreateParticleFlowObjects(pLCEvent));
+
+            stageTimes[PFO_STAGE + 1] = std::chrono::steady_clock::now();
+
+            for (unsigned int iStage = 0; iStage < N_BENCHMARK_STAGES; ++iStage)
+                stageSeconds[iStage] += std::chrono::duration<double>(stageTimes[iStage + 1] - stageTimes[iStage]).count();
+
+            nCaloHits += caloHitCreator.GetCalorimeterHitVector().size();
+
+            if (shouldRunPandora)
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPandora));
+
+            caloHitCreator.Reset();
+            trackCreator.Reset();
+            mcParticleCreator.Reset();
+        }
+
+        std::cout << "PandoraBenchmark: " << nEvents << " events, mean " << static_cast<double>(nCaloHits) / static_cast<double>(nEvents)
+                  << " calo hits per event" << std::endl;
+
+        double totalSeconds(0.);
+
+        for (unsigned int iStage = 0; iStage < N_BENCHMARK_STAGES; ++iStage)
+        {
+            if (!shouldRunPandora && (iStage >= PANDORA_INPUT_STAGE))
+                continue;
+
+            PrintStageSummary(BENCHMARK_STAGE_NAMES[iStage], stageSeconds[iStage], nEvents, nCaloHits);
+            totalSeconds += stageSeconds[iStage];
+        }
+
+        PrintStageSummary("total", totalSeconds, nEvents, nCaloHits);
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        std::cout << "PandoraBenchmark: pandora exception " << statusCodeException.ToString() << std::endl;
+        returnCode = 1;
+    }
+    catch (std::exception &exception)
+    {
+        std::cout << "PandoraBenchmark: exception " << exception.what() << std::endl;
+        returnCode = 1;
+    }
+
+    for (LCEventVector::const_iterator iter = lcEventVector.begin(), iterEnd = lcEventVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    if (NULL != pPandora)
+    {
+        ProfilingAlgorithm::PrintProfile(*pPandora);
+        ProfilingAlgorithm::ResetProfile(*pPandora);
+    }
+
+    delete pPandora;
+
+    marlin::Global::GEAR = NULL;
+    delete pGearMgr;
+
+    return returnCode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PrintStageSummary(const std::string &stageName, const double seconds, const unsigned int nEvents, const unsigned long long nCaloHits)
+{
+    std::cout << "PandoraBenchmark: " << stageName << ": " << seconds << " s, " << 1000. * seconds / static_cast<double>(nEvents)
+              << " ms per event";
+
+    if (seconds > 0.)
+    {
+        std::cout << ", " << static_cast<double>(nEvents) / seconds << " events per s, " << static_cast<double>(nCaloHits) / seconds
+                  << " calo hits per s";
+    }
+
+    std::cout << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PrintUsage(const std::string &programName)
+{
+    std::cout << "Usage: " << programName << " [-s PandoraSettings.xml] [-t single|jets] [-p pdg] [-e energy] [-j nJets] [-o occupancy]"
+              << " [-n nEvents] [-r seed] [-l] [-g nGridPoints]" << std::endl
+              << "    -s  pandora settings xml file (default none, timing only the creators)" << std::endl
+              << "    -t  event type, single particles or multi-jet events (default single)" << std::endl
+              << "    -p  pdg code of the single particle (default 211)" << std::endl
+              << "    -e  energy of the single particle, or of each jet, units GeV (default 10 and 45 respectively)" << std::endl
+              << "    -j  number of jets per multi-jet event (default 2)" << std::endl
+              << "    -o  fraction of ecal and hcal cells hit by beam-background overlay (default 0)" << std::endl
+              << "    -n  number of events (default 100)" << std::endl
+              << "    -r  random number seed (default 12345)" << std::endl
+              << "    -l  use the table pseudo layer plugin, as for the processor UseTablePseudoLayerPlugin parameter" << std::endl
+              << "    -g  number of uniform grid points for the non-linearity correction, as for the processor NonLinearityGridPoints parameter"
+              << " (default 0)" << std::endl;
+}
@@ -0,0 +1,320 @@
+/**
+ *  @file   MarlinPandora/benchmark/include/SyntheticEventGenerator.h
+ *
+ *  @brief  Header file for the synthetic event generator class.
+ *
+ *  $Log: $
+ */
+
+#ifndef SYNTHETIC_EVENT_GENERATOR_H
+#define SYNTHETIC_EVENT_GENERATOR_H 1
+
+#include "EVENT/LCEvent.h"
+#include "IMPL/CalorimeterHitImpl.h"
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/LCEventImpl.h"
+#include "IMPL/MCParticleImpl.h"
+#include "IMPL/SimCalorimeterHitImpl.h"
+#include "UTIL/CellIDEncoder.h"
+#include "UTIL/LCRelationNavigator.h"
+
+#include "gear/GearMgr.h"
+
+#include "CaloHitCreator.h"
+#include "GeometryCreator.h"
+#include "MCParticleCreator.h"
+#include "TrackCreator.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+/**
+ *  @brief  SyntheticEventGenerator class, producing lcio events for a toy detector without simulation, for benchmarking the creators and
+ *          pandora. Calorimeter hits, tracks and their mc relations are generated from simple parametrised shower and helix models.
+ */
+class SyntheticEventGenerator
+{
+public:
+    /**
+     *  @brief  EventType enum
+     */
+    enum EventType
+    {
+        SINGLE_PARTICLE,
+        MULTI_JET
+    };
+
+    /**
+     *  @brief  Settings class
+     */
+    class Settings
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        Settings();
+
+        EventType       m_eventType;                            ///< The type of event to generate
+        int             m_particlePdg;                          ///< The pdg code of the particle in single particle events
+        float           m_particleEnergy;                       ///< The particle energy in single particle events, units GeV
+        unsigned int    m_nJets;                                ///< The number of jets in multi-jet events
+        float           m_jetEnergy;                            ///< The energy of each jet in multi-jet events, units GeV
+        float           m_backgroundOccupancy;                  ///< The fraction of ecal and hcal cells hit by the beam-background overlay
+        unsigned int    m_randomSeed;                           ///< The random number seed
+    };
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  settings the generator settings
+     */
+    SyntheticEventGenerator(const Settings &settings);
+
+    /**
+     *  @brief  Destructor
+     */
+    ~SyntheticEventGenerator();
+
+    /**
+     *  @brief  Create an in-memory gear description of the toy detector, to be installed as marlin::Global::GEAR
+     *
+     *  @return address of the gear manager, ownership passes to the caller
+     */
+    static gear::GearMgr *CreateGearMgr();
+
+    /**
+     *  @brief  Get the bfield of the toy detector, in the main tracker, ecal and hcal
+     *
+     *  @return the bfield, units Tesla
+     */
+    static float GetInnerBField();
+
+    /**
+     *  @brief  Configure the creators for the collection names and calibrations of the generated events
+     *
+     *  @param  geometryCreatorSettings the geometry creator settings
+     *  @param  caloHitCreatorSettings the calo hit creator settings
+     *  @param  trackCreatorSettings the track creator settings
+     *  @param  mcParticleCreatorSettings the mc particle creator settings
+     */
+    static void SetCreatorSettings(GeometryCreator::Settings &geometryCreatorSettings, CaloHitCreator::Settings &caloHitCreatorSettings,
+        TrackCreator::Settings &trackCreatorSettings, MCParticleCreator::Settings &mcParticleCreatorSettings);
+
+    /**
+     *  @brief  Generate an event
+     *
+     *  @param  eventNumber the event number
+     *
+     *  @return address of the event, ownership passes to the caller
+     */
+    EVENT::LCEvent *GenerateEvent(const int eventNumber);
+
+private:
+    /**
+     *  @brief  LayerPosition class, the intersection of a shower axis with a calorimeter layer
+     */
+    class LayerPosition
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         */
+        LayerPosition();
+
+        bool                        m_isValid;                  ///< Whether the axis crosses the layer within the calorimeter region
+        unsigned int                m_region;                   ///< The calorimeter region
+        unsigned int                m_layer;                    ///< The layer within the calorimeter region
+        unsigned int                m_stave;                    ///< The barrel stave, or the endcap side
+        float                       m_depth;                    ///< The depth at the layer, in radiation or interaction lengths
+        pandora::CartesianVector    m_position;                 ///< The intersection position
+    };
+
+    typedef std::vector<LayerPosition> LayerPositionVector;
+    typedef std::pair<IMPL::CalorimeterHitImpl *, IMPL::SimCalorimeterHitImpl *> CellHit;
+    typedef std::map<unsigned long long, CellHit> CellToHitMap;
+    typedef UTIL::CellIDEncoder<IMPL::CalorimeterHitImpl> CellIDEncoder;
+
+    /**
+     *  @brief  Create the event collections and relation navigators
+     */
+    void BeginEvent();
+
+    /**
+     *  @brief  Add the event collections and relations to the event
+     *
+     *  @param  pLCEvent address of the event
+     */
+    void EndEvent(IMPL::LCEventImpl *const pLCEvent);
+
+    /**
+     *  @brief  Generate a jet, fragmented into charged hadrons, photons and neutral hadrons, with a parton parent
+     *
+     *  @param  jetEnergy the jet energy
+     */
+    void GenerateJet(const float jetEnergy);
+
+    /**
+     *  @brief  Generate a final state particle: its mc particle, its track if charged and its calorimeter deposits
+     *
+     *  @param  pdg the particle pdg code
+     *  @param  energy the particle energy
+     *  @param  direction the particle direction
+     *  @param  pParent address of the parent mc particle, NULL if none
+     */
+    void GenerateParticle(const int pdg, const float energy, const pandora::CartesianVector &direction, IMPL::MCParticleImpl *const pParent);
+
+    /**
+     *  @brief  Generate the beam-background overlay, a number of randomly placed ecal and hcal hits given by the occupancy setting
+     */
+    void GenerateBackground();
+
+    /**
+     *  @brief  Create a track, with tpc hits along its helix, and its mc relation
+     *
+     *  @param  pMCParticle address of the mc particle
+     *  @param  momentum the particle momentum
+     *  @param  charge the particle charge
+     *  @param  reachesCalorimeter whether the particle reaches the ecal
+     *  @param  calorimeterPosition the position at which the particle reaches the ecal
+     *  @param  calorimeterDirection the particle direction at the ecal
+     */
+    void CreateTrack(EVENT::MCParticle *const pMCParticle, const pandora::CartesianVector &momentum, const int charge,
+        const bool reachesCalorimeter, const pandora::CartesianVector &calorimeterPosition, const pandora::CartesianVector &calorimeterDirection);
+
+    /**
+     *  @brief  Propagate a particle from the ip to the inner face of the ecal, along a helix for charged particles
+     *
+     *  @param  momentum the particle momentum
+     *  @param  charge the particle charge
+     *  @param  position to receive the position at the ecal
+     *  @param  direction to receive the direction at the ecal
+     *  @param  isBarrel to receive whether the particle reaches the ecal barrel, rather than the endcap
+     *
+     *  @return whether the particle reaches the ecal
+     */
+    bool PropagateToCalorimeter(const pandora::CartesianVector &momentum, const int charge, pandora::CartesianVector &position,
+        pandora::CartesianVector &direction, bool &isBarrel) const;
+
+    /**
+     *  @brief  Deposit the energy of an electromagnetic shower in the ecal
+     *
+     *  @param  pMCParticle address of the mc particle
+     *  @param  energy the shower energy
+     *  @param  position the shower start position
+     *  @param  direction the shower axis
+     *  @param  isBarrel whether the shower starts in the barrel
+     */
+    void SimulateElectromagneticShower(EVENT::MCParticle *const pMCParticle, const float energy, const pandora::CartesianVector &position,
+        const pandora::CartesianVector &direction, const bool isBarrel);
+
+    /**
+     *  @brief  Deposit the energy of a hadronic shower in the ecal and hcal, preceded by a mip track segment for charged hadrons
+     *
+     *  @param  pMCParticle address of the mc particle
+     *  @param  energy the shower energy
+     *  @param  isCharged whether the hadron is charged
+     *  @param  position the position at which the hadron reaches the ecal
+     *  @param  direction the shower axis
+     *  @param  isBarrel whether the hadron reaches the barrel
+     */
+    void SimulateHadronicShower(EVENT::MCParticle *const pMCParticle, const float energy, const bool isCharged,
+        const pandora::CartesianVector &position, const pandora::CartesianVector &direction, const bool isBarrel);
+
+    /**
+     *  @brief  Deposit mip energy in every ecal, hcal and muon layer crossed by a muon
+     *
+     *  @param  pMCParticle address of the mc particle
+     *  @param  position the position at which the muon reaches the ecal
+     *  @param  direction the muon direction
+     *  @param  isBarrel whether the muon reaches the barrel
+     */
+    void SimulateMuon(EVENT::MCParticle *const pMCParticle, const pandora::CartesianVector &position, const pandora::CartesianVector &direction,
+        const bool isBarrel);
+
+    /**
+     *  @brief  Find the intersections of a straight line with each layer of a calorimeter region, appending them to a list
+     *
+     *  @param  region the calorimeter region
+     *  @param  position a point on the line
+     *  @param  direction the line direction
+     *  @param  useInteractionLengths whether layer depths are measured in interaction, rather than radiation, lengths
+     *  @param  layerPositionVector to receive the layer positions
+     */
+    void GetLayerPositions(const unsigned int region, const pandora::CartesianVector &position, const pandora::CartesianVector &direction,
+        const bool useInteractionLengths, LayerPositionVector &layerPositionVector) const;
+
+    /**
+     *  @brief  Deposit energy in the calorimeter cell containing a specified point in a layer, creating the cell hit if necessary
+     *
+     *  @param  layerPosition the layer position of the shower axis
+     *  @param  offset0 the offset from the axis along the first layer plane coordinate
+     *  @param  offset1 the offset from the axis along the second layer plane coordinate
+     *  @param  energy the energy to deposit
+     *  @param  pMCParticle address of the mc particle responsible for the energy deposit
+     */
+    void DepositEnergy(const LayerPosition &layerPosition, const float offset0, const float offset1, const float energy,
+        EVENT::MCParticle *const pMCParticle);
+
+    /**
+     *  @brief  Get the position on a helix starting at the ip
+     *
+     *  @param  phi0 the azimuthal direction at the ip
+     *  @param  radius the helix radius
+     *  @param  charge the particle charge
+     *  @param  tanLambda the helix dip
+     *  @param  arcLength the transverse arc length from the ip
+     *
+     *  @return the position
+     */
+    static pandora::CartesianVector GetHelixPosition(const float phi0, const float radius, const int charge, const float tanLambda,
+        const float arcLength);
+
+    /**
+     *  @brief  Create a track state at a point on a helix starting at the ip, using the point as the reference point
+     *
+     *  @param  location the lcio track state location
+     *  @param  phi0 the azimuthal direction at the ip
+     *  @param  radius the helix radius
+     *  @param  charge the particle charge
+     *  @param  tanLambda the helix dip
+     *  @param  arcLength the transverse arc length from the ip
+     *  @param  pCovMatrix address of the covariance matrix
+     *
+     *  @return address of the track state, ownership passes to the caller
+     */
+    static EVENT::TrackState *CreateTrackState(const int location, const float phi0, const float radius, const int charge, const float tanLambda,
+        const float arcLength, const float *const pCovMatrix);
+
+    /**
+     *  @brief  Get the mass and charge for a particle pdg code
+     *
+     *  @param  pdg the pdg code
+     *  @param  mass to receive the mass
+     *  @param  charge to receive the charge
+     */
+    static void GetParticleProperties(const int pdg, float &mass, int &charge);
+
+    /**
+     *  @brief  Get a random direction, isotropic within the generator polar angle acceptance
+     *
+     *  @return the direction
+     */
+    pandora::CartesianVector GetRandomDirection();
+
+    const Settings                      m_settings;                     ///< The generator settings
+    std::mt19937                        m_randomEngine;                 ///< The random number engine
+
+    IMPL::LCCollectionVec              *m_pMCParticleCollection;        ///< The mc particle collection for the current event
+    IMPL::LCCollectionVec              *m_pTrackCollection;             ///< The track collection for the current event
+    IMPL::LCCollectionVec              *m_pTrackerHitCollection;        ///< The tracker hit collection for the current event
+    IMPL::LCCollectionVec              *m_pSimCaloHitCollection;        ///< The sim calorimeter hit collection for the current event
+    std::vector<IMPL::LCCollectionVec*> m_caloHitCollections;           ///< The calorimeter hit collection for each calorimeter region
+    std::vector<CellIDEncoder*>         m_cellIDEncoders;               ///< The cell id encoder for each calorimeter region
+    UTIL::LCRelationNavigator          *m_pTrackRelationNavigator;      ///< The track to mc particle relations for the current event
+    UTIL::LCRelationNavigator          *m_pCaloHitRelationNavigator;    ///< The calo hit to sim calo hit relations for the current event
+    CellToHitMap                        m_cellToHitMap;                 ///< The hits created so far in the current event, keyed by cell
+};
+
+#endif // #ifndef SYNTHETIC_EVENT_GENERATOR_H
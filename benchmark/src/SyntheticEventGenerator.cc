@@ -0,0 +1,1132 @@
+/**
+ *  @file   MarlinPandora/benchmark/src/SyntheticEventGenerator.cc
+ *
+ *  @brief  Implementation of the synthetic event generator class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "IMPL/TrackImpl.h"
+#include "IMPL/TrackStateImpl.h"
+#include "IMPL/TrackerHitImpl.h"
+#include "UTIL/ILDConf.h"
+
+#include "gearimpl/CalorimeterParametersImpl.h"
+#include "gearimpl/ConstantBField.h"
+#include "gearimpl/FixedPadSizeDiskLayout.h"
+#include "gearimpl/GearMgrImpl.h"
+#include "gearimpl/GearParametersImpl.h"
+#include "gearimpl/TPCParametersImpl.h"
+#include "gearimpl/Vector3D.h"
+
+#include "SyntheticEventGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ *  @brief  CalorimeterDescription class, a calorimeter region of the toy detector, shared by the gear description and the hit generation
+ */
+class CalorimeterDescription
+{
+public:
+    const char     *m_collectionName;               ///< The name of the lcio collection holding the region hits
+    bool            m_isBarrel;                     ///< Whether the region is a barrel, rather than an endcap
+    bool            m_isHCalStaveCoding;            ///< Whether staves are encoded as for the hcal barrel, i.e. 2 * (symmetry - stave)
+    int             m_symmetryOrder;                ///< The symmetry order
+    float           m_innerR;                       ///< The inner radius, units mm
+    float           m_outerR;                       ///< The endcap outer radius, units mm
+    float           m_innerZ;                       ///< The endcap inner z coordinate, units mm
+    float           m_outerZ;                       ///< The barrel half length, units mm
+    unsigned int    m_nLayers;                      ///< The number of layers
+    float           m_layerThickness;               ///< The layer thickness, including absorber, units mm
+    float           m_absorberThickness;            ///< The absorber thickness, units mm
+    float           m_cellSize;                     ///< The cell size, units mm
+    float           m_mipEnergy;                    ///< The energy of a mip crossing a layer, units GeV
+    float           m_radLength;                    ///< The absorber radiation length, units 1/mm
+    float           m_intLength;                    ///< The absorber interaction length, units 1/mm
+};
+
+enum CalorimeterRegion
+{
+    ECAL_BARREL = 0,
+    ECAL_ENDCAP,
+    HCAL_BARREL,
+    HCAL_ENDCAP,
+    MUON_BARREL,
+    MUON_ENDCAP,
+    N_CALORIMETER_REGIONS
+};
+
+// Tungsten ecal, steel hcal and yoke, loosely following the ILD proportions
+static const CalorimeterDescription CALORIMETERS[N_CALORIMETER_REGIONS] =
+{
+    {"ECALBarrel", true,  false,  8, 1843.f,    0.f,    0.f, 2350.f, 30,   6.2f,   2.8f,  5.1f, 0.0063f, 1.f / 3.504f, 1.f / 99.46f},
+    {"ECALEndcap", false, false,  8,  400.f, 2088.f, 2450.f,    0.f, 30,   6.2f,   2.8f,  5.1f, 0.0063f, 1.f / 3.504f, 1.f / 99.46f},
+    {"HCALBarrel", true,  true,   8, 2058.f,    0.f,    0.f, 2350.f, 48,  26.5f,  20.f,  30.f,  0.028f, 1.f / 17.57f, 1.f / 168.f},
+    {"HCALEndcap", false, false,  8,  350.f, 3330.f, 2650.f,    0.f, 48,  26.5f,  20.f,  30.f,  0.028f, 1.f / 17.57f, 1.f / 168.f},
+    {"MUON",       true,  false, 12, 4450.f,    0.f,    0.f, 4047.f, 10, 140.f,  100.f,  30.f,    0.1f, 1.f / 17.57f, 1.f / 168.f},
+    {"MUON",       false, false, 12,  300.f, 5850.f, 4072.f,    0.f, 10, 140.f,  100.f,  30.f,    0.1f, 1.f / 17.57f, 1.f / 168.f}
+};
+
+static const std::string DETECTOR_NAME("SyntheticDetector");
+static const std::string CALO_HIT_ENCODING("M:3,S-1:4,I:16,J:16,K-1:6");
+static const std::string MC_PARTICLE_COLLECTION("MCParticle");
+static const std::string TRACK_COLLECTION("MarlinTrkTracks");
+static const std::string TRACKER_HIT_COLLECTION("TPCTrackerHits");
+static const std::string TRACK_RELATION_COLLECTION("MarlinTrkTracksMCTruthLink");
+static const std::string SIM_CALO_HIT_COLLECTION("SimCalorimeterHits");
+static const std::string CALO_HIT_RELATION_COLLECTION("RelationCaloHit");
+
+static const float B_FIELD = 3.5f;                          // Tesla
+static const float CURVATURE_CONSTANT = 2.99792e-4f;        // GeV per Tesla per mm
+static const float SPEED_OF_LIGHT = 299.792f;               // mm per ns
+static const float TPC_INNER_R = 329.f;
+static const float TPC_OUTER_R = 1808.f;
+static const float TPC_MAX_DRIFT_LENGTH = 2350.f;
+static const unsigned int TPC_N_ROWS = 224;
+static const float COIL_INNER_R = 3440.f;
+static const float COIL_OUTER_R = 4400.f;
+static const float COIL_HALF_Z = 3950.f;
+static const float MAX_COS_THETA = 0.95f;
+
+static const float EM_CRITICAL_ENERGY = 0.0081f;            // GeV, tungsten
+static const float EM_HITS_PER_GEV = 80.f;
+static const float EM_MOLIERE_SIGMA = 15.f;
+static const float HADRONIC_HITS_PER_GEV = 25.f;
+static const float HADRONIC_SIGMA = 60.f;
+static const float HADRONIC_SHAPE = 2.f;
+static const float HADRONIC_SCALE = 0.6f;                   // interaction lengths
+
+/**
+ *  @brief  Get the geometry of a calorimeter layer plane
+ *
+ *  @param  calorimeter the calorimeter description
+ *  @param  layer the layer
+ *  @param  stave the barrel stave, or the endcap side (0 for positive z, 1 for negative z)
+ *  @param  origin to receive the point at which the plane coordinates are zero
+ *  @param  normal to receive the plane unit normal, pointing away from the ip
+ *  @param  axis0 to receive the first plane coordinate axis
+ *  @param  axis1 to receive the second plane coordinate axis
+ */
+void GetLayerPlane(const CalorimeterDescription &calorimeter, const unsigned int layer, const unsigned int stave, pandora::CartesianVector &origin,
+    pandora::CartesianVector &normal, pandora::CartesianVector &axis0, pandora::CartesianVector &axis1);
+
+/**
+ *  @brief  Get the barrel stave whose outward normal is most closely aligned with a specified vector
+ *
+ *  @param  calorimeter the calorimeter description
+ *  @param  vector the vector
+ *
+ *  @return the stave
+ */
+unsigned int GetBarrelStave(const CalorimeterDescription &calorimeter, const pandora::CartesianVector &vector);
+
+/**
+ *  @brief  Get the number of cells in a calorimeter region
+ *
+ *  @param  calorimeter the calorimeter description
+ *
+ *  @return the number of cells
+ */
+double GetNCells(const CalorimeterDescription &calorimeter);
+
+/**
+ *  @brief  Create the gear parameters for a calorimeter region
+ *
+ *  @param  calorimeter the calorimeter description
+ *
+ *  @return address of the gear parameters, ownership passes to the caller
+ */
+gear::CalorimeterParametersImpl *CreateCalorimeterParameters(const CalorimeterDescription &calorimeter);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+SyntheticEventGenerator::SyntheticEventGenerator(const Settings &settings) :
+    m_settings(settings),
+    m_randomEngine(settings.m_randomSeed),
+    m_pMCParticleCollection(NULL),
+    m_pTrackCollection(NULL),
+    m_pTrackerHitCollection(NULL),
+    m_pSimCaloHitCollection(NULL),
+    m_pTrackRelationNavigator(NULL),
+    m_pCaloHitRelationNavigator(NULL)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+SyntheticEventGenerator::~SyntheticEventGenerator()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+gear::GearMgr *SyntheticEventGenerator::CreateGearMgr()
+{
+    gear::GearMgrImpl *const pGearMgr = new gear::GearMgrImpl;
+    pGearMgr->setDetectorName(DETECTOR_NAME);
+
+    pGearMgr->setEcalBarrelParameters(CreateCalorimeterParameters(CALORIMETERS[ECAL_BARREL]));
+    pGearMgr->setEcalEndcapParameters(CreateCalorimeterParameters(CALORIMETERS[ECAL_ENDCAP]));
+    pGearMgr->setHcalBarrelParameters(CreateCalorimeterParameters(CALORIMETERS[HCAL_BARREL]));
+    pGearMgr->setHcalEndcapParameters(CreateCalorimeterParameters(CALORIMETERS[HCAL_ENDCAP]));
+    pGearMgr->setYokeBarrelParameters(CreateCalorimeterParameters(CALORIMETERS[MUON_BARREL]));
+    pGearMgr->setYokeEndcapParameters(CreateCalorimeterParameters(CALORIMETERS[MUON_ENDCAP]));
+
+    // ATTN The muon calo hit creator requires a plug description, although no generated hits lie within it
+    const CalorimeterDescription &hCalEndCap(CALORIMETERS[HCAL_ENDCAP]);
+    const float hCalEndCapOuterZ(hCalEndCap.m_innerZ + static_cast<float>(hCalEndCap.m_nLayers) * hCalEndCap.m_layerThickness);
+    gear::CalorimeterParametersImpl *const pPlugParameters = new gear::CalorimeterParametersImpl(hCalEndCap.m_innerR, hCalEndCap.m_outerR,
+        hCalEndCapOuterZ, 2, 0.);
+    pPlugParameters->layerLayout().positionLayer(hCalEndCapOuterZ, 100., 30., 30., 100.);
+    pGearMgr->setYokePlugParameters(pPlugParameters);
+
+    gear::TPCParametersImpl *const pTPCParameters = new gear::TPCParametersImpl;
+    pTPCParameters->setMaxDriftLength(TPC_MAX_DRIFT_LENGTH);
+    pTPCParameters->setPadLayout(new gear::FixedPadSizeDiskLayout(TPC_INNER_R, TPC_OUTER_R, (TPC_OUTER_R - TPC_INNER_R) / TPC_N_ROWS, 1.,
+        TPC_N_ROWS));
+    pGearMgr->setTPCParameters(pTPCParameters);
+
+    gear::GearParametersImpl *const pCoilParameters = new gear::GearParametersImpl;
+    pCoilParameters->setDoubleVal("Coil_cryostat_inner_radius", COIL_INNER_R);
+    pCoilParameters->setDoubleVal("Coil_cryostat_outer_radius", COIL_OUTER_R);
+    pCoilParameters->setDoubleVal("Coil_cryostat_half_z", COIL_HALF_Z);
+    pGearMgr->setGearParameters("CoilParameters", pCoilParameters);
+
+    const double ftdInnerRadii[] = {39., 49.6, 70.1, 100.3, 102.8, 105.3, 107.8};
+    const double ftdOuterRadii[] = {151.9, 151.9, 298.9, 309.4, 309.4, 309.4, 309.4};
+    const double ftdZPositions[] = {220., 371.3, 644.9, 1046.1, 1300.9, 1555.7, 1810.5};
+    const unsigned int nFtdLayers(sizeof(ftdZPositions) / sizeof(ftdZPositions[0]));
+
+    gear::GearParametersImpl *const pFTDParameters = new gear::GearParametersImpl;
+    pFTDParameters->setDoubleVals("FTDInnerRadius", std::vector<double>(ftdInnerRadii, ftdInnerRadii + nFtdLayers));
+    pFTDParameters->setDoubleVals("FTDOuterRadius", std::vector<double>(ftdOuterRadii, ftdOuterRadii + nFtdLayers));
+    pFTDParameters->setDoubleVals("FTDZCoordinate", std::vector<double>(ftdZPositions, ftdZPositions + nFtdLayers));
+    pGearMgr->setGearParameters("FTD", pFTDParameters);
+
+    pGearMgr->setBField(new gear::ConstantBField(gear::Vector3D(0., 0., B_FIELD)));
+
+    return pGearMgr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float SyntheticEventGenerator::GetInnerBField()
+{
+    return B_FIELD;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::SetCreatorSettings(GeometryCreator::Settings &geometryCreatorSettings,
+    CaloHitCreator::Settings &caloHitCreatorSettings, TrackCreator::Settings &trackCreatorSettings,
+    MCParticleCreator::Settings &mcParticleCreatorSettings)
+{
+    geometryCreatorSettings.m_absorberRadLengthECal = CALORIMETERS[ECAL_BARREL].m_radLength;
+    geometryCreatorSettings.m_absorberIntLengthECal = CALORIMETERS[ECAL_BARREL].m_intLength;
+    geometryCreatorSettings.m_absorberRadLengthHCal = CALORIMETERS[HCAL_BARREL].m_radLength;
+    geometryCreatorSettings.m_absorberIntLengthHCal = CALORIMETERS[HCAL_BARREL].m_intLength;
+    geometryCreatorSettings.m_absorberRadLengthOther = CALORIMETERS[MUON_BARREL].m_radLength;
+    geometryCreatorSettings.m_absorberIntLengthOther = CALORIMETERS[MUON_BARREL].m_intLength;
+
+    // As for the processor, the calo hit creator absorber properties follow the geometry creator settings
+    caloHitCreatorSettings.m_absorberRadLengthECal = geometryCreatorSettings.m_absorberRadLengthECal;
+    caloHitCreatorSettings.m_absorberIntLengthECal = geometryCreatorSettings.m_absorberIntLengthECal;
+    caloHitCreatorSettings.m_absorberRadLengthHCal = geometryCreatorSettings.m_absorberRadLengthHCal;
+    caloHitCreatorSettings.m_absorberIntLengthHCal = geometryCreatorSettings.m_absorberIntLengthHCal;
+    caloHitCreatorSettings.m_absorberRadLengthOther = geometryCreatorSettings.m_absorberRadLengthOther;
+    caloHitCreatorSettings.m_absorberIntLengthOther = geometryCreatorSettings.m_absorberIntLengthOther;
+    caloHitCreatorSettings.m_hCalEndCapInnerSymmetryOrder = geometryCreatorSettings.m_hCalEndCapInnerSymmetryOrder;
+    caloHitCreatorSettings.m_hCalEndCapInnerPhiCoordinate = geometryCreatorSettings.m_hCalEndCapInnerPhiCoordinate;
+
+    caloHitCreatorSettings.m_eCalCaloHitCollections.clear();
+    caloHitCreatorSettings.m_eCalCaloHitCollections.push_back(CALORIMETERS[ECAL_BARREL].m_collectionName);
+    caloHitCreatorSettings.m_eCalCaloHitCollections.push_back(CALORIMETERS[ECAL_ENDCAP].m_collectionName);
+    caloHitCreatorSettings.m_hCalCaloHitCollections.clear();
+    caloHitCreatorSettings.m_hCalCaloHitCollections.push_back(CALORIMETERS[HCAL_BARREL].m_collectionName);
+    caloHitCreatorSettings.m_hCalCaloHitCollections.push_back(CALORIMETERS[HCAL_ENDCAP].m_collectionName);
+    caloHitCreatorSettings.m_muonCaloHitCollections.clear();
+    caloHitCreatorSettings.m_muonCaloHitCollections.push_back(CALORIMETERS[MUON_BARREL].m_collectionName);
+
+    // Generated hit energies are already calibrated, units GeV
+    caloHitCreatorSettings.m_eCalToMip = 1.f / CALORIMETERS[ECAL_BARREL].m_mipEnergy;
+    caloHitCreatorSettings.m_hCalToMip = 1.f / CALORIMETERS[HCAL_BARREL].m_mipEnergy;
+    caloHitCreatorSettings.m_muonToMip = 1.f / CALORIMETERS[MUON_BARREL].m_mipEnergy;
+    caloHitCreatorSettings.m_eCalMipThreshold = 0.5f;
+    caloHitCreatorSettings.m_hCalMipThreshold = 0.3f;
+    caloHitCreatorSettings.m_eCalToEMGeV = 1.f;
+    caloHitCreatorSettings.m_eCalToHadGeVBarrel = 1.f;
+    caloHitCreatorSettings.m_eCalToHadGeVEndCap = 1.f;
+    caloHitCreatorSettings.m_hCalToEMGeV = 1.f;
+    caloHitCreatorSettings.m_hCalToHadGeV = 1.f;
+
+    trackCreatorSettings.m_trackCollections.clear();
+    trackCreatorSettings.m_trackCollections.push_back(TRACK_COLLECTION);
+    trackCreatorSettings.m_curvatureToMomentumFactor = CURVATURE_CONSTANT * B_FIELD;
+
+    mcParticleCreatorSettings.m_mcParticleCollections.clear();
+    mcParticleCreatorSettings.m_mcParticleCollections.push_back(MC_PARTICLE_COLLECTION);
+    mcParticleCreatorSettings.m_lcCaloHitRelationCollections.clear();
+    mcParticleCreatorSettings.m_lcCaloHitRelationCollections.push_back(CALO_HIT_RELATION_COLLECTION);
+    mcParticleCreatorSettings.m_lcTrackRelationCollections.clear();
+    mcParticleCreatorSettings.m_lcTrackRelationCollections.push_back(TRACK_RELATION_COLLECTION);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EVENT::LCEvent *SyntheticEventGenerator::GenerateEvent(const int eventNumber)
+{
+    IMPL::LCEventImpl *const pLCEvent = new IMPL::LCEventImpl;
+    pLCEvent->setRunNumber(0);
+    pLCEvent->setEventNumber(eventNumber);
+    pLCEvent->setDetectorName(DETECTOR_NAME);
+
+    this->BeginEvent();
+
+    if (SINGLE_PARTICLE == m_settings.m_eventType)
+    {
+        this->GenerateParticle(m_settings.m_particlePdg, m_settings.m_particleEnergy, this->GetRandomDirection(), NULL);
+    }
+    else
+    {
+        for (unsigned int iJet = 0; iJet < m_settings.m_nJets; ++iJet)
+            this->GenerateJet(m_settings.m_jetEnergy);
+    }
+
+    if (m_settings.m_backgroundOccupancy > 0.f)
+        this->GenerateBackground();
+
+    this->EndEvent(pLCEvent);
+
+    return pLCEvent;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::BeginEvent()
+{
+    m_pMCParticleCollection = new IMPL::LCCollectionVec(LCIO::MCPARTICLE);
+    m_pTrackCollection = new IMPL::LCCollectionVec(LCIO::TRACK);
+    m_pTrackerHitCollection = new IMPL::LCCollectionVec(LCIO::TRACKERHIT);
+    m_pSimCaloHitCollection = new IMPL::LCCollectionVec(LCIO::SIMCALORIMETERHIT);
+    m_pTrackRelationNavigator = new UTIL::LCRelationNavigator(LCIO::TRACK, LCIO::MCPARTICLE);
+    m_pCaloHitRelationNavigator = new UTIL::LCRelationNavigator(LCIO::CALORIMETERHIT, LCIO::SIMCALORIMETERHIT);
+
+    // Regions sharing a collection name share a collection and its encoder
+    for (unsigned int iRegion = 0; iRegion < N_CALORIMETER_REGIONS; ++iRegion)
+    {
+        unsigned int firstRegion(0);
+
+        while (std::string(CALORIMETERS[firstRegion].m_collectionName) != CALORIMETERS[iRegion].m_collectionName)
+            ++firstRegion;
+
+        if (firstRegion < iRegion)
+        {
+            m_caloHitCollections.push_back(m_caloHitCollections[firstRegion]);
+            m_cellIDEncoders.push_back(m_cellIDEncoders[firstRegion]);
+            continue;
+        }
+
+        IMPL::LCCollectionVec *const pCaloHitCollection = new IMPL::LCCollectionVec(LCIO::CALORIMETERHIT);
+        pCaloHitCollection->setFlag(1 << LCIO::CHBIT_LONG);
+        m_caloHitCollections.push_back(pCaloHitCollection);
+        m_cellIDEncoders.push_back(new CellIDEncoder(CALO_HIT_ENCODING, pCaloHitCollection));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::EndEvent(IMPL::LCEventImpl *const pLCEvent)
+{
+    pLCEvent->addCollection(m_pMCParticleCollection, MC_PARTICLE_COLLECTION);
+    pLCEvent->addCollection(m_pTrackerHitCollection, TRACKER_HIT_COLLECTION);
+    pLCEvent->addCollection(m_pTrackCollection, TRACK_COLLECTION);
+    pLCEvent->addCollection(m_pTrackRelationNavigator->createLCCollection(), TRACK_RELATION_COLLECTION);
+    pLCEvent->addCollection(m_pSimCaloHitCollection, SIM_CALO_HIT_COLLECTION);
+    pLCEvent->addCollection(m_pCaloHitRelationNavigator->createLCCollection(), CALO_HIT_RELATION_COLLECTION);
+
+    for (unsigned int iRegion = 0; iRegion < N_CALORIMETER_REGIONS; ++iRegion)
+    {
+        if (std::find(m_caloHitCollections.begin(), m_caloHitCollections.begin() + iRegion, m_caloHitCollections[iRegion]) !=
+            m_caloHitCollections.begin() + iRegion)
+        {
+            continue;
+        }
+
+        pLCEvent->addCollection(m_caloHitCollections[iRegion], CALORIMETERS[iRegion].m_collectionName);
+        delete m_cellIDEncoders[iRegion];
+    }
+
+    delete m_pTrackRelationNavigator;
+    delete m_pCaloHitRelationNavigator;
+
+    m_pMCParticleCollection = NULL;
+    m_pTrackCollection = NULL;
+    m_pTrackerHitCollection = NULL;
+    m_pSimCaloHitCollection = NULL;
+    m_pTrackRelationNavigator = NULL;
+    m_pCaloHitRelationNavigator = NULL;
+    m_caloHitCollections.clear();
+    m_cellIDEncoders.clear();
+    m_cellToHitMap.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::GenerateJet(const float jetEnergy)
+{
+    const pandora::CartesianVector jetAxis(this->GetRandomDirection());
+
+    IMPL::MCParticleImpl *const pParton = new IMPL::MCParticleImpl;
+    const double partonMomentum[3] = {jetEnergy * jetAxis.GetX(), jetEnergy * jetAxis.GetY(), jetEnergy * jetAxis.GetZ()};
+    pParton->setPDG(1);
+    pParton->setGeneratorStatus(2);
+    pParton->setMomentum(partonMomentum);
+    pParton->setMass(0.);
+    pParton->setCharge(-1.f / 3.f);
+    m_pMCParticleCollection->addElement(pParton);
+
+    // Share the jet energy between an exponentially distributed set of fragments
+    std::poisson_distribution<unsigned int> multiplicityDistribution(2. + jetEnergy / 4.);
+    std::exponential_distribution<float> fractionDistribution(1.f);
+    std::uniform_real_distribution<float> flatDistribution(0.f, 1.f);
+    std::normal_distribution<float> angleDistribution(0.f, 0.1f);
+
+    const unsigned int nFragments(std::max(1u, multiplicityDistribution(m_randomEngine)));
+    std::vector<float> fractions;
+    float fractionSum(0.f);
+
+    for (unsigned int iFragment = 0; iFragment < nFragments; ++iFragment)
+    {
+        fractions.push_back(fractionDistribution(m_randomEngine));
+        fractionSum += fractions.back();
+    }
+
+    const pandora::CartesianVector perpendicular0(jetAxis.GetCrossProduct((std::fabs(jetAxis.GetZ()) < 0.9f) ?
+        pandora::CartesianVector(0.f, 0.f, 1.f) : pandora::CartesianVector(1.f, 0.f, 0.f)).GetUnitVector());
+    const pandora::CartesianVector perpendicular1(jetAxis.GetCrossProduct(perpendicular0));
+
+    for (unsigned int iFragment = 0; iFragment < nFragments; ++iFragment)
+    {
+        // Charged pions, photons and long-lived neutral hadrons, in roughly the proportions of jet energy found in hadronic jets
+        const float species(flatDistribution(m_randomEngine));
+        const int pdg((species < 0.62f) ? ((flatDistribution(m_randomEngine) < 0.5f) ? 211 : -211) :
+            (species < 0.88f) ? 22 : (species < 0.95f) ? 130 : 2112);
+
+        const pandora::CartesianVector direction((jetAxis + perpendicular0 * angleDistribution(m_randomEngine) +
+            perpendicular1 * angleDistribution(m_randomEngine)).GetUnitVector());
+
+        this->GenerateParticle(pdg, jetEnergy * fractions[iFragment] / fractionSum, direction, pParton);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::GenerateParticle(const int pdg, const float energy, const pandora::CartesianVector &direction,
+    IMPL::MCParticleImpl *const pParent)
+{
+    float mass(0.f);
+    int charge(0);
+    GetParticleProperties(pdg, mass, charge);
+
+    const float totalEnergy(std::max(energy, mass + 0.01f));
+    const pandora::CartesianVector momentum(direction * std::sqrt(totalEnergy * totalEnergy - mass * mass));
+
+    IMPL::MCParticleImpl *const pMCParticle = new IMPL::MCParticleImpl;
+    const double momentumArray[3] = {momentum.GetX(), momentum.GetY(), momentum.GetZ()};
+    const double vertexArray[3] = {0., 0., 0.};
+    pMCParticle->setPDG(pdg);
+    pMCParticle->setGeneratorStatus(1);
+    pMCParticle->setMomentum(momentumArray);
+    pMCParticle->setMass(mass);
+    pMCParticle->setCharge(static_cast<float>(charge));
+    pMCParticle->setVertex(vertexArray);
+
+    if (NULL != pParent)
+        pMCParticle->addParent(pParent);
+
+    m_pMCParticleCollection->addElement(pMCParticle);
+
+    pandora::CartesianVector calorimeterPosition(0.f, 0.f, 0.f), calorimeterDirection(0.f, 0.f, 0.f);
+    bool isBarrel(false);
+    const bool reachesCalorimeter(this->PropagateToCalorimeter(momentum, charge, calorimeterPosition, calorimeterDirection, isBarrel));
+
+    if (0 != charge)
+        this->CreateTrack(pMCParticle, momentum, charge, reachesCalorimeter, calorimeterPosition, calorimeterDirection);
+
+    if (!reachesCalorimeter)
+        return;
+
+    const double endpointArray[3] = {calorimeterPosition.GetX(), calorimeterPosition.GetY(), calorimeterPosition.GetZ()};
+    pMCParticle->setEndpoint(endpointArray);
+
+    if ((22 == pdg) || (11 == std::abs(pdg)))
+    {
+        this->SimulateElectromagneticShower(pMCParticle, totalEnergy, calorimeterPosition, calorimeterDirection, isBarrel);
+    }
+    else if (13 == std::abs(pdg))
+    {
+        this->SimulateMuon(pMCParticle, calorimeterPosition, calorimeterDirection, isBarrel);
+    }
+    else
+    {
+        this->SimulateHadronicShower(pMCParticle, totalEnergy - ((0 != charge) ? mass : 0.f), 0 != charge, calorimeterPosition,
+            calorimeterDirection, isBarrel);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::GenerateBackground()
+{
+    // A single low energy photon stands in for the many beam-background particles, so that the overlay hits have a true parent
+    IMPL::MCParticleImpl *const pMCParticle = new IMPL::MCParticleImpl;
+    const double momentumArray[3] = {0., 0., 0.01};
+    pMCParticle->setPDG(22);
+    pMCParticle->setGeneratorStatus(0);
+    pMCParticle->setMomentum(momentumArray);
+    pMCParticle->setMass(0.);
+    m_pMCParticleCollection->addElement(pMCParticle);
+
+    const unsigned int backgroundRegions[] = {ECAL_BARREL, ECAL_ENDCAP, HCAL_BARREL, HCAL_ENDCAP};
+    const unsigned int nBackgroundRegions(sizeof(backgroundRegions) / sizeof(backgroundRegions[0]));
+
+    std::uniform_real_distribution<float> flatDistribution(0.f, 1.f);
+    std::exponential_distribution<float> energyDistribution(1.f);
+
+    for (unsigned int iRegion = 0; iRegion < nBackgroundRegions; ++iRegion)
+    {
+        const unsigned int region(backgroundRegions[iRegion]);
+        const CalorimeterDescription &calorimeter(CALORIMETERS[region]);
+
+        std::poisson_distribution<unsigned int> nHitsDistribution(m_settings.m_backgroundOccupancy * GetNCells(calorimeter));
+        std::uniform_int_distribution<unsigned int> layerDistribution(0, calorimeter.m_nLayers - 1);
+        std::uniform_int_distribution<unsigned int> staveDistribution(0, calorimeter.m_isBarrel ? calorimeter.m_symmetryOrder - 1 : 1);
+        const unsigned int nHits(nHitsDistribution(m_randomEngine));
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+        {
+            LayerPosition layerPosition;
+            layerPosition.m_isValid = true;
+            layerPosition.m_region = region;
+            layerPosition.m_layer = layerDistribution(m_randomEngine);
+            layerPosition.m_stave = staveDistribution(m_randomEngine);
+
+            pandora::CartesianVector origin(0.f, 0.f, 0.f), normal(0.f, 0.f, 0.f), axis0(0.f, 0.f, 0.f), axis1(0.f, 0.f, 0.f);
+            GetLayerPlane(calorimeter, layerPosition.m_layer, layerPosition.m_stave, origin, normal, axis0, axis1);
+            layerPosition.m_position = origin;
+
+            float offset0(0.f), offset1(0.f);
+
+            if (calorimeter.m_isBarrel)
+            {
+                const float halfWidth(normal.GetDotProduct(origin) * std::tan(M_PI / static_cast<float>(calorimeter.m_symmetryOrder)));
+                offset0 = halfWidth * (2.f * flatDistribution(m_randomEngine) - 1.f);
+                offset1 = calorimeter.m_outerZ * (2.f * flatDistribution(m_randomEngine) - 1.f);
+            }
+            else
+            {
+                const float innerR2(calorimeter.m_innerR * calorimeter.m_innerR), outerR2(calorimeter.m_outerR * calorimeter.m_outerR);
+                const float radius(std::sqrt(innerR2 + (outerR2 - innerR2) * flatDistribution(m_randomEngine)));
+                const float phi(2.f * M_PI * flatDistribution(m_randomEngine));
+                offset0 = radius * std::cos(phi);
+                offset1 = radius * std::sin(phi);
+            }
+
+            this->DepositEnergy(layerPosition, offset0, offset1, calorimeter.m_mipEnergy * energyDistribution(m_randomEngine), pMCParticle);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::CreateTrack(EVENT::MCParticle *const pMCParticle, const pandora::CartesianVector &momentum, const int charge,
+    const bool reachesCalorimeter, const pandora::CartesianVector &calorimeterPosition, const pandora::CartesianVector &calorimeterDirection)
+{
+    const float pT(std::sqrt(momentum.GetX() * momentum.GetX() + momentum.GetY() * momentum.GetY()));
+
+    if (pT < std::numeric_limits<float>::epsilon())
+        return;
+
+    const float radius(pT / (CURVATURE_CONSTANT * B_FIELD));
+    const float omega(static_cast<float>(charge) / radius);
+    const float phi0(std::atan2(momentum.GetY(), momentum.GetX()));
+    const float tanLambda(momentum.GetZ() / pT);
+    const float rowPitch((TPC_OUTER_R - TPC_INNER_R) / static_cast<float>(TPC_N_ROWS));
+
+    EVENT::TrackerHitVec trackerHitVec;
+    float firstArcLength(0.f), lastArcLength(0.f);
+
+    for (unsigned int iRow = 0; iRow < TPC_N_ROWS; ++iRow)
+    {
+        const float rowRadius(TPC_INNER_R + (static_cast<float>(iRow) + 0.5f) * rowPitch);
+
+        if (rowRadius > 2.f * radius)
+            break;
+
+        const float arcLength(2.f * radius * std::asin(rowRadius / (2.f * radius)));
+        const pandora::CartesianVector hitPosition(GetHelixPosition(phi0, radius, charge, tanLambda, arcLength));
+
+        if (std::fabs(hitPosition.GetZ()) > TPC_MAX_DRIFT_LENGTH)
+            break;
+
+        IMPL::TrackerHitImpl *const pTrackerHit = new IMPL::TrackerHitImpl;
+        const double positionArray[3] = {hitPosition.GetX(), hitPosition.GetY(), hitPosition.GetZ()};
+        pTrackerHit->setPosition(positionArray);
+        pTrackerHit->setTime(arcLength * std::sqrt(1.f + tanLambda * tanLambda) / SPEED_OF_LIGHT);
+        m_pTrackerHitCollection->addElement(pTrackerHit);
+
+        if (trackerHitVec.empty())
+            firstArcLength = arcLength;
+
+        lastArcLength = arcLength;
+        trackerHitVec.push_back(pTrackerHit);
+    }
+
+    if (trackerHitVec.empty())
+        return;
+
+    // Diagonal covariance matrix, with a fractional momentum uncertainty of 0.1%
+    float covMatrix[15] = {0.f};
+    covMatrix[0] = 1.e-4f;
+    covMatrix[2] = 1.e-8f;
+    covMatrix[5] = (1.e-3f * omega) * (1.e-3f * omega);
+    covMatrix[9] = 1.e-4f;
+    covMatrix[14] = 1.e-8f;
+
+    IMPL::TrackImpl *const pTrack = new IMPL::TrackImpl;
+    const float ipReferencePoint[3] = {0.f, 0.f, 0.f};
+    pTrack->addTrackState(new IMPL::TrackStateImpl(EVENT::TrackState::AtIP, 0.f, phi0, omega, 0.f, tanLambda, covMatrix, ipReferencePoint));
+    pTrack->addTrackState(CreateTrackState(EVENT::TrackState::AtFirstHit, phi0, radius, charge, tanLambda, firstArcLength, covMatrix));
+    pTrack->addTrackState(CreateTrackState(EVENT::TrackState::AtLastHit, phi0, radius, charge, tanLambda, lastArcLength, covMatrix));
+
+    if (reachesCalorimeter)
+    {
+        const float calorimeterReferencePoint[3] = {calorimeterPosition.GetX(), calorimeterPosition.GetY(), calorimeterPosition.GetZ()};
+        pTrack->addTrackState(new IMPL::TrackStateImpl(EVENT::TrackState::AtCalorimeter, 0.f, std::atan2(calorimeterDirection.GetY(),
+            calorimeterDirection.GetX()), omega, 0.f, tanLambda, covMatrix, calorimeterReferencePoint));
+    }
+    else
+    {
+        pTrack->addTrackState(CreateTrackState(EVENT::TrackState::AtCalorimeter, phi0, radius, charge, tanLambda, lastArcLength, covMatrix));
+    }
+
+    for (EVENT::TrackerHitVec::const_iterator iter = trackerHitVec.begin(), iterEnd = trackerHitVec.end(); iter != iterEnd; ++iter)
+        pTrack->addHit(*iter);
+
+    const int nTpcHits(trackerHitVec.size());
+    pTrack->subdetectorHitNumbers().resize(2 * lcio::ILDDetID::ETD, 0);
+    pTrack->subdetectorHitNumbers()[2 * lcio::ILDDetID::TPC - 2] = nTpcHits;
+    pTrack->subdetectorHitNumbers()[2 * lcio::ILDDetID::TPC - 1] = nTpcHits;
+    pTrack->setRadiusOfInnermostHit(TPC_INNER_R + 0.5f * rowPitch);
+    pTrack->setChi2(static_cast<float>(2 * nTpcHits - 5));
+    pTrack->setNdf(2 * nTpcHits - 5);
+
+    m_pTrackCollection->addElement(pTrack);
+    m_pTrackRelationNavigator->addRelation(pTrack, pMCParticle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool SyntheticEventGenerator::PropagateToCalorimeter(const pandora::CartesianVector &momentum, const int charge,
+    pandora::CartesianVector &position, pandora::CartesianVector &direction, bool &isBarrel) const
+{
+    const CalorimeterDescription &eCalBarrel(CALORIMETERS[ECAL_BARREL]), &eCalEndCap(CALORIMETERS[ECAL_ENDCAP]);
+    const float pT(std::sqrt(momentum.GetX() * momentum.GetX() + momentum.GetY() * momentum.GetY()));
+    const float pZ(std::fabs(momentum.GetZ()));
+
+    if (momentum.GetMagnitude() < std::numeric_limits<float>::epsilon())
+        return false;
+
+    // Neutral particles travel in straight lines; charged particles follow a helix, first tested against the barrel inner cylinder
+    if ((0 == charge) || (pT < std::numeric_limits<float>::epsilon()))
+    {
+        direction = momentum.GetUnitVector();
+        isBarrel = (pT * eCalBarrel.m_outerZ > pZ * eCalBarrel.m_innerR);
+        position = isBarrel ? direction * (eCalBarrel.m_innerR * momentum.GetMagnitude() / pT) :
+            direction * (eCalEndCap.m_innerZ * momentum.GetMagnitude() / pZ);
+    }
+    else
+    {
+        const float radius(pT / (CURVATURE_CONSTANT * B_FIELD));
+        const float phi0(std::atan2(momentum.GetY(), momentum.GetX()));
+        const float tanLambda(momentum.GetZ() / pT);
+        float arcLength(std::numeric_limits<float>::max());
+
+        if (eCalBarrel.m_innerR < 2.f * radius)
+            arcLength = 2.f * radius * std::asin(eCalBarrel.m_innerR / (2.f * radius));
+
+        isBarrel = (std::fabs(arcLength * tanLambda) < eCalBarrel.m_outerZ);
+
+        if (!isBarrel)
+        {
+            if (std::fabs(tanLambda) < std::numeric_limits<float>::epsilon())
+                return false;
+
+            arcLength = eCalEndCap.m_innerZ / std::fabs(tanLambda);
+        }
+
+        const float phi(phi0 - static_cast<float>(charge) * arcLength / radius);
+        position = GetHelixPosition(phi0, radius, charge, tanLambda, arcLength);
+        direction = pandora::CartesianVector(std::cos(phi), std::sin(phi), tanLambda).GetUnitVector();
+    }
+
+    if (!isBarrel)
+    {
+        const float positionR(std::sqrt(position.GetX() * position.GetX() + position.GetY() * position.GetY()));
+
+        if ((positionR < eCalEndCap.m_innerR) || (positionR > eCalEndCap.m_outerR))
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::SimulateElectromagneticShower(EVENT::MCParticle *const pMCParticle, const float energy,
+    const pandora::CartesianVector &position, const pandora::CartesianVector &direction, const bool isBarrel)
+{
+    LayerPositionVector layerPositionVector;
+    this->GetLayerPositions(isBarrel ? ECAL_BARREL : ECAL_ENDCAP, position, direction, false, layerPositionVector);
+
+    // Longitudinal gamma distribution profile, with its maximum at ln(E/Ec) - 0.5 radiation lengths
+    const float profileScale(0.5f);
+    const float profileShape(1.f + profileScale * std::max(0.5f, std::log(energy / EM_CRITICAL_ENERGY) - 0.5f));
+
+    std::poisson_distribution<unsigned int> nHitsDistribution(energy * EM_HITS_PER_GEV);
+    std::gamma_distribution<float> depthDistribution(profileShape, 1.f / profileScale);
+    std::normal_distribution<float> transverseDistribution(0.f, EM_MOLIERE_SIGMA);
+
+    const unsigned int nHits(std::max(1u, nHitsDistribution(m_randomEngine)));
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        const float depth(depthDistribution(m_randomEngine));
+        LayerPositionVector::const_iterator iter(layerPositionVector.begin());
+
+        while ((layerPositionVector.end() != iter) && (iter->m_depth < depth))
+            ++iter;
+
+        // Energy beyond the rear of the ecal leaks out
+        if (layerPositionVector.end() == iter)
+            continue;
+
+        this->DepositEnergy(*iter, transverseDistribution(m_randomEngine), transverseDistribution(m_randomEngine),
+            energy / static_cast<float>(nHits), pMCParticle);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::SimulateHadronicShower(EVENT::MCParticle *const pMCParticle, const float energy, const bool isCharged,
+    const pandora::CartesianVector &position, const pandora::CartesianVector &direction, const bool isBarrel)
+{
+    LayerPositionVector layerPositionVector;
+    this->GetLayerPositions(isBarrel ? ECAL_BARREL : ECAL_ENDCAP, position, direction, true, layerPositionVector);
+    this->GetLayerPositions(isBarrel ? HCAL_BARREL : HCAL_ENDCAP, position, direction, true, layerPositionVector);
+
+    std::exponential_distribution<float> interactionDistribution(1.f);
+    std::gamma_distribution<float> depthDistribution(HADRONIC_SHAPE, HADRONIC_SCALE);
+    std::normal_distribution<float> transverseDistribution(0.f, HADRONIC_SIGMA);
+    std::gamma_distribution<float> mipDistribution(4.f, 0.25f);
+
+    const float interactionDepth(interactionDistribution(m_randomEngine));
+
+    // Charged hadrons leave a mip track segment up to the interaction point
+    if (isCharged)
+    {
+        for (LayerPositionVector::const_iterator iter = layerPositionVector.begin(), iterEnd = layerPositionVector.end();
+            (iter != iterEnd) && (iter->m_depth < interactionDepth); ++iter)
+        {
+            this->DepositEnergy(*iter, 0.f, 0.f, CALORIMETERS[iter->m_region].m_mipEnergy * mipDistribution(m_randomEngine), pMCParticle);
+        }
+    }
+
+    std::poisson_distribution<unsigned int> nHitsDistribution(energy * HADRONIC_HITS_PER_GEV);
+    const unsigned int nHits(std::max(1u, nHitsDistribution(m_randomEngine)));
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        const float depth(interactionDepth + depthDistribution(m_randomEngine));
+        LayerPositionVector::const_iterator iter(layerPositionVector.begin());
+
+        while ((layerPositionVector.end() != iter) && (iter->m_depth < depth))
+            ++iter;
+
+        if (layerPositionVector.end() == iter)
+            continue;
+
+        this->DepositEnergy(*iter, transverseDistribution(m_randomEngine), transverseDistribution(m_randomEngine),
+            energy / static_cast<float>(nHits), pMCParticle);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::SimulateMuon(EVENT::MCParticle *const pMCParticle, const pandora::CartesianVector &position,
+    const pandora::CartesianVector &direction, const bool isBarrel)
+{
+    LayerPositionVector layerPositionVector, muonBarrelPositionVector, muonEndCapPositionVector;
+    this->GetLayerPositions(isBarrel ? ECAL_BARREL : ECAL_ENDCAP, position, direction, false, layerPositionVector);
+    this->GetLayerPositions(isBarrel ? HCAL_BARREL : HCAL_ENDCAP, position, direction, false, layerPositionVector);
+    this->GetLayerPositions(MUON_BARREL, position, direction, false, muonBarrelPositionVector);
+    this->GetLayerPositions(MUON_ENDCAP, position, direction, false, muonEndCapPositionVector);
+
+    // The muon barrel and endcap overlap in polar angle, so the muon may cross layers of both
+    layerPositionVector.insert(layerPositionVector.end(), muonBarrelPositionVector.begin(), muonBarrelPositionVector.end());
+    layerPositionVector.insert(layerPositionVector.end(), muonEndCapPositionVector.begin(), muonEndCapPositionVector.end());
+
+    std::gamma_distribution<float> mipDistribution(4.f, 0.25f);
+
+    for (LayerPositionVector::const_iterator iter = layerPositionVector.begin(), iterEnd = layerPositionVector.end(); iter != iterEnd; ++iter)
+        this->DepositEnergy(*iter, 0.f, 0.f, CALORIMETERS[iter->m_region].m_mipEnergy * mipDistribution(m_randomEngine), pMCParticle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::GetLayerPositions(const unsigned int region, const pandora::CartesianVector &position,
+    const pandora::CartesianVector &direction, const bool useInteractionLengths, LayerPositionVector &layerPositionVector) const
+{
+    const CalorimeterDescription &calorimeter(CALORIMETERS[region]);
+    const float depthPerLayer(calorimeter.m_absorberThickness * (useInteractionLengths ? calorimeter.m_intLength : calorimeter.m_radLength));
+    float depth(layerPositionVector.empty() ? 0.f : layerPositionVector.back().m_depth);
+
+    for (unsigned int iLayer = 0; iLayer < calorimeter.m_nLayers; ++iLayer)
+    {
+        depth += depthPerLayer;
+
+        LayerPosition layerPosition;
+        layerPosition.m_region = region;
+        layerPosition.m_layer = iLayer;
+        layerPosition.m_depth = depth;
+        layerPosition.m_stave = calorimeter.m_isBarrel ? GetBarrelStave(calorimeter, direction) : ((direction.GetZ() > 0.f) ? 0 : 1);
+
+        // Barrel staves are chosen by the direction, then refined using the intersection itself
+        for (unsigned int iPass = 0; iPass < 2; ++iPass)
+        {
+            pandora::CartesianVector origin(0.f, 0.f, 0.f), normal(0.f, 0.f, 0.f), axis0(0.f, 0.f, 0.f), axis1(0.f, 0.f, 0.f);
+            GetLayerPlane(calorimeter, iLayer, layerPosition.m_stave, origin, normal, axis0, axis1);
+
+            const float cosAngle(normal.GetDotProduct(direction));
+
+            if (cosAngle < std::numeric_limits<float>::epsilon())
+                break;
+
+            const float pathLength((normal.GetDotProduct(origin) - normal.GetDotProduct(position)) / cosAngle);
+
+            if (pathLength < 0.f)
+                break;
+
+            layerPosition.m_position = position + direction * pathLength;
+            const float coordinate0(axis0.GetDotProduct(layerPosition.m_position - origin));
+            const float coordinate1(axis1.GetDotProduct(layerPosition.m_position - origin));
+
+            if (calorimeter.m_isBarrel)
+            {
+                const unsigned int stave(GetBarrelStave(calorimeter, layerPosition.m_position));
+
+                if ((0 == iPass) && (stave != layerPosition.m_stave))
+                {
+                    layerPosition.m_stave = stave;
+                    continue;
+                }
+
+                const float halfWidth(normal.GetDotProduct(origin) * std::tan(M_PI / static_cast<float>(calorimeter.m_symmetryOrder)));
+                layerPosition.m_isValid = ((std::fabs(coordinate0) < halfWidth) && (std::fabs(coordinate1) < calorimeter.m_outerZ));
+            }
+            else
+            {
+                const float radius(std::sqrt(coordinate0 * coordinate0 + coordinate1 * coordinate1));
+                layerPosition.m_isValid = ((radius > calorimeter.m_innerR) && (radius < calorimeter.m_outerR));
+            }
+
+            break;
+        }
+
+        layerPositionVector.push_back(layerPosition);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::DepositEnergy(const LayerPosition &layerPosition, const float offset0, const float offset1, const float energy,
+    EVENT::MCParticle *const pMCParticle)
+{
+    if (!layerPosition.m_isValid)
+        return;
+
+    const CalorimeterDescription &calorimeter(CALORIMETERS[layerPosition.m_region]);
+    pandora::CartesianVector origin(0.f, 0.f, 0.f), normal(0.f, 0.f, 0.f), axis0(0.f, 0.f, 0.f), axis1(0.f, 0.f, 0.f);
+    GetLayerPlane(calorimeter, layerPosition.m_layer, layerPosition.m_stave, origin, normal, axis0, axis1);
+
+    // Snap to the centre of the cell containing the offset point
+    const int cellIndex0(static_cast<int>(std::floor((axis0.GetDotProduct(layerPosition.m_position - origin) + offset0) / calorimeter.m_cellSize)));
+    const int cellIndex1(static_cast<int>(std::floor((axis1.GetDotProduct(layerPosition.m_position - origin) + offset1) / calorimeter.m_cellSize)));
+    const float coordinate0((static_cast<float>(cellIndex0) + 0.5f) * calorimeter.m_cellSize);
+    const float coordinate1((static_cast<float>(cellIndex1) + 0.5f) * calorimeter.m_cellSize);
+
+    if (calorimeter.m_isBarrel)
+    {
+        const float halfWidth(normal.GetDotProduct(origin) * std::tan(M_PI / static_cast<float>(calorimeter.m_symmetryOrder)));
+
+        if ((std::fabs(coordinate0) > halfWidth) || (std::fabs(coordinate1) > calorimeter.m_outerZ))
+            return;
+    }
+    else
+    {
+        const float radius(std::sqrt(coordinate0 * coordinate0 + coordinate1 * coordinate1));
+
+        if ((radius < calorimeter.m_innerR) || (radius > calorimeter.m_outerR))
+            return;
+    }
+
+    const pandora::CartesianVector cellPosition(origin + axis0 * coordinate0 + axis1 * coordinate1);
+    const float time(cellPosition.GetMagnitude() / SPEED_OF_LIGHT);
+
+    const unsigned long long cellKey((static_cast<unsigned long long>(layerPosition.m_region) << 52) |
+        (static_cast<unsigned long long>(layerPosition.m_layer) << 45) | (static_cast<unsigned long long>(layerPosition.m_stave) << 40) |
+        (static_cast<unsigned long long>(cellIndex0 + (1 << 19)) << 20) | static_cast<unsigned long long>(cellIndex1 + (1 << 19)));
+
+    CellToHitMap::iterator iter(m_cellToHitMap.find(cellKey));
+
+    if (m_cellToHitMap.end() == iter)
+    {
+        const float positionArray[3] = {cellPosition.GetX(), cellPosition.GetY(), cellPosition.GetZ()};
+        const int symmetryOrder(calorimeter.m_symmetryOrder);
+        const int stave(layerPosition.m_stave);
+
+        IMPL::CalorimeterHitImpl *const pCaloHit = new IMPL::CalorimeterHitImpl;
+        pCaloHit->setPosition(positionArray);
+        pCaloHit->setTime(time);
+
+        CellIDEncoder &cellIDEncoder(*m_cellIDEncoders[layerPosition.m_region]);
+        cellIDEncoder["M"] = calorimeter.m_isBarrel ? 0 : 1 + stave;
+        cellIDEncoder["S-1"] = !calorimeter.m_isBarrel ? 0 : calorimeter.m_isHCalStaveCoding ? 2 * ((symmetryOrder - stave) % symmetryOrder) : stave;
+        cellIDEncoder["I"] = cellIndex0 & 0xffff;
+        cellIDEncoder["J"] = cellIndex1 & 0xffff;
+        cellIDEncoder["K-1"] = layerPosition.m_layer;
+        cellIDEncoder.setCellID(pCaloHit);
+        m_caloHitCollections[layerPosition.m_region]->addElement(pCaloHit);
+
+        IMPL::SimCalorimeterHitImpl *const pSimCaloHit = new IMPL::SimCalorimeterHitImpl;
+        pSimCaloHit->setPosition(positionArray);
+        pSimCaloHit->setCellID0(pCaloHit->getCellID0());
+        pSimCaloHit->setCellID1(pCaloHit->getCellID1());
+        m_pSimCaloHitCollection->addElement(pSimCaloHit);
+
+        m_pCaloHitRelationNavigator->addRelation(pCaloHit, pSimCaloHit);
+        iter = m_cellToHitMap.insert(CellToHitMap::value_type(cellKey, CellHit(pCaloHit, pSimCaloHit))).first;
+    }
+
+    iter->second.first->setEnergy(iter->second.first->getEnergy() + energy);
+    iter->second.second->addMCParticleContribution(pMCParticle, energy, time, pMCParticle->getPDG());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::CartesianVector SyntheticEventGenerator::GetHelixPosition(const float phi0, const float radius, const int charge, const float tanLambda,
+    const float arcLength)
+{
+    // Positive particles turn clockwise in a field along positive z
+    const float signedRadius(static_cast<float>(charge) * radius);
+    const float phi(phi0 - arcLength / signedRadius);
+
+    return pandora::CartesianVector(signedRadius * (std::sin(phi0) - std::sin(phi)), signedRadius * (std::cos(phi) - std::cos(phi0)),
+        arcLength * tanLambda);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EVENT::TrackState *SyntheticEventGenerator::CreateTrackState(const int location, const float phi0, const float radius, const int charge,
+    const float tanLambda, const float arcLength, const float *const pCovMatrix)
+{
+    const pandora::CartesianVector referencePoint(GetHelixPosition(phi0, radius, charge, tanLambda, arcLength));
+    const float referencePointArray[3] = {referencePoint.GetX(), referencePoint.GetY(), referencePoint.GetZ()};
+    const float phi(phi0 - static_cast<float>(charge) * arcLength / radius);
+
+    return new IMPL::TrackStateImpl(location, 0.f, std::atan2(std::sin(phi), std::cos(phi)), static_cast<float>(charge) / radius, 0.f, tanLambda,
+        pCovMatrix, referencePointArray);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SyntheticEventGenerator::GetParticleProperties(const int pdg, float &mass, int &charge)
+{
+    switch (std::abs(pdg))
+    {
+    case 11:
+        mass = 0.000511f;
+        charge = (pdg > 0) ? -1 : 1;
+        break;
+    case 13:
+        mass = 0.105658f;
+        charge = (pdg > 0) ? -1 : 1;
+        break;
+    case 211:
+        mass = 0.139570f;
+        charge = (pdg > 0) ? 1 : -1;
+        break;
+    case 321:
+        mass = 0.493677f;
+        charge = (pdg > 0) ? 1 : -1;
+        break;
+    case 2212:
+        mass = 0.938272f;
+        charge = (pdg > 0) ? 1 : -1;
+        break;
+    case 130:
+        mass = 0.497614f;
+        charge = 0;
+        break;
+    case 2112:
+        mass = 0.939565f;
+        charge = 0;
+        break;
+    case 22:
+        mass = 0.f;
+        charge = 0;
+        break;
+    default:
+        streamlog_out(ERROR) << "SyntheticEventGenerator: unsupported particle pdg code " << pdg << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::CartesianVector SyntheticEventGenerator::GetRandomDirection()
+{
+    std::uniform_real_distribution<float> cosThetaDistribution(-MAX_COS_THETA, MAX_COS_THETA);
+    std::uniform_real_distribution<float> phiDistribution(0.f, 2.f * M_PI);
+
+    const float cosTheta(cosThetaDistribution(m_randomEngine));
+    const float sinTheta(std::sqrt(1.f - cosTheta * cosTheta));
+    const float phi(phiDistribution(m_randomEngine));
+
+    return pandora::CartesianVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+SyntheticEventGenerator::Settings::Settings() :
+    m_eventType(SINGLE_PARTICLE),
+    m_particlePdg(211),
+    m_particleEnergy(10.f),
+    m_nJets(2),
+    m_jetEnergy(45.f),
+    m_backgroundOccupancy(0.f),
+    m_randomSeed(12345)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+SyntheticEventGenerator::LayerPosition::LayerPosition() :
+    m_isValid(false),
+    m_region(0),
+    m_layer(0),
+    m_stave(0),
+    m_depth(0.f),
+    m_position(0.f, 0.f, 0.f)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GetLayerPlane(const CalorimeterDescription &calorimeter, const unsigned int layer, const unsigned int stave, pandora::CartesianVector &origin,
+    pandora::CartesianVector &normal, pandora::CartesianVector &axis0, pandora::CartesianVector &axis1)
+{
+    if (calorimeter.m_isBarrel)
+    {
+        // As in the calo hit creator, stave s has outward normal (-sin(phi), cos(phi), 0), phi = 2 pi s / symmetry order
+        const float phi(2.f * M_PI * static_cast<float>(stave) / static_cast<float>(calorimeter.m_symmetryOrder));
+        const float distance(calorimeter.m_innerR + (static_cast<float>(layer) + 0.5f) * calorimeter.m_layerThickness);
+
+        normal = pandora::CartesianVector(-std::sin(phi), std::cos(phi), 0.f);
+        origin = normal * distance;
+        axis0 = pandora::CartesianVector(std::cos(phi), std::sin(phi), 0.f);
+        axis1 = pandora::CartesianVector(0.f, 0.f, 1.f);
+    }
+    else
+    {
+        const float side((0 == stave) ? 1.f : -1.f);
+        const float z(calorimeter.m_innerZ + (static_cast<float>(layer) + 0.5f) * calorimeter.m_layerThickness);
+
+        normal = pandora::CartesianVector(0.f, 0.f, side);
+        origin = normal * z;
+        axis0 = pandora::CartesianVector(1.f, 0.f, 0.f);
+        axis1 = pandora::CartesianVector(0.f, 1.f, 0.f);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int GetBarrelStave(const CalorimeterDescription &calorimeter, const pandora::CartesianVector &vector)
+{
+    unsigned int bestStave(0);
+    float bestDotProduct(-std::numeric_limits<float>::max());
+
+    for (int iStave = 0; iStave < calorimeter.m_symmetryOrder; ++iStave)
+    {
+        const float phi(2.f * M_PI * static_cast<float>(iStave) / static_cast<float>(calorimeter.m_symmetryOrder));
+        const float dotProduct(-std::sin(phi) * vector.GetX() + std::cos(phi) * vector.GetY());
+
+        if (dotProduct > bestDotProduct)
+        {
+            bestDotProduct = dotProduct;
+            bestStave = iStave;
+        }
+    }
+
+    return bestStave;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double GetNCells(const CalorimeterDescription &calorimeter)
+{
+    double nCells(0.);
+
+    for (unsigned int iLayer = 0; iLayer < calorimeter.m_nLayers; ++iLayer)
+    {
+        if (calorimeter.m_isBarrel)
+        {
+            const double distance(calorimeter.m_innerR + (iLayer + 0.5) * calorimeter.m_layerThickness);
+            const double staveWidth(2. * distance * std::tan(M_PI / calorimeter.m_symmetryOrder));
+            nCells += calorimeter.m_symmetryOrder * staveWidth * 2. * calorimeter.m_outerZ;
+        }
+        else
+        {
+            nCells += 2. * M_PI * (calorimeter.m_outerR * calorimeter.m_outerR - calorimeter.m_innerR * calorimeter.m_innerR);
+        }
+    }
+
+    return nCells / (calorimeter.m_cellSize * calorimeter.m_cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+gear::CalorimeterParametersImpl *CreateCalorimeterParameters(const CalorimeterDescription &calorimeter)
+{
+    gear::CalorimeterParametersImpl *const pParameters = calorimeter.m_isBarrel ?
+        new gear::CalorimeterParametersImpl(calorimeter.m_innerR, calorimeter.m_outerZ, calorimeter.m_symmetryOrder, 0.) :
+        new gear::CalorimeterParametersImpl(calorimeter.m_innerR, calorimeter.m_outerR, calorimeter.m_innerZ, calorimeter.m_symmetryOrder, 0.);
+
+    const float innerDistance(calorimeter.m_isBarrel ? calorimeter.m_innerR : calorimeter.m_innerZ);
+
+    for (unsigned int iLayer = 0; iLayer < calorimeter.m_nLayers; ++iLayer)
+    {
+        pParameters->layerLayout().positionLayer(innerDistance + iLayer * calorimeter.m_layerThickness, calorimeter.m_layerThickness,
+            calorimeter.m_cellSize, calorimeter.m_cellSize, calorimeter.m_absorberThickness);
+    }
+
+    return pParameters;
+}
@@ -0,0 +1,240 @@
+/**
+ *  @file   MarlinPandora/include/BinaryFile.h
+ *
+ *  @brief  Header file for the binary file output and input classes.
+ *
+ *  $Log: $
+ */
+
+#ifndef BINARY_FILE_H
+#define BINARY_FILE_H 1
+
+#include "Pandora/StatusCodes.h"
+
+#include <cstring>
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  BinaryFileOutput class, accumulates a payload in memory and writes it to file behind a versioned, checksummed header
+ */
+class BinaryFileOutput
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  fileType the eight character file type identifier
+     *  @param  version the file format version
+     */
+    BinaryFileOutput(const std::string &fileType, const unsigned int version);
+
+    /**
+     *  @brief  Append a plain value to the payload
+     *
+     *  @param  t the value
+     */
+    template <typename T>
+    void Write(const T &t);
+
+    /**
+     *  @brief  Append a string to the payload
+     *
+     *  @param  value the string
+     */
+    void WriteString(const std::string &value);
+
+    /**
+     *  @brief  Get the current payload size
+     *
+     *  @return the payload size, units bytes
+     */
+    std::size_t GetPayloadSize() const;
+
+    /**
+     *  @brief  Write the header and payload to file, replacing any existing file atomically
+     *
+     *  @param  fileName the file name
+     */
+    pandora::StatusCode WriteFile(const std::string &fileName) const;
+
+private:
+    /**
+     *  @brief  Write a block of bytes to a file descriptor, continuing after partial writes and interruptions
+     *
+     *  @param  fileDescriptor the file descriptor
+     *  @param  pData address of the block
+     *  @param  size the block size, units bytes
+     *
+     *  @return whether the whole block was written
+     */
+    static bool WriteAll(const int fileDescriptor, const void *const pData, const std::size_t size);
+
+    const std::string       m_fileType;                    ///< The eight character file type identifier
+    const unsigned int      m_version;                      ///< The file format version
+    std::string             m_payload;                      ///< The payload
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  BinaryFileInput class, maps a file written by BinaryFileOutput and reads back the payload after checking the header
+ */
+class BinaryFileInput
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    BinaryFileInput();
+
+    /**
+     *  @brief  Destructor
+     */
+    ~BinaryFileInput();
+
+    /**
+     *  @brief  Map a file and check its type, version, size and checksum
+     *
+     *  @param  fileName the file name
+     *  @param  fileType the expected eight character file type identifier
+     *  @param  version the expected file format version
+     */
+    pandora::StatusCode Open(const std::string &fileName, const std::string &fileType, const unsigned int version);
+
+    /**
+     *  @brief  Read a plain value from the payload
+     *
+     *  @param  t to receive the value
+     */
+    template <typename T>
+    pandora::StatusCode Read(T &t);
+
+    /**
+     *  @brief  Read a string from the payload
+     *
+     *  @param  value to receive the string
+     */
+    pandora::StatusCode ReadString(std::string &value);
+
+    /**
+     *  @brief  Get the current read position within the payload
+     *
+     *  @return the read position, units bytes
+     */
+    std::size_t GetPosition() const;
+
+    /**
+     *  @brief  Get the payload size
+     *
+     *  @return the payload size, units bytes
+     */
+    std::size_t GetPayloadSize() const;
+
+    /**
+     *  @brief  Set the read position within the payload
+     *
+     *  @param  position the read position, units bytes
+     */
+    pandora::StatusCode SetPosition(const std::size_t position);
+
+    /**
+     *  @brief  Whether the whole payload has been read
+     *
+     *  @return boolean
+     */
+    bool IsAtEnd() const;
+
+    /**
+     *  @brief  Get the payload checksum, as stored in the file header
+     *
+     *  @return the payload checksum
+     */
+    unsigned long long GetChecksum() const;
+
+private:
+    /**
+     *  @brief  Unmap any currently mapped file
+     */
+    void Close();
+
+    void                   *m_pMapping;                     ///< Address of the file mapping
+    std::size_t             m_mappingSize;                  ///< The size of the file mapping
+    const char             *m_pPayload;                     ///< Address of the start of the payload
+    std::size_t             m_payloadSize;                  ///< The payload size
+    std::size_t             m_position;                     ///< The current read position within the payload
+    unsigned long long      m_checksum;                     ///< The payload checksum
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  Calculate the 64-bit FNV-1a hash of a block of memory
+ *
+ *  @param  pData address of the start of the block
+ *  @param  size the block size, units bytes
+ *  @param  seed the initial hash value, allowing hashes to be chained across blocks
+ *
+ *  @return the hash
+ */
+unsigned long long CalculateFnv1aHash(const void *const pData, const std::size_t size, const unsigned long long seed = 14695981039346656037ULL);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void BinaryFileOutput::Write(const T &t)
+{
+    m_payload.append(reinterpret_cast<const char *>(&t), sizeof(T));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline std::size_t BinaryFileOutput::GetPayloadSize() const
+{
+    return m_payload.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline pandora::StatusCode BinaryFileInput::Read(T &t)
+{
+    if ((NULL == m_pPayload) || (m_position + sizeof(T) > m_payloadSize))
+        return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+    std::memcpy(&t, m_pPayload + m_position, sizeof(T));
+    m_position += sizeof(T);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline std::size_t BinaryFileInput::GetPosition() const
+{
+    return m_position;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline std::size_t BinaryFileInput::GetPayloadSize() const
+{
+    return m_payloadSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool BinaryFileInput::IsAtEnd() const
+{
+    return (m_position == m_payloadSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned long long BinaryFileInput::GetChecksum() const
+{
+    return m_checksum;
+}
+
+#endif // #ifndef BINARY_FILE_H
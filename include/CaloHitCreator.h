@@ -11,11 +11,12 @@
 
 #include "EVENT/CalorimeterHit.h"
 
-#include "gear/LayerLayout.h"
-
 #include "Api/PandoraApi.h"
 
+#include "GeometryProvider.h"
+
 #include <string>
+#include <unordered_map>
 
 typedef std::vector<CalorimeterHit *> CalorimeterHitVector;
 
@@ -26,6 +27,10 @@ class CaloHitCreator
 {
 public:
     typedef std::vector<std::string> StringVector;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<PandoraApi::CaloHit::Parameters> CaloHitParametersVector;
+    typedef std::unordered_map<const void *, unsigned int> CalorimeterHitIndexMap;
+    typedef std::unordered_map<const void *, CalorimeterHitVector> SuperCellMemberMap;
 
     /**
      *  @brief  Settings class
@@ -86,15 +91,34 @@ public:
         float           m_eCalScToHadGeVBarrel;                 ///< The calibration from deposited Sc-layer energy on the endcaps to hadronic energy
         float           m_eCalSiToHadGeVEndCap;                 ///< The calibration from deposited Si-layer energy on the enecaps to hadronic energy
         float           m_eCalScToHadGeVEndCap;                 ///< The calibration from deposited Sc-layer energy on the endcaps to hadronic energy
+
+        // Timing windows, applied to hit times corrected for the straight line time of flight from the interaction point
+        int             m_applyTimingWindows;                   ///< Whether to reject hits outside the timing windows
+        float           m_eCalTimeWindowMin;                    ///< Min time of flight corrected time for ecal hits, units ns
+        float           m_eCalTimeWindowMax;                    ///< Max time of flight corrected time for ecal hits, units ns
+        float           m_hCalTimeWindowMin;                    ///< Min time of flight corrected time for hcal hits, units ns
+        float           m_hCalTimeWindowMax;                    ///< Max time of flight corrected time for hcal hits, units ns
+        float           m_muonTimeWindowMin;                    ///< Min time of flight corrected time for muon hits, units ns
+        float           m_muonTimeWindowMax;                    ///< Max time of flight corrected time for muon hits, units ns
+        float           m_forwardTimeWindowMin;                 ///< Min time of flight corrected time for lcal and lhcal hits, units ns
+        float           m_forwardTimeWindowMax;                 ///< Max time of flight corrected time for lcal and lhcal hits, units ns
+
+        // Forward calorimeter coarsening, merging neighbouring cells into super-cells before pandora calo hit creation
+        int             m_coarsenForwardHits;                   ///< Whether to merge lcal and lhcal cells into super-cells
+        IntVector       m_lCalCoarseningFactors;                ///< LCal super-cell size, in cells, per layer (last entry for deeper layers)
+        IntVector       m_lHCalCoarseningFactors;               ///< LHCal super-cell size, in cells, per layer (last entry for deeper layers)
+
+        int             m_sortCaloHitsSpatially;                ///< Whether to order the calo hits by hit type, layer and Morton code of position
+        float           m_spatialSortCellSize;                  ///< The cell size used to quantise positions for the Morton code, units mm
     };
 
     /**
      *  @brief  Constructor
      * 
      *  @param  settings the creator settings
-     *  @param  pPandora address of the relevant pandora instance
+     *  @param  geometryProvider the geometry provider, from which the geometry constants and layer layouts are copied
      */
-     CaloHitCreator(const Settings &settings, const pandora::Pandora *const pPandora);
+     CaloHitCreator(const Settings &settings, const GeometryProvider &geometryProvider);
 
     /**
      *  @brief  Destructor
@@ -102,12 +126,19 @@ public:
      ~CaloHitCreator();
 
     /**
-     *  @brief  Create calo hits
+     *  @brief  Create calo hit parameters from the lcio calorimeter hits, ready to be passed to one or more pandora instances
      * 
      *  @param  pLCEvent the lcio event
      */    
     pandora::StatusCode CreateCaloHits(const LCEvent *const pLCEvent);
 
+    /**
+     *  @brief  Create pandora calo hits, in the specified pandora instance, from the stored calo hit parameters
+     * 
+     *  @param  pandora the pandora instance
+     */
+    pandora::StatusCode CreatePandoraCaloHits(const pandora::Pandora &pandora) const;
+
     /**
      *  @brief  Get the calorimeter hit vector
      * 
@@ -115,6 +146,34 @@ public:
      */
     const CalorimeterHitVector &GetCalorimeterHitVector() const;
 
+    /**
+     *  @brief  Get the calo hit parameters vector
+     * 
+     *  @return The calo hit parameters vector
+     */
+    const CaloHitParametersVector &GetCaloHitParametersVector() const;
+
+    /**
+     *  @brief  Get the calorimeter hit index map, from calorimeter hit address to position in the calorimeter hit vector, which is also
+     *          the order in which the pandora calo hits are created
+     * 
+     *  @return The calorimeter hit index map
+     */
+    const CalorimeterHitIndexMap &GetCalorimeterHitIndexMap() const;
+
+    /**
+     *  @brief  Get the super-cell member map, from the representative calorimeter hit of each forward super-cell (the parent address of
+     *          the pandora calo hit) to all the calorimeter hits merged into the super-cell, including the representative
+     * 
+     *  @return The super-cell member map
+     */
+    const SuperCellMemberMap &GetSuperCellMemberMap() const;
+
+    /**
+     *  @brief  Print the numbers of hits, summed over all events, rejected by the timing windows
+     */
+    void PrintTimingWindowSummary() const;
+
     /**
      *  @brief  Reset the calo hit creator
      */
@@ -156,6 +215,48 @@ private:
      */
     pandora::StatusCode CreateLHCalCaloHits(const EVENT::LCEvent *const pLCEvent);
 
+    /**
+     *  @brief  Add forward calo hits to the stored calo hit parameters, merging neighbouring cells into super-cells if coarsening is enabled.
+     *          Cells in the same layer and endcap are merged on a grid whose pitch is the cell size multiplied by the layer coarsening
+     *          factor. Energies are summed, the position is energy-weighted, the time is the earliest member time and the parent address is
+     *          the highest energy member.
+     * 
+     *  @param  coarseningFactors the super-cell size, in cells, per layer
+     *  @param  caloHitParametersVector the calo hit parameters for the forward cells
+     *  @param  calorimeterHitVector the lcio calorimeter hits for the forward cells, in the same order
+     */
+    void AddForwardCaloHits(const IntVector &coarseningFactors, const CaloHitParametersVector &caloHitParametersVector,
+        const CalorimeterHitVector &calorimeterHitVector);
+
+    /**
+     *  @brief  Reorder the stored calo hit parameters and calorimeter hits, in step, by hit type, then layer, then Morton (Z-order) code of
+     *          position, so that hits adjacent in depth and space are created, and stored by pandora, next to one another
+     */
+    void SortCaloHits();
+
+    /**
+     *  @brief  Get the sort key for calo hit parameters: hit type (4 bits), layer (9 bits) and the Morton code of the quantised position
+     *          (17 bits per coordinate)
+     * 
+     *  @param  caloHitParameters the calo hit parameters
+     *  @param  cellSize the cell size used to quantise the position, units mm
+     * 
+     *  @return the sort key
+     */
+    static unsigned long long GetSortKey(const PandoraApi::CaloHit::Parameters &caloHitParameters, const float cellSize);
+
+    /**
+     *  @brief  Whether the time of a calorimeter hit, corrected for its straight line time of flight from the interaction point, lies
+     *          within a timing window. Always true if the timing windows are not applied.
+     * 
+     *  @param  pCaloHit the lcio calorimeter hit
+     *  @param  timeWindowMin the min corrected time, units ns
+     *  @param  timeWindowMax the max corrected time, units ns
+     * 
+     *  @return boolean
+     */
+    bool IsInTimingWindow(const EVENT::CalorimeterHit *const pCaloHit, const float timeWindowMin, const float timeWindowMax) const;
+
     /**
      *  @brief  Get common calo hit properties: position, parent address, input energy and time
      * 
@@ -168,25 +269,25 @@ private:
      *  @brief  Get end cap specific calo hit properties: cell size, absorber radiation and interaction lengths, normal vector
      * 
      *  @param  pCaloHit the lcio calorimeter hit
-     *  @param  layerLayout the gear end cap layer layout
+     *  @param  layerLayout the end cap layer layout
      *  @param  caloHitParameters the calo hit parameters to populate
      *  @param  absorberCorrection to receive the absorber thickness correction for the mip equivalent energy
      */
-    void GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const gear::LayerLayout &layerLayout,
+    void GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const CalorimeterLayerLayout &layerLayout,
         PandoraApi::CaloHit::Parameters &caloHitParameters, float &absorberCorrection) const;
 
     /**
      *  @brief  Get barrel specific calo hit properties: cell size, absorber radiation and interaction lengths, normal vector
      * 
      *  @param  pCaloHit the lcio calorimeter hit
-     *  @param  layerLayout the gear barrel layer layout
+     *  @param  layerLayout the barrel layer layout
      *  @param  barrelSymmetryOrder the barrel order of symmetry
      *  @param  barrelPhi0 the barrel orientation
      *  @param  staveNumber the stave number
      *  @param  caloHitParameters the calo hit parameters to populate
      *  @param  absorberCorrection to receive the absorber thickness correction for the mip equivalent energy
      */
-    void GetBarrelCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const gear::LayerLayout &layerLayout,
+    void GetBarrelCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const CalorimeterLayerLayout &layerLayout,
         unsigned int barrelSymmetryOrder, float barrelPhi0, unsigned int staveNumber, PandoraApi::CaloHit::Parameters &caloHitParameters,
         float &absorberCorrection) const;
 
@@ -226,9 +327,17 @@ private:
      */
     std::string GetStaveCoding(const std::string &encodingString) const;
 
-    const Settings                      m_settings;                         ///< The calo hit creator settings
+    /**
+     *  @brief  Get the layer layout for a calorimeter region that may be absent from the detector
+     * 
+     *  @param  geometryProvider the geometry provider
+     *  @param  region the calorimeter region
+     * 
+     *  @return the layer layout, with no layers if the region is absent
+     */
+    static CalorimeterLayerLayout GetOptionalLayerLayout(const GeometryProvider &geometryProvider, const GeometryProvider::CalorimeterRegion region);
 
-    const pandora::Pandora             *m_pPandora;                         ///< Address of the pandora object to create calo hits
+    const Settings                      m_settings;                         ///< The calo hit creator settings
 
     const float                         m_eCalBarrelOuterZ;                 ///< ECal barrel outer z coordinate
     const float                         m_hCalBarrelOuterZ;                 ///< HCal barrel outer z coordinate
@@ -248,10 +357,28 @@ private:
     const float                         m_hCalBarrelOuterPhi0;              ///< HCal barrel outer phi0 coordinate
     const unsigned int                  m_hCalBarrelOuterSymmetry;          ///< HCal barrel outer symmetry order
 
-    float                               m_hCalBarrelLayerThickness;         ///< HCal barrel layer thickness
-    float                               m_hCalEndCapLayerThickness;         ///< HCal endcap layer thickness
+    const float                         m_hCalBarrelLayerThickness;         ///< HCal barrel layer thickness
+    const float                         m_hCalEndCapLayerThickness;         ///< HCal endcap layer thickness
+
+    const CalorimeterLayerLayout        m_eCalBarrelLayerLayout;            ///< ECal barrel layer layout
+    const CalorimeterLayerLayout        m_eCalEndCapLayerLayout;            ///< ECal endcap layer layout
+    const CalorimeterLayerLayout        m_hCalBarrelLayerLayout;            ///< HCal barrel layer layout
+    const CalorimeterLayerLayout        m_hCalEndCapLayerLayout;            ///< HCal endcap layer layout
+    const CalorimeterLayerLayout        m_muonBarrelLayerLayout;            ///< Muon barrel layer layout
+    const CalorimeterLayerLayout        m_muonEndCapLayerLayout;            ///< Muon endcap layer layout
+    const CalorimeterLayerLayout        m_muonPlugLayerLayout;              ///< Muon plug layer layout, empty if absent
+    const CalorimeterLayerLayout        m_lCalLayerLayout;                  ///< LCal layer layout, empty if absent
+    const CalorimeterLayerLayout        m_lHCalLayerLayout;                 ///< LHCal layer layout, empty if absent
 
     CalorimeterHitVector                m_calorimeterHitVector;             ///< The calorimeter hit vector
+    CaloHitParametersVector             m_caloHitParametersVector;          ///< The calo hit parameters, to be passed to each pandora instance
+    CalorimeterHitIndexMap              m_calorimeterHitIndexMap;           ///< The calorimeter hit index map, built once per event
+    SuperCellMemberMap                  m_superCellMemberMap;               ///< The members of each forward super-cell, keyed by representative hit
+
+    unsigned int                        m_nECalHitsOutOfTime;               ///< The number of ecal hits rejected by the timing window, all events
+    unsigned int                        m_nHCalHitsOutOfTime;               ///< The number of hcal hits rejected by the timing window, all events
+    unsigned int                        m_nMuonHitsOutOfTime;               ///< The number of muon hits rejected by the timing window, all events
+    unsigned int                        m_nForwardHitsOutOfTime;            ///< The number of lcal and lhcal hits rejected by the timing window, all events
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -263,9 +390,33 @@ inline const CalorimeterHitVector &CaloHitCreator::GetCalorimeterHitVector() con
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+inline const CaloHitCreator::CaloHitParametersVector &CaloHitCreator::GetCaloHitParametersVector() const
+{
+    return m_caloHitParametersVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const CaloHitCreator::CalorimeterHitIndexMap &CaloHitCreator::GetCalorimeterHitIndexMap() const
+{
+    return m_calorimeterHitIndexMap;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const CaloHitCreator::SuperCellMemberMap &CaloHitCreator::GetSuperCellMemberMap() const
+{
+    return m_superCellMemberMap;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 inline void CaloHitCreator::Reset()
 {
     m_calorimeterHitVector.clear();
+    m_caloHitParametersVector.clear();
+    m_calorimeterHitIndexMap.clear();
+    m_superCellMemberMap.clear();
 }
 
 #endif // #ifndef CALO_HIT_CREATOR_H
@@ -10,6 +10,9 @@
 
 #include "Pandora/Algorithm.h"
 
+#include "CaloHitCreator.h"
+
+namespace EVENT { class LCCollection; }
 namespace pandora { class CaloHit; }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -34,14 +37,75 @@ public:
      */
     ExternalClusteringAlgorithm();
 
+    /**
+     *  @brief  Forget the calo hit index for a pandora instance, to be called at the end of each event
+     * 
+     *  @param  pandora the pandora instance
+     */
+    static void ResetCaloHitIndex(const pandora::Pandora &pandora);
+
 private:
     pandora::StatusCode Run();
     pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
 
-    typedef std::map<const void *, const pandora::CaloHit *> ParentAddressToCaloHitMap;
+    typedef std::vector<const pandora::CaloHit *> CaloHitVector;
+    typedef std::vector<unsigned int> IndexVector;
+    typedef std::vector<bool> ClaimedHitVector;
+    typedef std::vector<std::string> StringVector;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<float> FloatVector;
+
+    /**
+     *  @brief  CaloHitIndex class, the pandora calo hits in a calo hit list, indexed by the order in which they were created
+     */
+    class CaloHitIndex
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        CaloHitIndex();
+
+        std::string                     m_caloHitListName;  ///< The name of the indexed calo hit list
+        const pandora::CaloHitList     *m_pCaloHitList;     ///< Address of the indexed calo hit list
+        unsigned int                    m_nCaloHits;        ///< The number of calo hits in the indexed list, when indexed
+        CaloHitVector                   m_caloHitVector;    ///< The calo hits, by creation order, NULL if not in the indexed list
+    };
+
+    typedef std::map<const pandora::Pandora *, CaloHitIndex *> CaloHitIndexMap;
+
+    /**
+     *  @brief  Recreate the clusters in an external cluster collection within the pandora framework
+     * 
+     *  @param  pExternalClusterCollection address of the external cluster collection
+     *  @param  particleId the particle id to assign to the new clusters, zero to leave unset
+     *  @param  minRetainedHitFraction the min fraction of its calo hits a cluster must retain, after higher priority claims, to be recreated
+     *  @param  caloHitVector the calo hits in the current list, by creation order
+     *  @param  calorimeterHitIndexMap the calorimeter hit index map, from parent address to creation order
+     *  @param  claimedHitVector the calo hits already claimed by recreated clusters, by creation order, to be updated
+     */
+    pandora::StatusCode RecreateClusters(const EVENT::LCCollection *const pExternalClusterCollection, const int particleId,
+        const float minRetainedHitFraction, const CaloHitVector &caloHitVector, const CaloHitCreator::CalorimeterHitIndexMap &calorimeterHitIndexMap,
+        ClaimedHitVector &claimedHitVector) const;
+
+    /**
+     *  @brief  Get the index of the current calo hit list, built on first use for each event and list, then shared by all algorithm instances.
+     *          The index is rebuilt whenever the current list name, address or size differs from that of the indexed list.
+     * 
+     *  @param  caloHitListName the name of the current calo hit list
+     *  @param  caloHitList the current calo hit list
+     *  @param  calorimeterHitIndexMap the calorimeter hit index map, from parent address to creation order
+     * 
+     *  @return the calo hits, by creation order
+     */
+    const CaloHitVector &GetCaloHitIndex(const std::string &caloHitListName, const pandora::CaloHitList &caloHitList,
+        const CaloHitCreator::CalorimeterHitIndexMap &calorimeterHitIndexMap) const;
+
+    StringVector            m_externalClusterCollectionNames;   ///< The external cluster collection names, in decreasing priority for shared hits
+    IntVector               m_particleIds;                      ///< The particle id for the clusters from each collection, zero for none
+    FloatVector             m_minRetainedHitFractions;          ///< The min retained hit fraction for the clusters from each collection
 
-    std::string     m_externalClusterCollectionName;        ///< The collection name for the external clusters
-    bool            m_flagClustersAsPhotons;                ///< Whether to automatically flag new clusters as fixed photons
+    static CaloHitIndexMap  m_caloHitIndexMap;                  ///< The calo hit indices, keyed by pandora instance
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
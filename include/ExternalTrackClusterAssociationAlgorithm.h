@@ -0,0 +1,74 @@
+/**
+ *  @file   MarlinPandora/include/ExternalTrackClusterAssociationAlgorithm.h
+ * 
+ *  @brief  Header file for the external track-cluster association algorithm class.
+ * 
+ *  $Log: $
+ */
+#ifndef EXTERNAL_TRACK_CLUSTER_ASSOCIATION_ALGORITHM_H
+#define EXTERNAL_TRACK_CLUSTER_ASSOCIATION_ALGORITHM_H 1
+
+#include "Pandora/Algorithm.h"
+
+#include <unordered_map>
+
+namespace EVENT { class Cluster; }
+namespace pandora { class Cluster; class Track; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ExternalTrackClusterAssociationAlgorithm class, importing track-cluster associations from an lcio relation collection between
+ *          tracks and external clusters. Each external cluster is identified with the pandora cluster holding most of its calorimeter hits.
+ */
+class ExternalTrackClusterAssociationAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        pandora::Algorithm *CreateAlgorithm() const;
+    };
+
+    /**
+     *  @brief  Default constructor
+     */
+    ExternalTrackClusterAssociationAlgorithm();
+
+private:
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::unordered_map<const void *, const pandora::Track *> ParentAddressToTrackMap;
+    typedef std::unordered_map<const void *, const pandora::Cluster *> ParentAddressToClusterMap;
+    typedef std::map<const pandora::Cluster *, unsigned int> ClusterToHitCountMap;
+    typedef std::pair<const pandora::Cluster *, float> ClusterAndWeight;
+    typedef std::map<const pandora::Track *, ClusterAndWeight> TrackToClusterMap;
+
+    /**
+     *  @brief  Get the pandora cluster holding most of the calorimeter hits in an external cluster
+     * 
+     *  @param  pExternalCluster address of the external cluster
+     *  @param  parentAddressToClusterMap the map from calo hit parent address to pandora cluster
+     * 
+     *  @return address of the pandora cluster, NULL if none holds the required fraction of the hits
+     */
+    const pandora::Cluster *GetPandoraCluster(const EVENT::Cluster *const pExternalCluster, const ParentAddressToClusterMap &parentAddressToClusterMap) const;
+
+    std::string     m_trackClusterRelationCollectionName;   ///< The collection name for the track to external cluster relations
+    float           m_minRelationWeight;                    ///< The min relation weight for an association to be imported
+    float           m_minSharedHitFraction;                 ///< The min fraction of external cluster hits held by the matched pandora cluster
+    bool            m_shouldReplaceAssociations;            ///< Whether to replace existing associations for tracks, or leave those tracks
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *ExternalTrackClusterAssociationAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new ExternalTrackClusterAssociationAlgorithm();
+}
+
+#endif // #ifndef EXTERNAL_TRACK_CLUSTER_ASSOCIATION_ALGORITHM_H
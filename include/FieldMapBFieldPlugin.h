@@ -0,0 +1,60 @@
+/**
+ *  @file   MarlinPandora/include/FieldMapBFieldPlugin.h
+ *
+ *  @brief  Header file for the field map bfield plugin class.
+ *
+ *  $Log: $
+ */
+#ifndef FIELD_MAP_BFIELD_PLUGIN_H
+#define FIELD_MAP_BFIELD_PLUGIN_H 1
+
+#include "Plugins/BFieldPlugin.h"
+
+#include "GeometryProvider.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  FieldMapBFieldPlugin class, serving the z component of the bfield by bilinear interpolation in a regular (r, z) grid, sampled
+ *          once from the gear field map by the geometry provider. Points beyond the grid take the value at the nearest grid edge.
+ */
+class FieldMapBFieldPlugin : public pandora::BFieldPlugin
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  geometryProvider the geometry provider, from which the BFieldMapGrid and BFieldMapBz constants are copied
+     */
+    FieldMapBFieldPlugin(const GeometryProvider &geometryProvider);
+
+    /**
+     *  @brief  Whether a geometry provider holds a sampled bfield map
+     *
+     *  @param  geometryProvider the geometry provider
+     *
+     *  @return boolean
+     */
+    static bool HasBFieldMap(const GeometryProvider &geometryProvider);
+
+    float GetBField(const pandora::CartesianVector &positionVector) const;
+
+private:
+    pandora::StatusCode Initialize();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::vector<float> FloatVector;
+
+    float               m_rMax;                     ///< The r coordinate of the last grid row, units mm
+    float               m_zMin;                     ///< The z coordinate of the first grid column, units mm
+    float               m_zMax;                     ///< The z coordinate of the last grid column, units mm
+    unsigned int        m_nR;                       ///< The number of grid points in r
+    unsigned int        m_nZ;                       ///< The number of grid points in z
+    float               m_rScale;                   ///< The number of grid intervals per unit r
+    float               m_zScale;                   ///< The number of grid intervals per unit z
+    FloatVector         m_bz;                       ///< The z component of the bfield at each grid point, z index fastest, units Tesla
+};
+
+#endif // #ifndef FIELD_MAP_BFIELD_PLUGIN_H
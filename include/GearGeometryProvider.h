@@ -0,0 +1,148 @@
+/**
+ *  @file   MarlinPandora/include/GearGeometryProvider.h
+ *
+ *  @brief  Header file for the gear geometry provider class.
+ *
+ *  $Log: $
+ */
+
+#ifndef GEAR_GEOMETRY_PROVIDER_H
+#define GEAR_GEOMETRY_PROVIDER_H 1
+
+#include "GeometryProvider.h"
+
+namespace gear { class GearMgr; class LayerLayout; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  GearGeometryProvider class, reading the creator geometry constants and calorimeter layer layouts from a gear description.
+ *          Gear is read once, at construction; the optional layer layouts (muon plug, lcal and lhcal) are absent if gear lacks them.
+ */
+class GearGeometryProvider : public GeometryProvider
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  gearMgr the gear manager
+     *  @param  shouldSampleBFieldMap whether to sample the gear bfield map, only needed by the field map bfield plugin
+     */
+    GearGeometryProvider(const gear::GearMgr &gearMgr, const bool shouldSampleBFieldMap);
+
+    /**
+     *  @brief  Whether a named geometry constant was read from gear
+     *
+     *  @param  name the constant name
+     *
+     *  @return boolean
+     */
+    virtual bool HasConstant(const std::string &name) const;
+
+    /**
+     *  @brief  Get a named list of geometry constants, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  name the constant name
+     *
+     *  @return the constant values
+     */
+    virtual const DoubleVector &GetConstants(const std::string &name) const;
+
+    /**
+     *  @brief  Whether the layer layout for a calorimeter region was read from gear
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return boolean
+     */
+    virtual bool HasLayerLayout(const CalorimeterRegion region) const;
+
+    /**
+     *  @brief  Get the layer layout for a calorimeter region, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return the layer layout
+     */
+    virtual const CalorimeterLayerLayout &GetLayerLayout(const CalorimeterRegion region) const;
+
+    /**
+     *  @brief  Get the constant map
+     *
+     *  @return the constant map
+     */
+    const ConstantMap &GetConstantMap() const;
+
+    /**
+     *  @brief  Get the layer layout map
+     *
+     *  @return the layer layout map
+     */
+    const LayerLayoutMap &GetLayerLayoutMap() const;
+
+private:
+    /**
+     *  @brief  Read the geometry constants used by the calo hit, track and mc particle creators
+     *
+     *  @param  gearMgr the gear manager
+     */
+    void ReadConstants(const gear::GearMgr &gearMgr);
+
+    /**
+     *  @brief  Read the calorimeter layer layouts used by the calo hit creator
+     *
+     *  @param  gearMgr the gear manager
+     */
+    void ReadLayerLayouts(const gear::GearMgr &gearMgr);
+
+    /**
+     *  @brief  Sample the gear bfield map, assumed symmetric in phi, on a regular (r, z) grid covering the detector out to the yoke.
+     *          The grid is stored as constants BFieldMapGrid (r max, z min, z max, number of r points, number of z points) and
+     *          BFieldMapBz (the z component at each grid point, units Tesla, with the z index running fastest). A constant gear bfield
+     *          is not sampled, as the constant bfield regions describe it exactly.
+     *
+     *  @param  gearMgr the gear manager
+     */
+    void ReadBFieldMap(const gear::GearMgr &gearMgr);
+
+    /**
+     *  @brief  Copy a gear layer layout
+     *
+     *  @param  gearLayerLayout the gear layer layout
+     *  @param  region the calorimeter region to receive the copy
+     */
+    void AddLayerLayout(const gear::LayerLayout &gearLayerLayout, const CalorimeterRegion region);
+
+    ConstantMap         m_constantMap;              ///< The named geometry constants
+    LayerLayoutMap      m_layerLayoutMap;           ///< The calorimeter layer layouts
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool GearGeometryProvider::HasConstant(const std::string &name) const
+{
+    return (m_constantMap.end() != m_constantMap.find(name));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool GearGeometryProvider::HasLayerLayout(const CalorimeterRegion region) const
+{
+    return (m_layerLayoutMap.end() != m_layerLayoutMap.find(region));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const GeometryProvider::ConstantMap &GearGeometryProvider::GetConstantMap() const
+{
+    return m_constantMap;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const GeometryProvider::LayerLayoutMap &GearGeometryProvider::GetLayerLayoutMap() const
+{
+    return m_layerLayoutMap;
+}
+
+#endif // #ifndef GEAR_GEOMETRY_PROVIDER_H
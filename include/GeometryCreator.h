@@ -11,6 +11,8 @@
 
 #include "Api/PandoraApi.h"
 
+#include "GeometrySnapshot.h"
+
 namespace gear { class CalorimeterParameters; }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -53,15 +55,16 @@ public:
         float           m_hCalRingInnerPhiCoordinate;           ///< HCal ring inner phi coordinate (missing from ILD gear files)
         int             m_hCalRingOuterSymmetryOrder;           ///< HCal ring outer symmetry order (missing from ILD gear files)
         float           m_hCalRingOuterPhiCoordinate;           ///< HCal ring outer phi coordinate (missing from ILD gear files)
+
+        int             m_sampleBFieldMap;                      ///< Whether to sample the gear bfield map, for the field map bfield plugin
     };
 
     /**
      *  @brief  Constructor
      * 
      *  @param  settings the creator settings
-     *  @param  pPandora address of the relevant pandora instance
      */
-     GeometryCreator(const Settings &settings, const pandora::Pandora *const pPandora);
+     GeometryCreator(const Settings &settings);
 
     /**
      *  @brief  Destructor
@@ -69,9 +72,11 @@ public:
      ~GeometryCreator();
 
     /**
-     *  @brief  Create geometry
+     *  @brief  Create geometry, deriving the pandora geometry parameters and the creator geometry constants from gear
+     * 
+     *  @param  geometrySnapshot to receive the derived geometry
      */
-    pandora::StatusCode CreateGeometry() const;
+    pandora::StatusCode CreateGeometry(GeometrySnapshot &geometrySnapshot) const;
 
 private:
     typedef std::map<pandora::SubDetectorType, PandoraApi::Geometry::SubDetector::Parameters> SubDetectorTypeMap;
@@ -91,6 +96,13 @@ private:
      */
     void SetAdditionalSubDetectorParameters(SubDetectorNameMap &subDetectorNameMap) const;
 
+    /**
+     *  @brief  Set the geometry constants and layer layouts used by the calo hit, track and mc particle creators
+     * 
+     *  @param  geometrySnapshot the geometry snapshot
+     */
+    void SetCreatorConstants(GeometrySnapshot &geometrySnapshot) const;
+
     /**
      *  @brief  Set sub detector parameters to their gear default values
      * 
@@ -107,33 +119,50 @@ private:
      * 
      *  @param  subDetectorTypeMap the sub detector type map
      *  @param  subDetectorNameMap the sub detector name map (for smaller sub detectors, identified uniquely only by name)
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      */
-    pandora::StatusCode SetILDSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, SubDetectorNameMap &subDetectorNameMap) const;
+    pandora::StatusCode SetILDSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, SubDetectorNameMap &subDetectorNameMap,
+        GeometrySnapshot &geometrySnapshot) const;
 
     /**
-     *  @brief  Add information missing from GEAR parameters file for ILD SDHCAL detector
+     *  @brief  Set positions of gaps in ILD SDHCAL detector and add information missing from GEAR parameters file
      * 
      *  @param  subDetectorTypeMap the sub detector type map
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      */
-    pandora::StatusCode SetILD_SDHCALSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap) const;
+    pandora::StatusCode SetILD_SDHCALSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, GeometrySnapshot &geometrySnapshot) const;
+
+    /**
+     *  @brief  Specify positions of hcal barrel stave and module gaps - ILD SDHCAL (Videau) specific
+     * 
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
+     */
+    pandora::StatusCode CreateSDHCALBarrelGaps(GeometrySnapshot &geometrySnapshot) const;
 
     /**
      *  @brief  Specify positions of hcal barrel box gaps - ILD specific
+     * 
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      */
-    pandora::StatusCode CreateHCalBarrelBoxGaps() const;
+    pandora::StatusCode CreateHCalBarrelBoxGaps(GeometrySnapshot &geometrySnapshot) const;
 
     /**
      *  @brief  Specify positions of hcal end cap box gaps - ILD specific
+     * 
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      */
-    pandora::StatusCode CreateHCalEndCapBoxGaps() const;
+    pandora::StatusCode CreateHCalEndCapBoxGaps(GeometrySnapshot &geometrySnapshot) const;
 
     /**
      *  @brief  Specify positions of hcal barrel concentric polygon gaps - ILD specific
+     * 
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      */
-    pandora::StatusCode CreateHCalBarrelConcentricGaps() const;
+    pandora::StatusCode CreateHCalBarrelConcentricGaps(GeometrySnapshot &geometrySnapshot) const;
 
     /**
-     *  @brief  Create box gaps at regular positions on polygonal prism, oriented along main z axis - ILD specific
+     *  @brief  Create box gaps at regular positions on polygonal prism, oriented along main z axis, stored as a single symmetric sector
+     *          gap - ILD specific
      * 
      *  @param  symmetryOrder the pandora geometry parameters
      *  @param  phi0 the phi coordinate
@@ -142,13 +171,13 @@ private:
      *  @param  minZ the minimum z coordinate
      *  @param  maxZ the maximum z coordinate
      *  @param  gapWidth the gap width
+     *  @param  geometrySnapshot the geometry snapshot, to receive the gaps
      *  @param  vertexOffset position offset for vertex that doesn't point back to origin of xy plane
      */
     pandora::StatusCode CreateRegularBoxGaps(unsigned int symmetryOrder, float phi0, float innerRadius, float outerRadius, float minZ,
-        float maxZ, float gapWidth, pandora::CartesianVector vertexOffset = pandora::CartesianVector(0, 0, 0)) const;
+        float maxZ, float gapWidth, GeometrySnapshot &geometrySnapshot, pandora::CartesianVector vertexOffset = pandora::CartesianVector(0, 0, 0)) const;
 
     const Settings          m_settings;                     ///< The geometry creator settings
-    const pandora::Pandora *m_pPandora;                     ///< Address of the pandora object to create the geometry
 };
 
 #endif // #ifndef GEOMETRY_CREATOR_H
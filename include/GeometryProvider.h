@@ -0,0 +1,232 @@
+/**
+ *  @file   MarlinPandora/include/GeometryProvider.h
+ *
+ *  @brief  Header file for the geometry provider interface and the calorimeter layer layout class.
+ *
+ *  $Log: $
+ */
+
+#ifndef GEOMETRY_PROVIDER_H
+#define GEOMETRY_PROVIDER_H 1
+
+#include <map>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  CalorimeterLayerLayout class, a flat copy of the per-layer properties of a calorimeter region
+ */
+class CalorimeterLayerLayout
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    CalorimeterLayerLayout();
+
+    /**
+     *  @brief  Append a layer
+     *
+     *  @param  thickness the layer thickness
+     *  @param  absorberThickness the layer absorber thickness
+     *  @param  cellSize0 the layer cell size along the first cell axis
+     *  @param  cellSize1 the layer cell size along the second cell axis
+     */
+    void AddLayer(const float thickness, const float absorberThickness, const float cellSize0, const float cellSize1);
+
+    /**
+     *  @brief  Get the number of layers
+     *
+     *  @return the number of layers
+     */
+    unsigned int GetNLayers() const;
+
+    /**
+     *  @brief  Get the thickness of a specified layer
+     *
+     *  @param  layer the layer
+     *
+     *  @return the thickness
+     */
+    float GetThickness(const unsigned int layer) const;
+
+    /**
+     *  @brief  Get the absorber thickness of a specified layer
+     *
+     *  @param  layer the layer
+     *
+     *  @return the absorber thickness
+     */
+    float GetAbsorberThickness(const unsigned int layer) const;
+
+    /**
+     *  @brief  Get the cell size along the first cell axis of a specified layer
+     *
+     *  @param  layer the layer
+     *
+     *  @return the cell size
+     */
+    float GetCellSize0(const unsigned int layer) const;
+
+    /**
+     *  @brief  Get the cell size along the second cell axis of a specified layer
+     *
+     *  @param  layer the layer
+     *
+     *  @return the cell size
+     */
+    float GetCellSize1(const unsigned int layer) const;
+
+    /**
+     *  @brief  Get the absorber thickness of the first layer with non-zero absorber, against which the other layers are calibrated
+     *
+     *  @return the absorber thickness, zero if no layer has absorber
+     */
+    float GetFirstAbsorberThickness() const;
+
+private:
+    /**
+     *  @brief  Layer class
+     */
+    class Layer
+    {
+    public:
+        float           m_thickness;                ///< The layer thickness
+        float           m_absorberThickness;        ///< The layer absorber thickness
+        float           m_cellSize0;                ///< The cell size along the first cell axis
+        float           m_cellSize1;                ///< The cell size along the second cell axis
+    };
+
+    typedef std::vector<Layer> LayerVector;
+
+    LayerVector         m_layerVector;              ///< The layers
+    float               m_firstAbsorberThickness;   ///< The absorber thickness of the first layer with non-zero absorber
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  GeometryProvider class, the interface through which the creators read the detector geometry, so that they need not access gear
+ *          or marlin global state directly. Creators should copy what they need at construction, keeping their per-event loops free of
+ *          calls through this interface.
+ */
+class GeometryProvider
+{
+public:
+    typedef std::vector<double> DoubleVector;
+
+    /**
+     *  @brief  CalorimeterRegion enum, identifying the calorimeter layer layouts
+     */
+    enum CalorimeterRegion
+    {
+        ECAL_BARREL_REGION,
+        ECAL_ENDCAP_REGION,
+        HCAL_BARREL_REGION,
+        HCAL_ENDCAP_REGION,
+        MUON_BARREL_REGION,
+        MUON_ENDCAP_REGION,
+        MUON_PLUG_REGION,
+        LCAL_REGION,
+        LHCAL_REGION
+    };
+
+    typedef std::map<std::string, DoubleVector> ConstantMap;
+    typedef std::map<CalorimeterRegion, CalorimeterLayerLayout> LayerLayoutMap;
+
+    /**
+     *  @brief  Destructor
+     */
+    virtual ~GeometryProvider();
+
+    /**
+     *  @brief  Whether a named geometry constant is available
+     *
+     *  @param  name the constant name
+     *
+     *  @return boolean
+     */
+    virtual bool HasConstant(const std::string &name) const = 0;
+
+    /**
+     *  @brief  Get a named list of geometry constants, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  name the constant name
+     *
+     *  @return the constant values
+     */
+    virtual const DoubleVector &GetConstants(const std::string &name) const = 0;
+
+    /**
+     *  @brief  Whether the layer layout for a calorimeter region is available
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return boolean
+     */
+    virtual bool HasLayerLayout(const CalorimeterRegion region) const = 0;
+
+    /**
+     *  @brief  Get the layer layout for a calorimeter region, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return the layer layout
+     */
+    virtual const CalorimeterLayerLayout &GetLayerLayout(const CalorimeterRegion region) const = 0;
+
+    /**
+     *  @brief  Get a named geometry constant, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  name the constant name
+     *
+     *  @return the constant value
+     */
+    double GetConstant(const std::string &name) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int CalorimeterLayerLayout::GetNLayers() const
+{
+    return m_layerVector.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float CalorimeterLayerLayout::GetThickness(const unsigned int layer) const
+{
+    return m_layerVector.at(layer).m_thickness;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float CalorimeterLayerLayout::GetAbsorberThickness(const unsigned int layer) const
+{
+    return m_layerVector.at(layer).m_absorberThickness;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float CalorimeterLayerLayout::GetCellSize0(const unsigned int layer) const
+{
+    return m_layerVector.at(layer).m_cellSize0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float CalorimeterLayerLayout::GetCellSize1(const unsigned int layer) const
+{
+    return m_layerVector.at(layer).m_cellSize1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float CalorimeterLayerLayout::GetFirstAbsorberThickness() const
+{
+    return m_firstAbsorberThickness;
+}
+
+#endif // #ifndef GEOMETRY_PROVIDER_H
@@ -0,0 +1,328 @@
+/**
+ *  @file   MarlinPandora/include/GeometrySnapshot.h
+ *
+ *  @brief  Header file for the geometry snapshot class.
+ *
+ *  $Log: $
+ */
+
+#ifndef GEOMETRY_SNAPSHOT_H
+#define GEOMETRY_SNAPSHOT_H 1
+
+#include "Api/PandoraApi.h"
+
+#include "GeometryProvider.h"
+#include "SymmetricSectorGap.h"
+
+#include <string>
+#include <vector>
+
+class BinaryFileInput;
+class BinaryFileOutput;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  GeometrySnapshot class, holding the fully derived pandora geometry and the geometry constants and layer layouts used by the
+ *          creators, so that the gear-derived values can be calculated once, written to file and re-used by later jobs. Being filled
+ *          in memory, it also serves as a geometry provider for running the creators without gear.
+ */
+class GeometrySnapshot : public GeometryProvider
+{
+public:
+    typedef std::vector<PandoraApi::Geometry::SubDetector::Parameters> SubDetectorParametersVector;
+    typedef std::vector<PandoraApi::Geometry::BoxGap::Parameters> BoxGapParametersVector;
+    typedef std::vector<PandoraApi::Geometry::ConcentricGap::Parameters> ConcentricGapParametersVector;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  geometryKey the key identifying the detector and geometry settings described by the snapshot
+     */
+    GeometrySnapshot(const std::string &geometryKey);
+
+    /**
+     *  @brief  Write the snapshot to a binary file
+     *
+     *  @param  fileName the file name
+     */
+    pandora::StatusCode Write(const std::string &fileName) const;
+
+    /**
+     *  @brief  Read the snapshot from a binary file, replacing any existing contents. Fails if the file has a different geometry key.
+     *
+     *  @param  fileName the file name
+     */
+    pandora::StatusCode Read(const std::string &fileName);
+
+    /**
+     *  @brief  Create the sub detectors and gaps in a pandora instance
+     *
+     *  @param  pandora the pandora instance
+     */
+    pandora::StatusCode CreatePandoraGeometry(const pandora::Pandora &pandora) const;
+
+    /**
+     *  @brief  Add the parameters for a sub detector
+     *
+     *  @param  parameters the sub detector parameters
+     */
+    void AddSubDetector(const PandoraApi::Geometry::SubDetector::Parameters &parameters);
+
+    /**
+     *  @brief  Add the parameters for a box gap
+     *
+     *  @param  parameters the box gap parameters
+     */
+    void AddBoxGap(const PandoraApi::Geometry::BoxGap::Parameters &parameters);
+
+    /**
+     *  @brief  Add a symmetric sector gap, standing in for one box gap per sector
+     *
+     *  @param  symmetricSectorGap the symmetric sector gap
+     */
+    void AddSymmetricSectorGap(const SymmetricSectorGap &symmetricSectorGap);
+
+    /**
+     *  @brief  Add the parameters for a concentric gap
+     *
+     *  @param  parameters the concentric gap parameters
+     */
+    void AddConcentricGap(const PandoraApi::Geometry::ConcentricGap::Parameters &parameters);
+
+    /**
+     *  @brief  Set a named geometry constant
+     *
+     *  @param  name the constant name
+     *  @param  value the constant value
+     */
+    void SetConstant(const std::string &name, const double value);
+
+    /**
+     *  @brief  Set a named list of geometry constants
+     *
+     *  @param  name the constant name
+     *  @param  values the constant values
+     */
+    void SetConstants(const std::string &name, const DoubleVector &values);
+
+    /**
+     *  @brief  Set the layer layout for a calorimeter region
+     *
+     *  @param  region the calorimeter region
+     *  @param  layerLayout the layer layout
+     */
+    void SetLayerLayout(const CalorimeterRegion region, const CalorimeterLayerLayout &layerLayout);
+
+    /**
+     *  @brief  Whether a named geometry constant has been set
+     *
+     *  @param  name the constant name
+     *
+     *  @return boolean
+     */
+    virtual bool HasConstant(const std::string &name) const;
+
+    /**
+     *  @brief  Get a named list of geometry constants, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  name the constant name
+     *
+     *  @return the constant values
+     */
+    virtual const DoubleVector &GetConstants(const std::string &name) const;
+
+    /**
+     *  @brief  Whether the layer layout for a calorimeter region has been set
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return boolean
+     */
+    virtual bool HasLayerLayout(const CalorimeterRegion region) const;
+
+    /**
+     *  @brief  Get the layer layout for a calorimeter region, throws STATUS_CODE_NOT_FOUND if absent
+     *
+     *  @param  region the calorimeter region
+     *
+     *  @return the layer layout
+     */
+    virtual const CalorimeterLayerLayout &GetLayerLayout(const CalorimeterRegion region) const;
+
+    /**
+     *  @brief  Get the geometry key
+     *
+     *  @return the geometry key
+     */
+    const std::string &GetGeometryKey() const;
+
+    /**
+     *  @brief  Get the sub detector parameters vector
+     *
+     *  @return the sub detector parameters vector
+     */
+    const SubDetectorParametersVector &GetSubDetectorParametersVector() const;
+
+    /**
+     *  @brief  Get the box gap parameters vector
+     *
+     *  @return the box gap parameters vector
+     */
+    const BoxGapParametersVector &GetBoxGapParametersVector() const;
+
+    /**
+     *  @brief  Get the symmetric sector gap vector
+     *
+     *  @return the symmetric sector gap vector
+     */
+    const SymmetricSectorGapVector &GetSymmetricSectorGapVector() const;
+
+    /**
+     *  @brief  Get the concentric gap parameters vector
+     *
+     *  @return the concentric gap parameters vector
+     */
+    const ConcentricGapParametersVector &GetConcentricGapParametersVector() const;
+
+private:
+    /**
+     *  @brief  Write the parameters for a sub detector
+     *
+     *  @param  parameters the sub detector parameters
+     *  @param  fileOutput the binary file output
+     */
+    void WriteSubDetector(const PandoraApi::Geometry::SubDetector::Parameters &parameters, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Write a cartesian vector
+     *
+     *  @param  cartesianVector the cartesian vector
+     *  @param  fileOutput the binary file output
+     */
+    void WriteCartesianVector(const pandora::CartesianVector &cartesianVector, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read the parameters for a sub detector
+     *
+     *  @param  fileInput the binary file input
+     *  @param  parameters to receive the sub detector parameters
+     */
+    pandora::StatusCode ReadSubDetector(BinaryFileInput &fileInput, PandoraApi::Geometry::SubDetector::Parameters &parameters) const;
+
+    /**
+     *  @brief  Read a cartesian vector
+     *
+     *  @param  fileInput the binary file input
+     *  @param  cartesianVector to receive the cartesian vector
+     */
+    pandora::StatusCode ReadCartesianVector(BinaryFileInput &fileInput, pandora::InputCartesianVector &cartesianVector) const;
+
+    std::string                     m_geometryKey;                      ///< The key identifying the detector and geometry settings
+    SubDetectorParametersVector     m_subDetectorParametersVector;      ///< The sub detector parameters
+    BoxGapParametersVector          m_boxGapParametersVector;           ///< The box gap parameters
+    SymmetricSectorGapVector        m_symmetricSectorGapVector;         ///< The symmetric sector gaps
+    ConcentricGapParametersVector   m_concentricGapParametersVector;    ///< The concentric gap parameters
+    ConstantMap                     m_constantMap;                      ///< The named geometry constants used by the creators
+    LayerLayoutMap                  m_layerLayoutMap;                   ///< The calorimeter layer layouts used by the creators
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::AddSubDetector(const PandoraApi::Geometry::SubDetector::Parameters &parameters)
+{
+    m_subDetectorParametersVector.push_back(parameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::AddBoxGap(const PandoraApi::Geometry::BoxGap::Parameters &parameters)
+{
+    m_boxGapParametersVector.push_back(parameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::AddSymmetricSectorGap(const SymmetricSectorGap &symmetricSectorGap)
+{
+    m_symmetricSectorGapVector.push_back(symmetricSectorGap);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::AddConcentricGap(const PandoraApi::Geometry::ConcentricGap::Parameters &parameters)
+{
+    m_concentricGapParametersVector.push_back(parameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::SetConstant(const std::string &name, const double value)
+{
+    m_constantMap[name] = DoubleVector(1, value);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::SetConstants(const std::string &name, const DoubleVector &values)
+{
+    m_constantMap[name] = values;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void GeometrySnapshot::SetLayerLayout(const CalorimeterRegion region, const CalorimeterLayerLayout &layerLayout)
+{
+    m_layerLayoutMap[region] = layerLayout;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool GeometrySnapshot::HasConstant(const std::string &name) const
+{
+    return (m_constantMap.end() != m_constantMap.find(name));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool GeometrySnapshot::HasLayerLayout(const CalorimeterRegion region) const
+{
+    return (m_layerLayoutMap.end() != m_layerLayoutMap.find(region));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::string &GeometrySnapshot::GetGeometryKey() const
+{
+    return m_geometryKey;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const GeometrySnapshot::SubDetectorParametersVector &GeometrySnapshot::GetSubDetectorParametersVector() const
+{
+    return m_subDetectorParametersVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const GeometrySnapshot::BoxGapParametersVector &GeometrySnapshot::GetBoxGapParametersVector() const
+{
+    return m_boxGapParametersVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const SymmetricSectorGapVector &GeometrySnapshot::GetSymmetricSectorGapVector() const
+{
+    return m_symmetricSectorGapVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const GeometrySnapshot::ConcentricGapParametersVector &GeometrySnapshot::GetConcentricGapParametersVector() const
+{
+    return m_concentricGapParametersVector;
+}
+
+#endif // #ifndef GEOMETRY_SNAPSHOT_H
@@ -0,0 +1,47 @@
+/**
+ *  @file   MarlinPandora/include/GridNonLinearityCorrectionPlugin.h
+ *
+ *  @brief  Header file for the grid non linearity correction plugin class.
+ *
+ *  $Log: $
+ */
+#ifndef GRID_NON_LINEARITY_CORRECTION_PLUGIN_H
+#define GRID_NON_LINEARITY_CORRECTION_PLUGIN_H 1
+
+#include "Plugins/EnergyCorrectionsPlugin.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  GridNonLinearityCorrectionPlugin class, scaling cluster energies by the ratio of output to input energy correction points. The
+ *          ratio, interpolated linearly between points and constant beyond the first and last points, is resampled once onto a uniform
+ *          energy grid, so each correction is an index computation and a single interpolation.
+ */
+class GridNonLinearityCorrectionPlugin : public pandora::EnergyCorrectionPlugin
+{
+public:
+    typedef std::vector<float> FloatVector;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  inputEnergyCorrectionPoints the input energy points, in increasing order
+     *  @param  outputEnergyCorrectionPoints the output energy points, one per input energy point
+     *  @param  nGridPoints the number of uniform grid points between the first and last input energy points
+     */
+    GridNonLinearityCorrectionPlugin(const FloatVector &inputEnergyCorrectionPoints, const FloatVector &outputEnergyCorrectionPoints,
+        const unsigned int nGridPoints);
+
+    pandora::StatusCode MakeEnergyCorrections(const pandora::Cluster *const pCluster, float &correctedEnergy) const;
+
+private:
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    float               m_minEnergy;                ///< The energy of the first grid point
+    float               m_gridScale;                ///< The number of grid intervals per unit energy
+    FloatVector         m_correctionFactors;        ///< The energy correction factor at each grid point, empty for no correction
+};
+
+#endif // #ifndef GRID_NON_LINEARITY_CORRECTION_PLUGIN_H
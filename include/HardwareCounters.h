@@ -0,0 +1,120 @@
+/**
+ *  @file   MarlinPandora/include/HardwareCounters.h
+ *
+ *  @brief  Header file for the hardware counters class.
+ *
+ *  $Log: $
+ */
+
+#ifndef HARDWARE_COUNTERS_H
+#define HARDWARE_COUNTERS_H 1
+
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  HardwareCounters class, a linux perf_event_open counter group (cycles, instructions, last level cache misses, branch misses)
+ *          counting user space events of a single thread. Each thread has its own group, opened on first use and kept until the thread
+ *          exits, so counted threads should persist across events. Counters that cannot be opened, e.g. on other platforms, in virtual
+ *          machines or with a restrictive perf_event_paranoid setting, are reported as unavailable rather than treated as errors.
+ */
+class HardwareCounters
+{
+public:
+    /**
+     *  @brief  Counter enum
+     */
+    enum Counter
+    {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        N_COUNTERS
+    };
+
+    /**
+     *  @brief  Values class, counter values or summed differences, each flagged as valid if its counter was available
+     */
+    class Values
+    {
+    public:
+        /**
+         *  @brief  Default constructor, all values zero and invalid
+         */
+        Values();
+
+        /**
+         *  @brief  Add the differences between two readings, for the counters valid in both
+         *
+         *  @param  startValues the first reading
+         *  @param  endValues the second reading
+         */
+        void AddDifference(const Values &startValues, const Values &endValues);
+
+        double              m_counts[N_COUNTERS];           ///< The counter values
+        bool                m_isValid[N_COUNTERS];          ///< Whether each counter value is valid
+    };
+
+    /**
+     *  @brief  Get the counter group for the current thread, opening it on first use
+     *
+     *  @return the counter group
+     */
+    static HardwareCounters &GetThreadInstance();
+
+    /**
+     *  @brief  Read the current counter values, scaled up for any time the group was not scheduled on the cpu
+     *
+     *  @param  values to receive the counter values
+     */
+    void Read(Values &values) const;
+
+    /**
+     *  @brief  Get the header for the columns written by GetSummary
+     *
+     *  @return the column header
+     */
+    static std::string GetSummaryHeader();
+
+    /**
+     *  @brief  Get fixed width columns summarising summed counter differences: the mean cycles and instructions per call, the instructions
+     *          per cycle and the last level cache and branch misses per thousand instructions
+     *
+     *  @param  totals the summed counter differences
+     *  @param  nCalls the number of calls over which the differences were summed
+     *
+     *  @return the summary columns
+     */
+    static std::string GetSummary(const Values &totals, const unsigned int nCalls);
+
+private:
+    /**
+     *  @brief  Default constructor, opening the counter group for the current thread
+     */
+    HardwareCounters();
+
+    /**
+     *  @brief  Destructor, closing the counter group
+     */
+    ~HardwareCounters();
+
+    /**
+     *  @brief  Disallow copying
+     */
+    HardwareCounters(const HardwareCounters &);
+    HardwareCounters &operator=(const HardwareCounters &);
+
+    /**
+     *  @brief  Close any open counters
+     */
+    void Close();
+
+    int                     m_fileDescriptors[N_COUNTERS];  ///< The file descriptor for each counter, negative if unavailable
+    unsigned int            m_groupPositions[N_COUNTERS];   ///< The position of each counter in a group reading
+    unsigned int            m_nOpenCounters;                ///< The number of counters in the group
+    int                     m_groupFileDescriptor;          ///< The file descriptor of the group leader, negative if no counters
+};
+
+#endif // #ifndef HARDWARE_COUNTERS_H
@@ -0,0 +1,300 @@
+/**
+ *  @file   MarlinPandora/include/InputRecord.h
+ *
+ *  @brief  Header file for the input record class.
+ *
+ *  $Log: $
+ */
+
+#ifndef INPUT_RECORD_H
+#define INPUT_RECORD_H 1
+
+#include "Api/PandoraApi.h"
+
+#include <map>
+#include <vector>
+
+class BinaryFileInput;
+class BinaryFileOutput;
+class CaloHitCreator;
+class MCParticleCreator;
+class TrackCreator;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  InputRecord class, holding exactly the objects and relationships handed to pandora for one event. Lcio parent addresses are
+ *          replaced by indices, so that the record can be written to file and later replayed without lcio.
+ */
+class InputRecord
+{
+public:
+    typedef std::vector<PandoraApi::CaloHit::Parameters> CaloHitParametersVector;
+    typedef std::vector<PandoraApi::Track::Parameters> TrackParametersVector;
+    typedef std::vector<PandoraApi::MCParticle::Parameters> MCParticleParametersVector;
+    typedef std::pair<unsigned int, unsigned int> IndexPair;
+    typedef std::vector<IndexPair> IndexPairVector;
+
+    /**
+     *  @brief  CaloHitToMCParticleRelation class
+     */
+    class CaloHitToMCParticleRelation
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  caloHitIndex the calo hit index
+         *  @param  mcParticleIndex the mc particle index
+         *  @param  energyWeight the mc particle energy contribution to the calo hit
+         */
+        CaloHitToMCParticleRelation(const unsigned int caloHitIndex, const unsigned int mcParticleIndex, const float energyWeight);
+
+        unsigned int                    m_caloHitIndex;         ///< The calo hit index
+        unsigned int                    m_mcParticleIndex;      ///< The mc particle index
+        float                           m_energyWeight;         ///< The mc particle energy contribution to the calo hit
+    };
+
+    typedef std::vector<CaloHitToMCParticleRelation> CaloHitToMCParticleRelationVector;
+
+    /**
+     *  @brief  Default constructor
+     */
+    InputRecord();
+
+    /**
+     *  @brief  Fill the record from the parameters and relationships currently stored in the creators
+     *
+     *  @param  runNumber the run number
+     *  @param  eventNumber the event number
+     *  @param  caloHitCreator the calo hit creator
+     *  @param  trackCreator the track creator
+     *  @param  mcParticleCreator the mc particle creator
+     */
+    void Fill(const int runNumber, const int eventNumber, const CaloHitCreator &caloHitCreator, const TrackCreator &trackCreator,
+        const MCParticleCreator &mcParticleCreator);
+
+    /**
+     *  @brief  Write the record to a binary file output
+     *
+     *  @param  fileOutput the binary file output
+     */
+    void Write(BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read the record from a binary file input, replacing any existing contents
+     *
+     *  @param  fileInput the binary file input
+     */
+    pandora::StatusCode Read(BinaryFileInput &fileInput);
+
+    /**
+     *  @brief  Create the tracks, calo hits, mc particles and all relationships in a pandora instance, in the same order as the creators
+     *
+     *  @param  pandora the pandora instance
+     */
+    pandora::StatusCode CreatePandoraInputs(const pandora::Pandora &pandora) const;
+
+    /**
+     *  @brief  Clear the record
+     */
+    void Clear();
+
+    /**
+     *  @brief  Get the run number
+     *
+     *  @return the run number
+     */
+    int GetRunNumber() const;
+
+    /**
+     *  @brief  Get the event number
+     *
+     *  @return the event number
+     */
+    int GetEventNumber() const;
+
+    /**
+     *  @brief  Get the number of calo hits
+     *
+     *  @return the number of calo hits
+     */
+    unsigned int GetNCaloHits() const;
+
+    /**
+     *  @brief  Get the number of tracks
+     *
+     *  @return the number of tracks
+     */
+    unsigned int GetNTracks() const;
+
+    /**
+     *  @brief  Get the number of mc particles
+     *
+     *  @return the number of mc particles
+     */
+    unsigned int GetNMCParticles() const;
+
+private:
+    typedef std::map<const void *, unsigned int> AddressToIndexMap;
+    typedef std::vector<char> AddressVector;
+
+    /**
+     *  @brief  Copy constructor, private as parent addresses point into the record itself
+     */
+    InputRecord(const InputRecord &);
+
+    /**
+     *  @brief  Assignment operator, private as parent addresses point into the record itself
+     */
+    InputRecord &operator=(const InputRecord &);
+
+    /**
+     *  @brief  Point the parent address of each object at a unique location owned by this record
+     */
+    void AssignParentAddresses();
+
+    /**
+     *  @brief  Get the index for a specified parent address
+     *
+     *  @param  addressToIndexMap the address to index map
+     *  @param  pAddress the parent address
+     *  @param  index to receive the index
+     *
+     *  @return whether the address was found
+     */
+    bool GetIndex(const AddressToIndexMap &addressToIndexMap, const void *const pAddress, unsigned int &index) const;
+
+    /**
+     *  @brief  Write an input value, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  input the input value
+     *  @param  fileOutput the binary file output
+     */
+    template <typename STORED_TYPE, typename INPUT_TYPE>
+    void WriteInput(const INPUT_TYPE &input, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read an input value, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  fileInput the binary file input
+     *  @param  input to receive the input value
+     */
+    template <typename STORED_TYPE, typename VALUE_TYPE, typename INPUT_TYPE>
+    pandora::StatusCode ReadInput(BinaryFileInput &fileInput, INPUT_TYPE &input) const;
+
+    /**
+     *  @brief  Write a cartesian vector input, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  input the input cartesian vector
+     *  @param  fileOutput the binary file output
+     */
+    void WriteInput(const pandora::InputCartesianVector &input, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read a cartesian vector input, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  fileInput the binary file input
+     *  @param  input to receive the input cartesian vector
+     */
+    pandora::StatusCode ReadInput(BinaryFileInput &fileInput, pandora::InputCartesianVector &input) const;
+
+    /**
+     *  @brief  Write a track state input, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  input the input track state
+     *  @param  fileOutput the binary file output
+     */
+    void WriteInput(const pandora::InputTrackState &input, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read a track state input, preceded by a flag indicating whether it is initialized
+     *
+     *  @param  fileInput the binary file input
+     *  @param  input to receive the input track state
+     */
+    pandora::StatusCode ReadInput(BinaryFileInput &fileInput, pandora::InputTrackState &input) const;
+
+    /**
+     *  @brief  Write a list of index pairs
+     *
+     *  @param  indexPairVector the index pairs
+     *  @param  fileOutput the binary file output
+     */
+    void WriteIndexPairs(const IndexPairVector &indexPairVector, BinaryFileOutput &fileOutput) const;
+
+    /**
+     *  @brief  Read a list of index pairs
+     *
+     *  @param  fileInput the binary file input
+     *  @param  maxFirstIndex the upper bound on the first index of each pair
+     *  @param  maxSecondIndex the upper bound on the second index of each pair
+     *  @param  indexPairVector to receive the index pairs
+     */
+    pandora::StatusCode ReadIndexPairs(BinaryFileInput &fileInput, const unsigned int maxFirstIndex, const unsigned int maxSecondIndex,
+        IndexPairVector &indexPairVector) const;
+
+    int                                 m_runNumber;                        ///< The run number
+    int                                 m_eventNumber;                      ///< The event number
+
+    CaloHitParametersVector             m_caloHitParametersVector;          ///< The calo hit parameters
+    TrackParametersVector               m_trackParametersVector;            ///< The track parameters
+    MCParticleParametersVector          m_mcParticleParametersVector;       ///< The mc particle parameters
+
+    IndexPairVector                     m_parentDaughterTrackPairs;         ///< The track parent-daughter relationships
+    IndexPairVector                     m_siblingTrackPairs;                ///< The track sibling relationships
+    IndexPairVector                     m_parentDaughterMCParticlePairs;    ///< The mc particle parent-daughter relationships
+    IndexPairVector                     m_trackToMCParticlePairs;           ///< The track to mc particle relationships
+    CaloHitToMCParticleRelationVector   m_caloHitToMCParticleRelations;     ///< The calo hit to mc particle relationships
+
+    AddressVector                       m_caloHitAddresses;                 ///< Storage providing a unique parent address for each calo hit
+    AddressVector                       m_trackAddresses;                   ///< Storage providing a unique parent address for each track
+    AddressVector                       m_mcParticleAddresses;              ///< Storage providing a unique parent address for each mc particle
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline int InputRecord::GetRunNumber() const
+{
+    return m_runNumber;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline int InputRecord::GetEventNumber() const
+{
+    return m_eventNumber;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int InputRecord::GetNCaloHits() const
+{
+    return m_caloHitParametersVector.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int InputRecord::GetNTracks() const
+{
+    return m_trackParametersVector.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int InputRecord::GetNMCParticles() const
+{
+    return m_mcParticleParametersVector.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline InputRecord::CaloHitToMCParticleRelation::CaloHitToMCParticleRelation(const unsigned int caloHitIndex, const unsigned int mcParticleIndex,
+        const float energyWeight) :
+    m_caloHitIndex(caloHitIndex),
+    m_mcParticleIndex(mcParticleIndex),
+    m_energyWeight(energyWeight)
+{
+}
+
+#endif // #ifndef INPUT_RECORD_H
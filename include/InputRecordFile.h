@@ -0,0 +1,142 @@
+/**
+ *  @file   MarlinPandora/include/InputRecordFile.h
+ *
+ *  @brief  Header file for the input record file writer and reader classes.
+ *
+ *  $Log: $
+ */
+
+#ifndef INPUT_RECORD_FILE_H
+#define INPUT_RECORD_FILE_H 1
+
+#include "BinaryFile.h"
+#include "UserComponents.h"
+
+#include <string>
+#include <vector>
+
+class InputRecord;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  InputRecordHeader class, holding the per-file information needed to configure a pandora instance for replay
+ */
+class InputRecordHeader
+{
+public:
+    std::string                 m_geometryKey;              ///< The key of the geometry snapshot with which the inputs were created
+    UserComponents::Settings    m_userComponentSettings;    ///< The plugin selections and parameters with which the inputs were processed
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  InputRecordWriter class, accumulating input records and writing them to a single file, followed by an event index
+ */
+class InputRecordWriter
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  header the file header
+     */
+    InputRecordWriter(const InputRecordHeader &header);
+
+    /**
+     *  @brief  Append an input record
+     *
+     *  @param  inputRecord the input record
+     */
+    void AddEvent(const InputRecord &inputRecord);
+
+    /**
+     *  @brief  Get the number of input records appended
+     *
+     *  @return the number of input records
+     */
+    unsigned int GetNEvents() const;
+
+    /**
+     *  @brief  Append the event index and write the file; no further input records may be added
+     *
+     *  @param  fileName the file name
+     */
+    pandora::StatusCode WriteFile(const std::string &fileName);
+
+private:
+    typedef std::vector<unsigned long long> OffsetVector;
+
+    BinaryFileOutput    m_fileOutput;                   ///< The binary file output
+    OffsetVector        m_eventOffsets;                 ///< The payload offset of each input record
+    bool                m_isIndexWritten;               ///< Whether the event index has been appended
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  InputRecordReader class, providing random access to the input records in a file written by InputRecordWriter
+ */
+class InputRecordReader
+{
+public:
+    /**
+     *  @brief  Open a file and read its header and event index
+     *
+     *  @param  fileName the file name
+     */
+    pandora::StatusCode Open(const std::string &fileName);
+
+    /**
+     *  @brief  Get the file header
+     *
+     *  @return the file header
+     */
+    const InputRecordHeader &GetHeader() const;
+
+    /**
+     *  @brief  Get the number of input records in the file
+     *
+     *  @return the number of input records
+     */
+    unsigned int GetNEvents() const;
+
+    /**
+     *  @brief  Read a specified input record
+     *
+     *  @param  eventIndex the index of the input record within the file
+     *  @param  inputRecord to receive the input record
+     */
+    pandora::StatusCode ReadEvent(const unsigned int eventIndex, InputRecord &inputRecord);
+
+private:
+    typedef std::vector<unsigned long long> OffsetVector;
+
+    BinaryFileInput     m_fileInput;                    ///< The binary file input
+    InputRecordHeader   m_header;                       ///< The file header
+    OffsetVector        m_eventOffsets;                 ///< The payload offset of each input record
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int InputRecordWriter::GetNEvents() const
+{
+    return m_eventOffsets.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const InputRecordHeader &InputRecordReader::GetHeader() const
+{
+    return m_header;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int InputRecordReader::GetNEvents() const
+{
+    return m_eventOffsets.size();
+}
+
+#endif // #ifndef INPUT_RECORD_FILE_H
@@ -10,10 +10,12 @@
 #define MC_PARTICLE_CREATOR_H 1
 
 #include "EVENT/LCEvent.h"
+#include "EVENT/MCParticle.h"
 
 #include "Api/PandoraApi.h"
 
 #include "CaloHitCreator.h"
+#include "GeometryProvider.h"
 #include "TrackCreator.h"
 
 /**
@@ -23,6 +25,11 @@ class MCParticleCreator
 {
 public:
     typedef std::vector<std::string> StringVector;
+    typedef std::vector<PandoraApi::MCParticle::Parameters> MCParticleParametersVector;
+    typedef std::pair<const EVENT::MCParticle *, const EVENT::MCParticle *> MCParticlePair;
+    typedef std::vector<MCParticlePair> MCParticlePairVector;
+    typedef std::pair<const EVENT::Track *, const EVENT::MCParticle *> TrackToMCParticlePair;
+    typedef std::vector<TrackToMCParticlePair> TrackToMCParticlePairVector;
 
     /**
      *  @brief  Settings class
@@ -40,13 +47,35 @@ public:
         StringVector    m_lcTrackRelationCollections;           ///< The SimTrackerHit to TrackerHit particle relations
     };
 
+    /**
+     *  @brief  CaloHitToMCParticleRelation class
+     */
+    class CaloHitToMCParticleRelation
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         * 
+         *  @param  pCaloHit address of the lcio calorimeter hit
+         *  @param  pMCParticle address of the lcio mc particle
+         *  @param  energyWeight the mc particle energy contribution to the calorimeter hit
+         */
+        CaloHitToMCParticleRelation(const EVENT::CalorimeterHit *const pCaloHit, const EVENT::MCParticle *const pMCParticle, const float energyWeight);
+
+        const EVENT::CalorimeterHit    *m_pCaloHit;             ///< Address of the lcio calorimeter hit
+        const EVENT::MCParticle        *m_pMCParticle;          ///< Address of the lcio mc particle
+        float                           m_energyWeight;         ///< The mc particle energy contribution to the calorimeter hit
+    };
+
+    typedef std::vector<CaloHitToMCParticleRelation> CaloHitToMCParticleRelationVector;
+
     /**
      *  @brief  Constructor
      * 
      *  @param  settings the creator settings
-     *  @param  pPandora address of the relevant pandora instance
+     *  @param  geometryProvider the geometry provider, from which the geometry constants are copied
      */
-     MCParticleCreator(const Settings &settings, const pandora::Pandora *const pPandora);
+     MCParticleCreator(const Settings &settings, const GeometryProvider &geometryProvider);
 
     /**
      *  @brief  Destructor
@@ -54,11 +83,11 @@ public:
      ~MCParticleCreator();
 
     /**
-     *  @brief  Create MCParticles
+     *  @brief  Create MCParticle parameters and parent-daughter relationships, ready to be passed to one or more pandora instances
      * 
      *  @param  pLCEvent the lcio event
      */    
-    pandora::StatusCode CreateMCParticles(const EVENT::LCEvent *const pLCEvent) const;
+    pandora::StatusCode CreateMCParticles(const EVENT::LCEvent *const pLCEvent);
 
     /**
      *  @brief  Create Track to mc particle relationships
@@ -66,20 +95,114 @@ public:
      *  @param  pLCEvent the lcio event
      *  @param  trackVector the vector containing all tracks successfully passed to pandora
      */
-    pandora::StatusCode CreateTrackToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const TrackVector &trackVector) const;
+    pandora::StatusCode CreateTrackToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const TrackVector &trackVector);
 
     /**
      *  @brief  Create calo hit to mc particle relationships
      *
      *  @param  pLCEvent the lcio event
      *  @param  calorimeterHitVector the vector containing all calorimeter hits successfully passed to pandora
+     *  @param  superCellMemberMap the calorimeter hits merged into each forward super-cell, keyed by representative calorimeter hit
+     */
+    pandora::StatusCode CreateCaloHitToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const CalorimeterHitVector &calorimeterHitVector,
+        const CaloHitCreator::SuperCellMemberMap &superCellMemberMap);
+
+    /**
+     *  @brief  Create pandora mc particles and all mc particle relationships, in the specified pandora instance, from the stored parameters
+     * 
+     *  @param  pandora the pandora instance
+     */
+    pandora::StatusCode CreatePandoraMCParticles(const pandora::Pandora &pandora) const;
+
+    /**
+     *  @brief  Get the mc particle parameters vector
+     *
+     *  @return the mc particle parameters vector
+     */
+    const MCParticleParametersVector &GetMCParticleParametersVector() const;
+
+    /**
+     *  @brief  Get the mc particle parent-daughter relationships
+     *
+     *  @return the mc particle parent-daughter relationships
+     */
+    const MCParticlePairVector &GetParentDaughterMCParticlePairs() const;
+
+    /**
+     *  @brief  Get the track to mc particle relationships
+     *
+     *  @return the track to mc particle relationships
      */
-    pandora::StatusCode CreateCaloHitToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const CalorimeterHitVector &calorimeterHitVector) const;
+    const TrackToMCParticlePairVector &GetTrackToMCParticlePairs() const;
+
+    /**
+     *  @brief  Get the calo hit to mc particle relationships
+     *
+     *  @return the calo hit to mc particle relationships
+     */
+    const CaloHitToMCParticleRelationVector &GetCaloHitToMCParticleRelations() const;
+
+    /**
+     *  @brief  Reset the mc particle creator
+     */
+    void Reset();
 
 private:
-    const Settings          m_settings;                         ///< The mc particle creator settings
-    const pandora::Pandora *m_pPandora;                         ///< Address of the pandora object to create the mc particles
-    const float             m_bField;                           ///< The bfield
+    const Settings                      m_settings;                         ///< The mc particle creator settings
+    const float                         m_bField;                           ///< The bfield
+
+    MCParticleParametersVector          m_mcParticleParametersVector;       ///< The mc particle parameters, to be passed to each pandora instance
+    MCParticlePairVector                m_parentDaughterMCParticlePairs;    ///< The mc particle parent-daughter relationships
+    TrackToMCParticlePairVector         m_trackToMCParticlePairs;           ///< The track to mc particle relationships
+    CaloHitToMCParticleRelationVector   m_caloHitToMCParticleRelations;     ///< The calo hit to mc particle relationships
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const MCParticleCreator::MCParticleParametersVector &MCParticleCreator::GetMCParticleParametersVector() const
+{
+    return m_mcParticleParametersVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const MCParticleCreator::MCParticlePairVector &MCParticleCreator::GetParentDaughterMCParticlePairs() const
+{
+    return m_parentDaughterMCParticlePairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const MCParticleCreator::TrackToMCParticlePairVector &MCParticleCreator::GetTrackToMCParticlePairs() const
+{
+    return m_trackToMCParticlePairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const MCParticleCreator::CaloHitToMCParticleRelationVector &MCParticleCreator::GetCaloHitToMCParticleRelations() const
+{
+    return m_caloHitToMCParticleRelations;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void MCParticleCreator::Reset()
+{
+    m_mcParticleParametersVector.clear();
+    m_parentDaughterMCParticlePairs.clear();
+    m_trackToMCParticlePairs.clear();
+    m_caloHitToMCParticleRelations.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline MCParticleCreator::CaloHitToMCParticleRelation::CaloHitToMCParticleRelation(const EVENT::CalorimeterHit *const pCaloHit,
+        const EVENT::MCParticle *const pMCParticle, const float energyWeight) :
+    m_pCaloHit(pCaloHit),
+    m_pMCParticle(pMCParticle),
+    m_energyWeight(energyWeight)
+{
+}
+
 #endif // #ifndef MC_PARTICLE_CREATOR_H
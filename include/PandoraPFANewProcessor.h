@@ -13,12 +13,19 @@
 
 #include "CaloHitCreator.h"
 #include "GeometryCreator.h"
+#include "GeometrySnapshot.h"
+#include "InputRecordFile.h"
 #include "MCParticleCreator.h"
 #include "PfoCreator.h"
 #include "TrackCreator.h"
+#include "UserComponents.h"
 
 namespace pandora {class Pandora;}
 
+class PersistentThreadPool;
+class ReclusteringWorkerPool;
+class StageProfiler;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 /**
@@ -28,6 +35,7 @@ class PandoraPFANewProcessor : public marlin::Processor
 {
 public:
     typedef std::vector<float> FloatVector;
+    typedef std::vector<int> IntVector;
     typedef std::vector<std::string> StringVector;
 
     /**
@@ -42,13 +50,25 @@ public:
         Settings();
 
         std::string     m_pandoraSettingsXmlFile;           ///< The pandora settings xml file
+        std::string     m_geometrySnapshotFile;             ///< The geometry snapshot file, read if valid, otherwise written after deriving geometry from gear
+        std::string     m_recordInputsFile;                 ///< The file to which the pandora inputs for each event are recorded, for later replay
+
+        StringVector    m_additionalSettingsXmlFiles;       ///< Settings xml files for additional pandora instances, fed the same inputs
+        StringVector    m_additionalClusterCollections;     ///< The cluster output collection names for the additional pandora instances
+        StringVector    m_additionalPfoCollections;         ///< The pfo output collection names for the additional pandora instances
+        StringVector    m_additionalStartVertexCollections; ///< The start vertex output collection names for the additional pandora instances
+        int             m_processInstancesConcurrently;     ///< Whether to process the pandora instances concurrently, one thread per instance
 
-        float           m_innerBField;                      ///< The bfield in the main tracker, ecal and hcal, units Tesla
-        float           m_muonBarrelBField;                 ///< The bfield in the muon barrel, units Tesla
-        float           m_muonEndCapBField;                 ///< The bfield in the muon endcap, units Tesla
+        std::string     m_reclusteringSettingsXmlFile;      ///< The settings xml file for the reclustering worker pandora instances
+        int             m_nReclusteringWorkers;             ///< The number of reclustering worker pandora instances, shared by all pandora instances
 
-        FloatVector     m_inputEnergyCorrectionPoints;      ///< The input energy points for non-linearity energy correction
-        FloatVector     m_outputEnergyCorrectionPoints;     ///< The output energy points for non-linearity energy correction
+        StringVector    m_profileSettingsXmlFiles;          ///< Settings xml files for alternative primary pandora instances, selected per event
+        IntVector       m_profileMinCaloHits;               ///< For each profile, the min number of calo hits for selection, zero to ignore
+        IntVector       m_profileMinTracks;                 ///< For each profile, the min number of tracks for selection, zero to ignore
+        FloatVector     m_profileMinCaloHitEnergy;          ///< For each profile, the min total calo hit energy for selection, zero to ignore
+
+        int             m_profileStages;                    ///< Whether to record the wall time and heap allocations of each processEvent stage
+        int             m_profileHardwareCounters;          ///< Whether to sum the hardware counters over each processEvent stage and profiled algorithm
     };
 
     /**
@@ -93,9 +113,9 @@ public:
     virtual void end();
 
     /**
-     *  @brief  Get address of the pandora instance
+     *  @brief  Get address of the primary pandora instance
      * 
-     *  @return address of the pandora instance
+     *  @return address of the primary pandora instance
      */
     const pandora::Pandora *GetPandora() const;
 
@@ -108,12 +128,110 @@ public:
      */
     static const EVENT::LCEvent *GetCurrentEvent(const pandora::Pandora *const pPandora);
 
+    /**
+     *  @brief  Get the index of the current calorimeter hits, from lcio calorimeter hit address to pandora calo hit creation order
+     * 
+     *  @param  pPandora address of the relevant pandora instance
+     * 
+     *  @return the calorimeter hit index map
+     */
+    static const CaloHitCreator::CalorimeterHitIndexMap &GetCalorimeterHitIndexMap(const pandora::Pandora *const pPandora);
+
+    /**
+     *  @brief  Get the current forward super-cells, from representative lcio calorimeter hit to all merged lcio calorimeter hits
+     * 
+     *  @param  pPandora address of the relevant pandora instance
+     * 
+     *  @return address of the super-cell member map, NULL if no calo hit creator is registered for the pandora instance
+     */
+    static const CaloHitCreator::SuperCellMemberMap *GetSuperCellMemberMap(const pandora::Pandora *const pPandora);
+
 private:
+    typedef std::vector<pandora::Pandora *> PandoraVector;
+    typedef std::vector<PfoCreator *> PfoCreatorVector;
+
+    class InstanceTask;
+
     /**
      *  @brief  Register user algorithm factories, energy correction functions and particle id functions,
      *          insert user code here
+     * 
+     *  @param  pandora the pandora instance with which to register the user components
+     */
+    pandora::StatusCode RegisterUserComponents(const pandora::Pandora &pandora) const;
+
+    /**
+     *  @brief  Create the geometry snapshot, reading it from file if available, otherwise deriving it from gear. A snapshot already
+     *          created by another processor in this process, for the same detector and geometry settings, is shared instead.
+     */
+    void CreateGeometrySnapshot();
+
+    /**
+     *  @brief  Get a hash of the content of the gear xml file, so that a changed file is never matched with a stale geometry snapshot
+     *
+     *  @return the hash, as hexadecimal digits, or an empty string if the gear xml file cannot be read
+     */
+    static std::string GetGearFileHash();
+
+    /**
+     *  @brief  Release the reference to the shared geometry snapshot, deleting the snapshot once it is no longer referenced
+     */
+    void ReleaseGeometrySnapshot();
+
+    /**
+     *  @brief  Create the additional pandora instances and the pfo creators for each pandora instance
      */
-    pandora::StatusCode RegisterUserComponents() const;
+    void CreatePandoraInstances();
+
+    /**
+     *  @brief  Register user components with a pandora instance, create its geometry and read its settings
+     * 
+     *  @param  pandora the pandora instance
+     *  @param  settingsXmlFile the settings xml file
+     */
+    void InitialisePandoraInstance(const pandora::Pandora &pandora, const std::string &settingsXmlFile);
+
+    /**
+     *  @brief  Create the single pool of reclustering worker pandora instances, if requested, later passed to the parallel reclustering
+     *          algorithms of every pandora instance
+     */
+    void CreateReclusteringWorkers();
+
+    /**
+     *  @brief  Select the pandora instances and pfo creators for the current event, replacing the primary instance with the first
+     *          settings profile whose thresholds are reached by the input objects, if any
+     */
+    void SelectEventPandoraInstances();
+
+    /**
+     *  @brief  Create the persistent threads processing the pandora instances concurrently, one per instance, if requested
+     */
+    void CreateInstanceThreadPool();
+
+    /**
+     *  @brief  Pass the stored input objects to each pandora instance and process the event, concurrently if requested
+     */
+    pandora::StatusCode ProcessPandoraInstances() const;
+
+    /**
+     *  @brief  Pass the stored input objects to a single pandora instance and process the event
+     * 
+     *  @param  pPandora address of the pandora instance
+     *  @param  pStatusCode to receive the status code
+     */
+    void ProcessPandoraInstance(const pandora::Pandora *const pPandora, pandora::StatusCode *const pStatusCode) const;
+
+    /**
+     *  @brief  Create the input record writer, if the pandora inputs are to be recorded
+     */
+    void CreateInputRecordWriter();
+
+    /**
+     *  @brief  Record the pandora inputs for the current event
+     * 
+     *  @param  pLCEvent the lc event
+     */
+    void RecordInputs(const EVENT::LCEvent *const pLCEvent) const;
 
     /**
      *  @brief  Process steering file parameters, insert user code here
@@ -130,12 +248,23 @@ private:
      */
     void Reset();
 
-    pandora::Pandora                   *m_pPandora;                         ///< Address of the pandora instance
+    pandora::Pandora                   *m_pPandora;                         ///< Address of the primary pandora instance
+    PandoraVector                       m_pandoraVector;                    ///< The primary pandora instance, followed by any additional instances
+    const GeometrySnapshot             *m_pGeometrySnapshot;                ///< The geometry snapshot, shared by processors with identical geometry
     CaloHitCreator                     *m_pCaloHitCreator;                  ///< The calo hit creator
-    GeometryCreator                    *m_pGeometryCreator;                 ///< The geometry creator
     TrackCreator                       *m_pTrackCreator;                    ///< The track creator
     MCParticleCreator                  *m_pMCParticleCreator;               ///< The mc particle creator
-    PfoCreator                         *m_pPfoCreator;                      ///< The pfo creator
+    PfoCreatorVector                    m_pfoCreatorVector;                 ///< The pfo creators, one per pandora instance
+    PandoraVector                       m_profilePandoraVector;             ///< The pandora instances for the settings profiles
+    PfoCreatorVector                    m_profilePfoCreatorVector;          ///< The pfo creators, one per settings profile
+    std::vector<unsigned int>           m_profileNEvents;                   ///< The number of events processed with each settings profile
+    PandoraVector                       m_eventPandoraVector;               ///< The pandora instances for the current event
+    PfoCreatorVector                    m_eventPfoCreatorVector;            ///< The pfo creators for the current event
+    PandoraVector                       m_reclusteringWorkerVector;         ///< The reclustering worker pandora instances, shared by all pandora instances
+    ReclusteringWorkerPool             *m_pReclusteringWorkerPool;          ///< The reclustering worker pool, with its own threads and mutex
+    InputRecordWriter                  *m_pInputRecordWriter;               ///< The input record writer, if the pandora inputs are recorded
+    StageProfiler                      *m_pStageProfiler;                   ///< The stage profiler, if the processEvent stages are profiled
+    PersistentThreadPool               *m_pInstanceThreadPool;              ///< The threads processing the pandora instances, if concurrent
 
     Settings                            m_settings;                         ///< The settings for the pandora pfa new processor
     CaloHitCreator::Settings            m_caloHitCreatorSettings;           ///< The calo hit creator settings
@@ -143,9 +272,17 @@ private:
     MCParticleCreator::Settings         m_mcParticleCreatorSettings;        ///< The mc particle creator settings
     TrackCreator::Settings              m_trackCreatorSettings;             ///< The track creator settings
     PfoCreator::Settings                m_pfoCreatorSettings;               ///< The pfo creator settings
+    UserComponents::Settings            m_userComponentSettings;            ///< The user component settings
 
     typedef std::map<const pandora::Pandora *, EVENT::LCEvent *> PandoraToLCEventMap;
     static PandoraToLCEventMap          m_pandoraToLCEventMap;              ///< The pandora to lc event map
+
+    typedef std::map<const pandora::Pandora *, const CaloHitCreator *> PandoraToCaloHitCreatorMap;
+    static PandoraToCaloHitCreatorMap   m_pandoraToCaloHitCreatorMap;       ///< The pandora to calo hit creator map, for the current events
+
+    typedef std::pair<GeometrySnapshot *, unsigned int> GeometrySnapshotReference;
+    typedef std::map<std::string, GeometrySnapshotReference> GeometrySnapshotMap;
+    static GeometrySnapshotMap          m_geometrySnapshotMap;              ///< The shared geometry snapshots and reference counts, keyed by geometry key
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,216 @@
+/**
+ *  @file   MarlinPandora/include/ParallelReclusteringAlgorithm.h
+ *
+ *  @brief  Header file for the parallel reclustering algorithm class.
+ *
+ *  $Log: $
+ */
+#ifndef PARALLEL_RECLUSTERING_ALGORITHM_H
+#define PARALLEL_RECLUSTERING_ALGORITHM_H 1
+
+#include "Api/PandoraApi.h"
+
+#include "Pandora/Algorithm.h"
+
+#include "PersistentThreadPool.h"
+#include "ReclusteringCandidateAlgorithm.h"
+
+#include <mutex>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ReclusteringWorkerPool class, the worker pandora instances of a client application, with one persistent thread per worker and
+ *          the mutex allowing a single primary pandora instance at a time to use them. Each client owns its own pool, so that independent
+ *          clients, e.g. the processors of a multi-threaded standalone job, recluster concurrently.
+ */
+class ReclusteringWorkerPool
+{
+public:
+    typedef std::vector<const pandora::Pandora *> PandoraVector;
+
+    /**
+     *  @brief  Constructor, starting one thread per worker
+     *
+     *  @param  workerVector the worker pandora instances, owned by the caller and to be deleted only after the pool
+     */
+    ReclusteringWorkerPool(const PandoraVector &workerVector);
+
+    /**
+     *  @brief  Get the worker pandora instances
+     *
+     *  @return the worker pandora instances
+     */
+    const PandoraVector &GetWorkerVector() const;
+
+    /**
+     *  @brief  Get the mutex to be held while the workers are in use
+     *
+     *  @return the mutex
+     */
+    std::mutex &GetMutex();
+
+    /**
+     *  @brief  Get the thread pool, with one thread per worker
+     *
+     *  @return the thread pool
+     */
+    PersistentThreadPool &GetThreadPool();
+
+private:
+    /**
+     *  @brief  Disallow copying
+     */
+    ReclusteringWorkerPool(const ReclusteringWorkerPool &);
+    ReclusteringWorkerPool &operator=(const ReclusteringWorkerPool &);
+
+    const PandoraVector     m_workerVector;                 ///< The worker pandora instances
+    std::mutex              m_mutex;                        ///< The mutex held while the workers are in use
+    PersistentThreadPool    m_threadPool;                   ///< The thread pool, with one thread per worker
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ParallelReclusteringAlgorithm class, reclustering clusters whose energy exceeds that of their associated tracks. The candidate
+ *          clustering configurations are evaluated concurrently, in worker pandora instances supplied by the client application, each fed
+ *          copies of the calo hits and tracks of the cluster. The candidate with the best track-cluster compatibility replaces the
+ *          original cluster, if it is an improvement.
+ */
+class ParallelReclusteringAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        pandora::Algorithm *CreateAlgorithm() const;
+    };
+
+    typedef ReclusteringWorkerPool::PandoraVector PandoraVector;
+
+    /**
+     *  @brief  Set the worker pool for a primary pandora instance, to be called before the primary instance reads its settings. Each worker
+     *          must be configured with a ReclusteringCandidate algorithm listing the same candidate clustering algorithms. The same pool may
+     *          be set for several primary instances, which then take turns to use it.
+     *
+     *  @param  pandora the primary pandora instance
+     *  @param  pWorkerPool address of the worker pool, owned by the caller
+     */
+    static void SetWorkers(const pandora::Pandora &pandora, ReclusteringWorkerPool *const pWorkerPool);
+
+    /**
+     *  @brief  Forget the worker pool for a primary pandora instance, to be called before the worker pool is deleted
+     *
+     *  @param  pandora the primary pandora instance
+     */
+    static void ResetWorkers(const pandora::Pandora &pandora);
+
+    /**
+     *  @brief  Default constructor
+     */
+    ParallelReclusteringAlgorithm();
+
+private:
+    pandora::StatusCode Initialize();
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::vector<PandoraApi::CaloHit::Parameters> CaloHitParametersVector;
+    typedef std::vector<PandoraApi::Track::Parameters> TrackParametersVector;
+    typedef std::vector<ReclusteringCandidateAlgorithm::Result> ResultVector;
+    typedef std::vector<pandora::StatusCode> StatusCodeVector;
+    typedef std::map<const pandora::Pandora *, ReclusteringWorkerPool *> WorkerMap;
+
+    class EvaluationTask;
+
+    /**
+     *  @brief  Evaluate all reclustering candidates for a cluster, distributing the candidates between the worker pandora instances
+     *
+     *  @param  pCluster address of the cluster
+     *  @param  resultVector to receive the results, one per candidate
+     */
+    pandora::StatusCode EvaluateCandidates(const pandora::Cluster *const pCluster, ResultVector &resultVector) const;
+
+    /**
+     *  @brief  Evaluate the reclustering candidates assigned to a worker pandora instance, run on the pool thread of the worker. On
+     *          failure the worker is still reset, so that no hits or tracks from the current event are left in the shared worker
+     *
+     *  @param  pWorker address of the worker pandora instance
+     *  @param  firstCandidate the index of the first candidate to evaluate
+     *  @param  candidateStride the difference between the indices of successive candidates to evaluate
+     *  @param  hadronicEnergyResolution the stochastic hadronic energy resolution
+     *  @param  pCaloHitParametersVector address of the calo hit parameters for the cluster
+     *  @param  pTrackParametersVector address of the track parameters for the cluster
+     *  @param  pResultVector address of the results, one per candidate
+     *  @param  pStatusCode to receive the status code
+     */
+    static void EvaluateWorkerCandidates(const pandora::Pandora *const pWorker, const unsigned int firstCandidate, const unsigned int candidateStride,
+        const float hadronicEnergyResolution, const CaloHitParametersVector *const pCaloHitParametersVector,
+        const TrackParametersVector *const pTrackParametersVector, ResultVector *const pResultVector, pandora::StatusCode *const pStatusCode);
+
+    /**
+     *  @brief  Replace a cluster with the clusters of a reclustering candidate
+     *
+     *  @param  pCluster address of the cluster to replace
+     *  @param  result the reclustering candidate
+     */
+    pandora::StatusCode ReplaceCluster(const pandora::Cluster *const pCluster, const ReclusteringCandidateAlgorithm::Result &result) const;
+
+    /**
+     *  @brief  Copy the properties of a calo hit to calo hit parameters, recording the calo hit as the parent address
+     *
+     *  @param  pCaloHit address of the calo hit
+     *  @param  parameters to receive the calo hit parameters
+     */
+    static void CopyCaloHit(const pandora::CaloHit *const pCaloHit, PandoraApi::CaloHit::Parameters &parameters);
+
+    /**
+     *  @brief  Copy the properties of a track to track parameters, recording the track as the parent address
+     *
+     *  @param  pTrack address of the track
+     *  @param  parameters to receive the track parameters
+     */
+    static void CopyTrack(const pandora::Track *const pTrack, PandoraApi::Track::Parameters &parameters);
+
+    ReclusteringWorkerPool *m_pWorkerPool;                  ///< Address of the worker pool
+    unsigned int            m_nCandidates;                  ///< The number of reclustering candidates configured in each worker
+
+    float                   m_minChiToRecluster;            ///< The min track-cluster chi for a cluster to be reclustered
+    float                   m_hadronicEnergyResolution;     ///< The stochastic hadronic energy resolution, used for the track-cluster chi
+    unsigned int            m_minCaloHitsToRecluster;       ///< The min number of calo hits for a cluster to be reclustered
+
+    static WorkerMap        m_workerMap;                    ///< The worker pools, keyed by primary pandora instance
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const ReclusteringWorkerPool::PandoraVector &ReclusteringWorkerPool::GetWorkerVector() const
+{
+    return m_workerVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline std::mutex &ReclusteringWorkerPool::GetMutex()
+{
+    return m_mutex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline PersistentThreadPool &ReclusteringWorkerPool::GetThreadPool()
+{
+    return m_threadPool;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *ParallelReclusteringAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new ParallelReclusteringAlgorithm();
+}
+
+#endif // #ifndef PARALLEL_RECLUSTERING_ALGORITHM_H
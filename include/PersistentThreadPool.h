@@ -0,0 +1,102 @@
+/**
+ *  @file   MarlinPandora/include/PersistentThreadPool.h
+ *
+ *  @brief  Header file for the persistent thread pool class.
+ *
+ *  $Log: $
+ */
+
+#ifndef PERSISTENT_THREAD_POOL_H
+#define PERSISTENT_THREAD_POOL_H 1
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  PersistentThreadPool class, a fixed set of threads started once and reused for each task, so that per thread state, e.g. the
+ *          hardware counter groups, is created once per job rather than once per task
+ */
+class PersistentThreadPool
+{
+public:
+    /**
+     *  @brief  Task class, the work to run once on every thread of the pool
+     */
+    class Task
+    {
+    public:
+        /**
+         *  @brief  Destructor
+         */
+        virtual ~Task();
+
+        /**
+         *  @brief  Run the task on a single thread of the pool
+         *
+         *  @param  threadIndex the index of the thread
+         */
+        virtual void Run(const unsigned int threadIndex) = 0;
+    };
+
+    /**
+     *  @brief  Constructor, starting the threads
+     *
+     *  @param  nThreads the number of threads
+     */
+    PersistentThreadPool(const unsigned int nThreads);
+
+    /**
+     *  @brief  Destructor, stopping and joining the threads
+     */
+    ~PersistentThreadPool();
+
+    /**
+     *  @brief  Get the number of threads
+     *
+     *  @return the number of threads
+     */
+    unsigned int GetNThreads() const;
+
+    /**
+     *  @brief  Run a task once on every thread, returning when all threads have finished it
+     *
+     *  @param  task the task, which must not throw
+     */
+    void Run(Task &task);
+
+private:
+    /**
+     *  @brief  Disallow copying
+     */
+    PersistentThreadPool(const PersistentThreadPool &);
+    PersistentThreadPool &operator=(const PersistentThreadPool &);
+
+    /**
+     *  @brief  Wait for and run each task in turn, until the pool is stopped
+     *
+     *  @param  threadIndex the index of the thread
+     */
+    void Loop(const unsigned int threadIndex);
+
+    std::vector<std::thread>        m_threadVector;             ///< The threads
+    Task                           *m_pTask;                    ///< Address of the current task
+    unsigned long long              m_taskNumber;               ///< The number of tasks started, so that each thread runs each task once
+    unsigned int                    m_nThreadsRunning;          ///< The number of threads yet to finish the current task
+    bool                            m_isStopped;                ///< Whether the pool has been stopped
+    std::mutex                      m_mutex;                    ///< The mutex guarding the task state
+    std::condition_variable         m_taskStarted;              ///< Signalled when a task is started or the pool is stopped
+    std::condition_variable         m_taskFinished;             ///< Signalled when the last thread finishes the current task
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PersistentThreadPool::GetNThreads() const
+{
+    return m_threadVector.size();
+}
+
+#endif // #ifndef PERSISTENT_THREAD_POOL_H
@@ -12,6 +12,8 @@
 #include "ClusterShapes.h"
 #include "Api/PandoraApi.h"
 
+#include "CaloHitCreator.h"
+
 namespace IMPL { class ClusterImpl; class ReconstructedParticleImpl; }
 namespace EVENT { class LCEvent; }
 
@@ -91,14 +93,15 @@ private:
      *  @param  subDetectorNames the list of sub detector names
      *  @param  pLcioCluster the address of the lcio cluster to be set sub detector energies
      *  @param  pandoraCaloHitList the pandora calorimeter hit list
+     *  @param  pSuperCellMemberMap address of the forward super-cell member map, NULL if there are no super-cells
      *  @param  hitE the vector to receive the energy of hits
      *  @param  hitX the vector to receive the x position of hits
      *  @param  hitY the vector to receive the y position of hits
      *  @param  hitZ the vector to receive the z position of hits
      */
     void SetClusterSubDetectorEnergies(const pandora::StringVector &subDetectorNames, IMPL::ClusterImpl *const pLcioCluster,
-        const pandora::CaloHitList &pandoraCaloHitList, pandora::FloatVector &hitE, pandora::FloatVector &hitX, pandora::FloatVector &hitY,
-        pandora::FloatVector &hitZ) const;
+        const pandora::CaloHitList &pandoraCaloHitList, const CaloHitCreator::SuperCellMemberMap *const pSuperCellMemberMap,
+        pandora::FloatVector &hitE, pandora::FloatVector &hitX, pandora::FloatVector &hitY, pandora::FloatVector &hitZ) const;
 
     /**
      *  @brief  Set cluster energies and errors
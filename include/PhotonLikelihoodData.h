@@ -0,0 +1,272 @@
+/**
+ *  @file   MarlinPandora/include/PhotonLikelihoodData.h
+ *
+ *  @brief  Header file for the photon likelihood data class.
+ *
+ *  $Log: $
+ */
+
+#ifndef PHOTON_LIKELIHOOD_DATA_H
+#define PHOTON_LIKELIHOOD_DATA_H 1
+
+#include "Pandora/StatusCodes.h"
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  PhotonLikelihoodData class, holding the signal and background pdfs written by the photon reconstruction training, one pair per
+ *          likelihood variable and energy bin, read from and written to the training xml file. All bin contents are stored in a single
+ *          block, so that many files can be summed bin by bin.
+ */
+class PhotonLikelihoodData
+{
+public:
+    typedef std::vector<float> FloatVector;
+    typedef std::vector<unsigned int> UIntVector;
+    typedef std::vector<std::string> StringVector;
+
+    /**
+     *  @brief  Pdf class, describing a single histogram within the bin contents block
+     */
+    class Pdf
+    {
+    public:
+        unsigned int        m_nBins;                        ///< The number of bins
+        float               m_xLow;                         ///< The lower edge of the first bin
+        float               m_xHigh;                        ///< The upper edge of the last bin
+        unsigned int        m_offset;                       ///< The index of the first bin content within the bin contents block
+    };
+
+    typedef std::vector<Pdf> PdfVector;
+
+    /**
+     *  @brief  Default constructor
+     */
+    PhotonLikelihoodData();
+
+    /**
+     *  @brief  Read the likelihood data from a photon reconstruction training xml file
+     *
+     *  @param  fileName the xml file name
+     */
+    pandora::StatusCode ReadXml(const std::string &fileName);
+
+    /**
+     *  @brief  Write the likelihood data to a photon reconstruction training xml file
+     *
+     *  @param  fileName the xml file name
+     */
+    pandora::StatusCode WriteXml(const std::string &fileName) const;
+
+    /**
+     *  @brief  Replace the training event counts and pdf bin contents, keeping the variables, energy bins and pdf binning
+     *
+     *  @param  nSignalEvents the number of signal training events in each energy bin
+     *  @param  nBackgroundEvents the number of background training events in each energy bin
+     *  @param  binContents the bin contents of all pdfs, in pdf order
+     */
+    pandora::StatusCode SetContents(const UIntVector &nSignalEvents, const UIntVector &nBackgroundEvents, const FloatVector &binContents);
+
+    /**
+     *  @brief  Whether another likelihood data set has the same variables, energy bins and pdf binning
+     *
+     *  @param  other the other likelihood data set
+     *
+     *  @return boolean
+     */
+    bool HasSameBinning(const PhotonLikelihoodData &other) const;
+
+    /**
+     *  @brief  Get the number of energy bins
+     *
+     *  @return the number of energy bins
+     */
+    unsigned int GetNEnergyBins() const;
+
+    /**
+     *  @brief  Get the energy bin lower edges
+     *
+     *  @return the energy bin lower edges, units GeV
+     */
+    const FloatVector &GetEnergyBinLowerEdges() const;
+
+    /**
+     *  @brief  Get the number of signal training events in each energy bin
+     *
+     *  @return the numbers of signal events
+     */
+    const UIntVector &GetNSignalEvents() const;
+
+    /**
+     *  @brief  Get the number of background training events in each energy bin
+     *
+     *  @return the numbers of background events
+     */
+    const UIntVector &GetNBackgroundEvents() const;
+
+    /**
+     *  @brief  Get the likelihood variable names, e.g. PeakRms for the PhotonSigPeakRms_N and PhotonBkgPeakRms_N pdfs
+     *
+     *  @return the likelihood variable names, in index order
+     */
+    const StringVector &GetVariableNames() const;
+
+    /**
+     *  @brief  Get all pdf descriptions
+     *
+     *  @return the pdf descriptions, ordered by variable, then energy bin, then signal before background
+     */
+    const PdfVector &GetPdfs() const;
+
+    /**
+     *  @brief  Get the bin contents of a pdf
+     *
+     *  @param  pdf the pdf description
+     *
+     *  @return address of the first of the pdf bin contents
+     */
+    const float *GetBinContents(const Pdf &pdf) const;
+
+private:
+    /**
+     *  @brief  Reset the likelihood data
+     */
+    void Clear();
+
+    /**
+     *  @brief  Append a pdf to the bin contents block
+     *
+     *  @param  xLow the lower edge of the first bin
+     *  @param  xHigh the upper edge of the last bin
+     *  @param  binContents the bin contents
+     *  @param  pdf to receive the pdf description
+     */
+    pandora::StatusCode AddPdf(const float xLow, const float xHigh, const FloatVector &binContents, Pdf &pdf);
+
+    /**
+     *  @brief  Check that the energy bin description and pdf list are consistent
+     */
+    pandora::StatusCode CheckConsistency() const;
+
+    FloatVector             m_energyBinLowerEdges;          ///< The energy bin lower edges, units GeV
+    UIntVector              m_nSignalEvents;                ///< The number of signal training events in each energy bin
+    UIntVector              m_nBackgroundEvents;            ///< The number of background training events in each energy bin
+    StringVector            m_variableNames;                ///< The likelihood variable names
+    PdfVector               m_pdfs;                         ///< The pdfs, ordered by variable, then energy bin, then signal before background
+    FloatVector             m_binContents;                  ///< The bin contents of all pdfs
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  PhotonLikelihoodSum class, accumulating the training events of likelihood data sets with identical binning. Pdfs are converted
+ *          to bin counts, rounded to whole events as in MergePandoraLikelihoodData.py, and summed in flat arrays, so the sum does not
+ *          depend on the order in which data sets, or partial sums, are added.
+ */
+class PhotonLikelihoodSum
+{
+public:
+    typedef std::vector<double> DoubleVector;
+
+    /**
+     *  @brief  Default constructor
+     */
+    PhotonLikelihoodSum();
+
+    /**
+     *  @brief  Add the training events of a likelihood data set; the first data set added defines the binning
+     *
+     *  @param  likelihoodData the likelihood data set
+     */
+    pandora::StatusCode Add(const PhotonLikelihoodData &likelihoodData);
+
+    /**
+     *  @brief  Add a partial sum
+     *
+     *  @param  likelihoodSum the partial sum
+     */
+    pandora::StatusCode Add(const PhotonLikelihoodSum &likelihoodSum);
+
+    /**
+     *  @brief  Get the number of likelihood data sets added
+     *
+     *  @return the number of likelihood data sets
+     */
+    unsigned int GetNInputs() const;
+
+    /**
+     *  @brief  Get the summed likelihood data, with each pdf normalised to the summed number of training events in its energy bin
+     *
+     *  @param  likelihoodData to receive the summed likelihood data
+     */
+    pandora::StatusCode GetLikelihoodData(PhotonLikelihoodData &likelihoodData) const;
+
+private:
+    unsigned int            m_nInputs;                      ///< The number of likelihood data sets added
+    PhotonLikelihoodData    m_binning;                      ///< The first likelihood data set added, defining the binning
+    DoubleVector            m_nSignalEvents;                ///< The summed number of signal training events in each energy bin
+    DoubleVector            m_nBackgroundEvents;            ///< The summed number of background training events in each energy bin
+    DoubleVector            m_binCounts;                    ///< The summed bin counts of all pdfs
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PhotonLikelihoodData::GetNEnergyBins() const
+{
+    return m_energyBinLowerEdges.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PhotonLikelihoodData::FloatVector &PhotonLikelihoodData::GetEnergyBinLowerEdges() const
+{
+    return m_energyBinLowerEdges;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PhotonLikelihoodData::UIntVector &PhotonLikelihoodData::GetNSignalEvents() const
+{
+    return m_nSignalEvents;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PhotonLikelihoodData::UIntVector &PhotonLikelihoodData::GetNBackgroundEvents() const
+{
+    return m_nBackgroundEvents;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PhotonLikelihoodData::StringVector &PhotonLikelihoodData::GetVariableNames() const
+{
+    return m_variableNames;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PhotonLikelihoodData::PdfVector &PhotonLikelihoodData::GetPdfs() const
+{
+    return m_pdfs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const float *PhotonLikelihoodData::GetBinContents(const Pdf &pdf) const
+{
+    return &m_binContents[pdf.m_offset];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PhotonLikelihoodSum::GetNInputs() const
+{
+    return m_nInputs;
+}
+
+#endif // #ifndef PHOTON_LIKELIHOOD_DATA_H
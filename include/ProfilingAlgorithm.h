@@ -0,0 +1,163 @@
+/**
+ *  @file   MarlinPandora/include/ProfilingAlgorithm.h
+ *
+ *  @brief  Header file for the profiling algorithm class.
+ *
+ *  $Log: $
+ */
+#ifndef PROFILING_ALGORITHM_H
+#define PROFILING_ALGORITHM_H 1
+
+#include "Pandora/Algorithm.h"
+
+#include "HardwareCounters.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ProfilingAlgorithm class, running the algorithms listed within it in the pandora settings file and recording their call counts,
+ *          wall times and current calo hit and cluster list sizes on entry and exit. The current lists are left untouched, so any algorithm
+ *          may be wrapped. Profiling algorithms may be nested, building a call tree for each pandora instance, which is printed by the
+ *          client application at the end of the job. Hardware counters, if enabled for the pandora instance, are summed for each node.
+ */
+class ProfilingAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        pandora::Algorithm *CreateAlgorithm() const;
+    };
+
+    /**
+     *  @brief  Print the profile recorded for a pandora instance
+     *
+     *  @param  pandora the pandora instance
+     */
+    static void PrintProfile(const pandora::Pandora &pandora);
+
+    /**
+     *  @brief  Sum the hardware counters over each profiled algorithm for a pandora instance, to be called before the first event
+     *
+     *  @param  pandora the pandora instance
+     */
+    static void EnableHardwareCounters(const pandora::Pandora &pandora);
+
+    /**
+     *  @brief  Discard the profile recorded for a pandora instance, to be called before the pandora instance is deleted
+     *
+     *  @param  pandora the pandora instance
+     */
+    static void ResetProfile(const pandora::Pandora &pandora);
+
+private:
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    /**
+     *  @brief  Get the sizes of the current calo hit and cluster lists, zero if a list is unavailable
+     *
+     *  @param  nCaloHits to receive the size of the current calo hit list
+     *  @param  nClusters to receive the size of the current cluster list
+     */
+    void GetCurrentListSizes(unsigned int &nCaloHits, unsigned int &nClusters) const;
+
+    class ProfileNode;
+    typedef std::vector<ProfileNode *> ProfileNodeVector;
+
+    /**
+     *  @brief  ProfileNode class, the accumulated profile of one algorithm instance at one position in the call tree
+     */
+    class ProfileNode
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  algorithmName the algorithm instance name
+         *  @param  label the label to print
+         */
+        ProfileNode(const std::string &algorithmName, const std::string &label);
+
+        /**
+         *  @brief  Destructor
+         */
+        ~ProfileNode();
+
+        /**
+         *  @brief  Get the daughter node for an algorithm instance, creating it on first use
+         *
+         *  @param  algorithmName the algorithm instance name
+         *  @param  label the label to print
+         *
+         *  @return address of the daughter node
+         */
+        ProfileNode *GetDaughterNode(const std::string &algorithmName, const std::string &label);
+
+        /**
+         *  @brief  Print the profile of this node and, recursively, its daughters
+         *
+         *  @param  depth the depth of this node in the call tree
+         *  @param  parentSeconds the total wall time of the parent node, used to express this node as a fraction of its parent
+         *  @param  useHardwareCounters whether to print the hardware counter summary
+         */
+        void Print(const unsigned int depth, const double parentSeconds, const bool useHardwareCounters) const;
+
+        std::string             m_algorithmName;            ///< The algorithm instance name
+        std::string             m_label;                    ///< The label to print
+        unsigned int            m_nCalls;                   ///< The number of calls
+        double                  m_totalSeconds;             ///< The total wall time, including daughters
+        double                  m_nCaloHitsIn;              ///< The summed current calo hit list size on entry
+        double                  m_nCaloHitsOut;             ///< The summed current calo hit list size on exit
+        double                  m_nClustersIn;              ///< The summed current cluster list size on entry
+        double                  m_nClustersOut;             ///< The summed current cluster list size on exit
+        HardwareCounters::Values m_counterTotals;           ///< The summed hardware counter differences, including daughters
+        ProfileNodeVector       m_daughterNodes;            ///< The daughter nodes, in order of first call
+    };
+
+    /**
+     *  @brief  ProfileTree class, the call tree for a pandora instance, with the nodes of the algorithms currently running
+     */
+    class ProfileTree
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        ProfileTree();
+
+        ProfileNode             m_rootNode;                 ///< The root node, to which the outermost profiled algorithms are attached
+        ProfileNodeVector       m_nodeStack;                ///< The nodes of the profiled algorithms currently running, outermost first
+        bool                    m_useHardwareCounters;      ///< Whether to sum the hardware counters for each node
+    };
+
+    typedef std::map<const pandora::Pandora *, ProfileTree *> ProfileTreeMap;
+
+    /**
+     *  @brief  Get the call tree for a pandora instance, creating it on first use
+     *
+     *  @param  pandora the pandora instance
+     *
+     *  @return the call tree
+     */
+    static ProfileTree &GetProfileTree(const pandora::Pandora &pandora);
+
+    typedef std::pair<std::string, std::string> NameAndLabel;
+    typedef std::vector<NameAndLabel> NameAndLabelVector;
+
+    NameAndLabelVector          m_algorithms;               ///< The daughter algorithm instance names and labels, in the order run
+
+    static ProfileTreeMap       m_profileTreeMap;           ///< The call trees, keyed by pandora instance
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *ProfilingAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new ProfilingAlgorithm();
+}
+
+#endif // #ifndef PROFILING_ALGORITHM_H
@@ -0,0 +1,171 @@
+/**
+ *  @file   MarlinPandora/include/ReclusteringCandidateAlgorithm.h
+ *
+ *  @brief  Header file for the reclustering candidate algorithm class.
+ *
+ *  $Log: $
+ */
+#ifndef RECLUSTERING_CANDIDATE_ALGORITHM_H
+#define RECLUSTERING_CANDIDATE_ALGORITHM_H 1
+
+#include "Pandora/Algorithm.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ReclusteringCandidateAlgorithm class, run in the reclustering worker pandora instances. The worker inputs are the calo hits and
+ *          tracks of a single cluster in a primary pandora instance, whose addresses are the worker parent addresses. The algorithm runs
+ *          one of its listed clustering algorithms, followed by optional association algorithms, and records the resulting cluster
+ *          partition, in terms of primary instance addresses, with its track-cluster compatibility.
+ */
+class ReclusteringCandidateAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        pandora::Algorithm *CreateAlgorithm() const;
+    };
+
+    typedef std::vector<const void *> AddressVector;
+
+    /**
+     *  @brief  CandidateCluster class, a cluster in a reclustering candidate
+     */
+    class CandidateCluster
+    {
+    public:
+        AddressVector           m_caloHitAddresses;         ///< The addresses of the clustered calo hits in the primary instance
+        AddressVector           m_isolatedCaloHitAddresses; ///< The addresses of the isolated calo hits in the primary instance
+        AddressVector           m_trackAddresses;           ///< The addresses of the associated tracks in the primary instance
+    };
+
+    typedef std::vector<CandidateCluster> CandidateClusterVector;
+
+    /**
+     *  @brief  Result class, the outcome of a reclustering candidate
+     */
+    class Result
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        Result();
+
+        /**
+         *  @brief  Whether the candidate produced any track-associated clusters
+         *
+         *  @return boolean
+         */
+        bool IsValid() const;
+
+        /**
+         *  @brief  Get the chi2 per degree of freedom for the track-cluster energy compatibility
+         *
+         *  @return the chi2 per degree of freedom
+         */
+        float GetChi2PerDof() const;
+
+        CandidateClusterVector  m_candidateClusters;        ///< The candidate clusters
+        float                   m_chi2;                     ///< The summed track-cluster chi2 for the clusters with associated tracks
+        unsigned int            m_nDof;                     ///< The number of clusters with associated tracks
+    };
+
+    /**
+     *  @brief  Default constructor
+     */
+    ReclusteringCandidateAlgorithm();
+
+    /**
+     *  @brief  Destructor
+     */
+    ~ReclusteringCandidateAlgorithm();
+
+    /**
+     *  @brief  Get the reclustering candidate algorithm registered by a worker pandora instance
+     *
+     *  @param  pandora the worker pandora instance
+     *
+     *  @return address of the algorithm, NULL if the worker settings do not include one
+     */
+    static ReclusteringCandidateAlgorithm *GetAlgorithm(const pandora::Pandora &pandora);
+
+    /**
+     *  @brief  Get the chi of the energy of a cluster, compared with the summed energy of its associated tracks
+     *
+     *  @param  pandora the pandora instance
+     *  @param  pCluster address of the cluster
+     *  @param  hadronicEnergyResolution the stochastic hadronic energy resolution
+     *
+     *  @return the chi, zero if the cluster has no associated tracks
+     */
+    static float GetTrackClusterChi(const pandora::Pandora &pandora, const pandora::Cluster *const pCluster, const float hadronicEnergyResolution);
+
+    /**
+     *  @brief  Get the number of candidate clustering algorithms
+     *
+     *  @return the number of candidate clustering algorithms
+     */
+    unsigned int GetNCandidates() const;
+
+    /**
+     *  @brief  Set the candidate to evaluate during the next event processed by the worker
+     *
+     *  @param  candidateIndex the index of the candidate clustering algorithm
+     *  @param  hadronicEnergyResolution the stochastic hadronic energy resolution, used for the track-cluster chi
+     *  @param  pResult address of the result to populate, NULL to evaluate nothing
+     */
+    void SetCandidate(const unsigned int candidateIndex, const float hadronicEnergyResolution, Result *const pResult);
+
+private:
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::vector<std::string> StringVector;
+    typedef std::map<const pandora::Pandora *, ReclusteringCandidateAlgorithm *> AlgorithmMap;
+
+    StringVector                m_clusteringAlgorithms;         ///< The candidate clustering algorithm names
+    std::string                 m_associationAlgorithmName;     ///< The name of the topological association algorithm to run
+    std::string                 m_trackClusterAssociationAlgName; ///< The name of the track-cluster association algorithm to run
+
+    unsigned int                m_candidateIndex;               ///< The index of the candidate clustering algorithm to run
+    float                       m_hadronicEnergyResolution;     ///< The stochastic hadronic energy resolution, used for the track-cluster chi
+    Result                     *m_pResult;                      ///< Address of the result to populate, NULL to evaluate nothing
+
+    static AlgorithmMap         m_algorithmMap;                 ///< The reclustering candidate algorithms, keyed by worker pandora instance
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *ReclusteringCandidateAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new ReclusteringCandidateAlgorithm();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int ReclusteringCandidateAlgorithm::GetNCandidates() const
+{
+    return m_clusteringAlgorithms.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool ReclusteringCandidateAlgorithm::Result::IsValid() const
+{
+    return (m_nDof > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float ReclusteringCandidateAlgorithm::Result::GetChi2PerDof() const
+{
+    return ((m_nDof > 0) ? m_chi2 / static_cast<float>(m_nDof) : 0.f);
+}
+
+#endif // #ifndef RECLUSTERING_CANDIDATE_ALGORITHM_H
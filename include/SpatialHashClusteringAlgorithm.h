@@ -0,0 +1,94 @@
+/**
+ *  @file   MarlinPandora/include/SpatialHashClusteringAlgorithm.h
+ * 
+ *  @brief  Header file for the spatial hash clustering algorithm class.
+ * 
+ *  $Log: $
+ */
+#ifndef SPATIAL_HASH_CLUSTERING_ALGORITHM_H
+#define SPATIAL_HASH_CLUSTERING_ALGORITHM_H 1
+
+#include "Pandora/Algorithm.h"
+
+#include <unordered_map>
+
+namespace pandora { class CaloHit; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  SpatialHashClusteringAlgorithm class, a density-based clustering algorithm for high occupancy events. Hits are binned in a 3D
+ *          cell hash, with cell size equal to the largest hit separation, so neighbour searches visit only the 27 surrounding cells.
+ *          Hits with enough neighbours are core hits and connected core hits form clusters; other hits join the cluster of their nearest
+ *          core neighbour, or are left unclustered.
+ */
+class SpatialHashClusteringAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        pandora::Algorithm *CreateAlgorithm() const;
+    };
+
+    /**
+     *  @brief  Default constructor
+     */
+    SpatialHashClusteringAlgorithm();
+
+private:
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::vector<const pandora::CaloHit *> CaloHitVector;
+    typedef std::vector<unsigned int> IndexVector;
+    typedef std::unordered_map<unsigned int, IndexVector> CellToHitIndicesMap;
+
+    /**
+     *  @brief  Get the hash key for the cell containing a position
+     * 
+     *  @param  x the cell index in x
+     *  @param  y the cell index in y
+     *  @param  z the cell index in z
+     * 
+     *  @return the cell hash key, which different cells may share
+     */
+    static unsigned int GetCellKey(const int x, const int y, const int z);
+
+    /**
+     *  @brief  Get the max separation for a calo hit to be a neighbour of another
+     * 
+     *  @param  pCaloHit address of the calo hit
+     * 
+     *  @return the max separation
+     */
+    float GetMaxSeparation(const pandora::CaloHit *const pCaloHit) const;
+
+    /**
+     *  @brief  Find the root of the set containing a hit, compressing the path
+     * 
+     *  @param  index the hit index
+     *  @param  parentVector the parent of each hit in the disjoint set forest
+     * 
+     *  @return the index of the root hit
+     */
+    static unsigned int FindRoot(unsigned int index, IndexVector &parentVector);
+
+    float           m_maxSeparationFine;            ///< Max separation between neighbouring hits, for hits in fine granularity calorimeters
+    float           m_maxSeparationCoarse;          ///< Max separation between neighbouring hits, for hits in coarse granularity calorimeters
+    unsigned int    m_minNeighboursForCore;         ///< Min number of neighbouring hits for a hit to be a core hit
+    unsigned int    m_maxNeighboursPerHit;          ///< Max number of neighbours examined per hit, bounding the cost per hit in dense regions
+    unsigned int    m_minHitsPerCluster;            ///< Min number of hits for a cluster to be created
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *SpatialHashClusteringAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new SpatialHashClusteringAlgorithm();
+}
+
+#endif // #ifndef SPATIAL_HASH_CLUSTERING_ALGORITHM_H
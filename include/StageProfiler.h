@@ -0,0 +1,159 @@
+/**
+ *  @file   MarlinPandora/include/StageProfiler.h
+ *
+ *  @brief  Header file for the stage profiler class.
+ *
+ *  $Log: $
+ */
+
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H 1
+
+#include "HardwareCounters.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  StageProfiler class, recording the wall time and heap allocations of each named stage of event processing, one sample per stage
+ *          per event, and printing their distributions at the end of the job. Allocations are counted by a replacement of the global
+ *          operator new and delete, compiled in with the PROFILE_ALLOCATIONS cmake option, and are not counted if that replacement is not
+ *          bound at run time. Hardware counters, if requested, are summed over each stage for the whole run. Only allocations and counts on
+ *          the thread running a stage are recorded, so work handed to other threads, e.g. concurrently processed pandora instances, is missed.
+ */
+class StageProfiler
+{
+public:
+    /**
+     *  @brief  AllocationCounters class, the running allocation totals for a thread
+     */
+    class AllocationCounters
+    {
+    public:
+        unsigned long long      m_nAllocations;             ///< The number of allocations
+        unsigned long long      m_nBytes;                   ///< The number of bytes requested
+        long long               m_liveBytes;                ///< The number of bytes currently allocated, as reserved by malloc
+        long long               m_peakLiveBytes;            ///< The peak number of bytes allocated since the innermost scope began
+    };
+
+    /**
+     *  @brief  Scope class, recording a sample for a stage from its construction to its destruction
+     */
+    class Scope
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  pStageProfiler address of the stage profiler, NULL to record nothing
+         *  @param  pStageName the stage name
+         */
+        Scope(StageProfiler *const pStageProfiler, const char *const pStageName);
+
+        /**
+         *  @brief  Destructor
+         */
+        ~Scope();
+
+    private:
+        /**
+         *  @brief  Disallow copying
+         */
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+
+        StageProfiler *const                    m_pStageProfiler;   ///< Address of the stage profiler
+        unsigned int                            m_stageIndex;       ///< The stage index
+        AllocationCounters                      m_startCounters;    ///< The allocation counters at the start of the scope
+        HardwareCounters::Values                m_startValues;      ///< The hardware counter values at the start of the scope
+        std::chrono::steady_clock::time_point   m_startTime;        ///< The start time of the scope
+    };
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  useHardwareCounters whether to sum the hardware counters over each stage
+     */
+    StageProfiler(const bool useHardwareCounters);
+
+    /**
+     *  @brief  Print the distributions of the per event samples for each stage, in order of first use
+     */
+    void Print() const;
+
+    /**
+     *  @brief  Whether the allocation counting operator new and delete have been compiled in
+     *
+     *  @return boolean
+     */
+    static bool IsAllocationHookCompiled();
+
+    /**
+     *  @brief  Whether the allocation counting operator new is bound, i.e. is counting allocations on the current thread. It is not bound
+     *          when the library is loaded via dlopen, e.g. via MARLIN_DLL, unless the library is also listed in LD_PRELOAD
+     *
+     *  @return boolean
+     */
+    static bool IsAllocationHookBound();
+
+private:
+    typedef std::vector<double> DoubleVector;
+
+    /**
+     *  @brief  Stage class, the samples recorded for a single stage
+     */
+    class Stage
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  name the stage name
+         */
+        Stage(const std::string &name);
+
+        std::string             m_name;                     ///< The stage name
+        DoubleVector            m_seconds;                  ///< The wall time of each sample
+        DoubleVector            m_nAllocations;             ///< The number of allocations in each sample
+        DoubleVector            m_nBytes;                   ///< The number of bytes requested in each sample
+        DoubleVector            m_peakLiveBytes;            ///< The peak growth in allocated bytes within each sample
+        HardwareCounters::Values m_counterTotals;           ///< The hardware counter differences summed over all samples
+    };
+
+    typedef std::vector<Stage> StageVector;
+
+    /**
+     *  @brief  Get the index of a stage, creating the stage on first use
+     *
+     *  @param  pStageName the stage name
+     *
+     *  @return the stage index
+     */
+    unsigned int GetStageIndex(const char *const pStageName);
+
+    /**
+     *  @brief  Print a row of the distribution table
+     *
+     *  @param  quantity the quantity label
+     *  @param  samples the samples, sorted in place
+     *  @param  scale the factor by which to multiply each sample when printing
+     *  @param  stageName the stage name, empty for rows after the first for a stage
+     */
+    static void PrintRow(const std::string &quantity, DoubleVector samples, const double scale, const std::string &stageName);
+
+    /**
+     *  @brief  Get the allocation counters for the current thread
+     *
+     *  @return the allocation counters
+     */
+    static AllocationCounters &GetThreadAllocationCounters();
+
+    const bool                  m_useHardwareCounters;      ///< Whether to sum the hardware counters over each stage
+    const bool                  m_countAllocations;         ///< Whether allocations are counted, with the allocation hook compiled in and bound
+    StageVector                 m_stages;                   ///< The stages, in order of first use
+};
+
+#endif // #ifndef STAGE_PROFILER_H
@@ -0,0 +1,178 @@
+/**
+ *  @file   MarlinPandora/include/SymmetricSectorGap.h
+ *
+ *  @brief  Header file for the symmetric sector gap class.
+ *
+ *  $Log: $
+ */
+
+#ifndef SYMMETRIC_SECTOR_GAP_H
+#define SYMMETRIC_SECTOR_GAP_H 1
+
+#include "Api/PandoraApi.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  SymmetricSectorGap class, describing identical box gaps placed at regular phi positions on a polygonal prism, oriented along
+ *          the main z axis, by a single set of parameters rather than one box per sector.
+ */
+class SymmetricSectorGap
+{
+public:
+    typedef std::vector<PandoraApi::Geometry::BoxGap::Parameters> BoxGapParametersVector;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  symmetryOrder the number of sectors
+     *  @param  phi0 the phi coordinate of the first sector
+     *  @param  innerRadius the inner r coordinate
+     *  @param  outerRadius the outer r coordinate
+     *  @param  minZ the minimum z coordinate
+     *  @param  maxZ the maximum z coordinate
+     *  @param  gapWidth the gap width
+     *  @param  vertexOffset position offset for vertex that doesn't point back to origin of xy plane
+     */
+    SymmetricSectorGap(const unsigned int symmetryOrder, const float phi0, const float innerRadius, const float outerRadius, const float minZ,
+        const float maxZ, const float gapWidth, const pandora::CartesianVector &vertexOffset = pandora::CartesianVector(0.f, 0.f, 0.f));
+
+    /**
+     *  @brief  Get the equivalent box gap parameters, one box per sector, as required to register the gaps with pandora
+     *
+     *  @param  boxGapParametersVector to receive the box gap parameters
+     */
+    void GetBoxGapParameters(BoxGapParametersVector &boxGapParametersVector) const;
+
+    /**
+     *  @brief  Get the number of sectors
+     *
+     *  @return the number of sectors
+     */
+    unsigned int GetSymmetryOrder() const;
+
+    /**
+     *  @brief  Get the phi coordinate of the first sector
+     *
+     *  @return the phi coordinate of the first sector
+     */
+    float GetPhi0() const;
+
+    /**
+     *  @brief  Get the inner r coordinate
+     *
+     *  @return the inner r coordinate
+     */
+    float GetInnerRadius() const;
+
+    /**
+     *  @brief  Get the outer r coordinate
+     *
+     *  @return the outer r coordinate
+     */
+    float GetOuterRadius() const;
+
+    /**
+     *  @brief  Get the minimum z coordinate
+     *
+     *  @return the minimum z coordinate
+     */
+    float GetMinZ() const;
+
+    /**
+     *  @brief  Get the maximum z coordinate
+     *
+     *  @return the maximum z coordinate
+     */
+    float GetMaxZ() const;
+
+    /**
+     *  @brief  Get the gap width
+     *
+     *  @return the gap width
+     */
+    float GetGapWidth() const;
+
+    /**
+     *  @brief  Get the vertex offset
+     *
+     *  @return the vertex offset
+     */
+    const pandora::CartesianVector &GetVertexOffset() const;
+
+private:
+    typedef std::vector<float> FloatVector;
+
+    unsigned int                m_symmetryOrder;            ///< The number of sectors
+    float                       m_phi0;                     ///< The phi coordinate of the first sector
+    float                       m_innerRadius;              ///< The inner r coordinate
+    float                       m_outerRadius;              ///< The outer r coordinate
+    float                       m_minZ;                     ///< The minimum z coordinate
+    float                       m_maxZ;                     ///< The maximum z coordinate
+    float                       m_gapWidth;                 ///< The gap width
+    pandora::CartesianVector    m_vertexOffset;             ///< Position offset for vertex that doesn't point back to origin of xy plane
+    FloatVector                 m_sinPhi;                   ///< The sine of the rotation angle for each sector
+    FloatVector                 m_cosPhi;                   ///< The cosine of the rotation angle for each sector
+};
+
+typedef std::vector<SymmetricSectorGap> SymmetricSectorGapVector;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int SymmetricSectorGap::GetSymmetryOrder() const
+{
+    return m_symmetryOrder;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetPhi0() const
+{
+    return m_phi0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetInnerRadius() const
+{
+    return m_innerRadius;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetOuterRadius() const
+{
+    return m_outerRadius;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetMinZ() const
+{
+    return m_minZ;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetMaxZ() const
+{
+    return m_maxZ;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float SymmetricSectorGap::GetGapWidth() const
+{
+    return m_gapWidth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::CartesianVector &SymmetricSectorGap::GetVertexOffset() const
+{
+    return m_vertexOffset;
+}
+
+#endif // #ifndef SYMMETRIC_SECTOR_GAP_H
@@ -0,0 +1,114 @@
+/**
+ *  @file   MarlinPandora/include/TablePseudoLayerPlugin.h
+ *
+ *  @brief  Header file for the table pseudo layer plugin class.
+ *
+ *  $Log: $
+ */
+#ifndef TABLE_PSEUDO_LAYER_PLUGIN_H
+#define TABLE_PSEUDO_LAYER_PLUGIN_H 1
+
+#include "Plugins/PseudoLayerPlugin.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  TablePseudoLayerPlugin class, assigning pseudo layers using the barrel and endcap layer positions of the ecal, hcal and muon
+ *          sub-detectors registered by the geometry creator. The polygon sector containing a point is found by binary search of a
+ *          precomputed table of sector boundaries, so the polygon radius requires a single projection, rather than one per polygon side.
+ *          The layer is then found by binary search of the layer position tables.
+ */
+class TablePseudoLayerPlugin : public pandora::PseudoLayerPlugin
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    TablePseudoLayerPlugin();
+
+    unsigned int GetPseudoLayer(const pandora::CartesianVector &positionVector) const;
+    unsigned int GetPseudoLayerAtIp() const;
+
+private:
+    pandora::StatusCode Initialize();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    typedef std::vector<float> LayerPositionList;
+
+    /**
+     *  @brief  PolygonTable class, a regular polygon described by the normals of its sides and the pseudo angles of its vertices
+     */
+    class PolygonTable
+    {
+    public:
+        /**
+         *  @brief  Fill the table for a regular polygon
+         *
+         *  @param  symmetryOrder the polygon order of symmetry, a circle if fewer than three
+         *  @param  phi0 the angle of the normal to the first side
+         */
+        void Fill(const unsigned int symmetryOrder, const float phi0);
+
+        /**
+         *  @brief  Get the radius of a point, defined as its projection onto the normal of the polygon side it lies beyond
+         *
+         *  @param  x the point x coordinate
+         *  @param  y the point y coordinate
+         *
+         *  @return the radius
+         */
+        float GetRadius(const float x, const float y) const;
+
+    private:
+        typedef std::vector<std::pair<float, float> > NormalVector;
+        typedef std::vector<float> PseudoAngleVector;
+        typedef std::vector<unsigned int> SectorVector;
+
+        NormalVector            m_normals;                  ///< The (cos, sin) of the normal to each polygon side
+        PseudoAngleVector       m_vertexPseudoAngles;       ///< The pseudo angles of the polygon vertices, in increasing order
+        SectorVector            m_sectors;                  ///< The side following each vertex, in the order of the vertex pseudo angles
+    };
+
+    /**
+     *  @brief  Get a pseudo angle, increasing monotonically with the azimuthal angle over the range [0, 4), without trigonometric functions
+     *
+     *  @param  x the x coordinate
+     *  @param  y the y coordinate
+     *
+     *  @return the pseudo angle
+     */
+    static float GetPseudoAngle(const float x, const float y);
+
+    /**
+     *  @brief  Append the layer positions of a sub-detector to a layer position list
+     *
+     *  @param  subDetector the sub-detector
+     *  @param  layerPositionList the layer position list
+     */
+    void StoreLayerPositions(const pandora::SubDetector &subDetector, LayerPositionList &layerPositionList) const;
+
+    /**
+     *  @brief  Find the layer whose position is closest to a given position
+     *
+     *  @param  position the position
+     *  @param  layerPositionList the layer position list
+     *  @param  layer to receive the layer
+     */
+    pandora::StatusCode FindMatchingLayer(const float position, const LayerPositionList &layerPositionList, unsigned int &layer) const;
+
+    LayerPositionList       m_barrelLayerPositions;         ///< The barrel layer positions, in r
+    LayerPositionList       m_endCapLayerPositions;         ///< The endcap layer positions, in z
+    PolygonTable            m_eCalBarrelPolygon;            ///< The ecal barrel inner polygon, used to find the barrel radius
+    PolygonTable            m_muonBarrelPolygon;            ///< The muon barrel inner polygon, used to find the outer detector edge
+    float                   m_barrelInnerR;                 ///< The ecal barrel inner r coordinate
+    float                   m_endCapInnerZ;                 ///< The ecal endcap inner z coordinate
+    float                   m_barrelOuterR;                 ///< The outer r coordinate of the barrel sub-detectors
+    float                   m_endCapOuterZ;                 ///< The outer z coordinate of the endcap sub-detectors
+    float                   m_rCorrection;                  ///< The barrel radius correction in the barrel-endcap overlap region
+    float                   m_zCorrection;                  ///< The endcap z correction in the barrel-endcap overlap region
+    unsigned int            m_pseudoLayerAtIp;              ///< The pseudo layer at the interaction point
+};
+
+#endif // #ifndef TABLE_PSEUDO_LAYER_PLUGIN_H
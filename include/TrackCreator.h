@@ -20,6 +20,8 @@
 #include "Api/PandoraApi.h"
 #include "Objects/Helix.h"
 
+#include "GeometryProvider.h"
+
 typedef std::vector<Track *> TrackVector;
 typedef std::set<const Track *> TrackList;
 typedef std::map<Track *, int> TrackToPidMap;
@@ -47,6 +49,9 @@ class TrackCreator
 public:
     typedef std::vector<double> DoubleVector;
     typedef std::vector<std::string> StringVector;
+    typedef std::vector<PandoraApi::Track::Parameters> TrackParametersVector;
+    typedef std::pair<const EVENT::Track *, const EVENT::Track *> TrackPair;
+    typedef std::vector<TrackPair> TrackPairVector;
 
     /**
      *  @brief  Settings class
@@ -106,9 +111,9 @@ public:
      *  @brief  Constructor
      * 
      *  @param  settings the creator settings
-     *  @param  pPandora address of the relevant pandora instance
+     *  @param  geometryProvider the geometry provider, from which the geometry constants are copied
      */
-     TrackCreator(const Settings &settings, const pandora::Pandora *const pPandora);
+     TrackCreator(const Settings &settings, const GeometryProvider &geometryProvider);
 
     /**
      *  @brief  Destructor
@@ -123,12 +128,19 @@ public:
     pandora::StatusCode CreateTrackAssociations(const EVENT::LCEvent *const pLCEvent);
 
     /**
-     *  @brief  Create tracks, insert user code here
+     *  @brief  Create track parameters from the lcio tracks, ready to be passed to one or more pandora instances, insert user code here
      * 
      *  @param  pLCEvent the lcio event
      */
     pandora::StatusCode CreateTracks(EVENT::LCEvent *pLCEvent);
 
+    /**
+     *  @brief  Create pandora tracks and track relationships, in the specified pandora instance, from the stored track parameters
+     * 
+     *  @param  pandora the pandora instance
+     */
+    pandora::StatusCode CreatePandoraTracks(const pandora::Pandora &pandora) const;
+
     /**
      *  @brief  Get the track vector
      * 
@@ -136,6 +148,27 @@ public:
      */
     const TrackVector &GetTrackVector() const;
 
+    /**
+     *  @brief  Get the track parameters vector
+     * 
+     *  @return The track parameters vector
+     */
+    const TrackParametersVector &GetTrackParametersVector() const;
+
+    /**
+     *  @brief  Get the track parent-daughter relationships
+     * 
+     *  @return The track parent-daughter relationships
+     */
+    const TrackPairVector &GetParentDaughterTrackPairs() const;
+
+    /**
+     *  @brief  Get the track sibling relationships
+     * 
+     *  @return The track sibling relationships
+     */
+    const TrackPairVector &GetSiblingTrackPairs() const;
+
     /**
      *  @brief  Reset the track creator
      */
@@ -267,7 +300,6 @@ private:
     int GetNFtdHits(const EVENT::Track *const pTrack) const;
 
     const Settings          m_settings;                     ///< The track creator settings
-    const pandora::Pandora *m_pPandora;                     ///< Address of the pandora object to create tracks and track relationships
 
     const float             m_bField;                       ///< The bfield
 
@@ -296,6 +328,10 @@ private:
     TrackList               m_parentTrackList;              ///< The list of parent tracks
     TrackList               m_daughterTrackList;            ///< The list of daughter tracks
     TrackToPidMap           m_trackToPidMap;                ///< The map from track addresses to particle ids, where set by kinks/V0s
+
+    TrackParametersVector   m_trackParametersVector;        ///< The track parameters, to be passed to each pandora instance
+    TrackPairVector         m_parentDaughterTrackPairs;     ///< The track parent-daughter relationships, to be passed to each pandora instance
+    TrackPairVector         m_siblingTrackPairs;            ///< The track sibling relationships, to be passed to each pandora instance
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -307,6 +343,27 @@ inline const TrackVector &TrackCreator::GetTrackVector() const
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+inline const TrackCreator::TrackParametersVector &TrackCreator::GetTrackParametersVector() const
+{
+    return m_trackParametersVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const TrackCreator::TrackPairVector &TrackCreator::GetParentDaughterTrackPairs() const
+{
+    return m_parentDaughterTrackPairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const TrackCreator::TrackPairVector &TrackCreator::GetSiblingTrackPairs() const
+{
+    return m_siblingTrackPairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 inline void TrackCreator::Reset()
 {
     m_trackVector.clear();
@@ -314,6 +371,9 @@ inline void TrackCreator::Reset()
     m_parentTrackList.clear();
     m_daughterTrackList.clear();
     m_trackToPidMap.clear();
+    m_trackParametersVector.clear();
+    m_parentDaughterTrackPairs.clear();
+    m_siblingTrackPairs.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
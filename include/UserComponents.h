@@ -0,0 +1,63 @@
+/**
+ *  @file   MarlinPandora/include/UserComponents.h
+ *
+ *  @brief  Header file for the user components class.
+ *
+ *  $Log: $
+ */
+
+#ifndef USER_COMPONENTS_H
+#define USER_COMPONENTS_H 1
+
+#include "Api/PandoraApi.h"
+
+#include <vector>
+
+class GeometryProvider;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  UserComponents class, registering the lc content and marlin pandora algorithms and plugins with a pandora instance. Shared by
+ *          the processor, the replay driver and the benchmark, so that each configures pandora identically from the same settings.
+ */
+class UserComponents
+{
+public:
+    typedef std::vector<float> FloatVector;
+
+    /**
+     *  @brief  Settings class
+     */
+    class Settings
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        Settings();
+
+        float           m_innerBField;                      ///< The bfield in the main tracker, ecal and hcal, units Tesla
+        float           m_muonBarrelBField;                 ///< The bfield in the muon barrel, units Tesla
+        float           m_muonEndCapBField;                 ///< The bfield in the muon endcap, units Tesla
+        int             m_useBFieldMap;                     ///< Whether to interpolate the bfield in a grid sampled from the gear field map
+
+        int             m_useTablePseudoLayerPlugin;        ///< Whether to replace the lc pseudo layer plugin with the table pseudo layer plugin
+
+        FloatVector     m_inputEnergyCorrectionPoints;      ///< The input energy points for non-linearity energy correction
+        FloatVector     m_outputEnergyCorrectionPoints;     ///< The output energy points for non-linearity energy correction
+        int             m_nNonLinearityGridPoints;          ///< The number of uniform grid points for the non-linearity correction, zero for none
+    };
+
+    /**
+     *  @brief  Register the algorithm factories, plugins and energy corrections selected by the settings. The ExternalClustering and
+     *          ExternalTrackClusterAssociation algorithms read lcio collections via the processor, so are registered by the processor alone.
+     *
+     *  @param  pandora the pandora instance with which to register the components
+     *  @param  settings the settings
+     *  @param  geometryProvider the geometry provider, holding any sampled bfield map
+     */
+    static pandora::StatusCode Register(const pandora::Pandora &pandora, const Settings &settings, const GeometryProvider &geometryProvider);
+};
+
+#endif // #ifndef USER_COMPONENTS_H
@@ -10,6 +10,8 @@
 #
 # Tested with Pandora v02-08-02. If photon reconstruction algorithm in LCContent is not changed, then this script should be valid
 #
+# The PandoraLikelihoodMerger executable performs the same merge in C++, reading the input files on several threads
+#
 ###########################################################################################################################################
 
 #!/usr/bin/python
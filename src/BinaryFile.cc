@@ -0,0 +1,264 @@
+/**
+ *  @file   MarlinPandora/src/BinaryFile.cc
+ *
+ *  @brief  Implementation of the binary file output and input classes.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "BinaryFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ *  @brief  File header, written in native byte order; the endianness marker guards against reading a file from a foreign platform
+ */
+struct BinaryFileHeader
+{
+    char                    m_fileType[8];                  ///< The eight character file type identifier
+    unsigned int            m_version;                      ///< The file format version
+    unsigned int            m_endiannessMarker;             ///< The endianness marker
+    unsigned long long      m_payloadSize;                  ///< The payload size, units bytes
+    unsigned long long      m_checksum;                     ///< The 64-bit FNV-1a hash of the payload
+};
+
+static const unsigned int ENDIANNESS_MARKER = 0x01020304;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BinaryFileOutput::BinaryFileOutput(const std::string &fileType, const unsigned int version) :
+    m_fileType(fileType),
+    m_version(version)
+{
+    if (m_fileType.size() != sizeof(BinaryFileHeader().m_fileType))
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void BinaryFileOutput::WriteString(const std::string &value)
+{
+    this->Write<unsigned int>(value.size());
+    m_payload.append(value);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode BinaryFileOutput::WriteFile(const std::string &fileName) const
+{
+    BinaryFileHeader header;
+    std::memcpy(header.m_fileType, m_fileType.c_str(), sizeof(header.m_fileType));
+    header.m_version = m_version;
+    header.m_endiannessMarker = ENDIANNESS_MARKER;
+    header.m_payloadSize = m_payload.size();
+    header.m_checksum = CalculateFnv1aHash(m_payload.data(), m_payload.size());
+
+    // ATTN Write to a uniquely named temporary file and rename, so that concurrent jobs never map, or write to, a partially written file
+    std::string temporaryFileName(fileName + ".XXXXXX");
+    const int fileDescriptor(mkstemp(&temporaryFileName[0]));
+
+    if (fileDescriptor < 0)
+    {
+        streamlog_out(ERROR) << "BinaryFileOutput: unable to create a temporary file for " << fileName << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    // mkstemp creates the file readable by its owner only; the snapshot is shared, so use the usual permissions
+    const mode_t fileCreationMask(umask(0));
+    (void) umask(fileCreationMask);
+    (void) fchmod(fileDescriptor, 0666 & ~fileCreationMask);
+
+    const bool isWritten(BinaryFileOutput::WriteAll(fileDescriptor, &header, sizeof(header)) &&
+        BinaryFileOutput::WriteAll(fileDescriptor, m_payload.data(), m_payload.size()));
+
+    if ((0 != close(fileDescriptor)) || !isWritten)
+    {
+        streamlog_out(ERROR) << "BinaryFileOutput: failed to write " << temporaryFileName << std::endl;
+        (void) std::remove(temporaryFileName.c_str());
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    if (0 != std::rename(temporaryFileName.c_str(), fileName.c_str()))
+    {
+        streamlog_out(ERROR) << "BinaryFileOutput: unable to rename " << temporaryFileName << " to " << fileName << std::endl;
+        (void) std::remove(temporaryFileName.c_str());
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool BinaryFileOutput::WriteAll(const int fileDescriptor, const void *const pData, const std::size_t size)
+{
+    const char *pPosition(static_cast<const char *>(pData));
+    std::size_t nBytesRemaining(size);
+
+    while (nBytesRemaining > 0)
+    {
+        const ssize_t nBytesWritten(write(fileDescriptor, pPosition, nBytesRemaining));
+
+        if (nBytesWritten < 0)
+        {
+            if (EINTR == errno)
+                continue;
+
+            return false;
+        }
+
+        pPosition += nBytesWritten;
+        nBytesRemaining -= nBytesWritten;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BinaryFileInput::BinaryFileInput() :
+    m_pMapping(NULL),
+    m_mappingSize(0),
+    m_pPayload(NULL),
+    m_payloadSize(0),
+    m_position(0),
+    m_checksum(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BinaryFileInput::~BinaryFileInput()
+{
+    this->Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode BinaryFileInput::Open(const std::string &fileName, const std::string &fileType, const unsigned int version)
+{
+    this->Close();
+
+    const int fileDescriptor(open(fileName.c_str(), O_RDONLY));
+
+    if (fileDescriptor < 0)
+        return pandora::STATUS_CODE_NOT_FOUND;
+
+    struct stat fileStatus;
+
+    if ((0 != fstat(fileDescriptor, &fileStatus)) || (static_cast<std::size_t>(fileStatus.st_size) < sizeof(BinaryFileHeader)))
+    {
+        close(fileDescriptor);
+        streamlog_out(WARNING) << "BinaryFileInput: " << fileName << " is too small to be a valid file" << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    void *const pMapping(mmap(NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0));
+    close(fileDescriptor);
+
+    if (MAP_FAILED == pMapping)
+    {
+        streamlog_out(WARNING) << "BinaryFileInput: unable to map " << fileName << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    m_pMapping = pMapping;
+    m_mappingSize = fileStatus.st_size;
+
+    BinaryFileHeader header;
+    std::memcpy(&header, m_pMapping, sizeof(header));
+
+    if ((0 != std::memcmp(header.m_fileType, fileType.c_str(), sizeof(header.m_fileType))) || (version != header.m_version) ||
+        (ENDIANNESS_MARKER != header.m_endiannessMarker))
+    {
+        streamlog_out(WARNING) << "BinaryFileInput: " << fileName << " has unexpected file type, version or byte order" << std::endl;
+        this->Close();
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    const char *const pPayload(static_cast<const char *>(m_pMapping) + sizeof(header));
+
+    if ((sizeof(header) + header.m_payloadSize != m_mappingSize) || (header.m_checksum != CalculateFnv1aHash(pPayload, header.m_payloadSize)))
+    {
+        streamlog_out(WARNING) << "BinaryFileInput: " << fileName << " is truncated or corrupt" << std::endl;
+        this->Close();
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    m_pPayload = pPayload;
+    m_payloadSize = header.m_payloadSize;
+    m_position = 0;
+    m_checksum = header.m_checksum;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode BinaryFileInput::ReadString(std::string &value)
+{
+    unsigned int size(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->Read(size));
+
+    if (m_position + size > m_payloadSize)
+        return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+    value.assign(m_pPayload + m_position, size);
+    m_position += size;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode BinaryFileInput::SetPosition(const std::size_t position)
+{
+    if ((NULL == m_pPayload) || (position > m_payloadSize))
+        return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+    m_position = position;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void BinaryFileInput::Close()
+{
+    if (NULL != m_pMapping)
+        munmap(m_pMapping, m_mappingSize);
+
+    m_pMapping = NULL;
+    m_mappingSize = 0;
+    m_pPayload = NULL;
+    m_payloadSize = 0;
+    m_position = 0;
+    m_checksum = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned long long CalculateFnv1aHash(const void *const pData, const std::size_t size, const unsigned long long seed)
+{
+    const unsigned char *const pBytes(static_cast<const unsigned char *>(pData));
+    unsigned long long hash(seed);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= pBytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
@@ -6,18 +6,8 @@
  *  $Log: $
  */
 
-#include "marlin/Global.h"
 #include "marlin/Processor.h"
 
-#include "gear/GearParameters.h"
-#include "gear/CalorimeterParameters.h"
-#include "gear/GearDistanceProperties.h"
-#include "gear/GearPointProperties.h"
-#include "gear/GEAR.h"
-#include "gear/TPCParameters.h"
-#include "gear/PadRowLayout2D.h"
-#include "gear/LayerLayout.h"
-
 #include "UTIL/CellIDDecoder.h"
 
 #include "CaloHitCreator.h"
@@ -27,39 +17,39 @@
 #include <cmath>
 #include <limits>
 
-CaloHitCreator::CaloHitCreator(const Settings &settings, const pandora::Pandora *const pPandora) :
+CaloHitCreator::CaloHitCreator(const Settings &settings, const GeometryProvider &geometryProvider) :
     m_settings(settings),
-    m_pPandora(pPandora),
-    m_eCalBarrelOuterZ(marlin::Global::GEAR->getEcalBarrelParameters().getExtent()[3]),
-    m_hCalBarrelOuterZ(marlin::Global::GEAR->getHcalBarrelParameters().getExtent()[3]),
-    m_muonBarrelOuterZ(marlin::Global::GEAR->getYokeBarrelParameters().getExtent()[3]),
-    m_coilOuterR(marlin::Global::GEAR->getGearParameters("CoilParameters").getDoubleVal("Coil_cryostat_outer_radius")),
-    m_eCalBarrelInnerPhi0(marlin::Global::GEAR->getEcalBarrelParameters().getPhi0()),
-    m_eCalBarrelInnerSymmetry(marlin::Global::GEAR->getEcalBarrelParameters().getSymmetryOrder()),
-    m_hCalBarrelInnerPhi0(marlin::Global::GEAR->getHcalBarrelParameters().getPhi0()),
-    m_hCalBarrelInnerSymmetry(marlin::Global::GEAR->getHcalBarrelParameters().getSymmetryOrder()),
-    m_muonBarrelInnerPhi0(marlin::Global::GEAR->getYokeBarrelParameters().getPhi0()),
-    m_muonBarrelInnerSymmetry(marlin::Global::GEAR->getYokeBarrelParameters().getSymmetryOrder()),
-    m_hCalEndCapOuterR(marlin::Global::GEAR->getHcalEndcapParameters().getExtent()[1]),
-    m_hCalEndCapOuterZ(marlin::Global::GEAR->getHcalEndcapParameters().getExtent()[3]),
-    m_hCalBarrelOuterR(marlin::Global::GEAR->getHcalBarrelParameters().getExtent()[1]),
-    m_hCalBarrelOuterPhi0((std::find(marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().begin(),
-        marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().end(),
-        "Hcal_outer_polygon_phi0") != marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().end() ?
-        marlin::Global::GEAR->getHcalBarrelParameters().getIntVal("Hcal_outer_polygon_phi0")
-        : 0)),
-    m_hCalBarrelOuterSymmetry((std::find(marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().begin(),
-        marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().end(),
-        "Hcal_outer_polygon_order") != marlin::Global::GEAR->getHcalBarrelParameters().getIntKeys().end() ?
-        marlin::Global::GEAR->getHcalBarrelParameters().getIntVal("Hcal_outer_polygon_order")
-        : 0))
+    m_eCalBarrelOuterZ(geometryProvider.GetConstant("ECalBarrelOuterZ")),
+    m_hCalBarrelOuterZ(geometryProvider.GetConstant("HCalBarrelOuterZ")),
+    m_muonBarrelOuterZ(geometryProvider.GetConstant("MuonBarrelOuterZ")),
+    m_coilOuterR(geometryProvider.GetConstant("CoilOuterR")),
+    m_eCalBarrelInnerPhi0(geometryProvider.GetConstant("ECalBarrelInnerPhi0")),
+    m_eCalBarrelInnerSymmetry(geometryProvider.GetConstant("ECalBarrelInnerSymmetry")),
+    m_hCalBarrelInnerPhi0(geometryProvider.GetConstant("HCalBarrelInnerPhi0")),
+    m_hCalBarrelInnerSymmetry(geometryProvider.GetConstant("HCalBarrelInnerSymmetry")),
+    m_muonBarrelInnerPhi0(geometryProvider.GetConstant("MuonBarrelInnerPhi0")),
+    m_muonBarrelInnerSymmetry(geometryProvider.GetConstant("MuonBarrelInnerSymmetry")),
+    m_hCalEndCapOuterR(geometryProvider.GetConstant("HCalEndCapOuterR")),
+    m_hCalEndCapOuterZ(geometryProvider.GetConstant("HCalEndCapOuterZ")),
+    m_hCalBarrelOuterR(geometryProvider.GetConstant("HCalBarrelOuterR")),
+    m_hCalBarrelOuterPhi0(geometryProvider.GetConstant("HCalBarrelOuterPhi0")),
+    m_hCalBarrelOuterSymmetry(geometryProvider.GetConstant("HCalBarrelOuterSymmetry")),
+    m_hCalBarrelLayerThickness(geometryProvider.GetConstant("HCalBarrelLayerThickness")),
+    m_hCalEndCapLayerThickness(geometryProvider.GetConstant("HCalEndCapLayerThickness")),
+    m_eCalBarrelLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::ECAL_BARREL_REGION)),
+    m_eCalEndCapLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::ECAL_ENDCAP_REGION)),
+    m_hCalBarrelLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::HCAL_BARREL_REGION)),
+    m_hCalEndCapLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::HCAL_ENDCAP_REGION)),
+    m_muonBarrelLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::MUON_BARREL_REGION)),
+    m_muonEndCapLayerLayout(geometryProvider.GetLayerLayout(GeometryProvider::MUON_ENDCAP_REGION)),
+    m_muonPlugLayerLayout(GetOptionalLayerLayout(geometryProvider, GeometryProvider::MUON_PLUG_REGION)),
+    m_lCalLayerLayout(GetOptionalLayerLayout(geometryProvider, GeometryProvider::LCAL_REGION)),
+    m_lHCalLayerLayout(GetOptionalLayerLayout(geometryProvider, GeometryProvider::LHCAL_REGION)),
+    m_nECalHitsOutOfTime(0),
+    m_nHCalHitsOutOfTime(0),
+    m_nMuonHitsOutOfTime(0),
+    m_nForwardHitsOutOfTime(0)
 {
-    const gear::LayerLayout &hCalEndCapLayerLayout(marlin::Global::GEAR->getHcalEndcapParameters().getLayerLayout());
-    const gear::LayerLayout &hCalBarrelLayerLayout(marlin::Global::GEAR->getHcalBarrelParameters().getLayerLayout()); 
-
-    m_hCalEndCapLayerThickness = hCalEndCapLayerLayout.getThickness(hCalEndCapLayerLayout.getNLayers() - 1);
-    m_hCalBarrelLayerThickness = hCalBarrelLayerLayout.getThickness(hCalBarrelLayerLayout.getNLayers() - 1);
-
     if ((m_hCalEndCapLayerThickness < std::numeric_limits<float>::epsilon()) || (m_hCalBarrelLayerThickness < std::numeric_limits<float>::epsilon()))
         throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
 }
@@ -76,12 +66,65 @@ pandora::StatusCode CaloHitCreator::CreateCaloHits(const EVENT::LCEvent *const p
 {
     UTIL::CellIDDecoder<CalorimeterHit>::setDefaultEncoding("M:3,S-1:3,I:9,J:9,K-1:6");
 
+    const unsigned int nECalHitsOutOfTime(m_nECalHitsOutOfTime), nHCalHitsOutOfTime(m_nHCalHitsOutOfTime);
+    const unsigned int nMuonHitsOutOfTime(m_nMuonHitsOutOfTime), nForwardHitsOutOfTime(m_nForwardHitsOutOfTime);
+
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateECalCaloHits(pLCEvent));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalCaloHits(pLCEvent));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateMuonCaloHits(pLCEvent));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateLCalCaloHits(pLCEvent));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateLHCalCaloHits(pLCEvent));
 
+    if (m_settings.m_applyTimingWindows)
+    {
+        streamlog_out(DEBUG) << "CaloHitCreator - Hits outside timing windows, this event: ecal " << m_nECalHitsOutOfTime - nECalHitsOutOfTime
+                             << ", hcal " << m_nHCalHitsOutOfTime - nHCalHitsOutOfTime << ", muon " << m_nMuonHitsOutOfTime - nMuonHitsOutOfTime
+                             << ", forward " << m_nForwardHitsOutOfTime - nForwardHitsOutOfTime << std::endl;
+    }
+
+    if (m_settings.m_sortCaloHitsSpatially)
+        this->SortCaloHits();
+
+    // Index the calorimeter hits once, for use by any algorithm seeking pandora calo hits via their parent addresses
+    m_calorimeterHitIndexMap.reserve(m_calorimeterHitVector.size());
+
+    for (unsigned int iHit = 0, nHits = m_calorimeterHitVector.size(); iHit < nHits; ++iHit)
+        (void) m_calorimeterHitIndexMap.insert(CalorimeterHitIndexMap::value_type(m_calorimeterHitVector[iHit], iHit));
+
+    // ATTN Hits merged into a forward super-cell are indexed as the super-cell, whose parent address is the representative hit
+    for (SuperCellMemberMap::const_iterator iter = m_superCellMemberMap.begin(), iterEnd = m_superCellMemberMap.end(); iter != iterEnd; ++iter)
+    {
+        CalorimeterHitIndexMap::const_iterator indexIter = m_calorimeterHitIndexMap.find(iter->first);
+
+        if (m_calorimeterHitIndexMap.end() == indexIter)
+            continue;
+
+        const unsigned int superCellIndex(indexIter->second);
+
+        for (CalorimeterHitVector::const_iterator hitIter = iter->second.begin(), hitIterEnd = iter->second.end(); hitIter != hitIterEnd; ++hitIter)
+            (void) m_calorimeterHitIndexMap.insert(CalorimeterHitIndexMap::value_type(*hitIter, superCellIndex));
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode CaloHitCreator::CreatePandoraCaloHits(const pandora::Pandora &pandora) const
+{
+    for (CaloHitParametersVector::const_iterator iter = m_caloHitParametersVector.begin(), iterEnd = m_caloHitParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora calo hit: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
     return pandora::STATUS_CODE_SUCCESS;
 }
 
@@ -100,9 +143,6 @@ pandora::StatusCode CaloHitCreator::CreateECalCaloHits(const EVENT::LCEvent *con
             if (0 == nElements)
                 continue;
 
-            const gear::LayerLayout &endcapLayerLayout(marlin::Global::GEAR->getEcalEndcapParameters().getLayerLayout());
-            const gear::LayerLayout &barrelLayerLayout(marlin::Global::GEAR->getEcalBarrelParameters().getLayerLayout()); 
-
             UTIL::CellIDDecoder<CalorimeterHit> cellIdDecoder(pCaloHitCollection);
             const std::string layerCodingString(pCaloHitCollection->getParameters().getStringVal(LCIO::CellIDEncoding));
             const std::string layerCoding(this->GetLayerCoding(layerCodingString));
@@ -117,6 +157,12 @@ pandora::StatusCode CaloHitCreator::CreateECalCaloHits(const EVENT::LCEvent *con
                     if (NULL == pCaloHit)
                         throw EVENT::Exception("Collection type mismatch");
 
+                    if (!this->IsInTimingWindow(pCaloHit, m_settings.m_eCalTimeWindowMin, m_settings.m_eCalTimeWindowMax))
+                    {
+                        ++m_nECalHitsOutOfTime;
+                        continue;
+                    }
+
                     float eCalToMip(m_settings.m_eCalToMip), eCalMipThreshold(m_settings.m_eCalMipThreshold), eCalToEMGeV(m_settings.m_eCalToEMGeV),
                         eCalToHadGeVBarrel(m_settings.m_eCalToHadGeVBarrel), eCalToHadGeVEndCap(m_settings.m_eCalToHadGeVEndCap);
 
@@ -158,14 +204,14 @@ pandora::StatusCode CaloHitCreator::CreateECalCaloHits(const EVENT::LCEvent *con
 
                     if (std::fabs(pCaloHit->getPosition()[2]) < m_eCalBarrelOuterZ)
                     {
-                        this->GetBarrelCaloHitProperties(pCaloHit, barrelLayerLayout, m_eCalBarrelInnerSymmetry, m_eCalBarrelInnerPhi0,
+                        this->GetBarrelCaloHitProperties(pCaloHit, m_eCalBarrelLayerLayout, m_eCalBarrelInnerSymmetry, m_eCalBarrelInnerPhi0,
                             cellIdDecoder(pCaloHit)[ staveCoding], caloHitParameters, absorberCorrection);
 
                         caloHitParameters.m_hadronicEnergy = eCalToHadGeVBarrel * pCaloHit->getEnergy();
                     }
                     else
                     {
-                        this->GetEndCapCaloHitProperties(pCaloHit, endcapLayerLayout, caloHitParameters, absorberCorrection);
+                        this->GetEndCapCaloHitProperties(pCaloHit, m_eCalEndCapLayerLayout, caloHitParameters, absorberCorrection);
                         caloHitParameters.m_hadronicEnergy = eCalToHadGeVEndCap * pCaloHit->getEnergy();
                     }
 
@@ -184,9 +230,8 @@ pandora::StatusCode CaloHitCreator::CreateECalCaloHits(const EVENT::LCEvent *con
                         caloHitParameters.m_cellSize1 = splitCellSize;
                     }
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*m_pPandora, caloHitParameters));
+                    m_caloHitParametersVector.push_back(caloHitParameters);
                     m_calorimeterHitVector.push_back(pCaloHit);
-
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
                 {
@@ -222,9 +267,6 @@ pandora::StatusCode CaloHitCreator::CreateHCalCaloHits(const EVENT::LCEvent *con
             if (0 == nElements)
                 continue;
 
-            const gear::LayerLayout &endcapLayerLayout(marlin::Global::GEAR->getHcalEndcapParameters().getLayerLayout());
-            const gear::LayerLayout &barrelLayerLayout(marlin::Global::GEAR->getHcalBarrelParameters().getLayerLayout());
-
             UTIL::CellIDDecoder<CalorimeterHit> cellIdDecoder(pCaloHitCollection);
             const std::string layerCodingString(pCaloHitCollection->getParameters().getStringVal(LCIO::CellIDEncoding));
             const std::string layerCoding(this->GetLayerCoding(layerCodingString));
@@ -239,6 +281,12 @@ pandora::StatusCode CaloHitCreator::CreateHCalCaloHits(const EVENT::LCEvent *con
                     if (NULL == pCaloHit)
                         throw EVENT::Exception("Collection type mismatch");
 
+                    if (!this->IsInTimingWindow(pCaloHit, m_settings.m_hCalTimeWindowMin, m_settings.m_hCalTimeWindowMax))
+                    {
+                        ++m_nHCalHitsOutOfTime;
+                        continue;
+                    }
+
                     PandoraApi::CaloHit::Parameters caloHitParameters;
                     caloHitParameters.m_hitType = pandora::HCAL;
                     caloHitParameters.m_isDigital = false;
@@ -250,12 +298,12 @@ pandora::StatusCode CaloHitCreator::CreateHCalCaloHits(const EVENT::LCEvent *con
 
                     if (std::fabs(pCaloHit->getPosition()[2]) < m_hCalBarrelOuterZ)
                     {
-                        this->GetBarrelCaloHitProperties(pCaloHit, barrelLayerLayout, m_hCalBarrelInnerSymmetry, m_hCalBarrelInnerPhi0,
+                        this->GetBarrelCaloHitProperties(pCaloHit, m_hCalBarrelLayerLayout, m_hCalBarrelInnerSymmetry, m_hCalBarrelInnerPhi0,
                             m_hCalBarrelInnerSymmetry - int(cellIdDecoder(pCaloHit)[ staveCoding] / 2), caloHitParameters, absorberCorrection);
                     }
                     else
                     {
-                        this->GetEndCapCaloHitProperties(pCaloHit, endcapLayerLayout, caloHitParameters, absorberCorrection);
+                        this->GetEndCapCaloHitProperties(pCaloHit, m_hCalEndCapLayerLayout, caloHitParameters, absorberCorrection);
                     }
 
                     caloHitParameters.m_mipEquivalentEnergy = pCaloHit->getEnergy() * m_settings.m_hCalToMip * absorberCorrection;
@@ -266,7 +314,7 @@ pandora::StatusCode CaloHitCreator::CreateHCalCaloHits(const EVENT::LCEvent *con
                     caloHitParameters.m_hadronicEnergy = std::min(m_settings.m_hCalToHadGeV * pCaloHit->getEnergy(), m_settings.m_maxHCalHitHadronicEnergy);
                     caloHitParameters.m_electromagneticEnergy = m_settings.m_hCalToEMGeV * pCaloHit->getEnergy();
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*m_pPandora, caloHitParameters));
+                    m_caloHitParametersVector.push_back(caloHitParameters);
                     m_calorimeterHitVector.push_back(pCaloHit);
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
@@ -303,10 +351,6 @@ pandora::StatusCode CaloHitCreator::CreateMuonCaloHits(const EVENT::LCEvent *con
             if (0 == nElements)
                 continue;
 
-            const gear::LayerLayout &endcapLayerLayout(marlin::Global::GEAR->getYokeEndcapParameters().getLayerLayout());
-            const gear::LayerLayout &barrelLayerLayout(marlin::Global::GEAR->getYokeBarrelParameters().getLayerLayout()); 
-            const gear::LayerLayout &plugLayerLayout(marlin::Global::GEAR->getYokePlugParameters().getLayerLayout());
-
             UTIL::CellIDDecoder<CalorimeterHit> cellIdDecoder(pCaloHitCollection);
             const std::string layerCodingString(pCaloHitCollection->getParameters().getStringVal(LCIO::CellIDEncoding));
             const std::string layerCoding(this->GetLayerCoding(layerCodingString));
@@ -321,6 +365,12 @@ pandora::StatusCode CaloHitCreator::CreateMuonCaloHits(const EVENT::LCEvent *con
                     if (NULL == pCaloHit)
                         throw EVENT::Exception("Collection type mismatch");
 
+                    if (!this->IsInTimingWindow(pCaloHit, m_settings.m_muonTimeWindowMin, m_settings.m_muonTimeWindowMax))
+                    {
+                        ++m_nMuonHitsOutOfTime;
+                        continue;
+                    }
+
                     PandoraApi::CaloHit::Parameters caloHitParameters;
                     caloHitParameters.m_hitType = pandora::MUON;
                     caloHitParameters.m_layer = cellIdDecoder(pCaloHit)[layerCoding.c_str()];
@@ -337,16 +387,16 @@ pandora::StatusCode CaloHitCreator::CreateMuonCaloHits(const EVENT::LCEvent *con
 
                     if (isInBarrelRegion && isWithinCoil)
                     {
-                        this->GetEndCapCaloHitProperties(pCaloHit, plugLayerLayout, caloHitParameters, absorberCorrection);
+                        this->GetEndCapCaloHitProperties(pCaloHit, m_muonPlugLayerLayout, caloHitParameters, absorberCorrection);
                     }
                     else if (isInBarrelRegion)
                     {
-                        this->GetBarrelCaloHitProperties(pCaloHit, barrelLayerLayout, m_muonBarrelInnerSymmetry, m_muonBarrelInnerPhi0,
+                        this->GetBarrelCaloHitProperties(pCaloHit, m_muonBarrelLayerLayout, m_muonBarrelInnerSymmetry, m_muonBarrelInnerPhi0,
                             cellIdDecoder(pCaloHit)[ staveCoding ], caloHitParameters, absorberCorrection);
                     }
                     else
                     {
-                        this->GetEndCapCaloHitProperties(pCaloHit, endcapLayerLayout, caloHitParameters, absorberCorrection);
+                        this->GetEndCapCaloHitProperties(pCaloHit, m_muonEndCapLayerLayout, caloHitParameters, absorberCorrection);
                     }
 
                     if (m_settings.m_muonDigitalHits > 0)
@@ -366,7 +416,7 @@ pandora::StatusCode CaloHitCreator::CreateMuonCaloHits(const EVENT::LCEvent *con
                         caloHitParameters.m_mipEquivalentEnergy = pCaloHit->getEnergy() * m_settings.m_muonToMip;
                     }
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*m_pPandora, caloHitParameters));
+                    m_caloHitParametersVector.push_back(caloHitParameters);
                     m_calorimeterHitVector.push_back(pCaloHit);
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
@@ -392,6 +442,9 @@ pandora::StatusCode CaloHitCreator::CreateMuonCaloHits(const EVENT::LCEvent *con
 
 pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *const pLCEvent)
 {
+    CaloHitParametersVector caloHitParametersVector;
+    CalorimeterHitVector calorimeterHitVector;
+
     for (StringVector::const_iterator iter = m_settings.m_lCalCaloHitCollections.begin(), iterEnd = m_settings.m_lCalCaloHitCollections.end();
         iter != iterEnd; ++iter)
     {
@@ -403,8 +456,6 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
             if (0 == nElements)
                 continue;
 
-            const gear::LayerLayout &endcapLayerLayout(marlin::Global::GEAR->getLcalParameters().getLayerLayout()); 
-
             UTIL::CellIDDecoder<CalorimeterHit> cellIdDecoder(pCaloHitCollection);
             const std::string layerCodingString(pCaloHitCollection->getParameters().getStringVal(LCIO::CellIDEncoding));
             const std::string layerCoding(this->GetLayerCoding(layerCodingString));
@@ -418,6 +469,12 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
                     if (NULL == pCaloHit)
                         throw EVENT::Exception("Collection type mismatch");
 
+                    if (!this->IsInTimingWindow(pCaloHit, m_settings.m_forwardTimeWindowMin, m_settings.m_forwardTimeWindowMax))
+                    {
+                        ++m_nForwardHitsOutOfTime;
+                        continue;
+                    }
+
                     PandoraApi::CaloHit::Parameters caloHitParameters;
                     caloHitParameters.m_hitType = pandora::ECAL;
                     caloHitParameters.m_isDigital = false;
@@ -426,7 +483,7 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
                     this->GetCommonCaloHitProperties(pCaloHit, caloHitParameters);
 
                     float absorberCorrection(1.);
-                    this->GetEndCapCaloHitProperties(pCaloHit, endcapLayerLayout, caloHitParameters, absorberCorrection);
+                    this->GetEndCapCaloHitProperties(pCaloHit, m_lCalLayerLayout, caloHitParameters, absorberCorrection);
 
                     caloHitParameters.m_mipEquivalentEnergy = pCaloHit->getEnergy() * m_settings.m_eCalToMip * absorberCorrection;
 
@@ -436,8 +493,8 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
                     caloHitParameters.m_electromagneticEnergy = m_settings.m_eCalToEMGeV * pCaloHit->getEnergy();
                     caloHitParameters.m_hadronicEnergy = m_settings.m_eCalToHadGeVEndCap * pCaloHit->getEnergy();
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*m_pPandora, caloHitParameters));
-                    m_calorimeterHitVector.push_back(pCaloHit);
+                    caloHitParametersVector.push_back(caloHitParameters);
+                    calorimeterHitVector.push_back(pCaloHit);
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
                 {
@@ -455,6 +512,8 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
         }
     }
 
+    this->AddForwardCaloHits(m_settings.m_lCalCoarseningFactors, caloHitParametersVector, calorimeterHitVector);
+
     return pandora::STATUS_CODE_SUCCESS;
 }
 
@@ -462,6 +521,9 @@ pandora::StatusCode CaloHitCreator::CreateLCalCaloHits(const EVENT::LCEvent *con
 
 pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *const pLCEvent)
 {
+    CaloHitParametersVector caloHitParametersVector;
+    CalorimeterHitVector calorimeterHitVector;
+
     for (StringVector::const_iterator iter = m_settings.m_lHCalCaloHitCollections.begin(), iterEnd = m_settings.m_lHCalCaloHitCollections.end();
         iter != iterEnd; ++iter)
     {
@@ -473,8 +535,6 @@ pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *co
             if (0 == nElements)
                 continue;
 
-            const gear::LayerLayout &endcapLayerLayout(marlin::Global::GEAR->getLHcalParameters().getLayerLayout());
-
             UTIL::CellIDDecoder<CalorimeterHit> cellIdDecoder(pCaloHitCollection);
             const std::string layerCodingString(pCaloHitCollection->getParameters().getStringVal(LCIO::CellIDEncoding));
             const std::string layerCoding(this->GetLayerCoding(layerCodingString));
@@ -488,6 +548,12 @@ pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *co
                     if (NULL == pCaloHit)
                         throw EVENT::Exception("Collection type mismatch");
 
+                    if (!this->IsInTimingWindow(pCaloHit, m_settings.m_forwardTimeWindowMin, m_settings.m_forwardTimeWindowMax))
+                    {
+                        ++m_nForwardHitsOutOfTime;
+                        continue;
+                    }
+
                     PandoraApi::CaloHit::Parameters caloHitParameters;
                     caloHitParameters.m_hitType = pandora::HCAL;
                     caloHitParameters.m_isDigital = false;
@@ -496,7 +562,7 @@ pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *co
                     this->GetCommonCaloHitProperties(pCaloHit, caloHitParameters);
 
                     float absorberCorrection(1.);
-                    this->GetEndCapCaloHitProperties(pCaloHit, endcapLayerLayout, caloHitParameters, absorberCorrection);
+                    this->GetEndCapCaloHitProperties(pCaloHit, m_lHCalLayerLayout, caloHitParameters, absorberCorrection);
 
                     caloHitParameters.m_mipEquivalentEnergy = pCaloHit->getEnergy() * m_settings.m_hCalToMip * absorberCorrection;
 
@@ -506,8 +572,8 @@ pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *co
                     caloHitParameters.m_hadronicEnergy = std::min(m_settings.m_hCalToHadGeV * pCaloHit->getEnergy(), m_settings.m_maxHCalHitHadronicEnergy);
                     caloHitParameters.m_electromagneticEnergy = m_settings.m_hCalToEMGeV * pCaloHit->getEnergy();
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*m_pPandora, caloHitParameters));
-                    m_calorimeterHitVector.push_back(pCaloHit);
+                    caloHitParametersVector.push_back(caloHitParameters);
+                    calorimeterHitVector.push_back(pCaloHit);
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
                 {
@@ -525,11 +591,208 @@ pandora::StatusCode CaloHitCreator::CreateLHCalCaloHits(const EVENT::LCEvent *co
         }
     }
 
+    this->AddForwardCaloHits(m_settings.m_lHCalCoarseningFactors, caloHitParametersVector, calorimeterHitVector);
+
     return pandora::STATUS_CODE_SUCCESS;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void CaloHitCreator::PrintTimingWindowSummary() const
+{
+    if (!m_settings.m_applyTimingWindows)
+        return;
+
+    streamlog_out(MESSAGE) << "CaloHitCreator - Hits rejected by time of flight corrected timing windows: ecal " << m_nECalHitsOutOfTime
+                           << ", hcal " << m_nHCalHitsOutOfTime << ", muon " << m_nMuonHitsOutOfTime << ", forward " << m_nForwardHitsOutOfTime
+                           << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void CaloHitCreator::AddForwardCaloHits(const IntVector &coarseningFactors, const CaloHitParametersVector &caloHitParametersVector,
+    const CalorimeterHitVector &calorimeterHitVector)
+{
+    if (!m_settings.m_coarsenForwardHits || coarseningFactors.empty())
+    {
+        m_caloHitParametersVector.insert(m_caloHitParametersVector.end(), caloHitParametersVector.begin(), caloHitParametersVector.end());
+        m_calorimeterHitVector.insert(m_calorimeterHitVector.end(), calorimeterHitVector.begin(), calorimeterHitVector.end());
+        return;
+    }
+
+    typedef std::unordered_map<unsigned long long, unsigned int> SuperCellKeyMap;
+    typedef std::vector<unsigned int> IndexVector;
+    typedef std::vector<IndexVector> IndexVectorList;
+
+    // Group the cells by layer, endcap and super-cell grid position; the groups are ordered by their first cell, for reproducibility
+    SuperCellKeyMap superCellKeyMap;
+    IndexVectorList superCellList;
+
+    for (unsigned int iHit = 0, nHits = caloHitParametersVector.size(); iHit < nHits; ++iHit)
+    {
+        const PandoraApi::CaloHit::Parameters &caloHitParameters(caloHitParametersVector[iHit]);
+        const unsigned int layer(caloHitParameters.m_layer.Get());
+        const int coarseningFactor(std::max(1, coarseningFactors[std::min(static_cast<std::size_t>(layer), coarseningFactors.size() - 1)]));
+
+        const pandora::CartesianVector &positionVector(caloHitParameters.m_positionVector.Get());
+        const float pitch0(std::max(std::numeric_limits<float>::epsilon(), coarseningFactor * caloHitParameters.m_cellSize0.Get()));
+        const float pitch1(std::max(std::numeric_limits<float>::epsilon(), coarseningFactor * caloHitParameters.m_cellSize1.Get()));
+
+        // Pack layer (12 bits), endcap (1 bit) and the offset grid coordinates (25 bits each) into a single key
+        const long long gridX(static_cast<long long>(std::floor(positionVector.GetX() / pitch0)) + (1LL << 24));
+        const long long gridY(static_cast<long long>(std::floor(positionVector.GetY() / pitch1)) + (1LL << 24));
+        const unsigned long long key((static_cast<unsigned long long>(layer & 0xFFF) << 51) |
+            (static_cast<unsigned long long>(positionVector.GetZ() > 0.f) << 50) |
+            ((static_cast<unsigned long long>(gridX) & 0x1FFFFFFULL) << 25) | (static_cast<unsigned long long>(gridY) & 0x1FFFFFFULL));
+
+        std::pair<SuperCellKeyMap::iterator, bool> insertion(superCellKeyMap.insert(SuperCellKeyMap::value_type(key, superCellList.size())));
+
+        if (insertion.second)
+            superCellList.push_back(IndexVector());
+
+        superCellList[insertion.first->second].push_back(iHit);
+    }
+
+    for (IndexVectorList::const_iterator iter = superCellList.begin(), iterEnd = superCellList.end(); iter != iterEnd; ++iter)
+    {
+        const IndexVector &memberIndices(*iter);
+
+        if (1 == memberIndices.size())
+        {
+            m_caloHitParametersVector.push_back(caloHitParametersVector[memberIndices.front()]);
+            m_calorimeterHitVector.push_back(calorimeterHitVector[memberIndices.front()]);
+            continue;
+        }
+
+        unsigned int representativeIndex(memberIndices.front());
+        float inputEnergy(0.f), mipEquivalentEnergy(0.f), electromagneticEnergy(0.f), hadronicEnergy(0.f);
+        float time(std::numeric_limits<float>::max());
+        pandora::CartesianVector weightedPosition(0.f, 0.f, 0.f), meanPosition(0.f, 0.f, 0.f);
+        CalorimeterHitVector memberHits;
+
+        for (IndexVector::const_iterator indexIter = memberIndices.begin(), indexIterEnd = memberIndices.end(); indexIter != indexIterEnd; ++indexIter)
+        {
+            const PandoraApi::CaloHit::Parameters &caloHitParameters(caloHitParametersVector[*indexIter]);
+            const float memberEnergy(caloHitParameters.m_inputEnergy.Get());
+
+            if (memberEnergy > caloHitParametersVector[representativeIndex].m_inputEnergy.Get())
+                representativeIndex = *indexIter;
+
+            inputEnergy += memberEnergy;
+            mipEquivalentEnergy += caloHitParameters.m_mipEquivalentEnergy.Get();
+            electromagneticEnergy += caloHitParameters.m_electromagneticEnergy.Get();
+            hadronicEnergy += caloHitParameters.m_hadronicEnergy.Get();
+            time = std::min(time, caloHitParameters.m_time.Get());
+            weightedPosition += caloHitParameters.m_positionVector.Get() * memberEnergy;
+            meanPosition += caloHitParameters.m_positionVector.Get();
+            memberHits.push_back(calorimeterHitVector[*indexIter]);
+        }
+
+        const IntVector::size_type layer(caloHitParametersVector[representativeIndex].m_layer.Get());
+        const int coarseningFactor(std::max(1, coarseningFactors[std::min(layer, coarseningFactors.size() - 1)]));
+        const pandora::CartesianVector positionVector((inputEnergy > std::numeric_limits<float>::epsilon()) ? weightedPosition * (1.f / inputEnergy) :
+            meanPosition * (1.f / static_cast<float>(memberIndices.size())));
+
+        PandoraApi::CaloHit::Parameters superCellParameters(caloHitParametersVector[representativeIndex]);
+        superCellParameters.m_positionVector = positionVector;
+        superCellParameters.m_expectedDirection = positionVector.GetUnitVector();
+        superCellParameters.m_cellSize0 = coarseningFactor * superCellParameters.m_cellSize0.Get();
+        superCellParameters.m_cellSize1 = coarseningFactor * superCellParameters.m_cellSize1.Get();
+        superCellParameters.m_inputEnergy = inputEnergy;
+        superCellParameters.m_mipEquivalentEnergy = mipEquivalentEnergy;
+        superCellParameters.m_electromagneticEnergy = electromagneticEnergy;
+        superCellParameters.m_hadronicEnergy = hadronicEnergy;
+        superCellParameters.m_time = time;
+
+        EVENT::CalorimeterHit *const pRepresentativeHit(calorimeterHitVector[representativeIndex]);
+        m_caloHitParametersVector.push_back(superCellParameters);
+        m_calorimeterHitVector.push_back(pRepresentativeHit);
+        (void) m_superCellMemberMap.insert(SuperCellMemberMap::value_type(pRepresentativeHit, memberHits));
+    }
+
+    streamlog_out(DEBUG) << "CaloHitCreator - Coarsened " << caloHitParametersVector.size() << " forward cells into " << superCellList.size()
+                         << " super-cells" << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void CaloHitCreator::SortCaloHits()
+{
+    typedef std::vector<std::pair<unsigned long long, unsigned int> > SortKeyVector;
+    const float cellSize(std::max(std::numeric_limits<float>::epsilon(), m_settings.m_spatialSortCellSize));
+
+    // ATTN The original position breaks ties, so the ordering is reproducible
+    SortKeyVector sortKeyVector;
+    sortKeyVector.reserve(m_caloHitParametersVector.size());
+
+    for (unsigned int iHit = 0, nHits = m_caloHitParametersVector.size(); iHit < nHits; ++iHit)
+        sortKeyVector.push_back(SortKeyVector::value_type(CaloHitCreator::GetSortKey(m_caloHitParametersVector[iHit], cellSize), iHit));
+
+    std::sort(sortKeyVector.begin(), sortKeyVector.end());
+
+    CaloHitParametersVector caloHitParametersVector;
+    CalorimeterHitVector calorimeterHitVector;
+    caloHitParametersVector.reserve(sortKeyVector.size());
+    calorimeterHitVector.reserve(sortKeyVector.size());
+
+    for (SortKeyVector::const_iterator iter = sortKeyVector.begin(), iterEnd = sortKeyVector.end(); iter != iterEnd; ++iter)
+    {
+        caloHitParametersVector.push_back(m_caloHitParametersVector[iter->second]);
+        calorimeterHitVector.push_back(m_calorimeterHitVector[iter->second]);
+    }
+
+    m_caloHitParametersVector.swap(caloHitParametersVector);
+    m_calorimeterHitVector.swap(calorimeterHitVector);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned long long CaloHitCreator::GetSortKey(const PandoraApi::CaloHit::Parameters &caloHitParameters, const float cellSize)
+{
+    const pandora::CartesianVector &positionVector(caloHitParameters.m_positionVector.Get());
+    const float coordinates[3] = {positionVector.GetX(), positionVector.GetY(), positionVector.GetZ()};
+    unsigned long long mortonCode(0);
+
+    for (unsigned int iCoordinate = 0; iCoordinate < 3; ++iCoordinate)
+    {
+        // Quantise, offset to be non-negative and clamp to 17 bits, then spread the bits to every third position
+        const long long quantised(static_cast<long long>(std::floor(coordinates[iCoordinate] / cellSize)) + (1LL << 16));
+        unsigned long long bits(static_cast<unsigned long long>(std::max(0LL, std::min(quantised, (1LL << 17) - 1))));
+
+        bits = (bits | (bits << 32)) & 0x1F00000000FFFFULL;
+        bits = (bits | (bits << 16)) & 0x1F0000FF0000FFULL;
+        bits = (bits | (bits << 8)) & 0x100F00F00F00F00FULL;
+        bits = (bits | (bits << 4)) & 0x10C30C30C30C30C3ULL;
+        bits = (bits | (bits << 2)) & 0x1249249249249249ULL;
+
+        mortonCode |= (bits << iCoordinate);
+    }
+
+    const unsigned long long hitType(std::min(static_cast<unsigned int>(caloHitParameters.m_hitType.Get()), 0xFU));
+    const unsigned long long layer(std::min(caloHitParameters.m_layer.Get(), 0x1FFU));
+
+    return ((hitType << 60) | (layer << 51) | (mortonCode & 0x7FFFFFFFFFFFFULL));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool CaloHitCreator::IsInTimingWindow(const EVENT::CalorimeterHit *const pCaloHit, const float timeWindowMin, const float timeWindowMax) const
+{
+    if (!m_settings.m_applyTimingWindows)
+        return true;
+
+    // Correct for the straight line time of flight from the interaction point, speed of light in mm/ns
+    static const float speedOfLight(299.792458f);
+    const float *pCaloHitPosition(pCaloHit->getPosition());
+    const float distance(std::sqrt(pCaloHitPosition[0] * pCaloHitPosition[0] + pCaloHitPosition[1] * pCaloHitPosition[1] +
+        pCaloHitPosition[2] * pCaloHitPosition[2]));
+    const float correctedTime(pCaloHit->getTime() - distance / speedOfLight);
+
+    return ((correctedTime >= timeWindowMin) && (correctedTime <= timeWindowMax));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void CaloHitCreator::GetCommonCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, PandoraApi::CaloHit::Parameters &caloHitParameters) const
 {
     const float *pCaloHitPosition(pCaloHit->getPosition());
@@ -545,22 +808,26 @@ void CaloHitCreator::GetCommonCaloHitProperties(const EVENT::CalorimeterHit *con
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void CaloHitCreator::GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const gear::LayerLayout &layerLayout,
+void CaloHitCreator::GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const CalorimeterLayerLayout &layerLayout,
     PandoraApi::CaloHit::Parameters &caloHitParameters, float &absorberCorrection) const
 {
     caloHitParameters.m_hitRegion = pandora::ENDCAP;
 
-    const int physicalLayer(std::min(static_cast<int>(caloHitParameters.m_layer.Get()), layerLayout.getNLayers() - 1));
-    caloHitParameters.m_cellSize0 = layerLayout.getCellSize0(physicalLayer);
-    caloHitParameters.m_cellSize1 = layerLayout.getCellSize1(physicalLayer);
-    caloHitParameters.m_cellThickness = layerLayout.getThickness(physicalLayer);
+    // ATTN The layer layout is empty for optional regions absent from the detector
+    if (0 == layerLayout.GetNLayers())
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_INITIALIZED);
+
+    const unsigned int physicalLayer(std::min(caloHitParameters.m_layer.Get(), layerLayout.GetNLayers() - 1));
+    caloHitParameters.m_cellSize0 = layerLayout.GetCellSize0(physicalLayer);
+    caloHitParameters.m_cellSize1 = layerLayout.GetCellSize1(physicalLayer);
+    caloHitParameters.m_cellThickness = layerLayout.GetThickness(physicalLayer);
 
     const float radiationLength((pandora::ECAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberRadLengthECal :
         (pandora::HCAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberRadLengthHCal : m_settings.m_absorberRadLengthOther);
     const float interactionLength((pandora::ECAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberIntLengthECal :
         (pandora::HCAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberIntLengthHCal : m_settings.m_absorberIntLengthOther);
 
-    const float layerAbsorberThickness(layerLayout.getAbsorberThickness(physicalLayer));
+    const float layerAbsorberThickness(layerLayout.GetAbsorberThickness(physicalLayer));
     caloHitParameters.m_nCellRadiationLengths = radiationLength * layerAbsorberThickness;
     caloHitParameters.m_nCellInteractionLengths = interactionLength * layerAbsorberThickness;
 
@@ -571,19 +838,9 @@ void CaloHitCreator::GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *con
         throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
     }
 
-    absorberCorrection = 1.;
-    for (unsigned int i = 0, iMax = layerLayout.getNLayers(); i < iMax; ++i)
-    {
-        const float absorberThickness(layerLayout.getAbsorberThickness(i));
-
-        if (absorberThickness < std::numeric_limits<float>::epsilon())
-            continue;
-
-        if (layerAbsorberThickness > std::numeric_limits<float>::epsilon())
-            absorberCorrection = absorberThickness / layerAbsorberThickness;
-
-        break;
-    }
+    const float firstAbsorberThickness(layerLayout.GetFirstAbsorberThickness());
+    absorberCorrection = ((firstAbsorberThickness >= std::numeric_limits<float>::epsilon()) &&
+        (layerAbsorberThickness > std::numeric_limits<float>::epsilon())) ? firstAbsorberThickness / layerAbsorberThickness : 1.f;
 
     caloHitParameters.m_cellNormalVector = (pCaloHit->getPosition()[2] > 0) ? pandora::CartesianVector(0, 0, 1) :
         pandora::CartesianVector(0, 0, -1);
@@ -591,23 +848,27 @@ void CaloHitCreator::GetEndCapCaloHitProperties(const EVENT::CalorimeterHit *con
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void CaloHitCreator::GetBarrelCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const gear::LayerLayout &layerLayout,
+void CaloHitCreator::GetBarrelCaloHitProperties(const EVENT::CalorimeterHit *const pCaloHit, const CalorimeterLayerLayout &layerLayout,
     unsigned int barrelSymmetryOrder, float barrelPhi0, unsigned int staveNumber, PandoraApi::CaloHit::Parameters &caloHitParameters,
     float &absorberCorrection) const
 {
     caloHitParameters.m_hitRegion = pandora::BARREL;
 
-    const int physicalLayer(std::min(static_cast<int>(caloHitParameters.m_layer.Get()), layerLayout.getNLayers() - 1));
-    caloHitParameters.m_cellSize0 = layerLayout.getCellSize0(physicalLayer);
-    caloHitParameters.m_cellSize1 = layerLayout.getCellSize1(physicalLayer);
-    caloHitParameters.m_cellThickness = layerLayout.getThickness(physicalLayer);
+    // ATTN The layer layout is empty for optional regions absent from the detector
+    if (0 == layerLayout.GetNLayers())
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_INITIALIZED);
+
+    const unsigned int physicalLayer(std::min(caloHitParameters.m_layer.Get(), layerLayout.GetNLayers() - 1));
+    caloHitParameters.m_cellSize0 = layerLayout.GetCellSize0(physicalLayer);
+    caloHitParameters.m_cellSize1 = layerLayout.GetCellSize1(physicalLayer);
+    caloHitParameters.m_cellThickness = layerLayout.GetThickness(physicalLayer);
 
     const float radiationLength((pandora::ECAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberRadLengthECal :
         (pandora::HCAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberRadLengthHCal : m_settings.m_absorberRadLengthOther);
     const float interactionLength((pandora::ECAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberIntLengthECal :
         (pandora::HCAL == caloHitParameters.m_hitType.Get()) ? m_settings.m_absorberIntLengthHCal : m_settings.m_absorberIntLengthOther);
 
-    const float layerAbsorberThickness(layerLayout.getAbsorberThickness(physicalLayer));
+    const float layerAbsorberThickness(layerLayout.GetAbsorberThickness(physicalLayer));
     caloHitParameters.m_nCellRadiationLengths = radiationLength * layerAbsorberThickness;
     caloHitParameters.m_nCellInteractionLengths = interactionLength * layerAbsorberThickness;
 
@@ -618,19 +879,9 @@ void CaloHitCreator::GetBarrelCaloHitProperties(const EVENT::CalorimeterHit *con
         throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
     }
 
-    absorberCorrection = 1.;
-    for (unsigned int i = 0, iMax = layerLayout.getNLayers(); i < iMax; ++i)
-    {
-        const float absorberThickness(layerLayout.getAbsorberThickness(i));
-
-        if (absorberThickness < std::numeric_limits<float>::epsilon())
-            continue;
-
-        if (layerAbsorberThickness > std::numeric_limits<float>::epsilon())
-            absorberCorrection = absorberThickness / layerAbsorberThickness;
-
-        break;
-    }
+    const float firstAbsorberThickness(layerLayout.GetFirstAbsorberThickness());
+    absorberCorrection = ((firstAbsorberThickness >= std::numeric_limits<float>::epsilon()) &&
+        (layerAbsorberThickness > std::numeric_limits<float>::epsilon())) ? firstAbsorberThickness / layerAbsorberThickness : 1.f;
 
     if (barrelSymmetryOrder > 2)
     {
@@ -749,6 +1000,16 @@ std::string CaloHitCreator::GetStaveCoding(const std::string &encodingString) co
     return std::string("unknown_stave_encoding") ;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+CalorimeterLayerLayout CaloHitCreator::GetOptionalLayerLayout(const GeometryProvider &geometryProvider, const GeometryProvider::CalorimeterRegion region)
+{
+    if (!geometryProvider.HasLayerLayout(region))
+        return CalorimeterLayerLayout();
+
+    return geometryProvider.GetLayerLayout(region);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -788,6 +1049,20 @@ CaloHitCreator::Settings::Settings() :
     m_eCalSiToHadGeVBarrel(1.f),
     m_eCalScToHadGeVBarrel(1.f),
     m_eCalSiToHadGeVEndCap(1.f),
-    m_eCalScToHadGeVEndCap(1.f)
+    m_eCalScToHadGeVEndCap(1.f),
+    m_applyTimingWindows(0),
+    m_eCalTimeWindowMin(-10.f),
+    m_eCalTimeWindowMax(100.f),
+    m_hCalTimeWindowMin(-10.f),
+    m_hCalTimeWindowMax(100.f),
+    m_muonTimeWindowMin(-10.f),
+    m_muonTimeWindowMax(100.f),
+    m_forwardTimeWindowMin(-10.f),
+    m_forwardTimeWindowMax(100.f),
+    m_coarsenForwardHits(0),
+    m_lCalCoarseningFactors(1, 2),
+    m_lHCalCoarseningFactors(1, 2),
+    m_sortCaloHitsSpatially(0),
+    m_spatialSortCellSize(10.f)
 {
 }
@@ -15,11 +15,32 @@
 
 #include "Pandora/AlgorithmHeaders.h"
 
+#include <mutex>
+
 using namespace pandora;
 
-ExternalClusteringAlgorithm::ExternalClusteringAlgorithm() :
-    m_flagClustersAsPhotons(true)
+ExternalClusteringAlgorithm::CaloHitIndexMap ExternalClusteringAlgorithm::m_caloHitIndexMap;
+
+static std::mutex caloHitIndexMapMutex;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ExternalClusteringAlgorithm::ExternalClusteringAlgorithm()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ExternalClusteringAlgorithm::ResetCaloHitIndex(const Pandora &pandora)
 {
+    std::lock_guard<std::mutex> lock(caloHitIndexMapMutex);
+    CaloHitIndexMap::iterator iter = m_caloHitIndexMap.find(&pandora);
+
+    if (m_caloHitIndexMap.end() == iter)
+        return;
+
+    delete iter->second;
+    m_caloHitIndexMap.erase(iter);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -34,64 +55,34 @@ StatusCode ExternalClusteringAlgorithm::Run()
         if (pCaloHitList->empty())
             return STATUS_CODE_SUCCESS;
 
-        // Get external photon cluster collection
-        const EVENT::LCEvent *const pLCEvent(PandoraPFANewProcessor::GetCurrentEvent(&(this->GetPandora())));
-        const EVENT::LCCollection *const pExternalClusterCollection = pLCEvent->getCollection(m_externalClusterCollectionName);
-        const unsigned int nExternalClusters(pExternalClusterCollection->getNumberOfElements());
-
-        if (0 == nExternalClusters)
-            return STATUS_CODE_SUCCESS;
+        // Look up pandora calo hits via the calorimeter hit index, built once per event by the calo hit creator
+        std::string caloHitListName;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentListName<pandora::CaloHit>(*this, caloHitListName));
 
-        // Populate pandora parent address to calo hit map
-        ParentAddressToCaloHitMap parentAddressToCaloHitMap;
+        const CaloHitCreator::CalorimeterHitIndexMap &calorimeterHitIndexMap(PandoraPFANewProcessor::GetCalorimeterHitIndexMap(&(this->GetPandora())));
+        const CaloHitVector &caloHitVector(this->GetCaloHitIndex(caloHitListName, *pCaloHitList, calorimeterHitIndexMap));
 
-        for (CaloHitList::const_iterator hitIter = pCaloHitList->begin(), hitIterEnd = pCaloHitList->end(); hitIter != hitIterEnd; ++hitIter)
-        {
-            const pandora::CaloHit *const pCaloHit = *hitIter;
-            parentAddressToCaloHitMap.insert(ParentAddressToCaloHitMap::value_type(pCaloHit->GetParentAddress(), pCaloHit));
-        }
+        // Recreate external clusters within the pandora framework, with collections in priority order claiming the calo hits
+        const EVENT::LCEvent *const pLCEvent(PandoraPFANewProcessor::GetCurrentEvent(&(this->GetPandora())));
+        ClaimedHitVector claimedHitVector(caloHitVector.size(), false);
 
-        // Recreate external clusters within the pandora framework
-        for (unsigned int iCluster = 0; iCluster < nExternalClusters; ++iCluster)
+        for (unsigned int iCollection = 0, nCollections = m_externalClusterCollectionNames.size(); iCollection < nCollections; ++iCollection)
         {
-            const EVENT::Cluster *const pExternalCluster = dynamic_cast<const EVENT::Cluster*>(pExternalClusterCollection->getElementAt(iCluster));
+            const EVENT::LCCollection *pExternalClusterCollection = NULL;
 
-            if (NULL == pExternalCluster)
-                throw EVENT::Exception("Collection type mismatch");
-
-            const CalorimeterHitVec &calorimeterHitVec(pExternalCluster->getCalorimeterHits());
-
-            const pandora::Cluster *pPandoraCluster = NULL;
-
-            for (CalorimeterHitVec::const_iterator iter = calorimeterHitVec.begin(), iterEnd = calorimeterHitVec.end(); iter != iterEnd; ++iter)
+            try
+            {
+                pExternalClusterCollection = pLCEvent->getCollection(m_externalClusterCollectionNames[iCollection]);
+            }
+            catch (EVENT::DataNotAvailableException &exception)
             {
-                ParentAddressToCaloHitMap::const_iterator pandoraCaloHitIter = parentAddressToCaloHitMap.find(*iter);
-
-                if (parentAddressToCaloHitMap.end() == pandoraCaloHitIter)
-                {
-                    continue;
-                }
-
-                const pandora::CaloHit *const pPandoraCaloHit = pandoraCaloHitIter->second;
-
-                if (NULL == pPandoraCluster)
-                {
-                    PandoraContentApi::Cluster::Parameters parameters;
-                    parameters.m_caloHitList.push_back(pPandoraCaloHit);
-                    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::Create(*this, parameters, pPandoraCluster));
-
-                    if (m_flagClustersAsPhotons)
-                    {
-                        PandoraContentApi::Cluster::Metadata metadata;
-                        metadata.m_particleId = PHOTON;
-                        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::AlterMetadata(*this, pPandoraCluster, metadata));
-                    }
-                }
-                else
-                {
-                    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::AddToCluster(*this, pPandoraCluster, pPandoraCaloHit));
-                }
+                streamlog_out(MESSAGE) << "Failed to extract external cluster collection: " << m_externalClusterCollectionNames[iCollection] << ", "
+                                       << exception.what() << std::endl;
+                continue;
             }
+
+            PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, this->RecreateClusters(pExternalClusterCollection, m_particleIds[iCollection],
+                m_minRetainedHitFractions[iCollection], caloHitVector, calorimeterHitIndexMap, claimedHitVector));
         }
     }
     catch (StatusCodeException &statusCodeException)
@@ -109,13 +100,161 @@ StatusCode ExternalClusteringAlgorithm::Run()
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+StatusCode ExternalClusteringAlgorithm::RecreateClusters(const EVENT::LCCollection *const pExternalClusterCollection, const int particleId,
+    const float minRetainedHitFraction, const CaloHitVector &caloHitVector, const CaloHitCreator::CalorimeterHitIndexMap &calorimeterHitIndexMap,
+    ClaimedHitVector &claimedHitVector) const
+{
+    const unsigned int nExternalClusters(pExternalClusterCollection->getNumberOfElements());
+
+    for (unsigned int iCluster = 0; iCluster < nExternalClusters; ++iCluster)
+    {
+        const EVENT::Cluster *const pExternalCluster = dynamic_cast<const EVENT::Cluster*>(pExternalClusterCollection->getElementAt(iCluster));
+
+        if (NULL == pExternalCluster)
+            throw EVENT::Exception("Collection type mismatch");
+
+        const CalorimeterHitVec &calorimeterHitVec(pExternalCluster->getCalorimeterHits());
+
+        // Hits already claimed by a higher priority collection, or an earlier cluster, are left with their first owner
+        IndexVector unclaimedIndices;
+        unsigned int nAvailableHits(0);
+
+        for (CalorimeterHitVec::const_iterator iter = calorimeterHitVec.begin(), iterEnd = calorimeterHitVec.end(); iter != iterEnd; ++iter)
+        {
+            CaloHitCreator::CalorimeterHitIndexMap::const_iterator indexIter = calorimeterHitIndexMap.find(*iter);
+
+            if ((calorimeterHitIndexMap.end() == indexIter) || (indexIter->second >= caloHitVector.size()) || (NULL == caloHitVector[indexIter->second]))
+                continue;
+
+            ++nAvailableHits;
+
+            if (!claimedHitVector[indexIter->second])
+                unclaimedIndices.push_back(indexIter->second);
+        }
+
+        if (unclaimedIndices.empty() || (unclaimedIndices.size() < minRetainedHitFraction * static_cast<float>(nAvailableHits)))
+            continue;
+
+        PandoraContentApi::Cluster::Parameters parameters;
+
+        for (IndexVector::const_iterator iter = unclaimedIndices.begin(), iterEnd = unclaimedIndices.end(); iter != iterEnd; ++iter)
+        {
+            // ATTN The same calorimeter hit may appear twice in one external cluster
+            if (claimedHitVector[*iter])
+                continue;
+
+            claimedHitVector[*iter] = true;
+            parameters.m_caloHitList.push_back(caloHitVector[*iter]);
+        }
+
+        const pandora::Cluster *pPandoraCluster = NULL;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::Create(*this, parameters, pPandoraCluster));
+
+        if (0 != particleId)
+        {
+            PandoraContentApi::Cluster::Metadata metadata;
+            metadata.m_particleId = particleId;
+            PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::AlterMetadata(*this, pPandoraCluster, metadata));
+        }
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 StatusCode ExternalClusteringAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
 {
-    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, XmlHelper::ReadValue(xmlHandle,
-        "ExternalClusterCollectionName", m_externalClusterCollectionName));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadVectorOfValues(xmlHandle,
+        "ExternalClusterCollectionNames", m_externalClusterCollectionNames));
 
+    // ATTN The single collection name is retained for existing settings files, and takes the highest priority
+    std::string externalClusterCollectionName;
     PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
-        "FlagClustersAsPhotons", m_flagClustersAsPhotons));
+        "ExternalClusterCollectionName", externalClusterCollectionName));
+
+    if (!externalClusterCollectionName.empty())
+        m_externalClusterCollectionNames.insert(m_externalClusterCollectionNames.begin(), externalClusterCollectionName);
+
+    if (m_externalClusterCollectionNames.empty())
+    {
+        std::cout << "ExternalClusteringAlgorithm: no external cluster collections specified" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    bool flagClustersAsPhotons(true);
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "FlagClustersAsPhotons", flagClustersAsPhotons));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadVectorOfValues(xmlHandle,
+        "ParticleIds", m_particleIds));
+
+    if (m_particleIds.empty())
+        m_particleIds.assign(m_externalClusterCollectionNames.size(), flagClustersAsPhotons ? static_cast<int>(PHOTON) : 0);
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadVectorOfValues(xmlHandle,
+        "MinRetainedHitFractions", m_minRetainedHitFractions));
+
+    if (m_minRetainedHitFractions.empty())
+        m_minRetainedHitFractions.assign(m_externalClusterCollectionNames.size(), 0.f);
+
+    if ((m_particleIds.size() != m_externalClusterCollectionNames.size()) ||
+        (m_minRetainedHitFractions.size() != m_externalClusterCollectionNames.size()))
+    {
+        std::cout << "ExternalClusteringAlgorithm: ParticleIds and MinRetainedHitFractions require one entry per collection" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
 
     return STATUS_CODE_SUCCESS;
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const ExternalClusteringAlgorithm::CaloHitVector &ExternalClusteringAlgorithm::GetCaloHitIndex(const std::string &caloHitListName,
+    const CaloHitList &caloHitList, const CaloHitCreator::CalorimeterHitIndexMap &calorimeterHitIndexMap) const
+{
+    CaloHitIndex *pCaloHitIndex = NULL;
+
+    {
+        std::lock_guard<std::mutex> lock(caloHitIndexMapMutex);
+        CaloHitIndexMap::iterator iter = m_caloHitIndexMap.find(&(this->GetPandora()));
+
+        if (m_caloHitIndexMap.end() == iter)
+            iter = m_caloHitIndexMap.insert(CaloHitIndexMap::value_type(&(this->GetPandora()), new CaloHitIndex)).first;
+
+        pCaloHitIndex = iter->second;
+    }
+
+    // ATTN Each pandora instance is processed by a single thread, so its entry may be modified without holding the lock. A list of the same
+    // name may be replaced, or its contents changed, between algorithms, so the list address and size must also match.
+    if ((caloHitListName == pCaloHitIndex->m_caloHitListName) && (&caloHitList == pCaloHitIndex->m_pCaloHitList) &&
+        (caloHitList.size() == pCaloHitIndex->m_nCaloHits) && !pCaloHitIndex->m_caloHitVector.empty())
+    {
+        return pCaloHitIndex->m_caloHitVector;
+    }
+
+    pCaloHitIndex->m_caloHitListName = caloHitListName;
+    pCaloHitIndex->m_pCaloHitList = &caloHitList;
+    pCaloHitIndex->m_nCaloHits = caloHitList.size();
+    pCaloHitIndex->m_caloHitVector.assign(calorimeterHitIndexMap.size(), NULL);
+
+    for (CaloHitList::const_iterator hitIter = caloHitList.begin(), hitIterEnd = caloHitList.end(); hitIter != hitIterEnd; ++hitIter)
+    {
+        const pandora::CaloHit *const pCaloHit = *hitIter;
+        CaloHitCreator::CalorimeterHitIndexMap::const_iterator indexIter = calorimeterHitIndexMap.find(pCaloHit->GetParentAddress());
+
+        if ((calorimeterHitIndexMap.end() != indexIter) && (indexIter->second < pCaloHitIndex->m_caloHitVector.size()))
+            pCaloHitIndex->m_caloHitVector[indexIter->second] = pCaloHit;
+    }
+
+    return pCaloHitIndex->m_caloHitVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ExternalClusteringAlgorithm::CaloHitIndex::CaloHitIndex() :
+    m_pCaloHitList(NULL),
+    m_nCaloHits(0)
+{
+}
@@ -0,0 +1,214 @@
+/**
+ *  @file   MarlinPandora/src/ExternalTrackClusterAssociationAlgorithm.cc
+ * 
+ *  @brief  Implementation of the external track-cluster association algorithm class.
+ * 
+ *  $Log: $
+ */
+
+#include "EVENT/Cluster.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCRelation.h"
+#include "EVENT/Track.h"
+
+#include "ExternalTrackClusterAssociationAlgorithm.h"
+#include "PandoraPFANewProcessor.h"
+
+#include "Pandora/AlgorithmHeaders.h"
+
+using namespace pandora;
+
+ExternalTrackClusterAssociationAlgorithm::ExternalTrackClusterAssociationAlgorithm() :
+    m_minRelationWeight(0.f),
+    m_minSharedHitFraction(0.5f),
+    m_shouldReplaceAssociations(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ExternalTrackClusterAssociationAlgorithm::Run()
+{
+    try
+    {
+        const pandora::TrackList *pTrackList = NULL;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentList(*this, pTrackList));
+
+        const ClusterList *pClusterList = NULL;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentList(*this, pClusterList));
+
+        if (pTrackList->empty() || pClusterList->empty())
+            return STATUS_CODE_SUCCESS;
+
+        const EVENT::LCEvent *const pLCEvent(PandoraPFANewProcessor::GetCurrentEvent(&(this->GetPandora())));
+        const EVENT::LCCollection *pRelationCollection = NULL;
+
+        try
+        {
+            pRelationCollection = pLCEvent->getCollection(m_trackClusterRelationCollectionName);
+        }
+        catch (EVENT::DataNotAvailableException &exception)
+        {
+            streamlog_out(MESSAGE) << "Failed to extract track-cluster relation collection: " << m_trackClusterRelationCollectionName << ", "
+                                   << exception.what() << std::endl;
+            return STATUS_CODE_SUCCESS;
+        }
+
+        const unsigned int nRelations(pRelationCollection->getNumberOfElements());
+
+        if (0 == nRelations)
+            return STATUS_CODE_SUCCESS;
+
+        // Index the pandora tracks, and the clusters holding each calo hit, by the addresses of the lcio objects
+        ParentAddressToTrackMap parentAddressToTrackMap;
+
+        for (pandora::TrackList::const_iterator iter = pTrackList->begin(), iterEnd = pTrackList->end(); iter != iterEnd; ++iter)
+            (void) parentAddressToTrackMap.insert(ParentAddressToTrackMap::value_type((*iter)->GetParentAddress(), *iter));
+
+        ParentAddressToClusterMap parentAddressToClusterMap;
+
+        for (ClusterList::const_iterator iter = pClusterList->begin(), iterEnd = pClusterList->end(); iter != iterEnd; ++iter)
+        {
+            const pandora::Cluster *const pCluster = *iter;
+
+            CaloHitList caloHitList;
+            pCluster->GetOrderedCaloHitList().FillCaloHitList(caloHitList);
+            caloHitList.insert(caloHitList.end(), pCluster->GetIsolatedCaloHitList().begin(), pCluster->GetIsolatedCaloHitList().end());
+
+            for (CaloHitList::const_iterator hitIter = caloHitList.begin(), hitIterEnd = caloHitList.end(); hitIter != hitIterEnd; ++hitIter)
+                (void) parentAddressToClusterMap.insert(ParentAddressToClusterMap::value_type((*hitIter)->GetParentAddress(), pCluster));
+        }
+
+        // Choose the highest weight relation for each track, accepting relations in either direction
+        TrackToClusterMap trackToClusterMap;
+
+        for (unsigned int iRelation = 0; iRelation < nRelations; ++iRelation)
+        {
+            const EVENT::LCRelation *const pRelation = dynamic_cast<const EVENT::LCRelation*>(pRelationCollection->getElementAt(iRelation));
+
+            if (NULL == pRelation)
+                throw EVENT::Exception("Collection type mismatch");
+
+            if (pRelation->getWeight() < m_minRelationWeight)
+                continue;
+
+            const EVENT::Track *pExternalTrack = dynamic_cast<const EVENT::Track*>(pRelation->getFrom());
+            const EVENT::Cluster *pExternalCluster = dynamic_cast<const EVENT::Cluster*>(pRelation->getTo());
+
+            if ((NULL == pExternalTrack) || (NULL == pExternalCluster))
+            {
+                pExternalTrack = dynamic_cast<const EVENT::Track*>(pRelation->getTo());
+                pExternalCluster = dynamic_cast<const EVENT::Cluster*>(pRelation->getFrom());
+            }
+
+            if ((NULL == pExternalTrack) || (NULL == pExternalCluster))
+                throw EVENT::Exception("Relation is not between a track and a cluster");
+
+            ParentAddressToTrackMap::const_iterator trackIter = parentAddressToTrackMap.find(pExternalTrack);
+
+            if (parentAddressToTrackMap.end() == trackIter)
+                continue;
+
+            const pandora::Cluster *const pCluster(this->GetPandoraCluster(pExternalCluster, parentAddressToClusterMap));
+
+            if (NULL == pCluster)
+                continue;
+
+            TrackToClusterMap::iterator iter = trackToClusterMap.find(trackIter->second);
+
+            if (trackToClusterMap.end() == iter)
+            {
+                (void) trackToClusterMap.insert(TrackToClusterMap::value_type(trackIter->second, ClusterAndWeight(pCluster, pRelation->getWeight())));
+            }
+            else if (pRelation->getWeight() > iter->second.second)
+            {
+                iter->second = ClusterAndWeight(pCluster, pRelation->getWeight());
+            }
+        }
+
+        // Make the associations
+        for (TrackToClusterMap::const_iterator iter = trackToClusterMap.begin(), iterEnd = trackToClusterMap.end(); iter != iterEnd; ++iter)
+        {
+            const pandora::Track *const pTrack = iter->first;
+            const pandora::Cluster *const pCluster = iter->second.first;
+
+            if (pTrack->HasAssociatedCluster())
+            {
+                if (!m_shouldReplaceAssociations || (pCluster == pTrack->GetAssociatedCluster()))
+                    continue;
+
+                PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::RemoveTrackClusterAssociation(*this, pTrack,
+                    pTrack->GetAssociatedCluster()));
+            }
+
+            PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::AddTrackClusterAssociation(*this, pTrack, pCluster));
+        }
+    }
+    catch (StatusCodeException &statusCodeException)
+    {
+        return statusCodeException.GetStatusCode();
+    }
+    catch (EVENT::Exception &exception)
+    {
+        std::cout << "ExternalTrackClusterAssociationAlgorithm failure: " << exception.what() << std::endl;
+        return STATUS_CODE_FAILURE;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const pandora::Cluster *ExternalTrackClusterAssociationAlgorithm::GetPandoraCluster(const EVENT::Cluster *const pExternalCluster,
+    const ParentAddressToClusterMap &parentAddressToClusterMap) const
+{
+    const EVENT::CalorimeterHitVec &calorimeterHitVec(pExternalCluster->getCalorimeterHits());
+
+    if (calorimeterHitVec.empty())
+        return NULL;
+
+    ClusterToHitCountMap clusterToHitCountMap;
+    const pandora::Cluster *pBestCluster = NULL;
+    unsigned int bestHitCount(0);
+
+    for (EVENT::CalorimeterHitVec::const_iterator iter = calorimeterHitVec.begin(), iterEnd = calorimeterHitVec.end(); iter != iterEnd; ++iter)
+    {
+        ParentAddressToClusterMap::const_iterator clusterIter = parentAddressToClusterMap.find(*iter);
+
+        if (parentAddressToClusterMap.end() == clusterIter)
+            continue;
+
+        const unsigned int hitCount(++clusterToHitCountMap[clusterIter->second]);
+
+        if (hitCount > bestHitCount)
+        {
+            pBestCluster = clusterIter->second;
+            bestHitCount = hitCount;
+        }
+    }
+
+    if (bestHitCount < m_minSharedHitFraction * static_cast<float>(calorimeterHitVec.size()))
+        return NULL;
+
+    return pBestCluster;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ExternalTrackClusterAssociationAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, XmlHelper::ReadValue(xmlHandle,
+        "TrackClusterRelationCollectionName", m_trackClusterRelationCollectionName));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinRelationWeight", m_minRelationWeight));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinSharedHitFraction", m_minSharedHitFraction));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "ShouldReplaceAssociations", m_shouldReplaceAssociations));
+
+    return STATUS_CODE_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/**
+ *  @file   MarlinPandora/src/FieldMapBFieldPlugin.cc
+ *
+ *  @brief  Implementation of the field map bfield plugin class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/StatusCodes.h"
+
+#include "FieldMapBFieldPlugin.h"
+
+#include <algorithm>
+#include <cmath>
+
+FieldMapBFieldPlugin::FieldMapBFieldPlugin(const GeometryProvider &geometryProvider) :
+    m_rMax(0.f),
+    m_zMin(0.f),
+    m_zMax(0.f),
+    m_nR(0),
+    m_nZ(0),
+    m_rScale(0.f),
+    m_zScale(0.f)
+{
+    const GeometryProvider::DoubleVector &bFieldMapGrid(geometryProvider.GetConstants("BFieldMapGrid"));
+    const GeometryProvider::DoubleVector &bFieldMapBz(geometryProvider.GetConstants("BFieldMapBz"));
+
+    if (5 != bFieldMapGrid.size())
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    m_rMax = bFieldMapGrid[0];
+    m_zMin = bFieldMapGrid[1];
+    m_zMax = bFieldMapGrid[2];
+    m_nR = static_cast<unsigned int>(bFieldMapGrid[3]);
+    m_nZ = static_cast<unsigned int>(bFieldMapGrid[4]);
+
+    if ((m_nR < 2) || (m_nZ < 2) || (m_rMax <= 0.f) || (m_zMax <= m_zMin) || (bFieldMapBz.size() != m_nR * m_nZ))
+    {
+        streamlog_out(ERROR) << "FieldMapBFieldPlugin - Inconsistent bfield map grid" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    m_rScale = static_cast<float>(m_nR - 1) / m_rMax;
+    m_zScale = static_cast<float>(m_nZ - 1) / (m_zMax - m_zMin);
+    m_bz.assign(bFieldMapBz.begin(), bFieldMapBz.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool FieldMapBFieldPlugin::HasBFieldMap(const GeometryProvider &geometryProvider)
+{
+    return (geometryProvider.HasConstant("BFieldMapGrid") && geometryProvider.HasConstant("BFieldMapBz"));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float FieldMapBFieldPlugin::GetBField(const pandora::CartesianVector &positionVector) const
+{
+    const float r(std::sqrt(positionVector.GetX() * positionVector.GetX() + positionVector.GetY() * positionVector.GetY()));
+    const float rIndex(std::min(r * m_rScale, static_cast<float>(m_nR - 1)));
+    const float zIndex(std::max(0.f, std::min((positionVector.GetZ() - m_zMin) * m_zScale, static_cast<float>(m_nZ - 1))));
+
+    // ATTN The lower grid point is limited so that the upper grid point exists; the fractions then reach one at the far edges
+    const unsigned int iR(std::min(static_cast<unsigned int>(rIndex), m_nR - 2));
+    const unsigned int iZ(std::min(static_cast<unsigned int>(zIndex), m_nZ - 2));
+    const float fR(rIndex - static_cast<float>(iR));
+    const float fZ(zIndex - static_cast<float>(iZ));
+
+    const float *const pLower(&m_bz[iR * m_nZ + iZ]);
+    const float *const pUpper(pLower + m_nZ);
+
+    return ((1.f - fR) * ((1.f - fZ) * pLower[0] + fZ * pLower[1]) + fR * ((1.f - fZ) * pUpper[0] + fZ * pUpper[1]));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode FieldMapBFieldPlugin::Initialize()
+{
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode FieldMapBFieldPlugin::ReadSettings(const pandora::TiXmlHandle /*xmlHandle*/)
+{
+    return pandora::STATUS_CODE_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/**
+ *  @file   MarlinPandora/src/GearGeometryProvider.cc
+ *
+ *  @brief  Implementation of the gear geometry provider class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "gear/BField.h"
+#include "gear/GEAR.h"
+#include "gear/GearParameters.h"
+#include "gear/CalorimeterParameters.h"
+#include "gear/TPCParameters.h"
+#include "gear/PadRowLayout2D.h"
+#include "gear/LayerLayout.h"
+#include "gear/FTDParameters.h"
+#include "gear/FTDLayerLayout.h"
+
+#include "gearimpl/ConstantBField.h"
+
+#include "Pandora/StatusCodes.h"
+
+#include "GearGeometryProvider.h"
+
+#include <algorithm>
+#include <cmath>
+
+GearGeometryProvider::GearGeometryProvider(const gear::GearMgr &gearMgr, const bool shouldSampleBFieldMap)
+{
+    this->ReadConstants(gearMgr);
+    this->ReadLayerLayouts(gearMgr);
+
+    if (shouldSampleBFieldMap)
+        this->ReadBFieldMap(gearMgr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const GeometryProvider::DoubleVector &GearGeometryProvider::GetConstants(const std::string &name) const
+{
+    ConstantMap::const_iterator iter = m_constantMap.find(name);
+
+    if (m_constantMap.end() == iter)
+    {
+        streamlog_out(ERROR) << "Gear geometry constant " << name << " not found" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_FOUND);
+    }
+
+    return iter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const CalorimeterLayerLayout &GearGeometryProvider::GetLayerLayout(const CalorimeterRegion region) const
+{
+    LayerLayoutMap::const_iterator iter = m_layerLayoutMap.find(region);
+
+    if (m_layerLayoutMap.end() == iter)
+    {
+        streamlog_out(ERROR) << "Gear layer layout for calorimeter region " << region << " not found" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_FOUND);
+    }
+
+    return iter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GearGeometryProvider::ReadConstants(const gear::GearMgr &gearMgr)
+{
+    const gear::CalorimeterParameters &eCalBarrelParameters(gearMgr.getEcalBarrelParameters());
+    const gear::CalorimeterParameters &eCalEndCapParameters(gearMgr.getEcalEndcapParameters());
+    const gear::CalorimeterParameters &hCalBarrelParameters(gearMgr.getHcalBarrelParameters());
+    const gear::CalorimeterParameters &hCalEndCapParameters(gearMgr.getHcalEndcapParameters());
+    const gear::CalorimeterParameters &muonBarrelParameters(gearMgr.getYokeBarrelParameters());
+    const gear::TPCParameters &tpcParameters(gearMgr.getTPCParameters());
+
+    m_constantMap["InnerBField"] = DoubleVector(1, gearMgr.getBField().at(gear::Vector3D(0., 0., 0.)).z());
+    m_constantMap["CoilOuterR"] = DoubleVector(1, gearMgr.getGearParameters("CoilParameters").getDoubleVal("Coil_cryostat_outer_radius"));
+
+    m_constantMap["ECalBarrelInnerR"] = DoubleVector(1, eCalBarrelParameters.getExtent()[0]);
+    m_constantMap["ECalBarrelOuterZ"] = DoubleVector(1, eCalBarrelParameters.getExtent()[3]);
+    m_constantMap["ECalBarrelInnerPhi0"] = DoubleVector(1, eCalBarrelParameters.getPhi0());
+    m_constantMap["ECalBarrelInnerSymmetry"] = DoubleVector(1, eCalBarrelParameters.getSymmetryOrder());
+    m_constantMap["ECalEndCapInnerZ"] = DoubleVector(1, eCalEndCapParameters.getExtent()[2]);
+
+    const std::vector<std::string> &hCalBarrelIntKeys(hCalBarrelParameters.getIntKeys());
+    const bool hasOuterPolygonPhi0(hCalBarrelIntKeys.end() != std::find(hCalBarrelIntKeys.begin(), hCalBarrelIntKeys.end(), "Hcal_outer_polygon_phi0"));
+    const bool hasOuterPolygonOrder(hCalBarrelIntKeys.end() != std::find(hCalBarrelIntKeys.begin(), hCalBarrelIntKeys.end(), "Hcal_outer_polygon_order"));
+    const gear::LayerLayout &hCalBarrelLayerLayout(hCalBarrelParameters.getLayerLayout());
+
+    m_constantMap["HCalBarrelOuterR"] = DoubleVector(1, hCalBarrelParameters.getExtent()[1]);
+    m_constantMap["HCalBarrelOuterZ"] = DoubleVector(1, hCalBarrelParameters.getExtent()[3]);
+    m_constantMap["HCalBarrelInnerPhi0"] = DoubleVector(1, hCalBarrelParameters.getPhi0());
+    m_constantMap["HCalBarrelInnerSymmetry"] = DoubleVector(1, hCalBarrelParameters.getSymmetryOrder());
+    m_constantMap["HCalBarrelOuterPhi0"] = DoubleVector(1, hasOuterPolygonPhi0 ? hCalBarrelParameters.getIntVal("Hcal_outer_polygon_phi0") : 0);
+    m_constantMap["HCalBarrelOuterSymmetry"] = DoubleVector(1, hasOuterPolygonOrder ? hCalBarrelParameters.getIntVal("Hcal_outer_polygon_order") : 0);
+    m_constantMap["HCalBarrelLayerThickness"] = DoubleVector(1, hCalBarrelLayerLayout.getThickness(hCalBarrelLayerLayout.getNLayers() - 1));
+
+    const gear::LayerLayout &hCalEndCapLayerLayout(hCalEndCapParameters.getLayerLayout());
+    m_constantMap["HCalEndCapOuterR"] = DoubleVector(1, hCalEndCapParameters.getExtent()[1]);
+    m_constantMap["HCalEndCapOuterZ"] = DoubleVector(1, hCalEndCapParameters.getExtent()[3]);
+    m_constantMap["HCalEndCapLayerThickness"] = DoubleVector(1, hCalEndCapLayerLayout.getThickness(hCalEndCapLayerLayout.getNLayers() - 1));
+
+    m_constantMap["MuonBarrelOuterZ"] = DoubleVector(1, muonBarrelParameters.getExtent()[3]);
+    m_constantMap["MuonBarrelInnerPhi0"] = DoubleVector(1, muonBarrelParameters.getPhi0());
+    m_constantMap["MuonBarrelInnerSymmetry"] = DoubleVector(1, muonBarrelParameters.getSymmetryOrder());
+
+    m_constantMap["TPCInnerR"] = DoubleVector(1, tpcParameters.getPadLayout().getPlaneExtent()[0]);
+    m_constantMap["TPCOuterR"] = DoubleVector(1, tpcParameters.getPadLayout().getPlaneExtent()[1]);
+    m_constantMap["TPCMaxRow"] = DoubleVector(1, tpcParameters.getPadLayout().getNRows());
+    m_constantMap["TPCZMax"] = DoubleVector(1, tpcParameters.getMaxDriftLength());
+
+    // fg: FTD description in GEAR has changed ...
+    try
+    {
+        m_constantMap["FTDInnerRadii"] = gearMgr.getGearParameters("FTD").getDoubleVals("FTDInnerRadius");
+        m_constantMap["FTDOuterRadii"] = gearMgr.getGearParameters("FTD").getDoubleVals("FTDOuterRadius");
+        m_constantMap["FTDZPositions"] = gearMgr.getGearParameters("FTD").getDoubleVals("FTDZCoordinate");
+    }
+    catch (gear::UnknownParameterException &)
+    {
+        const gear::FTDLayerLayout &ftdLayerLayout(gearMgr.getFTDParameters().getFTDLayerLayout());
+        streamlog_out( DEBUG2 ) << " Filling FTD parameters from gear::FTDParameters - n layers: " << ftdLayerLayout.getNLayers() << std::endl;
+
+        DoubleVector ftdInnerRadii, ftdOuterRadii, ftdZPositions;
+
+        for(unsigned int i = 0, N = ftdLayerLayout.getNLayers(); i < N; ++i)
+        {
+            // Create a disk to represent even number petals front side
+            ftdInnerRadii.push_back(ftdLayerLayout.getSensitiveRinner(i));
+            ftdOuterRadii.push_back(ftdLayerLayout.getMaxRadius(i));
+
+            // Take the mean z position of the staggered petals
+            const double zpos(ftdLayerLayout.getZposition(i));
+            ftdZPositions.push_back(zpos);
+            streamlog_out( DEBUG2 ) << "     layer " << i << " - mean z position = " << zpos << std::endl;
+        }
+
+        m_constantMap["FTDInnerRadii"] = ftdInnerRadii;
+        m_constantMap["FTDOuterRadii"] = ftdOuterRadii;
+        m_constantMap["FTDZPositions"] = ftdZPositions;
+    }
+
+    // fg: make SET and ETD optional - as they might not be in the model ...
+    try
+    {
+        m_constantMap["ETDZPositions"] = gearMgr.getGearParameters("ETD").getDoubleVals("ETDLayerZ");
+        m_constantMap["SETInnerRadii"] = gearMgr.getGearParameters("SET").getDoubleVals("SETLayerRadius");
+    }
+    catch (gear::UnknownParameterException &)
+    {
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GearGeometryProvider::ReadLayerLayouts(const gear::GearMgr &gearMgr)
+{
+    this->AddLayerLayout(gearMgr.getEcalBarrelParameters().getLayerLayout(), ECAL_BARREL_REGION);
+    this->AddLayerLayout(gearMgr.getEcalEndcapParameters().getLayerLayout(), ECAL_ENDCAP_REGION);
+    this->AddLayerLayout(gearMgr.getHcalBarrelParameters().getLayerLayout(), HCAL_BARREL_REGION);
+    this->AddLayerLayout(gearMgr.getHcalEndcapParameters().getLayerLayout(), HCAL_ENDCAP_REGION);
+    this->AddLayerLayout(gearMgr.getYokeBarrelParameters().getLayerLayout(), MUON_BARREL_REGION);
+    this->AddLayerLayout(gearMgr.getYokeEndcapParameters().getLayerLayout(), MUON_ENDCAP_REGION);
+
+    // The muon plug and forward calorimeters are not present in every detector model
+    try
+    {
+        this->AddLayerLayout(gearMgr.getYokePlugParameters().getLayerLayout(), MUON_PLUG_REGION);
+    }
+    catch (gear::Exception &)
+    {
+    }
+
+    try
+    {
+        this->AddLayerLayout(gearMgr.getLcalParameters().getLayerLayout(), LCAL_REGION);
+    }
+    catch (gear::Exception &)
+    {
+    }
+
+    try
+    {
+        this->AddLayerLayout(gearMgr.getLHcalParameters().getLayerLayout(), LHCAL_REGION);
+    }
+    catch (gear::Exception &)
+    {
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GearGeometryProvider::ReadBFieldMap(const gear::GearMgr &gearMgr)
+{
+    // The grid pitch, units mm, is a compromise between interpolation accuracy near the coil and the geometry snapshot size
+    static const double gridPitch(50.);
+
+    if (NULL != dynamic_cast<const gear::ConstantBField *>(&gearMgr.getBField()))
+    {
+        streamlog_out(WARNING) << "GearGeometryProvider - Gear describes a constant bfield, so there is no bfield map to sample" << std::endl;
+        return;
+    }
+
+    const gear::CalorimeterParameters &muonBarrelParameters(gearMgr.getYokeBarrelParameters());
+    const gear::CalorimeterParameters &muonEndCapParameters(gearMgr.getYokeEndcapParameters());
+
+    const double rMax(std::max(muonBarrelParameters.getExtent()[1], muonEndCapParameters.getExtent()[1]));
+    const double zMax(std::max(muonBarrelParameters.getExtent()[3], muonEndCapParameters.getExtent()[3]));
+    const unsigned int nR(2 + static_cast<unsigned int>(std::ceil(rMax / gridPitch)));
+    const unsigned int nZ(2 + static_cast<unsigned int>(std::ceil(2. * zMax / gridPitch)));
+    const gear::BField &bField(gearMgr.getBField());
+
+    DoubleVector bFieldMapBz;
+    bFieldMapBz.reserve(nR * nZ);
+
+    for (unsigned int iR = 0; iR < nR; ++iR)
+    {
+        const double r(rMax * static_cast<double>(iR) / static_cast<double>(nR - 1));
+
+        for (unsigned int iZ = 0; iZ < nZ; ++iZ)
+        {
+            const double z(-zMax + 2. * zMax * static_cast<double>(iZ) / static_cast<double>(nZ - 1));
+            bFieldMapBz.push_back(bField.at(gear::Vector3D(r, 0., z)).z());
+        }
+    }
+
+    DoubleVector bFieldMapGrid;
+    bFieldMapGrid.push_back(rMax);
+    bFieldMapGrid.push_back(-zMax);
+    bFieldMapGrid.push_back(zMax);
+    bFieldMapGrid.push_back(nR);
+    bFieldMapGrid.push_back(nZ);
+
+    m_constantMap["BFieldMapGrid"] = bFieldMapGrid;
+    m_constantMap["BFieldMapBz"] = bFieldMapBz;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GearGeometryProvider::AddLayerLayout(const gear::LayerLayout &gearLayerLayout, const CalorimeterRegion region)
+{
+    CalorimeterLayerLayout layerLayout;
+
+    for (int i = 0, iMax = gearLayerLayout.getNLayers(); i < iMax; ++i)
+    {
+        layerLayout.AddLayer(gearLayerLayout.getThickness(i), gearLayerLayout.getAbsorberThickness(i), gearLayerLayout.getCellSize0(i),
+            gearLayerLayout.getCellSize1(i));
+    }
+
+    m_layerLayoutMap[region] = layerLayout;
+}
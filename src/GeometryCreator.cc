@@ -9,7 +9,6 @@
 #include "marlin/Global.h"
 #include "marlin/Processor.h"
 
-#include "gear/BField.h"
 #include "gear/GEAR.h"
 #include "gear/GearParameters.h"
 #include "gear/CalorimeterParameters.h"
@@ -17,12 +16,14 @@
 #include "gear/PadRowLayout2D.h"
 #include "gear/LayerLayout.h"
 
+#include "GearGeometryProvider.h"
 #include "GeometryCreator.h"
 #include "PandoraPFANewProcessor.h"
 
-GeometryCreator::GeometryCreator(const Settings &settings, const pandora::Pandora *const pPandora) :
-    m_settings(settings),
-    m_pPandora(pPandora)
+#include <algorithm>
+
+GeometryCreator::GeometryCreator(const Settings &settings) :
+    m_settings(settings)
 {
 }
 
@@ -34,7 +35,7 @@ GeometryCreator::~GeometryCreator()
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::CreateGeometry() const
+pandora::StatusCode GeometryCreator::CreateGeometry(GeometrySnapshot &geometrySnapshot) const
 {
     try
     {
@@ -45,13 +46,15 @@ pandora::StatusCode GeometryCreator::CreateGeometry() const
         this->SetAdditionalSubDetectorParameters(subDetectorNameMap);
 
         if (std::string::npos != marlin::Global::GEAR->getDetectorName().find("ILD"))
-            this->SetILDSpecificGeometry(subDetectorTypeMap, subDetectorNameMap);
+            this->SetILDSpecificGeometry(subDetectorTypeMap, subDetectorNameMap, geometrySnapshot);
 
         for (SubDetectorTypeMap::const_iterator iter = subDetectorTypeMap.begin(), iterEnd = subDetectorTypeMap.end(); iter != iterEnd; ++iter)
-            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::SubDetector::Create(*m_pPandora, iter->second));
+            geometrySnapshot.AddSubDetector(iter->second);
 
         for (SubDetectorNameMap::const_iterator iter = subDetectorNameMap.begin(), iterEnd = subDetectorNameMap.end(); iter != iterEnd; ++iter)
-            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::SubDetector::Create(*m_pPandora, iter->second));
+            geometrySnapshot.AddSubDetector(iter->second);
+
+        this->SetCreatorConstants(geometrySnapshot);
     }
     catch (gear::Exception &exception)
     {
@@ -167,6 +170,25 @@ void GeometryCreator::SetAdditionalSubDetectorParameters(SubDetectorNameMap &sub
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void GeometryCreator::SetCreatorConstants(GeometrySnapshot &geometrySnapshot) const
+{
+    const GearGeometryProvider gearGeometryProvider(*marlin::Global::GEAR, 0 != m_settings.m_sampleBFieldMap);
+
+    for (GeometryProvider::ConstantMap::const_iterator iter = gearGeometryProvider.GetConstantMap().begin(),
+        iterEnd = gearGeometryProvider.GetConstantMap().end(); iter != iterEnd; ++iter)
+    {
+        geometrySnapshot.SetConstants(iter->first, iter->second);
+    }
+
+    for (GeometryProvider::LayerLayoutMap::const_iterator iter = gearGeometryProvider.GetLayerLayoutMap().begin(),
+        iterEnd = gearGeometryProvider.GetLayerLayoutMap().end(); iter != iterEnd; ++iter)
+    {
+        geometrySnapshot.SetLayerLayout(iter->first, iter->second);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void GeometryCreator::SetDefaultSubDetectorParameters(const gear::CalorimeterParameters &inputParameters, const std::string &subDetectorName,
     const pandora::SubDetectorType subDetectorType, PandoraApi::Geometry::SubDetector::Parameters &parameters) const
 {
@@ -203,7 +225,8 @@ void GeometryCreator::SetDefaultSubDetectorParameters(const gear::CalorimeterPar
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::SetILDSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, SubDetectorNameMap &subDetectorNameMap) const
+pandora::StatusCode GeometryCreator::SetILDSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, SubDetectorNameMap &subDetectorNameMap,
+    GeometrySnapshot &geometrySnapshot) const
 {
     // Set positions of gaps in ILD detector and add information missing from GEAR parameters file
     try
@@ -215,7 +238,7 @@ pandora::StatusCode GeometryCreator::SetILDSpecificGeometry(SubDetectorTypeMap &
     catch (gear::Exception &)
     {
         // aLaVideauGeometry
-        return this->SetILD_SDHCALSpecificGeometry(subDetectorTypeMap);
+        return this->SetILD_SDHCALSpecificGeometry(subDetectorTypeMap, geometrySnapshot);
     }
 
     subDetectorTypeMap[pandora::ECAL_ENDCAP].m_innerSymmetryOrder = m_settings.m_eCalEndCapInnerSymmetryOrder;
@@ -234,16 +257,16 @@ pandora::StatusCode GeometryCreator::SetILDSpecificGeometry(SubDetectorTypeMap &
     subDetectorNameMap["HCalRing"].m_outerPhiCoordinate = m_settings.m_hCalRingOuterPhiCoordinate;
 
     // Gaps in detector active material
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalBarrelBoxGaps());
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalEndCapBoxGaps());
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalBarrelConcentricGaps());
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalBarrelBoxGaps(geometrySnapshot));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalEndCapBoxGaps(geometrySnapshot));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalBarrelConcentricGaps(geometrySnapshot));
 
     return pandora::STATUS_CODE_SUCCESS;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::SetILD_SDHCALSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap) const
+pandora::StatusCode GeometryCreator::SetILD_SDHCALSpecificGeometry(SubDetectorTypeMap &subDetectorTypeMap, GeometrySnapshot &geometrySnapshot) const
 {
     // Non-default values (and those missing from GEAR parameters file)...
     // The following 2 parameters have no sense for Videau Geometry, set them to 0
@@ -261,14 +284,87 @@ pandora::StatusCode GeometryCreator::SetILD_SDHCALSpecificGeometry(SubDetectorTy
     subDetectorTypeMap[pandora::HCAL_ENDCAP].m_outerSymmetryOrder = m_settings.m_hCalEndCapOuterSymmetryOrder;
     subDetectorTypeMap[pandora::HCAL_ENDCAP].m_outerPhiCoordinate = m_settings.m_hCalEndCapOuterPhiCoordinate;
 
-    // TODO implement gaps between modules
+    // Gaps in detector active material
+    try
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateHCalEndCapBoxGaps(geometrySnapshot));
+    }
+    catch (gear::Exception &)
+    {
+        streamlog_out(MESSAGE) << "SDHCAL endcap: Hcal_stave_gaps not specified, no endcap gaps created" << std::endl;
+    }
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateSDHCALBarrelGaps(geometrySnapshot));
 
     return pandora::STATUS_CODE_SUCCESS;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::CreateHCalBarrelBoxGaps() const
+pandora::StatusCode GeometryCreator::CreateSDHCALBarrelGaps(GeometrySnapshot &geometrySnapshot) const
+{
+    const gear::CalorimeterParameters &hCalBarrelParameters = marlin::Global::GEAR->getHcalBarrelParameters();
+    const std::vector<std::string> doubleKeys(hCalBarrelParameters.getDoubleKeys());
+    const std::vector<std::string> intKeys(hCalBarrelParameters.getIntKeys());
+
+    const unsigned int symmetryOrder(hCalBarrelParameters.getSymmetryOrder());
+    const float innerRadius(hCalBarrelParameters.getExtent()[0]);
+    const float outerRadius(hCalBarrelParameters.getExtent()[1]);
+    const float outerZ(hCalBarrelParameters.getExtent()[3]);
+    const float phi0(hCalBarrelParameters.getPhi0());
+
+    if (0 == symmetryOrder)
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+
+    // ATTN Videau staves tile the polygon corners, so each stave gap is approximated by a radial slab from the inner polygon corner outwards
+    if (doubleKeys.end() != std::find(doubleKeys.begin(), doubleKeys.end(), "Hcal_stave_gaps"))
+    {
+        const float staveGap(hCalBarrelParameters.getDoubleVal("Hcal_stave_gaps"));
+        const float cornerPhi(M_PI / static_cast<float>(symmetryOrder));
+
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateRegularBoxGaps(symmetryOrder, phi0 + cornerPhi,
+            innerRadius / std::cos(cornerPhi), outerRadius, -outerZ, outerZ, staveGap, geometrySnapshot));
+    }
+    else
+    {
+        streamlog_out(MESSAGE) << "SDHCAL barrel: Hcal_stave_gaps not specified, no stave gaps created" << std::endl;
+    }
+
+    if ((doubleKeys.end() != std::find(doubleKeys.begin(), doubleKeys.end(), "Hcal_modules_gap")) &&
+        (intKeys.end() != std::find(intKeys.begin(), intKeys.end(), "Hcal_barrel_number_modules")))
+    {
+        const float moduleGap(hCalBarrelParameters.getDoubleVal("Hcal_modules_gap"));
+        const int nModules(hCalBarrelParameters.getIntVal("Hcal_barrel_number_modules"));
+        const float moduleLength((nModules > 0) ? 2.f * outerZ / static_cast<float>(nModules) : 0.f);
+
+        for (int iModule = 1; iModule < nModules; ++iModule)
+        {
+            const float boundaryZ(-outerZ + static_cast<float>(iModule) * moduleLength);
+
+            PandoraApi::Geometry::ConcentricGap::Parameters gapParameters;
+            gapParameters.m_minZCoordinate = boundaryZ - 0.5f * moduleGap;
+            gapParameters.m_maxZCoordinate = boundaryZ + 0.5f * moduleGap;
+            gapParameters.m_innerRCoordinate = innerRadius;
+            gapParameters.m_innerPhiCoordinate = phi0;
+            gapParameters.m_innerSymmetryOrder = symmetryOrder;
+            gapParameters.m_outerRCoordinate = outerRadius;
+            gapParameters.m_outerPhiCoordinate = 0.f;
+            gapParameters.m_outerSymmetryOrder = 0;
+
+            geometrySnapshot.AddConcentricGap(gapParameters);
+        }
+    }
+    else
+    {
+        streamlog_out(MESSAGE) << "SDHCAL barrel: Hcal_modules_gap or Hcal_barrel_number_modules not specified, no module gaps created" << std::endl;
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometryCreator::CreateHCalBarrelBoxGaps(GeometrySnapshot &geometrySnapshot) const
 {
     const std::string detectorName(marlin::Global::GEAR->getDetectorName());
 
@@ -289,7 +385,7 @@ pandora::StatusCode GeometryCreator::CreateHCalBarrelBoxGaps() const
 
     const float staveGap(hCalBarrelParameters.getDoubleVal("Hcal_stave_gaps"));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateRegularBoxGaps(innerSymmetryOrder, phi0, innerRadius, outerRadius,
-        -outerZ, outerZ, staveGap));
+        -outerZ, outerZ, staveGap, geometrySnapshot));
 
     const float outerPseudoPhi0(M_PI / static_cast<float>(innerSymmetryOrder));
     const float cosOuterPseudoPhi0(std::cos(outerPseudoPhi0));
@@ -302,14 +398,14 @@ pandora::StatusCode GeometryCreator::CreateHCalBarrelBoxGaps() const
 
     const float middleStaveGap(hCalBarrelParameters.getDoubleVal("Hcal_middle_stave_gaps"));
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateRegularBoxGaps(innerSymmetryOrder, outerPseudoPhi0,
-        innerRadius / cosOuterPseudoPhi0, outerRadius, -outerZ, outerZ, middleStaveGap));
+        innerRadius / cosOuterPseudoPhi0, outerRadius, -outerZ, outerZ, middleStaveGap, geometrySnapshot));
 
     return pandora::STATUS_CODE_SUCCESS;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::CreateHCalEndCapBoxGaps() const
+pandora::StatusCode GeometryCreator::CreateHCalEndCapBoxGaps(GeometrySnapshot &geometrySnapshot) const
 {
     const gear::CalorimeterParameters &hCalEndCapParameters = marlin::Global::GEAR->getHcalEndcapParameters();
 
@@ -320,11 +416,11 @@ pandora::StatusCode GeometryCreator::CreateHCalEndCapBoxGaps() const
     const float outerZ(hCalEndCapParameters.getExtent()[3]);
 
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateRegularBoxGaps(m_settings.m_hCalEndCapInnerSymmetryOrder,
-        m_settings.m_hCalEndCapInnerPhiCoordinate, innerRadius, outerRadius, innerZ, outerZ, staveGap,
+        m_settings.m_hCalEndCapInnerPhiCoordinate, innerRadius, outerRadius, innerZ, outerZ, staveGap, geometrySnapshot,
         pandora::CartesianVector(-innerRadius, 0, 0)));
 
     PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CreateRegularBoxGaps(m_settings.m_hCalEndCapInnerSymmetryOrder,
-        m_settings.m_hCalEndCapInnerPhiCoordinate, innerRadius, outerRadius, -outerZ, -innerZ, staveGap,
+        m_settings.m_hCalEndCapInnerPhiCoordinate, innerRadius, outerRadius, -outerZ, -innerZ, staveGap, geometrySnapshot,
         pandora::CartesianVector(innerRadius, 0, 0)));
 
     return pandora::STATUS_CODE_SUCCESS;
@@ -332,7 +428,7 @@ pandora::StatusCode GeometryCreator::CreateHCalEndCapBoxGaps() const
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode GeometryCreator::CreateHCalBarrelConcentricGaps() const
+pandora::StatusCode GeometryCreator::CreateHCalBarrelConcentricGaps(GeometrySnapshot &geometrySnapshot) const
 {
     const gear::CalorimeterParameters &hCalBarrelParameters = marlin::Global::GEAR->getHcalBarrelParameters();
     const float gapWidth(hCalBarrelParameters.getDoubleVal("Hcal_stave_gaps"));
@@ -348,7 +444,7 @@ pandora::StatusCode GeometryCreator::CreateHCalBarrelConcentricGaps() const
     gapParameters.m_outerPhiCoordinate = hCalBarrelParameters.getIntVal("Hcal_outer_polygon_phi0");
     gapParameters.m_outerSymmetryOrder = hCalBarrelParameters.getIntVal("Hcal_outer_polygon_order");
 
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::ConcentricGap::Create(*m_pPandora, gapParameters));
+    geometrySnapshot.AddConcentricGap(gapParameters);
 
     return pandora::STATUS_CODE_SUCCESS;
 }
@@ -356,31 +452,17 @@ pandora::StatusCode GeometryCreator::CreateHCalBarrelConcentricGaps() const
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 pandora::StatusCode GeometryCreator::CreateRegularBoxGaps(unsigned int symmetryOrder, float phi0, float innerRadius, float outerRadius,
-    float minZ, float maxZ, float gapWidth, pandora::CartesianVector vertexOffset) const
+    float minZ, float maxZ, float gapWidth, GeometrySnapshot &geometrySnapshot, pandora::CartesianVector vertexOffset) const
 {
-    const pandora::CartesianVector basicGapVertex(pandora::CartesianVector(-0.5f * gapWidth, innerRadius, minZ) + vertexOffset);
-    const pandora::CartesianVector basicSide1(gapWidth, 0, 0);
-    const pandora::CartesianVector basicSide2(0, outerRadius - innerRadius, 0);
-    const pandora::CartesianVector basicSide3(0, 0, maxZ - minZ);
-
-    for (unsigned int i = 0; i < symmetryOrder; ++i)
+    try
+    {
+        geometrySnapshot.AddSymmetricSectorGap(SymmetricSectorGap(symmetryOrder, phi0, innerRadius, outerRadius, minZ, maxZ, gapWidth,
+            vertexOffset));
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
     {
-        const float phi = phi0 + (2. * M_PI * static_cast<float>(i) / static_cast<float>(symmetryOrder));
-        const float sinPhi(std::sin(phi));
-        const float cosPhi(std::cos(phi));
-
-        PandoraApi::Geometry::BoxGap::Parameters gapParameters;
-
-        gapParameters.m_vertex = pandora::CartesianVector(cosPhi * basicGapVertex.GetX() + sinPhi * basicGapVertex.GetY(),
-            -sinPhi * basicGapVertex.GetX() + cosPhi * basicGapVertex.GetY(), basicGapVertex.GetZ());
-        gapParameters.m_side1 = pandora::CartesianVector(cosPhi * basicSide1.GetX() + sinPhi * basicSide1.GetY(),
-            -sinPhi * basicSide1.GetX() + cosPhi * basicSide1.GetY(), basicSide1.GetZ());
-        gapParameters.m_side2 = pandora::CartesianVector(cosPhi * basicSide2.GetX() + sinPhi * basicSide2.GetY(),
-            -sinPhi * basicSide2.GetX() + cosPhi * basicSide2.GetY(), basicSide2.GetZ());
-        gapParameters.m_side3 = pandora::CartesianVector(cosPhi * basicSide3.GetX() + sinPhi * basicSide3.GetY(),
-            -sinPhi * basicSide3.GetX() + cosPhi * basicSide3.GetY(), basicSide3.GetZ());
-
-        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::BoxGap::Create(*m_pPandora, gapParameters));
+        streamlog_out(ERROR) << "CreateRegularBoxGaps: invalid gap parameters " << statusCodeException.ToString() << std::endl;
+        return statusCodeException.GetStatusCode();
     }
 
     return pandora::STATUS_CODE_SUCCESS;
@@ -407,6 +489,7 @@ GeometryCreator::Settings::Settings() :
     m_hCalRingInnerSymmetryOrder(8),
     m_hCalRingInnerPhiCoordinate(0.f),
     m_hCalRingOuterSymmetryOrder(16),
-    m_hCalRingOuterPhiCoordinate(0.f)
+    m_hCalRingOuterPhiCoordinate(0.f),
+    m_sampleBFieldMap(0)
 {
 }
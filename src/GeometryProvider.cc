@@ -0,0 +1,57 @@
+/**
+ *  @file   MarlinPandora/src/GeometryProvider.cc
+ *
+ *  @brief  Implementation of the geometry provider interface and the calorimeter layer layout class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/StatusCodes.h"
+
+#include "GeometryProvider.h"
+
+#include <limits>
+
+CalorimeterLayerLayout::CalorimeterLayerLayout() :
+    m_firstAbsorberThickness(0.f)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void CalorimeterLayerLayout::AddLayer(const float thickness, const float absorberThickness, const float cellSize0, const float cellSize1)
+{
+    Layer layer;
+    layer.m_thickness = thickness;
+    layer.m_absorberThickness = absorberThickness;
+    layer.m_cellSize0 = cellSize0;
+    layer.m_cellSize1 = cellSize1;
+    m_layerVector.push_back(layer);
+
+    if ((m_firstAbsorberThickness < std::numeric_limits<float>::epsilon()) && (absorberThickness >= std::numeric_limits<float>::epsilon()))
+        m_firstAbsorberThickness = absorberThickness;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+GeometryProvider::~GeometryProvider()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double GeometryProvider::GetConstant(const std::string &name) const
+{
+    const DoubleVector &values(this->GetConstants(name));
+
+    if (1 != values.size())
+    {
+        streamlog_out(ERROR) << "Geometry constant " << name << " is a list, not a single value" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    return values.front();
+}
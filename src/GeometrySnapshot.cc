@@ -0,0 +1,454 @@
+/**
+ *  @file   MarlinPandora/src/GeometrySnapshot.cc
+ *
+ *  @brief  Implementation of the geometry snapshot class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "BinaryFile.h"
+#include "GeometrySnapshot.h"
+
+// ATTN Increment the version whenever the payload layout changes, so that existing snapshot files are ignored and regenerated
+static const std::string GEOMETRY_SNAPSHOT_FILE_TYPE("MPGEOSNP");
+static const unsigned int GEOMETRY_SNAPSHOT_VERSION = 3;
+
+GeometrySnapshot::GeometrySnapshot(const std::string &geometryKey) :
+    m_geometryKey(geometryKey)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometrySnapshot::Write(const std::string &fileName) const
+{
+    try
+    {
+        BinaryFileOutput fileOutput(GEOMETRY_SNAPSHOT_FILE_TYPE, GEOMETRY_SNAPSHOT_VERSION);
+        fileOutput.WriteString(m_geometryKey);
+
+        fileOutput.Write<unsigned int>(m_subDetectorParametersVector.size());
+
+        for (SubDetectorParametersVector::const_iterator iter = m_subDetectorParametersVector.begin(),
+            iterEnd = m_subDetectorParametersVector.end(); iter != iterEnd; ++iter)
+        {
+            this->WriteSubDetector(*iter, fileOutput);
+        }
+
+        fileOutput.Write<unsigned int>(m_boxGapParametersVector.size());
+
+        for (BoxGapParametersVector::const_iterator iter = m_boxGapParametersVector.begin(), iterEnd = m_boxGapParametersVector.end();
+            iter != iterEnd; ++iter)
+        {
+            this->WriteCartesianVector(iter->m_vertex.Get(), fileOutput);
+            this->WriteCartesianVector(iter->m_side1.Get(), fileOutput);
+            this->WriteCartesianVector(iter->m_side2.Get(), fileOutput);
+            this->WriteCartesianVector(iter->m_side3.Get(), fileOutput);
+        }
+
+        fileOutput.Write<unsigned int>(m_symmetricSectorGapVector.size());
+
+        for (SymmetricSectorGapVector::const_iterator iter = m_symmetricSectorGapVector.begin(), iterEnd = m_symmetricSectorGapVector.end();
+            iter != iterEnd; ++iter)
+        {
+            fileOutput.Write<unsigned int>(iter->GetSymmetryOrder());
+            fileOutput.Write<float>(iter->GetPhi0());
+            fileOutput.Write<float>(iter->GetInnerRadius());
+            fileOutput.Write<float>(iter->GetOuterRadius());
+            fileOutput.Write<float>(iter->GetMinZ());
+            fileOutput.Write<float>(iter->GetMaxZ());
+            fileOutput.Write<float>(iter->GetGapWidth());
+            this->WriteCartesianVector(iter->GetVertexOffset(), fileOutput);
+        }
+
+        fileOutput.Write<unsigned int>(m_concentricGapParametersVector.size());
+
+        for (ConcentricGapParametersVector::const_iterator iter = m_concentricGapParametersVector.begin(),
+            iterEnd = m_concentricGapParametersVector.end(); iter != iterEnd; ++iter)
+        {
+            fileOutput.Write<float>(iter->m_minZCoordinate.Get());
+            fileOutput.Write<float>(iter->m_maxZCoordinate.Get());
+            fileOutput.Write<float>(iter->m_innerRCoordinate.Get());
+            fileOutput.Write<float>(iter->m_innerPhiCoordinate.Get());
+            fileOutput.Write<unsigned int>(iter->m_innerSymmetryOrder.Get());
+            fileOutput.Write<float>(iter->m_outerRCoordinate.Get());
+            fileOutput.Write<float>(iter->m_outerPhiCoordinate.Get());
+            fileOutput.Write<unsigned int>(iter->m_outerSymmetryOrder.Get());
+        }
+
+        fileOutput.Write<unsigned int>(m_constantMap.size());
+
+        for (ConstantMap::const_iterator iter = m_constantMap.begin(), iterEnd = m_constantMap.end(); iter != iterEnd; ++iter)
+        {
+            fileOutput.WriteString(iter->first);
+            fileOutput.Write<unsigned int>(iter->second.size());
+
+            for (DoubleVector::const_iterator vIter = iter->second.begin(), vIterEnd = iter->second.end(); vIter != vIterEnd; ++vIter)
+                fileOutput.Write<double>(*vIter);
+        }
+
+        fileOutput.Write<unsigned int>(m_layerLayoutMap.size());
+
+        for (LayerLayoutMap::const_iterator iter = m_layerLayoutMap.begin(), iterEnd = m_layerLayoutMap.end(); iter != iterEnd; ++iter)
+        {
+            const CalorimeterLayerLayout &layerLayout(iter->second);
+            fileOutput.Write<unsigned int>(iter->first);
+            fileOutput.Write<unsigned int>(layerLayout.GetNLayers());
+
+            for (unsigned int iLayer = 0, nLayers = layerLayout.GetNLayers(); iLayer < nLayers; ++iLayer)
+            {
+                fileOutput.Write<float>(layerLayout.GetThickness(iLayer));
+                fileOutput.Write<float>(layerLayout.GetAbsorberThickness(iLayer));
+                fileOutput.Write<float>(layerLayout.GetCellSize0(iLayer));
+                fileOutput.Write<float>(layerLayout.GetCellSize1(iLayer));
+            }
+        }
+
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileOutput.WriteFile(fileName));
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        streamlog_out(ERROR) << "Failed to write geometry snapshot " << fileName << ": " << statusCodeException.ToString() << std::endl;
+        return statusCodeException.GetStatusCode();
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometrySnapshot::Read(const std::string &fileName)
+{
+    BinaryFileInput fileInput;
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Open(fileName, GEOMETRY_SNAPSHOT_FILE_TYPE, GEOMETRY_SNAPSHOT_VERSION));
+
+    std::string geometryKey;
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.ReadString(geometryKey));
+
+    if (geometryKey != m_geometryKey)
+    {
+        streamlog_out(WARNING) << "Geometry snapshot " << fileName << " was written for a different detector or geometry settings: "
+                               << geometryKey << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    SubDetectorParametersVector subDetectorParametersVector;
+    BoxGapParametersVector boxGapParametersVector;
+    SymmetricSectorGapVector symmetricSectorGapVector;
+    ConcentricGapParametersVector concentricGapParametersVector;
+    ConstantMap constantMap;
+    LayerLayoutMap layerLayoutMap;
+
+    unsigned int nSubDetectors(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nSubDetectors));
+
+    for (unsigned int iSubDetector = 0; iSubDetector < nSubDetectors; ++iSubDetector)
+    {
+        PandoraApi::Geometry::SubDetector::Parameters parameters;
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadSubDetector(fileInput, parameters));
+        subDetectorParametersVector.push_back(parameters);
+    }
+
+    unsigned int nBoxGaps(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nBoxGaps));
+
+    for (unsigned int iBoxGap = 0; iBoxGap < nBoxGaps; ++iBoxGap)
+    {
+        PandoraApi::Geometry::BoxGap::Parameters parameters;
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadCartesianVector(fileInput, parameters.m_vertex));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadCartesianVector(fileInput, parameters.m_side1));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadCartesianVector(fileInput, parameters.m_side2));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadCartesianVector(fileInput, parameters.m_side3));
+        boxGapParametersVector.push_back(parameters);
+    }
+
+    unsigned int nSymmetricSectorGaps(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nSymmetricSectorGaps));
+
+    for (unsigned int iSymmetricSectorGap = 0; iSymmetricSectorGap < nSymmetricSectorGaps; ++iSymmetricSectorGap)
+    {
+        unsigned int symmetryOrder(0);
+        float phi0(0.f), innerRadius(0.f), outerRadius(0.f), minZ(0.f), maxZ(0.f), gapWidth(0.f);
+        pandora::InputCartesianVector vertexOffset;
+
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(symmetryOrder));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(phi0));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerRadius));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerRadius));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(minZ));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(maxZ));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(gapWidth));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadCartesianVector(fileInput, vertexOffset));
+
+        try
+        {
+            symmetricSectorGapVector.push_back(SymmetricSectorGap(symmetryOrder, phi0, innerRadius, outerRadius, minZ, maxZ, gapWidth,
+                vertexOffset.Get()));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            return statusCodeException.GetStatusCode();
+        }
+    }
+
+    unsigned int nConcentricGaps(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nConcentricGaps));
+
+    for (unsigned int iConcentricGap = 0; iConcentricGap < nConcentricGaps; ++iConcentricGap)
+    {
+        float minZCoordinate(0.f), maxZCoordinate(0.f), innerRCoordinate(0.f), innerPhiCoordinate(0.f), outerRCoordinate(0.f), outerPhiCoordinate(0.f);
+        unsigned int innerSymmetryOrder(0), outerSymmetryOrder(0);
+
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(minZCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(maxZCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerRCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerPhiCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerSymmetryOrder));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerRCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerPhiCoordinate));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerSymmetryOrder));
+
+        PandoraApi::Geometry::ConcentricGap::Parameters parameters;
+        parameters.m_minZCoordinate = minZCoordinate;
+        parameters.m_maxZCoordinate = maxZCoordinate;
+        parameters.m_innerRCoordinate = innerRCoordinate;
+        parameters.m_innerPhiCoordinate = innerPhiCoordinate;
+        parameters.m_innerSymmetryOrder = innerSymmetryOrder;
+        parameters.m_outerRCoordinate = outerRCoordinate;
+        parameters.m_outerPhiCoordinate = outerPhiCoordinate;
+        parameters.m_outerSymmetryOrder = outerSymmetryOrder;
+        concentricGapParametersVector.push_back(parameters);
+    }
+
+    unsigned int nConstants(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nConstants));
+
+    for (unsigned int iConstant = 0; iConstant < nConstants; ++iConstant)
+    {
+        std::string name;
+        unsigned int nValues(0);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.ReadString(name));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nValues));
+
+        DoubleVector &values(constantMap[name]);
+
+        for (unsigned int iValue = 0; iValue < nValues; ++iValue)
+        {
+            double value(0.);
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(value));
+            values.push_back(value);
+        }
+    }
+
+    unsigned int nLayerLayouts(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nLayerLayouts));
+
+    for (unsigned int iLayerLayout = 0; iLayerLayout < nLayerLayouts; ++iLayerLayout)
+    {
+        unsigned int region(0), nLayers(0);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(region));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nLayers));
+
+        if (region > LHCAL_REGION)
+            return pandora::STATUS_CODE_FAILURE;
+
+        CalorimeterLayerLayout &layerLayout(layerLayoutMap[static_cast<CalorimeterRegion>(region)]);
+
+        for (unsigned int iLayer = 0; iLayer < nLayers; ++iLayer)
+        {
+            float thickness(0.f), absorberThickness(0.f), cellSize0(0.f), cellSize1(0.f);
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(thickness));
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(absorberThickness));
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(cellSize0));
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(cellSize1));
+            layerLayout.AddLayer(thickness, absorberThickness, cellSize0, cellSize1);
+        }
+    }
+
+    if (!fileInput.IsAtEnd())
+        return pandora::STATUS_CODE_FAILURE;
+
+    m_subDetectorParametersVector.swap(subDetectorParametersVector);
+    m_boxGapParametersVector.swap(boxGapParametersVector);
+    m_symmetricSectorGapVector.swap(symmetricSectorGapVector);
+    m_concentricGapParametersVector.swap(concentricGapParametersVector);
+    m_constantMap.swap(constantMap);
+    m_layerLayoutMap.swap(layerLayoutMap);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometrySnapshot::CreatePandoraGeometry(const pandora::Pandora &pandora) const
+{
+    for (SubDetectorParametersVector::const_iterator iter = m_subDetectorParametersVector.begin(), iterEnd = m_subDetectorParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::SubDetector::Create(pandora, *iter));
+    }
+
+    for (BoxGapParametersVector::const_iterator iter = m_boxGapParametersVector.begin(), iterEnd = m_boxGapParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::BoxGap::Create(pandora, *iter));
+    }
+
+    // ATTN Pandora only understands box and concentric gaps, so each symmetric sector gap is registered as one box per sector
+    for (SymmetricSectorGapVector::const_iterator iter = m_symmetricSectorGapVector.begin(), iterEnd = m_symmetricSectorGapVector.end();
+        iter != iterEnd; ++iter)
+    {
+        BoxGapParametersVector sectorBoxGapParametersVector;
+        iter->GetBoxGapParameters(sectorBoxGapParametersVector);
+
+        for (BoxGapParametersVector::const_iterator bIter = sectorBoxGapParametersVector.begin(), bIterEnd = sectorBoxGapParametersVector.end();
+            bIter != bIterEnd; ++bIter)
+        {
+            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::BoxGap::Create(pandora, *bIter));
+        }
+    }
+
+    for (ConcentricGapParametersVector::const_iterator iter = m_concentricGapParametersVector.begin(),
+        iterEnd = m_concentricGapParametersVector.end(); iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::ConcentricGap::Create(pandora, *iter));
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const GeometrySnapshot::DoubleVector &GeometrySnapshot::GetConstants(const std::string &name) const
+{
+    ConstantMap::const_iterator iter = m_constantMap.find(name);
+
+    if (m_constantMap.end() == iter)
+    {
+        streamlog_out(ERROR) << "Geometry snapshot constant " << name << " not found" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_FOUND);
+    }
+
+    return iter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const CalorimeterLayerLayout &GeometrySnapshot::GetLayerLayout(const CalorimeterRegion region) const
+{
+    LayerLayoutMap::const_iterator iter = m_layerLayoutMap.find(region);
+
+    if (m_layerLayoutMap.end() == iter)
+    {
+        streamlog_out(ERROR) << "Geometry snapshot layer layout for calorimeter region " << region << " not found" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_FOUND);
+    }
+
+    return iter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GeometrySnapshot::WriteSubDetector(const PandoraApi::Geometry::SubDetector::Parameters &parameters, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.WriteString(parameters.m_subDetectorName.Get());
+    fileOutput.Write<int>(parameters.m_subDetectorType.Get());
+    fileOutput.Write<float>(parameters.m_innerRCoordinate.Get());
+    fileOutput.Write<float>(parameters.m_innerZCoordinate.Get());
+    fileOutput.Write<float>(parameters.m_innerPhiCoordinate.Get());
+    fileOutput.Write<unsigned int>(parameters.m_innerSymmetryOrder.Get());
+    fileOutput.Write<float>(parameters.m_outerRCoordinate.Get());
+    fileOutput.Write<float>(parameters.m_outerZCoordinate.Get());
+    fileOutput.Write<float>(parameters.m_outerPhiCoordinate.Get());
+    fileOutput.Write<unsigned int>(parameters.m_outerSymmetryOrder.Get());
+    fileOutput.Write<unsigned char>(parameters.m_isMirroredInZ.Get() ? 1 : 0);
+    fileOutput.Write<unsigned int>(parameters.m_nLayers.Get());
+    fileOutput.Write<unsigned int>(parameters.m_layerParametersVector.size());
+
+    for (std::vector<PandoraApi::Geometry::LayerParameters>::const_iterator iter = parameters.m_layerParametersVector.begin(),
+        iterEnd = parameters.m_layerParametersVector.end(); iter != iterEnd; ++iter)
+    {
+        fileOutput.Write<float>(iter->m_closestDistanceToIp.Get());
+        fileOutput.Write<float>(iter->m_nRadiationLengths.Get());
+        fileOutput.Write<float>(iter->m_nInteractionLengths.Get());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GeometrySnapshot::WriteCartesianVector(const pandora::CartesianVector &cartesianVector, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<float>(cartesianVector.GetX());
+    fileOutput.Write<float>(cartesianVector.GetY());
+    fileOutput.Write<float>(cartesianVector.GetZ());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometrySnapshot::ReadSubDetector(BinaryFileInput &fileInput, PandoraApi::Geometry::SubDetector::Parameters &parameters) const
+{
+    std::string subDetectorName;
+    int subDetectorType(0);
+    float innerRCoordinate(0.f), innerZCoordinate(0.f), innerPhiCoordinate(0.f), outerRCoordinate(0.f), outerZCoordinate(0.f), outerPhiCoordinate(0.f);
+    unsigned int innerSymmetryOrder(0), outerSymmetryOrder(0), nLayers(0), nLayerParameters(0);
+    unsigned char isMirroredInZ(0);
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.ReadString(subDetectorName));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(subDetectorType));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerRCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerZCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerPhiCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(innerSymmetryOrder));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerRCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerZCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerPhiCoordinate));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(outerSymmetryOrder));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(isMirroredInZ));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nLayers));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nLayerParameters));
+
+    parameters.m_subDetectorName = subDetectorName;
+    parameters.m_subDetectorType = static_cast<pandora::SubDetectorType>(subDetectorType);
+    parameters.m_innerRCoordinate = innerRCoordinate;
+    parameters.m_innerZCoordinate = innerZCoordinate;
+    parameters.m_innerPhiCoordinate = innerPhiCoordinate;
+    parameters.m_innerSymmetryOrder = innerSymmetryOrder;
+    parameters.m_outerRCoordinate = outerRCoordinate;
+    parameters.m_outerZCoordinate = outerZCoordinate;
+    parameters.m_outerPhiCoordinate = outerPhiCoordinate;
+    parameters.m_outerSymmetryOrder = outerSymmetryOrder;
+    parameters.m_isMirroredInZ = (0 != isMirroredInZ);
+    parameters.m_nLayers = nLayers;
+
+    for (unsigned int iLayer = 0; iLayer < nLayerParameters; ++iLayer)
+    {
+        float closestDistanceToIp(0.f), nRadiationLengths(0.f), nInteractionLengths(0.f);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(closestDistanceToIp));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nRadiationLengths));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nInteractionLengths));
+
+        PandoraApi::Geometry::LayerParameters layerParameters;
+        layerParameters.m_closestDistanceToIp = closestDistanceToIp;
+        layerParameters.m_nRadiationLengths = nRadiationLengths;
+        layerParameters.m_nInteractionLengths = nInteractionLengths;
+        parameters.m_layerParametersVector.push_back(layerParameters);
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GeometrySnapshot::ReadCartesianVector(BinaryFileInput &fileInput, pandora::InputCartesianVector &cartesianVector) const
+{
+    float x(0.f), y(0.f), z(0.f);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(x));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(y));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(z));
+
+    cartesianVector = pandora::CartesianVector(x, y, z);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/**
+ *  @file   MarlinPandora/src/GridNonLinearityCorrectionPlugin.cc
+ *
+ *  @brief  Implementation of the grid non linearity correction plugin class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/StatusCodes.h"
+
+#include "GridNonLinearityCorrectionPlugin.h"
+
+#include <algorithm>
+#include <limits>
+
+GridNonLinearityCorrectionPlugin::GridNonLinearityCorrectionPlugin(const FloatVector &inputEnergyCorrectionPoints,
+    const FloatVector &outputEnergyCorrectionPoints, const unsigned int nGridPoints) :
+    m_minEnergy(0.f),
+    m_gridScale(0.f)
+{
+    const unsigned int nPoints(inputEnergyCorrectionPoints.size());
+
+    if (nPoints != outputEnergyCorrectionPoints.size())
+    {
+        streamlog_out(ERROR) << "GridNonLinearityCorrectionPlugin - Mismatched numbers of input and output energy correction points" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    if (0 == nPoints)
+        return;
+
+    FloatVector ratios;
+
+    for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint)
+    {
+        if ((inputEnergyCorrectionPoints[iPoint] < std::numeric_limits<float>::epsilon()) ||
+            ((iPoint > 0) && (inputEnergyCorrectionPoints[iPoint] <= inputEnergyCorrectionPoints[iPoint - 1])))
+        {
+            streamlog_out(ERROR) << "GridNonLinearityCorrectionPlugin - Input energy correction points must be positive and increasing" << std::endl;
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+        }
+
+        ratios.push_back(outputEnergyCorrectionPoints[iPoint] / inputEnergyCorrectionPoints[iPoint]);
+    }
+
+    m_minEnergy = inputEnergyCorrectionPoints.front();
+
+    if (1 == nPoints)
+    {
+        m_correctionFactors.assign(1, ratios.front());
+        return;
+    }
+
+    const unsigned int nGrid(std::max(2U, nGridPoints));
+    const float maxEnergy(inputEnergyCorrectionPoints.back());
+    m_gridScale = static_cast<float>(nGrid - 1) / (maxEnergy - m_minEnergy);
+    m_correctionFactors.reserve(nGrid);
+
+    // Resample the piecewise-linear ratio, advancing through the input points in step with the grid
+    unsigned int iUpper(1);
+
+    for (unsigned int iGrid = 0; iGrid < nGrid; ++iGrid)
+    {
+        const float energy((iGrid + 1 == nGrid) ? maxEnergy : m_minEnergy + static_cast<float>(iGrid) / m_gridScale);
+
+        while ((iUpper + 1 < nPoints) && (energy > inputEnergyCorrectionPoints[iUpper]))
+            ++iUpper;
+
+        const float lowEnergy(inputEnergyCorrectionPoints[iUpper - 1]), highEnergy(inputEnergyCorrectionPoints[iUpper]);
+        const float fraction(std::max(0.f, std::min(1.f, (energy - lowEnergy) / (highEnergy - lowEnergy))));
+        m_correctionFactors.push_back(ratios[iUpper - 1] + fraction * (ratios[iUpper] - ratios[iUpper - 1]));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GridNonLinearityCorrectionPlugin::MakeEnergyCorrections(const pandora::Cluster *const /*pCluster*/, float &correctedEnergy) const
+{
+    if (m_correctionFactors.empty())
+        return pandora::STATUS_CODE_SUCCESS;
+
+    const float index((correctedEnergy - m_minEnergy) * m_gridScale);
+    const unsigned int maxIndex(m_correctionFactors.size() - 1);
+
+    if ((index <= 0.f) || (0 == maxIndex))
+    {
+        correctedEnergy *= m_correctionFactors.front();
+    }
+    else if (index >= static_cast<float>(maxIndex))
+    {
+        correctedEnergy *= m_correctionFactors.back();
+    }
+    else
+    {
+        const unsigned int iGrid(static_cast<unsigned int>(index));
+        const float fraction(index - static_cast<float>(iGrid));
+        correctedEnergy *= m_correctionFactors[iGrid] + fraction * (m_correctionFactors[iGrid + 1] - m_correctionFactors[iGrid]);
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode GridNonLinearityCorrectionPlugin::ReadSettings(const pandora::TiXmlHandle /*xmlHandle*/)
+{
+    return pandora::STATUS_CODE_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/**
+ *  @file   MarlinPandora/src/HardwareCounters.cc
+ *
+ *  @brief  Implementation of the hardware counters class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "HardwareCounters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static std::mutex warningMutex;
+static bool isWarningPrinted(false);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HardwareCounters &HardwareCounters::GetThreadInstance()
+{
+    static thread_local HardwareCounters hardwareCounters;
+    return hardwareCounters;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HardwareCounters::Read(Values &values) const
+{
+    values = Values();
+
+#ifdef __linux__
+    if (m_groupFileDescriptor < 0)
+        return;
+
+    // Group reading layout: number of counters, time enabled, time running, then one value per counter in the order opened
+    unsigned long long buffer[3 + N_COUNTERS];
+    const ssize_t nBytesExpected((3 + m_nOpenCounters) * sizeof(unsigned long long));
+
+    if ((read(m_groupFileDescriptor, buffer, sizeof(buffer)) != nBytesExpected) || (buffer[0] != m_nOpenCounters) || (0 == buffer[2]))
+        return;
+
+    const double scale(static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]));
+
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        if (m_fileDescriptors[iCounter] < 0)
+            continue;
+
+        values.m_counts[iCounter] = scale * static_cast<double>(buffer[3 + m_groupPositions[iCounter]]);
+        values.m_isValid[iCounter] = true;
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string HardwareCounters::GetSummaryHeader()
+{
+    std::ostringstream header;
+    header << std::setw(14) << "Mcycles/call" << std::setw(14) << "Minstr/call" << std::setw(8) << "IPC" << std::setw(12) << "LLC miss/kI"
+           << std::setw(12) << "Br miss/kI";
+
+    return header.str();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string HardwareCounters::GetSummary(const Values &totals, const unsigned int nCalls)
+{
+    const double nCallsDouble(std::max(1U, nCalls));
+    const double instructions(totals.m_counts[INSTRUCTIONS]);
+    const bool hasInstructions(totals.m_isValid[INSTRUCTIONS] && (instructions > 0.));
+
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(3);
+
+    if (totals.m_isValid[CYCLES]) summary << std::setw(14) << 1.e-6 * totals.m_counts[CYCLES] / nCallsDouble;
+    else summary << std::setw(14) << "n/a";
+
+    if (totals.m_isValid[INSTRUCTIONS]) summary << std::setw(14) << 1.e-6 * instructions / nCallsDouble;
+    else summary << std::setw(14) << "n/a";
+
+    if (hasInstructions && totals.m_isValid[CYCLES] && (totals.m_counts[CYCLES] > 0.)) summary << std::setw(8) << std::setprecision(2) << instructions / totals.m_counts[CYCLES];
+    else summary << std::setw(8) << "n/a";
+
+    if (hasInstructions && totals.m_isValid[LLC_MISSES]) summary << std::setw(12) << std::setprecision(3) << 1000. * totals.m_counts[LLC_MISSES] / instructions;
+    else summary << std::setw(12) << "n/a";
+
+    if (hasInstructions && totals.m_isValid[BRANCH_MISSES]) summary << std::setw(12) << std::setprecision(3) << 1000. * totals.m_counts[BRANCH_MISSES] / instructions;
+    else summary << std::setw(12) << "n/a";
+
+    return summary.str();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HardwareCounters::HardwareCounters() :
+    m_nOpenCounters(0),
+    m_groupFileDescriptor(-1)
+{
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        m_fileDescriptors[iCounter] = -1;
+        m_groupPositions[iCounter] = 0;
+    }
+
+#ifdef __linux__
+    const unsigned long long configs[N_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    int firstErrorNumber(0);
+
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        struct perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = configs[iCounter];
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.disabled = (m_groupFileDescriptor < 0) ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // ATTN Counters that cannot be opened are skipped, and the first counter opened leads the group
+        const int fileDescriptor(static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, m_groupFileDescriptor, 0)));
+
+        if (fileDescriptor < 0)
+        {
+            if (0 == firstErrorNumber)
+                firstErrorNumber = errno;
+
+            continue;
+        }
+
+        if (m_groupFileDescriptor < 0)
+            m_groupFileDescriptor = fileDescriptor;
+
+        m_fileDescriptors[iCounter] = fileDescriptor;
+        m_groupPositions[iCounter] = m_nOpenCounters++;
+    }
+
+    if ((m_groupFileDescriptor >= 0) && (0 != ioctl(m_groupFileDescriptor, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP)))
+    {
+        firstErrorNumber = errno;
+        this->Close();
+    }
+
+    if (0 == firstErrorNumber)
+        return;
+
+    std::lock_guard<std::mutex> lock(warningMutex);
+
+    if (!isWarningPrinted)
+    {
+        streamlog_out(WARNING) << "HardwareCounters - Some counters are unavailable (" << std::strerror(firstErrorNumber) << "), check "
+                               << "/proc/sys/kernel/perf_event_paranoid and the cpu support for hardware events" << std::endl;
+        isWarningPrinted = true;
+    }
+#else
+    std::lock_guard<std::mutex> lock(warningMutex);
+
+    if (!isWarningPrinted)
+    {
+        streamlog_out(WARNING) << "HardwareCounters - Hardware counters require linux perf events and are unavailable" << std::endl;
+        isWarningPrinted = true;
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HardwareCounters::~HardwareCounters()
+{
+    this->Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HardwareCounters::Close()
+{
+#ifdef __linux__
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        if (m_fileDescriptors[iCounter] >= 0)
+            close(m_fileDescriptors[iCounter]);
+
+        m_fileDescriptors[iCounter] = -1;
+    }
+#endif
+
+    m_nOpenCounters = 0;
+    m_groupFileDescriptor = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HardwareCounters::Values::Values()
+{
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        m_counts[iCounter] = 0.;
+        m_isValid[iCounter] = false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HardwareCounters::Values::AddDifference(const Values &startValues, const Values &endValues)
+{
+    for (unsigned int iCounter = 0; iCounter < N_COUNTERS; ++iCounter)
+    {
+        if (!startValues.m_isValid[iCounter] || !endValues.m_isValid[iCounter])
+            continue;
+
+        m_counts[iCounter] += endValues.m_counts[iCounter] - startValues.m_counts[iCounter];
+        m_isValid[iCounter] = true;
+    }
+}
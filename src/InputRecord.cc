@@ -0,0 +1,540 @@
+/**
+ *  @file   MarlinPandora/src/InputRecord.cc
+ *
+ *  @brief  Implementation of the input record class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "BinaryFile.h"
+#include "CaloHitCreator.h"
+#include "InputRecord.h"
+#include "MCParticleCreator.h"
+#include "TrackCreator.h"
+
+InputRecord::InputRecord() :
+    m_runNumber(0),
+    m_eventNumber(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::Fill(const int runNumber, const int eventNumber, const CaloHitCreator &caloHitCreator, const TrackCreator &trackCreator,
+    const MCParticleCreator &mcParticleCreator)
+{
+    this->Clear();
+
+    m_runNumber = runNumber;
+    m_eventNumber = eventNumber;
+    m_caloHitParametersVector = caloHitCreator.GetCaloHitParametersVector();
+    m_trackParametersVector = trackCreator.GetTrackParametersVector();
+    m_mcParticleParametersVector = mcParticleCreator.GetMCParticleParametersVector();
+
+    AddressToIndexMap caloHitIndexMap, trackIndexMap, mcParticleIndexMap;
+
+    for (unsigned int i = 0; i < m_caloHitParametersVector.size(); ++i)
+        (void) caloHitIndexMap.insert(AddressToIndexMap::value_type(m_caloHitParametersVector[i].m_pParentAddress.Get(), i));
+
+    for (unsigned int i = 0; i < m_trackParametersVector.size(); ++i)
+        (void) trackIndexMap.insert(AddressToIndexMap::value_type(m_trackParametersVector[i].m_pParentAddress.Get(), i));
+
+    for (unsigned int i = 0; i < m_mcParticleParametersVector.size(); ++i)
+        (void) mcParticleIndexMap.insert(AddressToIndexMap::value_type(m_mcParticleParametersVector[i].m_pParentAddress.Get(), i));
+
+    // ATTN Relationships referring to objects that were not passed to pandora are dropped, as pandora would ignore them
+    unsigned int firstIndex(0), secondIndex(0);
+
+    for (TrackCreator::TrackPairVector::const_iterator iter = trackCreator.GetParentDaughterTrackPairs().begin(),
+        iterEnd = trackCreator.GetParentDaughterTrackPairs().end(); iter != iterEnd; ++iter)
+    {
+        if (this->GetIndex(trackIndexMap, iter->first, firstIndex) && this->GetIndex(trackIndexMap, iter->second, secondIndex))
+            m_parentDaughterTrackPairs.push_back(IndexPair(firstIndex, secondIndex));
+    }
+
+    for (TrackCreator::TrackPairVector::const_iterator iter = trackCreator.GetSiblingTrackPairs().begin(),
+        iterEnd = trackCreator.GetSiblingTrackPairs().end(); iter != iterEnd; ++iter)
+    {
+        if (this->GetIndex(trackIndexMap, iter->first, firstIndex) && this->GetIndex(trackIndexMap, iter->second, secondIndex))
+            m_siblingTrackPairs.push_back(IndexPair(firstIndex, secondIndex));
+    }
+
+    for (MCParticleCreator::MCParticlePairVector::const_iterator iter = mcParticleCreator.GetParentDaughterMCParticlePairs().begin(),
+        iterEnd = mcParticleCreator.GetParentDaughterMCParticlePairs().end(); iter != iterEnd; ++iter)
+    {
+        if (this->GetIndex(mcParticleIndexMap, iter->first, firstIndex) && this->GetIndex(mcParticleIndexMap, iter->second, secondIndex))
+            m_parentDaughterMCParticlePairs.push_back(IndexPair(firstIndex, secondIndex));
+    }
+
+    for (MCParticleCreator::TrackToMCParticlePairVector::const_iterator iter = mcParticleCreator.GetTrackToMCParticlePairs().begin(),
+        iterEnd = mcParticleCreator.GetTrackToMCParticlePairs().end(); iter != iterEnd; ++iter)
+    {
+        if (this->GetIndex(trackIndexMap, iter->first, firstIndex) && this->GetIndex(mcParticleIndexMap, iter->second, secondIndex))
+            m_trackToMCParticlePairs.push_back(IndexPair(firstIndex, secondIndex));
+    }
+
+    for (MCParticleCreator::CaloHitToMCParticleRelationVector::const_iterator iter = mcParticleCreator.GetCaloHitToMCParticleRelations().begin(),
+        iterEnd = mcParticleCreator.GetCaloHitToMCParticleRelations().end(); iter != iterEnd; ++iter)
+    {
+        if (this->GetIndex(caloHitIndexMap, iter->m_pCaloHit, firstIndex) && this->GetIndex(mcParticleIndexMap, iter->m_pMCParticle, secondIndex))
+            m_caloHitToMCParticleRelations.push_back(CaloHitToMCParticleRelation(firstIndex, secondIndex, iter->m_energyWeight));
+    }
+
+    this->AssignParentAddresses();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::Write(BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<int>(m_runNumber);
+    fileOutput.Write<int>(m_eventNumber);
+
+    fileOutput.Write<unsigned int>(m_trackParametersVector.size());
+
+    for (TrackParametersVector::const_iterator iter = m_trackParametersVector.begin(), iterEnd = m_trackParametersVector.end(); iter != iterEnd; ++iter)
+    {
+        this->WriteInput<float>(iter->m_d0, fileOutput);
+        this->WriteInput<float>(iter->m_z0, fileOutput);
+        this->WriteInput<int>(iter->m_particleId, fileOutput);
+        this->WriteInput<int>(iter->m_charge, fileOutput);
+        this->WriteInput<float>(iter->m_mass, fileOutput);
+        this->WriteInput(iter->m_momentumAtDca, fileOutput);
+        this->WriteInput(iter->m_trackStateAtStart, fileOutput);
+        this->WriteInput(iter->m_trackStateAtEnd, fileOutput);
+        this->WriteInput(iter->m_trackStateAtCalorimeter, fileOutput);
+        this->WriteInput<float>(iter->m_timeAtCalorimeter, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_reachesCalorimeter, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_isProjectedToEndCap, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_canFormPfo, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_canFormClusterlessPfo, fileOutput);
+    }
+
+    fileOutput.Write<unsigned int>(m_caloHitParametersVector.size());
+
+    for (CaloHitParametersVector::const_iterator iter = m_caloHitParametersVector.begin(), iterEnd = m_caloHitParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        this->WriteInput(iter->m_positionVector, fileOutput);
+        this->WriteInput(iter->m_expectedDirection, fileOutput);
+        this->WriteInput(iter->m_cellNormalVector, fileOutput);
+        this->WriteInput<int>(iter->m_cellGeometry, fileOutput);
+        this->WriteInput<float>(iter->m_cellSize0, fileOutput);
+        this->WriteInput<float>(iter->m_cellSize1, fileOutput);
+        this->WriteInput<float>(iter->m_cellThickness, fileOutput);
+        this->WriteInput<float>(iter->m_nCellRadiationLengths, fileOutput);
+        this->WriteInput<float>(iter->m_nCellInteractionLengths, fileOutput);
+        this->WriteInput<float>(iter->m_time, fileOutput);
+        this->WriteInput<float>(iter->m_inputEnergy, fileOutput);
+        this->WriteInput<float>(iter->m_mipEquivalentEnergy, fileOutput);
+        this->WriteInput<float>(iter->m_electromagneticEnergy, fileOutput);
+        this->WriteInput<float>(iter->m_hadronicEnergy, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_isDigital, fileOutput);
+        this->WriteInput<int>(iter->m_hitType, fileOutput);
+        this->WriteInput<int>(iter->m_hitRegion, fileOutput);
+        this->WriteInput<unsigned int>(iter->m_layer, fileOutput);
+        this->WriteInput<unsigned char>(iter->m_isInOuterSamplingLayer, fileOutput);
+    }
+
+    fileOutput.Write<unsigned int>(m_mcParticleParametersVector.size());
+
+    for (MCParticleParametersVector::const_iterator iter = m_mcParticleParametersVector.begin(), iterEnd = m_mcParticleParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        this->WriteInput<float>(iter->m_energy, fileOutput);
+        this->WriteInput(iter->m_momentum, fileOutput);
+        this->WriteInput(iter->m_vertex, fileOutput);
+        this->WriteInput(iter->m_endpoint, fileOutput);
+        this->WriteInput<int>(iter->m_particleId, fileOutput);
+        this->WriteInput<int>(iter->m_mcParticleType, fileOutput);
+    }
+
+    this->WriteIndexPairs(m_parentDaughterTrackPairs, fileOutput);
+    this->WriteIndexPairs(m_siblingTrackPairs, fileOutput);
+    this->WriteIndexPairs(m_parentDaughterMCParticlePairs, fileOutput);
+    this->WriteIndexPairs(m_trackToMCParticlePairs, fileOutput);
+
+    fileOutput.Write<unsigned int>(m_caloHitToMCParticleRelations.size());
+
+    for (CaloHitToMCParticleRelationVector::const_iterator iter = m_caloHitToMCParticleRelations.begin(),
+        iterEnd = m_caloHitToMCParticleRelations.end(); iter != iterEnd; ++iter)
+    {
+        fileOutput.Write<unsigned int>(iter->m_caloHitIndex);
+        fileOutput.Write<unsigned int>(iter->m_mcParticleIndex);
+        fileOutput.Write<float>(iter->m_energyWeight);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecord::Read(BinaryFileInput &fileInput)
+{
+    this->Clear();
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(m_runNumber));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(m_eventNumber));
+
+    unsigned int nTracks(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nTracks));
+
+    for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack)
+    {
+        PandoraApi::Track::Parameters parameters;
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_d0)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_z0)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, int>(fileInput, parameters.m_particleId)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, int>(fileInput, parameters.m_charge)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_mass)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_momentumAtDca));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_trackStateAtStart));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_trackStateAtEnd));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_trackStateAtCalorimeter));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_timeAtCalorimeter)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_reachesCalorimeter)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_isProjectedToEndCap)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_canFormPfo)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_canFormClusterlessPfo)));
+        m_trackParametersVector.push_back(parameters);
+    }
+
+    unsigned int nCaloHits(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nCaloHits));
+
+    for (unsigned int iCaloHit = 0; iCaloHit < nCaloHits; ++iCaloHit)
+    {
+        PandoraApi::CaloHit::Parameters parameters;
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_positionVector));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_expectedDirection));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_cellNormalVector));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, pandora::CellGeometry>(fileInput, parameters.m_cellGeometry)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_cellSize0)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_cellSize1)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_cellThickness)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_nCellRadiationLengths)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_nCellInteractionLengths)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_time)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_inputEnergy)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_mipEquivalentEnergy)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_electromagneticEnergy)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_hadronicEnergy)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_isDigital)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, pandora::HitType>(fileInput, parameters.m_hitType)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, pandora::HitRegion>(fileInput, parameters.m_hitRegion)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned int, unsigned int>(fileInput, parameters.m_layer)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<unsigned char, bool>(fileInput, parameters.m_isInOuterSamplingLayer)));
+        m_caloHitParametersVector.push_back(parameters);
+    }
+
+    unsigned int nMCParticles(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nMCParticles));
+
+    for (unsigned int iMCParticle = 0; iMCParticle < nMCParticles; ++iMCParticle)
+    {
+        PandoraApi::MCParticle::Parameters parameters;
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<float, float>(fileInput, parameters.m_energy)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_momentum));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_vertex));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadInput(fileInput, parameters.m_endpoint));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, int>(fileInput, parameters.m_particleId)));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (this->ReadInput<int, pandora::MCParticleType>(fileInput, parameters.m_mcParticleType)));
+        m_mcParticleParametersVector.push_back(parameters);
+    }
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadIndexPairs(fileInput, nTracks, nTracks, m_parentDaughterTrackPairs));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadIndexPairs(fileInput, nTracks, nTracks, m_siblingTrackPairs));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadIndexPairs(fileInput, nMCParticles, nMCParticles, m_parentDaughterMCParticlePairs));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ReadIndexPairs(fileInput, nTracks, nMCParticles, m_trackToMCParticlePairs));
+
+    unsigned int nCaloHitRelations(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nCaloHitRelations));
+
+    for (unsigned int iRelation = 0; iRelation < nCaloHitRelations; ++iRelation)
+    {
+        unsigned int caloHitIndex(0), mcParticleIndex(0);
+        float energyWeight(0.f);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(caloHitIndex));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(mcParticleIndex));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(energyWeight));
+
+        if ((caloHitIndex >= nCaloHits) || (mcParticleIndex >= nMCParticles))
+            return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+        m_caloHitToMCParticleRelations.push_back(CaloHitToMCParticleRelation(caloHitIndex, mcParticleIndex, energyWeight));
+    }
+
+    this->AssignParentAddresses();
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecord::CreatePandoraInputs(const pandora::Pandora &pandora) const
+{
+    // ATTN Objects pandora rejects are skipped, exactly as in the creators, so that a replay reproduces the original event
+    for (TrackParametersVector::const_iterator iter = m_trackParametersVector.begin(), iterEnd = m_trackParametersVector.end(); iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Track::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora track: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (IndexPairVector::const_iterator iter = m_parentDaughterTrackPairs.begin(), iterEnd = m_parentDaughterTrackPairs.end(); iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackParentDaughterRelationship(pandora,
+            &m_trackAddresses[iter->first], &m_trackAddresses[iter->second]));
+    }
+
+    for (IndexPairVector::const_iterator iter = m_siblingTrackPairs.begin(), iterEnd = m_siblingTrackPairs.end(); iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackSiblingRelationship(pandora,
+            &m_trackAddresses[iter->first], &m_trackAddresses[iter->second]));
+    }
+
+    for (CaloHitParametersVector::const_iterator iter = m_caloHitParametersVector.begin(), iterEnd = m_caloHitParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora calo hit: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (MCParticleParametersVector::const_iterator iter = m_mcParticleParametersVector.begin(), iterEnd = m_mcParticleParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::MCParticle::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora MCParticle: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (IndexPairVector::const_iterator iter = m_parentDaughterMCParticlePairs.begin(), iterEnd = m_parentDaughterMCParticlePairs.end();
+        iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetMCParentDaughterRelationship(pandora,
+            &m_mcParticleAddresses[iter->first], &m_mcParticleAddresses[iter->second]));
+    }
+
+    for (IndexPairVector::const_iterator iter = m_trackToMCParticlePairs.begin(), iterEnd = m_trackToMCParticlePairs.end(); iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackToMCParticleRelationship(pandora,
+            &m_trackAddresses[iter->first], &m_mcParticleAddresses[iter->second]));
+    }
+
+    for (CaloHitToMCParticleRelationVector::const_iterator iter = m_caloHitToMCParticleRelations.begin(),
+        iterEnd = m_caloHitToMCParticleRelations.end(); iter != iterEnd; ++iter)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetCaloHitToMCParticleRelationship(pandora,
+            &m_caloHitAddresses[iter->m_caloHitIndex], &m_mcParticleAddresses[iter->m_mcParticleIndex], iter->m_energyWeight));
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::Clear()
+{
+    m_runNumber = 0;
+    m_eventNumber = 0;
+    m_caloHitParametersVector.clear();
+    m_trackParametersVector.clear();
+    m_mcParticleParametersVector.clear();
+    m_parentDaughterTrackPairs.clear();
+    m_siblingTrackPairs.clear();
+    m_parentDaughterMCParticlePairs.clear();
+    m_trackToMCParticlePairs.clear();
+    m_caloHitToMCParticleRelations.clear();
+    m_caloHitAddresses.clear();
+    m_trackAddresses.clear();
+    m_mcParticleAddresses.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::AssignParentAddresses()
+{
+    m_caloHitAddresses.assign(m_caloHitParametersVector.size(), 0);
+    m_trackAddresses.assign(m_trackParametersVector.size(), 0);
+    m_mcParticleAddresses.assign(m_mcParticleParametersVector.size(), 0);
+
+    for (unsigned int i = 0; i < m_caloHitParametersVector.size(); ++i)
+        m_caloHitParametersVector[i].m_pParentAddress = &m_caloHitAddresses[i];
+
+    for (unsigned int i = 0; i < m_trackParametersVector.size(); ++i)
+        m_trackParametersVector[i].m_pParentAddress = &m_trackAddresses[i];
+
+    for (unsigned int i = 0; i < m_mcParticleParametersVector.size(); ++i)
+        m_mcParticleParametersVector[i].m_pParentAddress = &m_mcParticleAddresses[i];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool InputRecord::GetIndex(const AddressToIndexMap &addressToIndexMap, const void *const pAddress, unsigned int &index) const
+{
+    AddressToIndexMap::const_iterator iter = addressToIndexMap.find(pAddress);
+
+    if (addressToIndexMap.end() == iter)
+    {
+        streamlog_out(DEBUG2) << "InputRecord: dropping relationship to object not passed to pandora" << std::endl;
+        return false;
+    }
+
+    index = iter->second;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename STORED_TYPE, typename INPUT_TYPE>
+void InputRecord::WriteInput(const INPUT_TYPE &input, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<unsigned char>(input.IsInitialized() ? 1 : 0);
+
+    if (input.IsInitialized())
+        fileOutput.Write<STORED_TYPE>(static_cast<STORED_TYPE>(input.Get()));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename STORED_TYPE, typename VALUE_TYPE, typename INPUT_TYPE>
+pandora::StatusCode InputRecord::ReadInput(BinaryFileInput &fileInput, INPUT_TYPE &input) const
+{
+    unsigned char isInitialized(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(isInitialized));
+
+    if (0 == isInitialized)
+        return pandora::STATUS_CODE_SUCCESS;
+
+    STORED_TYPE value;
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(value));
+    input = static_cast<VALUE_TYPE>(value);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::WriteInput(const pandora::InputCartesianVector &input, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<unsigned char>(input.IsInitialized() ? 1 : 0);
+
+    if (input.IsInitialized())
+    {
+        fileOutput.Write<float>(input.Get().GetX());
+        fileOutput.Write<float>(input.Get().GetY());
+        fileOutput.Write<float>(input.Get().GetZ());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecord::ReadInput(BinaryFileInput &fileInput, pandora::InputCartesianVector &input) const
+{
+    unsigned char isInitialized(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(isInitialized));
+
+    if (0 == isInitialized)
+        return pandora::STATUS_CODE_SUCCESS;
+
+    float x(0.f), y(0.f), z(0.f);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(x));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(y));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(z));
+    input = pandora::CartesianVector(x, y, z);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::WriteInput(const pandora::InputTrackState &input, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<unsigned char>(input.IsInitialized() ? 1 : 0);
+
+    if (input.IsInitialized())
+    {
+        const pandora::CartesianVector &position(input.Get().GetPosition());
+        const pandora::CartesianVector &momentum(input.Get().GetMomentum());
+        fileOutput.Write<float>(position.GetX());
+        fileOutput.Write<float>(position.GetY());
+        fileOutput.Write<float>(position.GetZ());
+        fileOutput.Write<float>(momentum.GetX());
+        fileOutput.Write<float>(momentum.GetY());
+        fileOutput.Write<float>(momentum.GetZ());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecord::ReadInput(BinaryFileInput &fileInput, pandora::InputTrackState &input) const
+{
+    unsigned char isInitialized(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(isInitialized));
+
+    if (0 == isInitialized)
+        return pandora::STATUS_CODE_SUCCESS;
+
+    float x(0.f), y(0.f), z(0.f), px(0.f), py(0.f), pz(0.f);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(x));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(y));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(z));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(px));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(py));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(pz));
+    input = pandora::TrackState(x, y, z, px, py, pz);
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecord::WriteIndexPairs(const IndexPairVector &indexPairVector, BinaryFileOutput &fileOutput) const
+{
+    fileOutput.Write<unsigned int>(indexPairVector.size());
+
+    for (IndexPairVector::const_iterator iter = indexPairVector.begin(), iterEnd = indexPairVector.end(); iter != iterEnd; ++iter)
+    {
+        fileOutput.Write<unsigned int>(iter->first);
+        fileOutput.Write<unsigned int>(iter->second);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecord::ReadIndexPairs(BinaryFileInput &fileInput, const unsigned int maxFirstIndex, const unsigned int maxSecondIndex,
+    IndexPairVector &indexPairVector) const
+{
+    unsigned int nPairs(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(nPairs));
+
+    for (unsigned int iPair = 0; iPair < nPairs; ++iPair)
+    {
+        unsigned int firstIndex(0), secondIndex(0);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(firstIndex));
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, fileInput.Read(secondIndex));
+
+        if ((firstIndex >= maxFirstIndex) || (secondIndex >= maxSecondIndex))
+            return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+        indexPairVector.push_back(IndexPair(firstIndex, secondIndex));
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/**
+ *  @file   MarlinPandora/src/InputRecordFile.cc
+ *
+ *  @brief  Implementation of the input record file writer and reader classes.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "InputRecord.h"
+#include "InputRecordFile.h"
+
+static const std::string INPUT_RECORD_FILE_TYPE("MPINPREC");
+static const unsigned int INPUT_RECORD_VERSION = 2;
+
+InputRecordWriter::InputRecordWriter(const InputRecordHeader &header) :
+    m_fileOutput(INPUT_RECORD_FILE_TYPE, INPUT_RECORD_VERSION),
+    m_isIndexWritten(false)
+{
+    const UserComponents::Settings &settings(header.m_userComponentSettings);
+
+    m_fileOutput.WriteString(header.m_geometryKey);
+    m_fileOutput.Write<float>(settings.m_innerBField);
+    m_fileOutput.Write<float>(settings.m_muonBarrelBField);
+    m_fileOutput.Write<float>(settings.m_muonEndCapBField);
+    m_fileOutput.Write<int>(settings.m_useBFieldMap);
+    m_fileOutput.Write<int>(settings.m_useTablePseudoLayerPlugin);
+
+    m_fileOutput.Write<unsigned int>(settings.m_inputEnergyCorrectionPoints.size());
+
+    for (UserComponents::FloatVector::const_iterator iter = settings.m_inputEnergyCorrectionPoints.begin(),
+        iterEnd = settings.m_inputEnergyCorrectionPoints.end(); iter != iterEnd; ++iter)
+    {
+        m_fileOutput.Write<float>(*iter);
+    }
+
+    m_fileOutput.Write<unsigned int>(settings.m_outputEnergyCorrectionPoints.size());
+
+    for (UserComponents::FloatVector::const_iterator iter = settings.m_outputEnergyCorrectionPoints.begin(),
+        iterEnd = settings.m_outputEnergyCorrectionPoints.end(); iter != iterEnd; ++iter)
+    {
+        m_fileOutput.Write<float>(*iter);
+    }
+
+    m_fileOutput.Write<int>(settings.m_nNonLinearityGridPoints);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InputRecordWriter::AddEvent(const InputRecord &inputRecord)
+{
+    if (m_isIndexWritten)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_ALLOWED);
+
+    m_eventOffsets.push_back(m_fileOutput.GetPayloadSize());
+    inputRecord.Write(m_fileOutput);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecordWriter::WriteFile(const std::string &fileName)
+{
+    if (!m_isIndexWritten)
+    {
+        // The index follows the records, and the final eight bytes of the payload give its position
+        const unsigned long long indexPosition(m_fileOutput.GetPayloadSize());
+        m_fileOutput.Write<unsigned int>(m_eventOffsets.size());
+
+        for (OffsetVector::const_iterator iter = m_eventOffsets.begin(), iterEnd = m_eventOffsets.end(); iter != iterEnd; ++iter)
+            m_fileOutput.Write<unsigned long long>(*iter);
+
+        m_fileOutput.Write<unsigned long long>(indexPosition);
+        m_isIndexWritten = true;
+    }
+
+    return m_fileOutput.WriteFile(fileName);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecordReader::Open(const std::string &fileName)
+{
+    m_header = InputRecordHeader();
+    m_eventOffsets.clear();
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Open(fileName, INPUT_RECORD_FILE_TYPE, INPUT_RECORD_VERSION));
+
+    UserComponents::Settings &settings(m_header.m_userComponentSettings);
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.ReadString(m_header.m_geometryKey));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_innerBField));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_muonBarrelBField));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_muonEndCapBField));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_useBFieldMap));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_useTablePseudoLayerPlugin));
+
+    unsigned int nInputPoints(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(nInputPoints));
+
+    for (unsigned int iPoint = 0; iPoint < nInputPoints; ++iPoint)
+    {
+        float point(0.f);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(point));
+        settings.m_inputEnergyCorrectionPoints.push_back(point);
+    }
+
+    unsigned int nOutputPoints(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(nOutputPoints));
+
+    for (unsigned int iPoint = 0; iPoint < nOutputPoints; ++iPoint)
+    {
+        float point(0.f);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(point));
+        settings.m_outputEnergyCorrectionPoints.push_back(point);
+    }
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(settings.m_nNonLinearityGridPoints));
+
+    const std::size_t payloadSize(m_fileInput.GetPayloadSize());
+
+    if (payloadSize < sizeof(unsigned long long))
+        return pandora::STATUS_CODE_FAILURE;
+
+    unsigned long long indexPosition(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.SetPosition(payloadSize - sizeof(unsigned long long)));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(indexPosition));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.SetPosition(indexPosition));
+
+    unsigned int nEvents(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(nEvents));
+
+    for (unsigned int iEvent = 0; iEvent < nEvents; ++iEvent)
+    {
+        unsigned long long eventOffset(0);
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.Read(eventOffset));
+
+        if (eventOffset >= indexPosition)
+            return pandora::STATUS_CODE_FAILURE;
+
+        m_eventOffsets.push_back(eventOffset);
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode InputRecordReader::ReadEvent(const unsigned int eventIndex, InputRecord &inputRecord)
+{
+    if (eventIndex >= m_eventOffsets.size())
+        return pandora::STATUS_CODE_OUT_OF_RANGE;
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_fileInput.SetPosition(m_eventOffsets[eventIndex]));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, inputRecord.Read(m_fileInput));
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
@@ -25,10 +25,9 @@
 #include <cmath>
 #include <limits>
 
-MCParticleCreator::MCParticleCreator(const Settings &settings, const pandora::Pandora *const pPandora) :
+MCParticleCreator::MCParticleCreator(const Settings &settings, const GeometryProvider &geometryProvider) :
     m_settings(settings),
-    m_pPandora(pPandora),
-    m_bField(marlin::Global::GEAR->getBField().at(gear::Vector3D(0., 0., 0.)).z())
+    m_bField(geometryProvider.GetConstant("InnerBField"))
 {
 }
 
@@ -40,7 +39,7 @@ MCParticleCreator::~MCParticleCreator()
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode MCParticleCreator::CreateMCParticles(const EVENT::LCEvent *const pLCEvent) const
+pandora::StatusCode MCParticleCreator::CreateMCParticles(const EVENT::LCEvent *const pLCEvent)
 {
     for (StringVector::const_iterator iter = m_settings.m_mcParticleCollections.begin(), iterEnd = m_settings.m_mcParticleCollections.end();
         iter != iterEnd; ++iter)
@@ -70,14 +69,13 @@ pandora::StatusCode MCParticleCreator::CreateMCParticles(const EVENT::LCEvent *c
                     mcParticleParameters.m_endpoint = pandora::CartesianVector(pMcParticle->getEndpoint()[0], pMcParticle->getEndpoint()[1],
                         pMcParticle->getEndpoint()[2]);
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::MCParticle::Create(*m_pPandora, mcParticleParameters));
+                    m_mcParticleParametersVector.push_back(mcParticleParameters);
 
                     // Create parent-daughter relationships
                     for(MCParticleVec::const_iterator itDaughter = pMcParticle->getDaughters().begin(),
                         itDaughterEnd = pMcParticle->getDaughters().end(); itDaughter != itDaughterEnd; ++itDaughter)
                     {
-                        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetMCParentDaughterRelationship(*m_pPandora,
-                            pMcParticle, *itDaughter));
+                        m_parentDaughterMCParticlePairs.push_back(MCParticlePair(pMcParticle, *itDaughter));
                     }
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
@@ -101,7 +99,7 @@ pandora::StatusCode MCParticleCreator::CreateMCParticles(const EVENT::LCEvent *c
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode MCParticleCreator::CreateTrackToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const TrackVector &trackVector) const
+pandora::StatusCode MCParticleCreator::CreateTrackToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const TrackVector &trackVector)
 {
     for (StringVector::const_iterator iter = m_settings.m_lcTrackRelationCollections.begin(), iterEnd = m_settings.m_lcTrackRelationCollections.end();
          iter != iterEnd; ++iter)
@@ -150,8 +148,7 @@ pandora::StatusCode MCParticleCreator::CreateTrackToMCParticleRelationships(cons
                     if (NULL == pBestMCParticle)
                         continue;
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackToMCParticleRelationship(*m_pPandora, pTrack,
-                        pBestMCParticle));
+                    m_trackToMCParticlePairs.push_back(TrackToMCParticlePair(pTrack, pBestMCParticle));
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
                 {
@@ -174,7 +171,8 @@ pandora::StatusCode MCParticleCreator::CreateTrackToMCParticleRelationships(cons
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode MCParticleCreator::CreateCaloHitToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const CalorimeterHitVector &calorimeterHitVector) const
+pandora::StatusCode MCParticleCreator::CreateCaloHitToMCParticleRelationships(const EVENT::LCEvent *const pLCEvent, const CalorimeterHitVector &calorimeterHitVector,
+    const CaloHitCreator::SuperCellMemberMap &superCellMemberMap)
 {
     typedef std::map<MCParticle *, float> MCParticleToEnergyWeightMap;
     MCParticleToEnergyWeightMap mcParticleToEnergyWeightMap;
@@ -193,26 +191,45 @@ pandora::StatusCode MCParticleCreator::CreateCaloHitToMCParticleRelationships(co
                 try
                 {
                     mcParticleToEnergyWeightMap.clear();
-                    const EVENT::LCObjectVec &objectVec = navigate.getRelatedToObjects(*caloHitIter);
 
-                    for (EVENT::LCObjectVec::const_iterator itRel = objectVec.begin(), itRelEnd = objectVec.end(); itRel != itRelEnd; ++itRel)
+                    // ATTN A forward super-cell collects the mc contributions of all its merged calorimeter hits, any other hit only its own
+                    CalorimeterHit *const *pMemberHitBegin(&(*caloHitIter));
+                    CalorimeterHit *const *pMemberHitEnd(pMemberHitBegin + 1);
+
+                    if (!superCellMemberMap.empty())
                     {
-                        EVENT::SimCalorimeterHit *pSimHit = dynamic_cast<SimCalorimeterHit *>(*itRel);
+                        CaloHitCreator::SuperCellMemberMap::const_iterator memberIter = superCellMemberMap.find(*caloHitIter);
 
-                        if (NULL == pSimHit)
-                            continue;
+                        if ((superCellMemberMap.end() != memberIter) && !memberIter->second.empty())
+                        {
+                            pMemberHitBegin = &(memberIter->second.front());
+                            pMemberHitEnd = pMemberHitBegin + memberIter->second.size();
+                        }
+                    }
 
-                        for (int iCont = 0, iEnd = pSimHit->getNMCContributions(); iCont < iEnd; ++iCont)
+                    for (CalorimeterHit *const *hitIter = pMemberHitBegin; hitIter != pMemberHitEnd; ++hitIter)
+                    {
+                        const EVENT::LCObjectVec &objectVec = navigate.getRelatedToObjects(*hitIter);
+
+                        for (EVENT::LCObjectVec::const_iterator itRel = objectVec.begin(), itRelEnd = objectVec.end(); itRel != itRelEnd; ++itRel)
                         {
-                            mcParticleToEnergyWeightMap[pSimHit->getParticleCont(iCont)] += pSimHit->getEnergyCont(iCont);
+                            EVENT::SimCalorimeterHit *pSimHit = dynamic_cast<SimCalorimeterHit *>(*itRel);
+
+                            if (NULL == pSimHit)
+                                continue;
+
+                            for (int iCont = 0, iEnd = pSimHit->getNMCContributions(); iCont < iEnd; ++iCont)
+                            {
+                                mcParticleToEnergyWeightMap[pSimHit->getParticleCont(iCont)] += pSimHit->getEnergyCont(iCont);
+                            }
                         }
                     }
 
                     for (MCParticleToEnergyWeightMap::const_iterator mcParticleIter = mcParticleToEnergyWeightMap.begin(),
                         mcParticleIterEnd = mcParticleToEnergyWeightMap.end(); mcParticleIter != mcParticleIterEnd; ++mcParticleIter)
                     {
-                        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetCaloHitToMCParticleRelationship(*m_pPandora,
-                            *caloHitIter, mcParticleIter->first, mcParticleIter->second));
+                        m_caloHitToMCParticleRelations.push_back(CaloHitToMCParticleRelation(*caloHitIter, mcParticleIter->first,
+                            mcParticleIter->second));
                     }
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
@@ -234,6 +251,66 @@ pandora::StatusCode MCParticleCreator::CreateCaloHitToMCParticleRelationships(co
     return pandora::STATUS_CODE_SUCCESS;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode MCParticleCreator::CreatePandoraMCParticles(const pandora::Pandora &pandora) const
+{
+    for (MCParticleParametersVector::const_iterator iter = m_mcParticleParametersVector.begin(), iterEnd = m_mcParticleParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::MCParticle::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora MCParticle: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (MCParticlePairVector::const_iterator iter = m_parentDaughterMCParticlePairs.begin(), iterEnd = m_parentDaughterMCParticlePairs.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetMCParentDaughterRelationship(pandora, iter->first, iter->second));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create mc particle parent-daughter relationship: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (TrackToMCParticlePairVector::const_iterator iter = m_trackToMCParticlePairs.begin(), iterEnd = m_trackToMCParticlePairs.end();
+        iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackToMCParticleRelationship(pandora, iter->first, iter->second));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create track to mc particle relationship: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (CaloHitToMCParticleRelationVector::const_iterator iter = m_caloHitToMCParticleRelations.begin(),
+        iterEnd = m_caloHitToMCParticleRelations.end(); iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetCaloHitToMCParticleRelationship(pandora, iter->m_pCaloHit,
+                iter->m_pMCParticle, iter->m_energyWeight));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create calo hit to mc particle relationship: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -13,27 +13,67 @@
 
 #include "Api/PandoraApi.h"
 
-#include "LCContent.h"
-
+#include "BinaryFile.h"
 #include "ExternalClusteringAlgorithm.h"
+#include "ExternalTrackClusterAssociationAlgorithm.h"
+#include "InputRecord.h"
+#include "ParallelReclusteringAlgorithm.h"
 #include "PandoraPFANewProcessor.h"
+#include "PersistentThreadPool.h"
+#include "ProfilingAlgorithm.h"
+#include "StageProfiler.h"
 
 #include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
 
 PandoraPFANewProcessor pandoraPFANewProcessor;
 
 PandoraPFANewProcessor::PandoraToLCEventMap PandoraPFANewProcessor::m_pandoraToLCEventMap;
 
+PandoraPFANewProcessor::PandoraToCaloHitCreatorMap PandoraPFANewProcessor::m_pandoraToCaloHitCreatorMap;
+
+PandoraPFANewProcessor::GeometrySnapshotMap PandoraPFANewProcessor::m_geometrySnapshotMap;
+
+static std::mutex geometrySnapshotMapMutex;
+
+static std::mutex pandoraToLCEventMapMutex;
+
+/**
+ *  @brief  InstanceTask class, processing the event with the pandora instance matching the index of each thread of the instance thread pool
+ */
+class PandoraPFANewProcessor::InstanceTask : public PersistentThreadPool::Task
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pProcessor address of the processor
+     *  @param  statusCodeVector to receive the status code for each pandora instance
+     */
+    InstanceTask(const PandoraPFANewProcessor *const pProcessor, std::vector<pandora::StatusCode> &statusCodeVector);
+
+    void Run(const unsigned int threadIndex);
+
+private:
+    const PandoraPFANewProcessor       *m_pProcessor;                       ///< Address of the processor
+    std::vector<pandora::StatusCode>   &m_statusCodeVector;                 ///< The status code for each pandora instance
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 PandoraPFANewProcessor::PandoraPFANewProcessor() :
     Processor("PandoraPFANewProcessor"),
     m_pPandora(NULL),
+    m_pGeometrySnapshot(NULL),
     m_pCaloHitCreator(NULL),
-    m_pGeometryCreator(NULL),
     m_pTrackCreator(NULL),
     m_pMCParticleCreator(NULL),
-    m_pPfoCreator(NULL)
+    m_pReclusteringWorkerPool(NULL),
+    m_pInputRecordWriter(NULL),
+    m_pStageProfiler(NULL),
+    m_pInstanceThreadPool(NULL)
 {
     _description = "Pandora reconstructs clusters and particle flow objects";
     this->ProcessSteeringFile();
@@ -46,18 +86,29 @@ void PandoraPFANewProcessor::init()
     try
     {
         streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Init" << std::endl;
+        this->CreateGeometrySnapshot();
         this->FinaliseSteeringParameters();
 
-        m_pPandora = new pandora::Pandora();
-        m_pGeometryCreator = new GeometryCreator(m_geometryCreatorSettings, m_pPandora);
-        m_pCaloHitCreator = new CaloHitCreator(m_caloHitCreatorSettings, m_pPandora);
-        m_pTrackCreator = new TrackCreator(m_trackCreatorSettings, m_pPandora);
-        m_pMCParticleCreator = new MCParticleCreator(m_mcParticleCreatorSettings, m_pPandora);
-        m_pPfoCreator = new PfoCreator(m_pfoCreatorSettings, m_pPandora);
+        this->CreatePandoraInstances();
+        m_pCaloHitCreator = new CaloHitCreator(m_caloHitCreatorSettings, *m_pGeometrySnapshot);
+        m_pTrackCreator = new TrackCreator(m_trackCreatorSettings, *m_pGeometrySnapshot);
+        m_pMCParticleCreator = new MCParticleCreator(m_mcParticleCreatorSettings, *m_pGeometrySnapshot);
+        this->CreateInputRecordWriter();
 
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->RegisterUserComponents());
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pGeometryCreator->CreateGeometry());
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*m_pPandora, m_settings.m_pandoraSettingsXmlFile));
+        if ((0 != m_settings.m_profileStages) || (0 != m_settings.m_profileHardwareCounters))
+            m_pStageProfiler = new StageProfiler(0 != m_settings.m_profileHardwareCounters);
+
+        this->CreateReclusteringWorkers();
+        this->CreateInstanceThreadPool();
+
+        for (unsigned int iPandora = 0; iPandora < m_pandoraVector.size(); ++iPandora)
+        {
+            this->InitialisePandoraInstance(*m_pandoraVector[iPandora], (0 == iPandora) ? m_settings.m_pandoraSettingsXmlFile :
+                m_settings.m_additionalSettingsXmlFiles[iPandora - 1]);
+        }
+
+        for (unsigned int iProfile = 0; iProfile < m_profilePandoraVector.size(); ++iProfile)
+            this->InitialisePandoraInstance(*m_profilePandoraVector[iProfile], m_settings.m_profileSettingsXmlFiles[iProfile]);
     }
     catch (pandora::StatusCodeException &statusCodeException)
     {
@@ -89,20 +140,73 @@ void PandoraPFANewProcessor::processEvent(LCEvent *pLCEvent)
     try
     {
         streamlog_out(DEBUG) << "PandoraPFANewProcessor - Run " << std::endl;
-        (void) m_pandoraToLCEventMap.insert(PandoraToLCEventMap::value_type(m_pPandora, pLCEvent));
-
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateMCParticles(pLCEvent));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pTrackCreator->CreateTrackAssociations(pLCEvent));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pTrackCreator->CreateTracks(pLCEvent));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateTrackToMCParticleRelationships(pLCEvent, m_pTrackCreator->GetTrackVector()));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pCaloHitCreator->CreateCaloHits(pLCEvent));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateCaloHitToMCParticleRelationships(pLCEvent, m_pCaloHitCreator->GetCalorimeterHitVector()));
 
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*m_pPandora));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pPfoCreator->CreateParticleFlowObjects(pLCEvent));
-
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*m_pPandora));
-        this->Reset();
+        // Convert the lcio inputs once, then pass the resulting input objects to each pandora instance
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateMCParticles");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateMCParticles(pLCEvent));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateTrackAssociations");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pTrackCreator->CreateTrackAssociations(pLCEvent));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateTracks");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pTrackCreator->CreateTracks(pLCEvent));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateTrackToMCParticleRelationships");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateTrackToMCParticleRelationships(pLCEvent, m_pTrackCreator->GetTrackVector()));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateCaloHits");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pCaloHitCreator->CreateCaloHits(pLCEvent));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateCaloHitToMCParticleRelationships");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreateCaloHitToMCParticleRelationships(pLCEvent, m_pCaloHitCreator->GetCalorimeterHitVector(),
+                m_pCaloHitCreator->GetSuperCellMemberMap()));
+        }
+
+        if (NULL != m_pInputRecordWriter)
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "RecordInputs");
+            this->RecordInputs(pLCEvent);
+        }
+
+        this->SelectEventPandoraInstances();
+
+        {
+            // ATTN Several processors may be processing events concurrently, e.g. in the standalone driver
+            std::lock_guard<std::mutex> lock(pandoraToLCEventMapMutex);
+
+            for (PandoraVector::const_iterator iter = m_eventPandoraVector.begin(), iterEnd = m_eventPandoraVector.end(); iter != iterEnd; ++iter)
+            {
+                (void) m_pandoraToLCEventMap.insert(PandoraToLCEventMap::value_type(*iter, pLCEvent));
+                (void) m_pandoraToCaloHitCreatorMap.insert(PandoraToCaloHitCreatorMap::value_type(*iter, m_pCaloHitCreator));
+            }
+        }
+
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "ProcessPandoraInstances");
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->ProcessPandoraInstances());
+        }
+
+        // ATTN Output collections are added to the lcio event sequentially, after all pandora instances have finished
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "CreateParticleFlowObjects");
+
+            for (PfoCreatorVector::const_iterator iter = m_eventPfoCreatorVector.begin(), iterEnd = m_eventPfoCreatorVector.end(); iter != iterEnd; ++iter)
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, (*iter)->CreateParticleFlowObjects(pLCEvent));
+        }
+        {
+            StageProfiler::Scope scope(m_pStageProfiler, "Reset");
+
+            for (PandoraVector::const_iterator iter = m_eventPandoraVector.begin(), iterEnd = m_eventPandoraVector.end(); iter != iterEnd; ++iter)
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(**iter));
+
+            this->Reset();
+        }
     }
     catch (pandora::StatusCodeException &statusCodeException)
     {
@@ -137,12 +241,64 @@ void PandoraPFANewProcessor::check(LCEvent */*pLCEvent*/)
 
 void PandoraPFANewProcessor::end()
 {
-    delete m_pPandora;
-    delete m_pGeometryCreator;
+    if (NULL != m_pInputRecordWriter)
+    {
+        if (pandora::STATUS_CODE_SUCCESS == m_pInputRecordWriter->WriteFile(m_settings.m_recordInputsFile))
+        {
+            streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Recorded inputs for " << m_pInputRecordWriter->GetNEvents() << " events to "
+                                   << m_settings.m_recordInputsFile << std::endl;
+        }
+
+        delete m_pInputRecordWriter;
+        m_pInputRecordWriter = NULL;
+    }
+
+    for (unsigned int iProfile = 0; iProfile < m_profilePandoraVector.size(); ++iProfile)
+    {
+        streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Processed " << m_profileNEvents[iProfile] << " events with settings profile "
+                               << m_settings.m_profileSettingsXmlFiles[iProfile] << std::endl;
+    }
+
+    PandoraVector allPandoraVector(m_pandoraVector);
+    allPandoraVector.insert(allPandoraVector.end(), m_profilePandoraVector.begin(), m_profilePandoraVector.end());
+
+    for (PandoraVector::const_iterator iter = allPandoraVector.begin(), iterEnd = allPandoraVector.end(); iter != iterEnd; ++iter)
+    {
+        ProfilingAlgorithm::PrintProfile(**iter);
+        ProfilingAlgorithm::ResetProfile(**iter);
+        ParallelReclusteringAlgorithm::ResetWorkers(**iter);
+        delete *iter;
+    }
+
+    delete m_pReclusteringWorkerPool;
+    m_pReclusteringWorkerPool = NULL;
+
+    for (PandoraVector::const_iterator iter = m_reclusteringWorkerVector.begin(), iterEnd = m_reclusteringWorkerVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    delete m_pInstanceThreadPool;
+    m_pInstanceThreadPool = NULL;
+
+    for (PfoCreatorVector::const_iterator iter = m_pfoCreatorVector.begin(), iterEnd = m_pfoCreatorVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    for (PfoCreatorVector::const_iterator iter = m_profilePfoCreatorVector.begin(), iterEnd = m_profilePfoCreatorVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    if (NULL != m_pStageProfiler)
+    {
+        m_pStageProfiler->Print();
+        delete m_pStageProfiler;
+        m_pStageProfiler = NULL;
+    }
+
+    if (NULL != m_pCaloHitCreator)
+        m_pCaloHitCreator->PrintTimingWindowSummary();
+
     delete m_pCaloHitCreator;
     delete m_pTrackCreator;
     delete m_pMCParticleCreator;
-    delete m_pPfoCreator;
+    this->ReleaseGeometrySnapshot();
 
     streamlog_out(MESSAGE) << "PandoraPFANewProcessor - End" << std::endl;
 }
@@ -161,6 +317,7 @@ const pandora::Pandora *PandoraPFANewProcessor::GetPandora() const
 
 const EVENT::LCEvent *PandoraPFANewProcessor::GetCurrentEvent(const pandora::Pandora *const pPandora)
 {
+    std::lock_guard<std::mutex> lock(pandoraToLCEventMapMutex);
     PandoraToLCEventMap::iterator iter = m_pandoraToLCEventMap.find(pPandora);
 
     if (m_pandoraToLCEventMap.end() == iter)
@@ -171,23 +328,376 @@ const EVENT::LCEvent *PandoraPFANewProcessor::GetCurrentEvent(const pandora::Pan
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-pandora::StatusCode PandoraPFANewProcessor::RegisterUserComponents() const
+const CaloHitCreator::CalorimeterHitIndexMap &PandoraPFANewProcessor::GetCalorimeterHitIndexMap(const pandora::Pandora *const pPandora)
 {
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterAlgorithms(*m_pPandora));
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterBasicPlugins(*m_pPandora));
+    std::lock_guard<std::mutex> lock(pandoraToLCEventMapMutex);
+    PandoraToCaloHitCreatorMap::iterator iter = m_pandoraToCaloHitCreatorMap.find(pPandora);
 
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterBFieldPlugin(*m_pPandora,
-        m_settings.m_innerBField, m_settings.m_muonBarrelBField, m_settings.m_muonEndCapBField));
+    if (m_pandoraToCaloHitCreatorMap.end() == iter)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_FOUND);
+
+    return iter->second->GetCalorimeterHitIndexMap();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const CaloHitCreator::SuperCellMemberMap *PandoraPFANewProcessor::GetSuperCellMemberMap(const pandora::Pandora *const pPandora)
+{
+    std::lock_guard<std::mutex> lock(pandoraToLCEventMapMutex);
+    PandoraToCaloHitCreatorMap::iterator iter = m_pandoraToCaloHitCreatorMap.find(pPandora);
+
+    if (m_pandoraToCaloHitCreatorMap.end() == iter)
+        return NULL;
 
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterNonLinearityEnergyCorrection(*m_pPandora,
-        "NonLinearity", pandora::HADRONIC, m_settings.m_inputEnergyCorrectionPoints, m_settings.m_outputEnergyCorrectionPoints));
+    return &(iter->second->GetSuperCellMemberMap());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PandoraPFANewProcessor::RegisterUserComponents(const pandora::Pandora &pandora) const
+{
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, UserComponents::Register(pandora, m_userComponentSettings, *m_pGeometrySnapshot));
 
-    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*m_pPandora,
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
         "ExternalClustering", new ExternalClusteringAlgorithm::Factory));
 
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
+        "ExternalTrackClusterAssociation", new ExternalTrackClusterAssociationAlgorithm::Factory));
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::CreateGeometrySnapshot()
+{
+    // The gear bfield map is only sampled when the field map bfield plugin will use it
+    m_geometryCreatorSettings.m_sampleBFieldMap = m_userComponentSettings.m_useBFieldMap;
+
+    // ATTN The snapshot is only re-used for the same detector, gear file content and geometry creator settings
+    const std::string gearFileHash(PandoraPFANewProcessor::GetGearFileHash());
+
+    if (gearFileHash.empty() && !m_settings.m_geometrySnapshotFile.empty())
+    {
+        streamlog_out(WARNING) << "PandoraPFANewProcessor - Unable to read the gear xml file, the geometry snapshot is matched by detector name "
+                               << "and geometry settings only" << std::endl;
+    }
+
+    std::ostringstream geometryKey;
+    geometryKey << marlin::Global::GEAR->getDetectorName() << " " << gearFileHash
+                << " " << m_geometryCreatorSettings.m_absorberRadLengthECal << " " << m_geometryCreatorSettings.m_absorberIntLengthECal
+                << " " << m_geometryCreatorSettings.m_absorberRadLengthHCal << " " << m_geometryCreatorSettings.m_absorberIntLengthHCal
+                << " " << m_geometryCreatorSettings.m_absorberRadLengthOther << " " << m_geometryCreatorSettings.m_absorberIntLengthOther
+                << " " << m_geometryCreatorSettings.m_eCalEndCapInnerSymmetryOrder << " " << m_geometryCreatorSettings.m_eCalEndCapInnerPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_eCalEndCapOuterSymmetryOrder << " " << m_geometryCreatorSettings.m_eCalEndCapOuterPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_hCalEndCapInnerSymmetryOrder << " " << m_geometryCreatorSettings.m_hCalEndCapInnerPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_hCalEndCapOuterSymmetryOrder << " " << m_geometryCreatorSettings.m_hCalEndCapOuterPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_hCalRingInnerSymmetryOrder << " " << m_geometryCreatorSettings.m_hCalRingInnerPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_hCalRingOuterSymmetryOrder << " " << m_geometryCreatorSettings.m_hCalRingOuterPhiCoordinate
+                << " " << m_geometryCreatorSettings.m_sampleBFieldMap;
+
+    std::lock_guard<std::mutex> lock(geometrySnapshotMapMutex);
+    GeometrySnapshotMap::iterator iter = m_geometrySnapshotMap.find(geometryKey.str());
+
+    if (m_geometrySnapshotMap.end() != iter)
+    {
+        streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Sharing geometry snapshot with another processor" << std::endl;
+        ++(iter->second.second);
+        m_pGeometrySnapshot = iter->second.first;
+        return;
+    }
+
+    GeometrySnapshot *const pGeometrySnapshot = new GeometrySnapshot(geometryKey.str());
+
+    if (!m_settings.m_geometrySnapshotFile.empty() && (pandora::STATUS_CODE_SUCCESS == pGeometrySnapshot->Read(m_settings.m_geometrySnapshotFile)))
+    {
+        streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Read geometry snapshot " << m_settings.m_geometrySnapshotFile << std::endl;
+    }
+    else
+    {
+        try
+        {
+            const GeometryCreator geometryCreator(m_geometryCreatorSettings);
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, geometryCreator.CreateGeometry(*pGeometrySnapshot));
+        }
+        catch (...)
+        {
+            delete pGeometrySnapshot;
+            throw;
+        }
+
+        // ATTN A failure to write the snapshot is not fatal: the derived geometry is already available to this job
+        if (!m_settings.m_geometrySnapshotFile.empty() && (pandora::STATUS_CODE_SUCCESS == pGeometrySnapshot->Write(m_settings.m_geometrySnapshotFile)))
+            streamlog_out(MESSAGE) << "PandoraPFANewProcessor - Wrote geometry snapshot " << m_settings.m_geometrySnapshotFile << std::endl;
+    }
+
+    (void) m_geometrySnapshotMap.insert(GeometrySnapshotMap::value_type(geometryKey.str(), GeometrySnapshotReference(pGeometrySnapshot, 1)));
+    m_pGeometrySnapshot = pGeometrySnapshot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string PandoraPFANewProcessor::GetGearFileHash()
+{
+    if (NULL == marlin::Global::parameters)
+        return std::string();
+
+    std::ifstream gearFile(marlin::Global::parameters->getStringVal("GearXMLFile").c_str(), std::ios::in | std::ios::binary);
+
+    if (!gearFile.is_open())
+        return std::string();
+
+    std::ostringstream gearFileContent;
+    gearFileContent << gearFile.rdbuf();
+    const std::string content(gearFileContent.str());
+
+    std::ostringstream gearFileHash;
+    gearFileHash << std::hex << CalculateFnv1aHash(content.data(), content.size());
+    return gearFileHash.str();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::ReleaseGeometrySnapshot()
+{
+    if (NULL == m_pGeometrySnapshot)
+        return;
+
+    std::lock_guard<std::mutex> lock(geometrySnapshotMapMutex);
+    GeometrySnapshotMap::iterator iter = m_geometrySnapshotMap.find(m_pGeometrySnapshot->GetGeometryKey());
+
+    if ((m_geometrySnapshotMap.end() == iter) || (0 == iter->second.second))
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+    if (0 == --(iter->second.second))
+    {
+        delete iter->second.first;
+        m_geometrySnapshotMap.erase(iter);
+    }
+
+    m_pGeometrySnapshot = NULL;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::CreatePandoraInstances()
+{
+    const unsigned int nAdditionalInstances(m_settings.m_additionalSettingsXmlFiles.size());
+
+    if ((nAdditionalInstances != m_settings.m_additionalClusterCollections.size()) ||
+        (nAdditionalInstances != m_settings.m_additionalPfoCollections.size()) ||
+        (nAdditionalInstances != m_settings.m_additionalStartVertexCollections.size()))
+    {
+        streamlog_out(ERROR) << "Each additional pandora settings xml file requires a cluster, pfo and start vertex collection name" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    m_pPandora = new pandora::Pandora();
+    m_pandoraVector.push_back(m_pPandora);
+    m_pfoCreatorVector.push_back(new PfoCreator(m_pfoCreatorSettings, m_pPandora));
+
+    for (unsigned int iInstance = 0; iInstance < nAdditionalInstances; ++iInstance)
+    {
+        PfoCreator::Settings pfoCreatorSettings(m_pfoCreatorSettings);
+        pfoCreatorSettings.m_clusterCollectionName = m_settings.m_additionalClusterCollections[iInstance];
+        pfoCreatorSettings.m_pfoCollectionName = m_settings.m_additionalPfoCollections[iInstance];
+        pfoCreatorSettings.m_startVertexCollectionName = m_settings.m_additionalStartVertexCollections[iInstance];
+
+        pandora::Pandora *const pPandora = new pandora::Pandora();
+        m_pandoraVector.push_back(pPandora);
+        m_pfoCreatorVector.push_back(new PfoCreator(pfoCreatorSettings, pPandora));
+    }
+
+    // Settings profiles replace the primary instance for selected events, so write to the primary output collections
+    const unsigned int nProfiles(m_settings.m_profileSettingsXmlFiles.size());
+
+    if ((nProfiles != m_settings.m_profileMinCaloHits.size()) || (nProfiles != m_settings.m_profileMinTracks.size()) ||
+        (nProfiles != m_settings.m_profileMinCaloHitEnergy.size()))
+    {
+        streamlog_out(ERROR) << "Each settings profile xml file requires a min number of calo hits, min number of tracks and min calo hit energy"
+                             << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    for (unsigned int iProfile = 0; iProfile < nProfiles; ++iProfile)
+    {
+        pandora::Pandora *const pPandora = new pandora::Pandora();
+        m_profilePandoraVector.push_back(pPandora);
+        m_profilePfoCreatorVector.push_back(new PfoCreator(m_pfoCreatorSettings, pPandora));
+    }
+
+    m_profileNEvents.assign(nProfiles, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::InitialisePandoraInstance(const pandora::Pandora &pandora, const std::string &settingsXmlFile)
+{
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->RegisterUserComponents(pandora));
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pGeometrySnapshot->CreatePandoraGeometry(pandora));
+
+    // ATTN The worker pool must be passed to the parallel reclustering algorithms before they are created by reading the settings
+    if (NULL != m_pReclusteringWorkerPool)
+        ParallelReclusteringAlgorithm::SetWorkers(pandora, m_pReclusteringWorkerPool);
+
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(pandora, settingsXmlFile));
+
+    if (0 != m_settings.m_profileHardwareCounters)
+        ProfilingAlgorithm::EnableHardwareCounters(pandora);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::CreateReclusteringWorkers()
+{
+    if (m_settings.m_reclusteringSettingsXmlFile.empty())
+        return;
+
+    if (m_settings.m_nReclusteringWorkers <= 0)
+    {
+        streamlog_out(ERROR) << "The reclustering settings xml file requires a positive number of reclustering workers" << std::endl;
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    for (int iWorker = 0; iWorker < m_settings.m_nReclusteringWorkers; ++iWorker)
+    {
+        pandora::Pandora *const pWorker = new pandora::Pandora();
+        m_reclusteringWorkerVector.push_back(pWorker);
+
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->RegisterUserComponents(*pWorker));
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pGeometrySnapshot->CreatePandoraGeometry(*pWorker));
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pWorker, m_settings.m_reclusteringSettingsXmlFile));
+    }
+
+    m_pReclusteringWorkerPool = new ReclusteringWorkerPool(ReclusteringWorkerPool::PandoraVector(m_reclusteringWorkerVector.begin(),
+        m_reclusteringWorkerVector.end()));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::SelectEventPandoraInstances()
+{
+    m_eventPandoraVector = m_pandoraVector;
+    m_eventPfoCreatorVector = m_pfoCreatorVector;
+
+    if (m_profilePandoraVector.empty())
+        return;
+
+    const CaloHitCreator::CaloHitParametersVector &caloHitParametersVector(m_pCaloHitCreator->GetCaloHitParametersVector());
+    const unsigned int nCaloHits(caloHitParametersVector.size());
+    const unsigned int nTracks(m_pTrackCreator->GetTrackVector().size());
+    float caloHitEnergy(0.f);
+
+    for (CaloHitCreator::CaloHitParametersVector::const_iterator iter = caloHitParametersVector.begin(), iterEnd = caloHitParametersVector.end();
+        iter != iterEnd; ++iter)
+    {
+        caloHitEnergy += iter->m_inputEnergy.Get();
+    }
+
+    for (unsigned int iProfile = 0; iProfile < m_profilePandoraVector.size(); ++iProfile)
+    {
+        const int minCaloHits(m_settings.m_profileMinCaloHits[iProfile]);
+        const int minTracks(m_settings.m_profileMinTracks[iProfile]);
+        const float minCaloHitEnergy(m_settings.m_profileMinCaloHitEnergy[iProfile]);
+
+        if (((minCaloHits > 0) && (nCaloHits >= static_cast<unsigned int>(minCaloHits))) ||
+            ((minTracks > 0) && (nTracks >= static_cast<unsigned int>(minTracks))) ||
+            ((minCaloHitEnergy > 0.f) && (caloHitEnergy >= minCaloHitEnergy)))
+        {
+            streamlog_out(DEBUG) << "PandoraPFANewProcessor - Event with " << nCaloHits << " calo hits, " << nTracks << " tracks and "
+                                 << caloHitEnergy << " GeV calo hit energy, using settings profile " << m_settings.m_profileSettingsXmlFiles[iProfile]
+                                 << std::endl;
+
+            m_eventPandoraVector.front() = m_profilePandoraVector[iProfile];
+            m_eventPfoCreatorVector.front() = m_profilePfoCreatorVector[iProfile];
+            ++m_profileNEvents[iProfile];
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::CreateInstanceThreadPool()
+{
+    // ATTN The threads persist for the whole job, so per thread state, e.g. the hardware counter groups, is not recreated for each event
+    if ((m_pandoraVector.size() > 1) && (0 != m_settings.m_processInstancesConcurrently))
+        m_pInstanceThreadPool = new PersistentThreadPool(m_pandoraVector.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PandoraPFANewProcessor::ProcessPandoraInstances() const
+{
+    const unsigned int nInstances(m_eventPandoraVector.size());
+    std::vector<pandora::StatusCode> statusCodeVector(nInstances, pandora::STATUS_CODE_FAILURE);
+
+    if (NULL != m_pInstanceThreadPool)
+    {
+        // ATTN Input objects are only read from the creators here, so can be shared between threads; pandora instances are independent
+        InstanceTask instanceTask(this, statusCodeVector);
+        m_pInstanceThreadPool->Run(instanceTask);
+    }
+    else
+    {
+        for (unsigned int iInstance = 0; iInstance < nInstances; ++iInstance)
+            this->ProcessPandoraInstance(m_eventPandoraVector[iInstance], &statusCodeVector[iInstance]);
+    }
+
+    for (std::vector<pandora::StatusCode>::const_iterator iter = statusCodeVector.begin(), iterEnd = statusCodeVector.end(); iter != iterEnd; ++iter)
+    {
+        if (pandora::STATUS_CODE_SUCCESS != *iter)
+            return *iter;
+    }
+
     return pandora::STATUS_CODE_SUCCESS;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::ProcessPandoraInstance(const pandora::Pandora *const pPandora, pandora::StatusCode *const pStatusCode) const
+{
+    try
+    {
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pTrackCreator->CreatePandoraTracks(*pPandora));
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pCaloHitCreator->CreatePandoraCaloHits(*pPandora));
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, m_pMCParticleCreator->CreatePandoraMCParticles(*pPandora));
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPandora));
+        *pStatusCode = pandora::STATUS_CODE_SUCCESS;
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        *pStatusCode = statusCodeException.GetStatusCode();
+    }
+    catch (...)
+    {
+        *pStatusCode = pandora::STATUS_CODE_FAILURE;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::CreateInputRecordWriter()
+{
+    if (m_settings.m_recordInputsFile.empty())
+        return;
+
+    InputRecordHeader header;
+    header.m_geometryKey = m_pGeometrySnapshot->GetGeometryKey();
+    header.m_userComponentSettings = m_userComponentSettings;
+
+    m_pInputRecordWriter = new InputRecordWriter(header);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PandoraPFANewProcessor::RecordInputs(const EVENT::LCEvent *const pLCEvent) const
+{
+    InputRecord inputRecord;
+    inputRecord.Fill(pLCEvent->getRunNumber(), pLCEvent->getEventNumber(), *m_pCaloHitCreator, *m_pTrackCreator, *m_pMCParticleCreator);
+    m_pInputRecordWriter->AddEvent(inputRecord);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -198,6 +708,16 @@ void PandoraPFANewProcessor::ProcessSteeringFile()
                             m_settings.m_pandoraSettingsXmlFile,
                             std::string());
 
+    registerProcessorParameter("GeometrySnapshotFile",
+                            "Binary geometry snapshot: read if present and valid, otherwise written after deriving the geometry from gear",
+                            m_settings.m_geometrySnapshotFile,
+                            std::string());
+
+    registerProcessorParameter("RecordInputsFile",
+                            "Binary file to which the pandora inputs for each event are recorded, for replay without lcio or gear",
+                            m_settings.m_recordInputsFile,
+                            std::string());
+
     // Input collections
     registerInputCollections(LCIO::TRACK,
                             "TrackCollections", 
@@ -419,6 +939,78 @@ void PandoraPFANewProcessor::ProcessSteeringFile()
                             m_caloHitCreatorSettings.m_maxHCalHitHadronicEnergy,
                             float(10000.));
 
+    // Timing windows, applied to calo hit times corrected for the straight line time of flight from the interaction point
+    registerProcessorParameter("ApplyTimingWindows",
+                            "Whether to reject calo hits outside the time of flight corrected timing windows",
+                            m_caloHitCreatorSettings.m_applyTimingWindows,
+                            int(0));
+
+    registerProcessorParameter("ECalTimeWindowMin",
+                            "Min time of flight corrected time for ecal hits, units ns",
+                            m_caloHitCreatorSettings.m_eCalTimeWindowMin,
+                            float(-10.));
+
+    registerProcessorParameter("ECalTimeWindowMax",
+                            "Max time of flight corrected time for ecal hits, units ns",
+                            m_caloHitCreatorSettings.m_eCalTimeWindowMax,
+                            float(100.));
+
+    registerProcessorParameter("HCalTimeWindowMin",
+                            "Min time of flight corrected time for hcal hits, units ns",
+                            m_caloHitCreatorSettings.m_hCalTimeWindowMin,
+                            float(-10.));
+
+    registerProcessorParameter("HCalTimeWindowMax",
+                            "Max time of flight corrected time for hcal hits, units ns",
+                            m_caloHitCreatorSettings.m_hCalTimeWindowMax,
+                            float(100.));
+
+    registerProcessorParameter("MuonTimeWindowMin",
+                            "Min time of flight corrected time for muon hits, units ns",
+                            m_caloHitCreatorSettings.m_muonTimeWindowMin,
+                            float(-10.));
+
+    registerProcessorParameter("MuonTimeWindowMax",
+                            "Max time of flight corrected time for muon hits, units ns",
+                            m_caloHitCreatorSettings.m_muonTimeWindowMax,
+                            float(100.));
+
+    registerProcessorParameter("ForwardTimeWindowMin",
+                            "Min time of flight corrected time for lcal and lhcal hits, units ns",
+                            m_caloHitCreatorSettings.m_forwardTimeWindowMin,
+                            float(-10.));
+
+    registerProcessorParameter("ForwardTimeWindowMax",
+                            "Max time of flight corrected time for lcal and lhcal hits, units ns",
+                            m_caloHitCreatorSettings.m_forwardTimeWindowMax,
+                            float(100.));
+
+    // Forward calorimeter coarsening, merging neighbouring lcal and lhcal cells into super-cells before pandora calo hit creation
+    registerProcessorParameter("CoarsenForwardHits",
+                            "Whether to merge neighbouring lcal and lhcal cells into super-cells, conserving energy",
+                            m_caloHitCreatorSettings.m_coarsenForwardHits,
+                            int(0));
+
+    registerProcessorParameter("LCalCoarseningFactors",
+                            "LCal super-cell size, in cells, per layer; the last entry applies to all deeper layers",
+                            m_caloHitCreatorSettings.m_lCalCoarseningFactors,
+                            IntVector(1, 2));
+
+    registerProcessorParameter("LHCalCoarseningFactors",
+                            "LHCal super-cell size, in cells, per layer; the last entry applies to all deeper layers",
+                            m_caloHitCreatorSettings.m_lHCalCoarseningFactors,
+                            IntVector(1, 2));
+
+    registerProcessorParameter("SortCaloHitsSpatially",
+                            "Whether to create calo hits ordered by hit type, layer and Morton code of position, for spatially coherent storage",
+                            m_caloHitCreatorSettings.m_sortCaloHitsSpatially,
+                            int(0));
+
+    registerProcessorParameter("SpatialSortCellSize",
+                            "The cell size used to quantise calo hit positions for the Morton code, units mm",
+                            m_caloHitCreatorSettings.m_spatialSortCellSize,
+                            float(10.));
+
     registerProcessorParameter("NOuterSamplingLayers",
                             "Number of layers from edge for hit to be flagged as an outer layer hit",
                             m_caloHitCreatorSettings.m_nOuterSamplingLayers,
@@ -432,14 +1024,25 @@ void PandoraPFANewProcessor::ProcessSteeringFile()
     // B-field parameters
     registerProcessorParameter("MuonBarrelBField",
                             "The bfield in the muon barrel, units Tesla",
-                            m_settings.m_muonBarrelBField,
+                            m_userComponentSettings.m_muonBarrelBField,
                             float(-1.5f));
 
     registerProcessorParameter("MuonEndCapBField",
                             "The bfield in the muon endcap, units Tesla",
-                            m_settings.m_muonEndCapBField,
+                            m_userComponentSettings.m_muonEndCapBField,
                             float(0.01f));
 
+    registerProcessorParameter("UseBFieldMap",
+                            "Whether to interpolate the bfield in an (r, z) grid sampled from the gear field map, instead of using constant regions",
+                            m_userComponentSettings.m_useBFieldMap,
+                            int(0));
+
+    // Pseudo layer parameters
+    registerProcessorParameter("UseTablePseudoLayerPlugin",
+                            "Whether to assign pseudo layers using precomputed polygon sector and layer position tables",
+                            m_userComponentSettings.m_useTablePseudoLayerPlugin,
+                            int(0));
+
     // Track relationship parameters
     registerProcessorParameter("ShouldFormTrackRelationships",
                             "Whether to form pandora track relationships using v0 and kink info",
@@ -722,13 +1325,87 @@ void PandoraPFANewProcessor::ProcessSteeringFile()
     // Hadronic energy non-linearity correction
     registerProcessorParameter("InputEnergyCorrectionPoints",
                             "The input energy points for hadronic energy correction",
-                            m_settings.m_inputEnergyCorrectionPoints,
+                            m_userComponentSettings.m_inputEnergyCorrectionPoints,
                             FloatVector());
 
     registerProcessorParameter("OutputEnergyCorrectionPoints",
                             "The output energy points for hadronic energy correction",
-                            m_settings.m_outputEnergyCorrectionPoints,
+                            m_userComponentSettings.m_outputEnergyCorrectionPoints,
                             FloatVector());
+
+    registerProcessorParameter("NonLinearityGridPoints",
+                            "If non-zero, resample the hadronic energy correction onto this number of uniform grid points, for constant-time lookup",
+                            m_userComponentSettings.m_nNonLinearityGridPoints,
+                            int(0));
+
+    // Additional pandora instances, fed the same input objects as the primary instance
+    registerProcessorParameter("AdditionalPandoraSettingsXmlFiles",
+                            "Settings xml files for additional pandora instances, each processing the same input objects",
+                            m_settings.m_additionalSettingsXmlFiles,
+                            StringVector());
+
+    registerProcessorParameter("AdditionalClusterCollectionNames",
+                            "Cluster collection names for the additional pandora instances",
+                            m_settings.m_additionalClusterCollections,
+                            StringVector());
+
+    registerProcessorParameter("AdditionalPFOCollectionNames",
+                            "PFO collection names for the additional pandora instances",
+                            m_settings.m_additionalPfoCollections,
+                            StringVector());
+
+    registerProcessorParameter("AdditionalStartVertexCollectionNames",
+                            "Start vertex collection names for the additional pandora instances",
+                            m_settings.m_additionalStartVertexCollections,
+                            StringVector());
+
+    registerProcessorParameter("ProcessInstancesConcurrently",
+                            "Whether to process the pandora instances concurrently, one thread per instance; logging from the instances is then interleaved",
+                            m_settings.m_processInstancesConcurrently,
+                            int(0));
+
+    // Reclustering worker pandora instances, evaluating reclustering candidates concurrently for the ParallelReclustering algorithm
+    registerProcessorParameter("ReclusteringSettingsXmlFile",
+                            "Settings xml file for the reclustering worker pandora instances, containing a ReclusteringCandidate algorithm",
+                            m_settings.m_reclusteringSettingsXmlFile,
+                            std::string());
+
+    registerProcessorParameter("NReclusteringWorkers",
+                            "The number of reclustering worker pandora instances, and so threads, shared by all pandora instances",
+                            m_settings.m_nReclusteringWorkers,
+                            int(4));
+
+    // Settings profiles, replacing the primary pandora instance for events whose input objects reach the profile thresholds
+    registerProcessorParameter("ProfileSettingsXmlFiles",
+                            "Settings xml files for alternative primary pandora instances, the first whose thresholds are reached is used for each event",
+                            m_settings.m_profileSettingsXmlFiles,
+                            StringVector());
+
+    registerProcessorParameter("ProfileMinCaloHits",
+                            "For each settings profile, the min number of calo hits to select the profile, zero to ignore",
+                            m_settings.m_profileMinCaloHits,
+                            IntVector());
+
+    registerProcessorParameter("ProfileMinTracks",
+                            "For each settings profile, the min number of tracks to select the profile, zero to ignore",
+                            m_settings.m_profileMinTracks,
+                            IntVector());
+
+    registerProcessorParameter("ProfileMinCaloHitEnergy",
+                            "For each settings profile, the min total calo hit energy (GeV) to select the profile, zero to ignore",
+                            m_settings.m_profileMinCaloHitEnergy,
+                            FloatVector());
+
+    // Instrumentation, printing per event distributions of the wall time and heap allocations of each stage at the end of the job
+    registerProcessorParameter("ProfileStages",
+                            "Whether to profile each processEvent stage; allocations are counted only if built with PROFILE_ALLOCATIONS",
+                            m_settings.m_profileStages,
+                            int(0));
+
+    registerProcessorParameter("ProfileHardwareCounters",
+                            "Whether to sum cpu cycles, instructions, cache and branch misses over each processEvent stage and profiled algorithm",
+                            m_settings.m_profileHardwareCounters,
+                            int(0));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -736,7 +1413,7 @@ void PandoraPFANewProcessor::ProcessSteeringFile()
 void PandoraPFANewProcessor::FinaliseSteeringParameters()
 {
     // ATTN: This function seems to be necessary for operations that cannot easily be performed at construction of the processor,
-    // when the steering file is parsed e.g. the call to GEAR to get the inner bfield
+    // when the steering file is parsed e.g. the call to GEAR (now via the geometry snapshot) to get the inner bfield
     m_caloHitCreatorSettings.m_absorberRadLengthECal = m_geometryCreatorSettings.m_absorberRadLengthECal;
     m_caloHitCreatorSettings.m_absorberIntLengthECal = m_geometryCreatorSettings.m_absorberIntLengthECal;
     m_caloHitCreatorSettings.m_absorberRadLengthHCal = m_geometryCreatorSettings.m_absorberRadLengthHCal;
@@ -751,7 +1428,7 @@ void PandoraPFANewProcessor::FinaliseSteeringParameters()
     m_trackCreatorSettings.m_prongSplitVertexCollections.insert(m_trackCreatorSettings.m_prongSplitVertexCollections.end(),
         m_trackCreatorSettings.m_splitVertexCollections.begin(), m_trackCreatorSettings.m_splitVertexCollections.end());
 
-    m_settings.m_innerBField = marlin::Global::GEAR->getBField().at(gear::Vector3D(0., 0., 0.)).z();
+    m_userComponentSettings.m_innerBField = m_pGeometrySnapshot->GetConstant("InnerBField");
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -760,21 +1437,49 @@ void PandoraPFANewProcessor::Reset()
 {
     m_pCaloHitCreator->Reset();
     m_pTrackCreator->Reset();
+    m_pMCParticleCreator->Reset();
 
-    PandoraToLCEventMap::iterator iter = m_pandoraToLCEventMap.find(m_pPandora);
+    std::lock_guard<std::mutex> lock(pandoraToLCEventMapMutex);
 
-    if (m_pandoraToLCEventMap.end() == iter)
-        throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+    for (PandoraVector::const_iterator pandoraIter = m_eventPandoraVector.begin(), pandoraIterEnd = m_eventPandoraVector.end();
+        pandoraIter != pandoraIterEnd; ++pandoraIter)
+    {
+        PandoraToLCEventMap::iterator iter = m_pandoraToLCEventMap.find(*pandoraIter);
+
+        if (m_pandoraToLCEventMap.end() == iter)
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+        m_pandoraToLCEventMap.erase(iter);
+        m_pandoraToCaloHitCreatorMap.erase(*pandoraIter);
+
+        ExternalClusteringAlgorithm::ResetCaloHitIndex(**pandoraIter);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PandoraPFANewProcessor::InstanceTask::InstanceTask(const PandoraPFANewProcessor *const pProcessor,
+        std::vector<pandora::StatusCode> &statusCodeVector) :
+    m_pProcessor(pProcessor),
+    m_statusCodeVector(statusCodeVector)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    m_pandoraToLCEventMap.erase(iter);
+void PandoraPFANewProcessor::InstanceTask::Run(const unsigned int threadIndex)
+{
+    m_pProcessor->ProcessPandoraInstance(m_pProcessor->m_eventPandoraVector[threadIndex], &m_statusCodeVector[threadIndex]);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 PandoraPFANewProcessor::Settings::Settings() :
-    m_innerBField(3.5f),
-    m_muonBarrelBField(-1.5f),
-    m_muonEndCapBField(0.01f)
+    m_processInstancesConcurrently(0),
+    m_nReclusteringWorkers(4),
+    m_profileStages(0),
+    m_profileHardwareCounters(0)
 {
 }
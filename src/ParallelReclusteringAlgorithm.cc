@@ -0,0 +1,423 @@
+/**
+ *  @file   MarlinPandora/src/ParallelReclusteringAlgorithm.cc
+ *
+ *  @brief  Implementation of the parallel reclustering algorithm class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "ParallelReclusteringAlgorithm.h"
+
+#include <algorithm>
+
+using namespace pandora;
+
+ParallelReclusteringAlgorithm::WorkerMap ParallelReclusteringAlgorithm::m_workerMap;
+
+static std::mutex workerMapMutex;
+
+/**
+ *  @brief  EvaluationTask class, evaluating the reclustering candidates of a cluster, one worker per thread of the worker pool
+ */
+class ParallelReclusteringAlgorithm::EvaluationTask : public PersistentThreadPool::Task
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  workerVector the worker pandora instances
+     *  @param  nWorkers the number of workers to use
+     *  @param  hadronicEnergyResolution the stochastic hadronic energy resolution
+     *  @param  caloHitParametersVector the calo hit parameters for the cluster
+     *  @param  trackParametersVector the track parameters for the cluster
+     *  @param  resultVector to receive the results, one per candidate
+     *  @param  statusCodeVector to receive the status code for each worker used
+     */
+    EvaluationTask(const PandoraVector &workerVector, const unsigned int nWorkers, const float hadronicEnergyResolution,
+        const CaloHitParametersVector &caloHitParametersVector, const TrackParametersVector &trackParametersVector, ResultVector &resultVector,
+        StatusCodeVector &statusCodeVector);
+
+    void Run(const unsigned int threadIndex);
+
+private:
+    const PandoraVector            &m_workerVector;             ///< The worker pandora instances
+    const unsigned int              m_nWorkers;                 ///< The number of workers to use
+    const float                     m_hadronicEnergyResolution; ///< The stochastic hadronic energy resolution
+    const CaloHitParametersVector  &m_caloHitParametersVector;  ///< The calo hit parameters for the cluster
+    const TrackParametersVector    &m_trackParametersVector;    ///< The track parameters for the cluster
+    ResultVector                   &m_resultVector;             ///< The results, one per candidate
+    StatusCodeVector               &m_statusCodeVector;         ///< The status code for each worker used
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ReclusteringWorkerPool::ReclusteringWorkerPool(const PandoraVector &workerVector) :
+    m_workerVector(workerVector),
+    m_threadPool(workerVector.size())
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::SetWorkers(const Pandora &pandora, ReclusteringWorkerPool *const pWorkerPool)
+{
+    std::lock_guard<std::mutex> lock(workerMapMutex);
+    m_workerMap[&pandora] = pWorkerPool;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::ResetWorkers(const Pandora &pandora)
+{
+    std::lock_guard<std::mutex> lock(workerMapMutex);
+    m_workerMap.erase(&pandora);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ParallelReclusteringAlgorithm::ParallelReclusteringAlgorithm() :
+    m_pWorkerPool(NULL),
+    m_nCandidates(0),
+    m_minChiToRecluster(3.f),
+    m_hadronicEnergyResolution(0.6f),
+    m_minCaloHitsToRecluster(10)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ParallelReclusteringAlgorithm::Initialize()
+{
+    {
+        std::lock_guard<std::mutex> lock(workerMapMutex);
+        WorkerMap::const_iterator iter = m_workerMap.find(&(this->GetPandora()));
+
+        if (m_workerMap.end() != iter)
+            m_pWorkerPool = iter->second;
+    }
+
+    if ((NULL == m_pWorkerPool) || m_pWorkerPool->GetWorkerVector().empty())
+    {
+        streamlog_out(ERROR) << "ParallelReclusteringAlgorithm - No reclustering worker pandora instances have been provided" << std::endl;
+        return STATUS_CODE_NOT_INITIALIZED;
+    }
+
+    const PandoraVector &workerVector(m_pWorkerPool->GetWorkerVector());
+
+    for (PandoraVector::const_iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+    {
+        const ReclusteringCandidateAlgorithm *const pCandidateAlgorithm(ReclusteringCandidateAlgorithm::GetAlgorithm(**iter));
+
+        if ((NULL == pCandidateAlgorithm) || (0 == pCandidateAlgorithm->GetNCandidates()) ||
+            ((0 != m_nCandidates) && (m_nCandidates != pCandidateAlgorithm->GetNCandidates())))
+        {
+            streamlog_out(ERROR) << "ParallelReclusteringAlgorithm - Each worker requires a ReclusteringCandidate algorithm, listing the same candidates"
+                                 << std::endl;
+            return STATUS_CODE_INVALID_PARAMETER;
+        }
+
+        m_nCandidates = pCandidateAlgorithm->GetNCandidates();
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ParallelReclusteringAlgorithm::Run()
+{
+    const ClusterList *pClusterList = NULL;
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentList(*this, pClusterList));
+
+    // ATTN Reclustered clusters are removed from the current list, so iterate over a copy
+    const ClusterVector clusterVector(pClusterList->begin(), pClusterList->end());
+
+    for (ClusterVector::const_iterator iter = clusterVector.begin(), iterEnd = clusterVector.end(); iter != iterEnd; ++iter)
+    {
+        const pandora::Cluster *const pCluster = *iter;
+
+        if (pCluster->GetAssociatedTrackList().empty() || (pCluster->GetNCaloHits() < m_minCaloHitsToRecluster))
+            continue;
+
+        const float originalChi(ReclusteringCandidateAlgorithm::GetTrackClusterChi(this->GetPandora(), pCluster, m_hadronicEnergyResolution));
+
+        if (originalChi < m_minChiToRecluster)
+            continue;
+
+        ResultVector resultVector;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, this->EvaluateCandidates(pCluster, resultVector));
+
+        // The original cluster is a single track-associated cluster, so its chi2 per dof is simply chi2
+        const ReclusteringCandidateAlgorithm::Result *pBestResult = NULL;
+        float bestChi2PerDof(originalChi * originalChi);
+
+        for (ResultVector::const_iterator resultIter = resultVector.begin(), resultIterEnd = resultVector.end(); resultIter != resultIterEnd; ++resultIter)
+        {
+            if (resultIter->IsValid() && (resultIter->GetChi2PerDof() < bestChi2PerDof))
+            {
+                pBestResult = &(*resultIter);
+                bestChi2PerDof = resultIter->GetChi2PerDof();
+            }
+        }
+
+        if (NULL != pBestResult)
+            PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, this->ReplaceCluster(pCluster, *pBestResult));
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ParallelReclusteringAlgorithm::EvaluateCandidates(const pandora::Cluster *const pCluster, ResultVector &resultVector) const
+{
+    CaloHitList caloHitList;
+    pCluster->GetOrderedCaloHitList().FillCaloHitList(caloHitList);
+    const CaloHitList &isolatedCaloHitList(pCluster->GetIsolatedCaloHitList());
+    caloHitList.insert(caloHitList.end(), isolatedCaloHitList.begin(), isolatedCaloHitList.end());
+
+    CaloHitParametersVector caloHitParametersVector(caloHitList.size());
+    unsigned int iCaloHit(0);
+
+    for (CaloHitList::const_iterator iter = caloHitList.begin(), iterEnd = caloHitList.end(); iter != iterEnd; ++iter)
+        ParallelReclusteringAlgorithm::CopyCaloHit(*iter, caloHitParametersVector[iCaloHit++]);
+
+    const TrackList &trackList(pCluster->GetAssociatedTrackList());
+    TrackParametersVector trackParametersVector(trackList.size());
+    unsigned int iTrack(0);
+
+    for (TrackList::const_iterator iter = trackList.begin(), iterEnd = trackList.end(); iter != iterEnd; ++iter)
+        ParallelReclusteringAlgorithm::CopyTrack(*iter, trackParametersVector[iTrack++]);
+
+    // ATTN The worker pool may be shared by pandora instances processed concurrently, so only one instance may use it at a time
+    std::lock_guard<std::mutex> lock(m_pWorkerPool->GetMutex());
+
+    // ATTN Each worker evaluates every nWorkers-th candidate, writing only to the corresponding elements of the result vector
+    resultVector.assign(m_nCandidates, ReclusteringCandidateAlgorithm::Result());
+    const unsigned int nWorkers(std::min(static_cast<unsigned int>(m_pWorkerPool->GetWorkerVector().size()), m_nCandidates));
+    StatusCodeVector statusCodeVector(nWorkers, STATUS_CODE_FAILURE);
+
+    EvaluationTask evaluationTask(m_pWorkerPool->GetWorkerVector(), nWorkers, m_hadronicEnergyResolution, caloHitParametersVector,
+        trackParametersVector, resultVector, statusCodeVector);
+    m_pWorkerPool->GetThreadPool().Run(evaluationTask);
+
+    for (StatusCodeVector::const_iterator iter = statusCodeVector.begin(), iterEnd = statusCodeVector.end(); iter != iterEnd; ++iter)
+    {
+        if (STATUS_CODE_SUCCESS != *iter)
+            return *iter;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::EvaluateWorkerCandidates(const Pandora *const pWorker, const unsigned int firstCandidate,
+    const unsigned int candidateStride, const float hadronicEnergyResolution, const CaloHitParametersVector *const pCaloHitParametersVector,
+    const TrackParametersVector *const pTrackParametersVector, ResultVector *const pResultVector, StatusCode *const pStatusCode)
+{
+    ReclusteringCandidateAlgorithm *const pCandidateAlgorithm(ReclusteringCandidateAlgorithm::GetAlgorithm(*pWorker));
+
+    try
+    {
+        if (NULL == pCandidateAlgorithm)
+            throw StatusCodeException(STATUS_CODE_NOT_INITIALIZED);
+
+        for (unsigned int iCandidate = firstCandidate; iCandidate < pResultVector->size(); iCandidate += candidateStride)
+        {
+            for (TrackParametersVector::const_iterator iter = pTrackParametersVector->begin(), iterEnd = pTrackParametersVector->end(); iter != iterEnd; ++iter)
+                PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Track::Create(*pWorker, *iter));
+
+            for (CaloHitParametersVector::const_iterator iter = pCaloHitParametersVector->begin(), iterEnd = pCaloHitParametersVector->end(); iter != iterEnd; ++iter)
+                PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*pWorker, *iter));
+
+            pCandidateAlgorithm->SetCandidate(iCandidate, hadronicEnergyResolution, &(pResultVector->at(iCandidate)));
+            const StatusCode statusCode(PandoraApi::ProcessEvent(*pWorker));
+            pCandidateAlgorithm->SetCandidate(0, hadronicEnergyResolution, NULL);
+
+            PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pWorker));
+
+            // ATTN A candidate that fails is simply not selected
+            if (STATUS_CODE_SUCCESS != statusCode)
+                pResultVector->at(iCandidate) = ReclusteringCandidateAlgorithm::Result();
+        }
+
+        *pStatusCode = STATUS_CODE_SUCCESS;
+        return;
+    }
+    catch (StatusCodeException &statusCodeException)
+    {
+        *pStatusCode = statusCodeException.GetStatusCode();
+    }
+    catch (...)
+    {
+        // ATTN Run on a pool thread, where an escaping exception would terminate the job
+        *pStatusCode = STATUS_CODE_FAILURE;
+    }
+
+    // ATTN The parent addresses of any hits and tracks left in the worker belong to the current event, so must not reach the next evaluation
+    try
+    {
+        if (NULL != pCandidateAlgorithm)
+            pCandidateAlgorithm->SetCandidate(0, hadronicEnergyResolution, NULL);
+
+        if (STATUS_CODE_SUCCESS != PandoraApi::Reset(*pWorker))
+            streamlog_out(ERROR) << "ParallelReclusteringAlgorithm - Failed to reset a worker pandora instance" << std::endl;
+    }
+    catch (...)
+    {
+        streamlog_out(ERROR) << "ParallelReclusteringAlgorithm - Failed to reset a worker pandora instance" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ParallelReclusteringAlgorithm::ReplaceCluster(const pandora::Cluster *const pCluster, const ReclusteringCandidateAlgorithm::Result &result) const
+{
+    std::string originalClusterListName;
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentListName<pandora::Cluster>(*this, originalClusterListName));
+
+    const TrackList trackList(pCluster->GetAssociatedTrackList());
+
+    for (TrackList::const_iterator iter = trackList.begin(), iterEnd = trackList.end(); iter != iterEnd; ++iter)
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::RemoveTrackClusterAssociation(*this, *iter, pCluster));
+
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Delete(*this, pCluster));
+
+    const ClusterList *pTemporaryClusterList = NULL;
+    std::string temporaryClusterListName;
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::CreateTemporaryListAndSetCurrent(*this, pTemporaryClusterList,
+        temporaryClusterListName));
+
+    for (ReclusteringCandidateAlgorithm::CandidateClusterVector::const_iterator iter = result.m_candidateClusters.begin(),
+        iterEnd = result.m_candidateClusters.end(); iter != iterEnd; ++iter)
+    {
+        if (iter->m_caloHitAddresses.empty())
+            continue;
+
+        PandoraContentApi::Cluster::Parameters parameters;
+
+        for (ReclusteringCandidateAlgorithm::AddressVector::const_iterator hitIter = iter->m_caloHitAddresses.begin(),
+            hitIterEnd = iter->m_caloHitAddresses.end(); hitIter != hitIterEnd; ++hitIter)
+        {
+            parameters.m_caloHitList.push_back(static_cast<const pandora::CaloHit *>(*hitIter));
+        }
+
+        for (ReclusteringCandidateAlgorithm::AddressVector::const_iterator hitIter = iter->m_isolatedCaloHitAddresses.begin(),
+            hitIterEnd = iter->m_isolatedCaloHitAddresses.end(); hitIter != hitIterEnd; ++hitIter)
+        {
+            parameters.m_isolatedCaloHitList.push_back(static_cast<const pandora::CaloHit *>(*hitIter));
+        }
+
+        const pandora::Cluster *pNewCluster = NULL;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::Create(*this, parameters, pNewCluster));
+
+        for (ReclusteringCandidateAlgorithm::AddressVector::const_iterator trackIter = iter->m_trackAddresses.begin(),
+            trackIterEnd = iter->m_trackAddresses.end(); trackIter != trackIterEnd; ++trackIter)
+        {
+            PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::AddTrackClusterAssociation(*this,
+                static_cast<const pandora::Track *>(*trackIter), pNewCluster));
+        }
+    }
+
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::SaveList<pandora::Cluster>(*this, temporaryClusterListName, originalClusterListName));
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::ReplaceCurrentList<pandora::Cluster>(*this, originalClusterListName));
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::CopyCaloHit(const pandora::CaloHit *const pCaloHit, PandoraApi::CaloHit::Parameters &parameters)
+{
+    parameters.m_positionVector = pCaloHit->GetPositionVector();
+    parameters.m_expectedDirection = pCaloHit->GetExpectedDirection();
+    parameters.m_cellNormalVector = pCaloHit->GetCellNormalVector();
+    parameters.m_cellGeometry = pCaloHit->GetCellGeometry();
+    parameters.m_cellSize0 = pCaloHit->GetCellSize0();
+    parameters.m_cellSize1 = pCaloHit->GetCellSize1();
+    parameters.m_cellThickness = pCaloHit->GetCellThickness();
+    parameters.m_nCellRadiationLengths = pCaloHit->GetNCellRadiationLengths();
+    parameters.m_nCellInteractionLengths = pCaloHit->GetNCellInteractionLengths();
+    parameters.m_time = pCaloHit->GetTime();
+    parameters.m_inputEnergy = pCaloHit->GetInputEnergy();
+    parameters.m_mipEquivalentEnergy = pCaloHit->GetMipEquivalentEnergy();
+    parameters.m_electromagneticEnergy = pCaloHit->GetElectromagneticEnergy();
+    parameters.m_hadronicEnergy = pCaloHit->GetHadronicEnergy();
+    parameters.m_isDigital = pCaloHit->IsDigital();
+    parameters.m_hitType = pCaloHit->GetHitType();
+    parameters.m_hitRegion = pCaloHit->GetHitRegion();
+    parameters.m_layer = pCaloHit->GetLayer();
+    parameters.m_isInOuterSamplingLayer = pCaloHit->IsInOuterSamplingLayer();
+    parameters.m_pParentAddress = pCaloHit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::CopyTrack(const pandora::Track *const pTrack, PandoraApi::Track::Parameters &parameters)
+{
+    parameters.m_d0 = pTrack->GetD0();
+    parameters.m_z0 = pTrack->GetZ0();
+    parameters.m_particleId = pTrack->GetParticleId();
+    parameters.m_charge = pTrack->GetCharge();
+    parameters.m_mass = pTrack->GetMass();
+    parameters.m_momentumAtDca = pTrack->GetMomentumAtDca();
+    parameters.m_trackStateAtStart = pTrack->GetTrackStateAtStart();
+    parameters.m_trackStateAtEnd = pTrack->GetTrackStateAtEnd();
+    parameters.m_trackStateAtCalorimeter = pTrack->GetTrackStateAtCalorimeter();
+    parameters.m_timeAtCalorimeter = pTrack->GetTimeAtCalorimeter();
+    parameters.m_reachesCalorimeter = pTrack->ReachesCalorimeter();
+    parameters.m_isProjectedToEndCap = pTrack->IsProjectedToEndCap();
+    parameters.m_canFormPfo = pTrack->CanFormPfo();
+    parameters.m_canFormClusterlessPfo = pTrack->CanFormClusterlessPfo();
+    parameters.m_pParentAddress = pTrack;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ParallelReclusteringAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinChiToRecluster", m_minChiToRecluster));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "HadronicEnergyResolution", m_hadronicEnergyResolution));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinCaloHitsToRecluster", m_minCaloHitsToRecluster));
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ParallelReclusteringAlgorithm::EvaluationTask::EvaluationTask(const PandoraVector &workerVector, const unsigned int nWorkers,
+        const float hadronicEnergyResolution, const CaloHitParametersVector &caloHitParametersVector,
+        const TrackParametersVector &trackParametersVector, ResultVector &resultVector, StatusCodeVector &statusCodeVector) :
+    m_workerVector(workerVector),
+    m_nWorkers(nWorkers),
+    m_hadronicEnergyResolution(hadronicEnergyResolution),
+    m_caloHitParametersVector(caloHitParametersVector),
+    m_trackParametersVector(trackParametersVector),
+    m_resultVector(resultVector),
+    m_statusCodeVector(statusCodeVector)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ParallelReclusteringAlgorithm::EvaluationTask::Run(const unsigned int threadIndex)
+{
+    // ATTN Each pool thread drives the worker with the same index; workers beyond the number of candidates are idle
+    if (threadIndex >= m_nWorkers)
+        return;
+
+    ParallelReclusteringAlgorithm::EvaluateWorkerCandidates(m_workerVector[threadIndex], threadIndex, m_nWorkers, m_hadronicEnergyResolution,
+        &m_caloHitParametersVector, &m_trackParametersVector, &m_resultVector, &m_statusCodeVector[threadIndex]);
+}
@@ -0,0 +1,92 @@
+/**
+ *  @file   MarlinPandora/src/PersistentThreadPool.cc
+ *
+ *  @brief  Implementation of the persistent thread pool class.
+ *
+ *  $Log: $
+ */
+
+#include "PersistentThreadPool.h"
+
+PersistentThreadPool::PersistentThreadPool(const unsigned int nThreads) :
+    m_pTask(NULL),
+    m_taskNumber(0),
+    m_nThreadsRunning(0),
+    m_isStopped(false)
+{
+    for (unsigned int iThread = 0; iThread < nThreads; ++iThread)
+        m_threadVector.push_back(std::thread(&PersistentThreadPool::Loop, this, iThread));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PersistentThreadPool::~PersistentThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopped = true;
+    }
+
+    m_taskStarted.notify_all();
+
+    for (std::vector<std::thread>::iterator iter = m_threadVector.begin(), iterEnd = m_threadVector.end(); iter != iterEnd; ++iter)
+        iter->join();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PersistentThreadPool::Run(Task &task)
+{
+    if (m_threadVector.empty())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pTask = &task;
+    m_nThreadsRunning = m_threadVector.size();
+    ++m_taskNumber;
+    m_taskStarted.notify_all();
+
+    while (m_nThreadsRunning > 0)
+        m_taskFinished.wait(lock);
+
+    m_pTask = NULL;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PersistentThreadPool::Loop(const unsigned int threadIndex)
+{
+    unsigned long long lastTaskNumber(0);
+
+    while (true)
+    {
+        Task *pTask(NULL);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (!m_isStopped && (lastTaskNumber == m_taskNumber))
+                m_taskStarted.wait(lock);
+
+            if (m_isStopped)
+                return;
+
+            lastTaskNumber = m_taskNumber;
+            pTask = m_pTask;
+        }
+
+        pTask->Run(threadIndex);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (0 == --m_nThreadsRunning)
+            m_taskFinished.notify_one();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PersistentThreadPool::Task::~Task()
+{
+}
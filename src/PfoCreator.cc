@@ -65,6 +65,9 @@ pandora::StatusCode PfoCreator::CreateParticleFlowObjects(EVENT::LCEvent *pLCEve
     this->InitialiseSubDetectorNames(subDetectorNames);
     pClusterCollection->parameters().setValues("ClusterSubdetectorNames", subDetectorNames);
 
+    // ATTN Standalone clients may not register their calo hit creator with the processor, in which case there are no super-cells
+    const CaloHitCreator::SuperCellMemberMap *const pSuperCellMemberMap(PandoraPFANewProcessor::GetSuperCellMemberMap(m_pPandora));
+
     // Create lcio "reconstructed particles" from the pandora "particle flow objects"
     for (pandora::PfoList::const_iterator pIter = pPandoraPfoList->begin(), pIterEnd = pPandoraPfoList->end(); pIter != pIterEnd; ++pIter)
     {
@@ -85,7 +88,7 @@ pandora::StatusCode PfoCreator::CreateParticleFlowObjects(EVENT::LCEvent *pLCEve
 
             pandora::FloatVector hitE, hitX, hitY, hitZ;
             IMPL::ClusterImpl *const pLcioCluster(new ClusterImpl());
-            this->SetClusterSubDetectorEnergies(subDetectorNames, pLcioCluster, pandoraCaloHitList, hitE, hitX, hitY, hitZ);
+            this->SetClusterSubDetectorEnergies(subDetectorNames, pLcioCluster, pandoraCaloHitList, pSuperCellMemberMap, hitE, hitX, hitY, hitZ);
 
             float clusterCorrectEnergy(0.f);
             this->SetClusterEnergyAndError(pPandoraPfo, pPandoraCluster, pLcioCluster, clusterCorrectEnergy);
@@ -155,33 +158,50 @@ void PfoCreator::InitialiseSubDetectorNames(pandora::StringVector &subDetectorNa
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void PfoCreator::SetClusterSubDetectorEnergies(const pandora::StringVector &subDetectorNames, IMPL::ClusterImpl *const pLcioCluster,
-    const pandora::CaloHitList &pandoraCaloHitList, pandora::FloatVector &hitE, pandora::FloatVector &hitX, pandora::FloatVector &hitY,
-    pandora::FloatVector &hitZ) const
+    const pandora::CaloHitList &pandoraCaloHitList, const CaloHitCreator::SuperCellMemberMap *const pSuperCellMemberMap,
+    pandora::FloatVector &hitE, pandora::FloatVector &hitX, pandora::FloatVector &hitY, pandora::FloatVector &hitZ) const
 {
     for (pandora::CaloHitList::const_iterator hIter = pandoraCaloHitList.begin(), hIterEnd = pandoraCaloHitList.end(); hIter != hIterEnd; ++hIter)
     {
         const pandora::CaloHit *const pPandoraCaloHit(*hIter);
-        EVENT::CalorimeterHit *const pCalorimeterHit = (EVENT::CalorimeterHit*)(pPandoraCaloHit->GetParentAddress());
-        pLcioCluster->addHit(pCalorimeterHit, 1.f);
+        EVENT::CalorimeterHit *const pParentCalorimeterHit = (EVENT::CalorimeterHit*)(pPandoraCaloHit->GetParentAddress());
 
-        const float caloHitEnergy(pCalorimeterHit->getEnergy());
-        hitE.push_back(caloHitEnergy);
-        hitX.push_back(pCalorimeterHit->getPosition()[0]);
-        hitY.push_back(pCalorimeterHit->getPosition()[1]);
-        hitZ.push_back(pCalorimeterHit->getPosition()[2]);
+        // ATTN A forward super-cell is expanded into all the lcio calorimeter hits merged to create it
+        CalorimeterHitVector memberHits(1, pParentCalorimeterHit);
 
-        std::vector<float> &subDetectorEnergies = pLcioCluster->subdetectorEnergies();
-        subDetectorEnergies.resize(subDetectorNames.size());
+        if (NULL != pSuperCellMemberMap)
+        {
+            CaloHitCreator::SuperCellMemberMap::const_iterator memberIter = pSuperCellMemberMap->find(pParentCalorimeterHit);
 
-        switch (CHT(pCalorimeterHit->getType()).caloID())
+            if (pSuperCellMemberMap->end() != memberIter)
+                memberHits = memberIter->second;
+        }
+
+        for (CalorimeterHitVector::const_iterator memberHitIter = memberHits.begin(), memberHitIterEnd = memberHits.end();
+            memberHitIter != memberHitIterEnd; ++memberHitIter)
         {
-            case CHT::ecal:  subDetectorEnergies[ECAL_INDEX ] += caloHitEnergy; break;
-            case CHT::hcal:  subDetectorEnergies[HCAL_INDEX ] += caloHitEnergy; break;
-            case CHT::yoke:  subDetectorEnergies[YOKE_INDEX ] += caloHitEnergy; break;
-            case CHT::lcal:  subDetectorEnergies[LCAL_INDEX ] += caloHitEnergy; break;
-            case CHT::lhcal: subDetectorEnergies[LHCAL_INDEX] += caloHitEnergy; break;
-            case CHT::bcal:  subDetectorEnergies[BCAL_INDEX ] += caloHitEnergy; break;
-            default: streamlog_out(WARNING) << "PfoCreator::SetClusterSubDetectorEnergies: no subdetector found for hit with type: " << pCalorimeterHit->getType() << std::endl;
+            EVENT::CalorimeterHit *const pCalorimeterHit(*memberHitIter);
+            pLcioCluster->addHit(pCalorimeterHit, 1.f);
+
+            const float caloHitEnergy(pCalorimeterHit->getEnergy());
+            hitE.push_back(caloHitEnergy);
+            hitX.push_back(pCalorimeterHit->getPosition()[0]);
+            hitY.push_back(pCalorimeterHit->getPosition()[1]);
+            hitZ.push_back(pCalorimeterHit->getPosition()[2]);
+
+            std::vector<float> &subDetectorEnergies = pLcioCluster->subdetectorEnergies();
+            subDetectorEnergies.resize(subDetectorNames.size());
+
+            switch (CHT(pCalorimeterHit->getType()).caloID())
+            {
+                case CHT::ecal:  subDetectorEnergies[ECAL_INDEX ] += caloHitEnergy; break;
+                case CHT::hcal:  subDetectorEnergies[HCAL_INDEX ] += caloHitEnergy; break;
+                case CHT::yoke:  subDetectorEnergies[YOKE_INDEX ] += caloHitEnergy; break;
+                case CHT::lcal:  subDetectorEnergies[LCAL_INDEX ] += caloHitEnergy; break;
+                case CHT::lhcal: subDetectorEnergies[LHCAL_INDEX] += caloHitEnergy; break;
+                case CHT::bcal:  subDetectorEnergies[BCAL_INDEX ] += caloHitEnergy; break;
+                default: streamlog_out(WARNING) << "PfoCreator::SetClusterSubDetectorEnergies: no subdetector found for hit with type: " << pCalorimeterHit->getType() << std::endl;
+            }
         }
     }
 }
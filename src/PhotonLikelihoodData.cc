@@ -0,0 +1,407 @@
+/**
+ *  @file   MarlinPandora/src/PhotonLikelihoodData.cc
+ *
+ *  @brief  Implementation of the photon likelihood data class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Helpers/XmlHelper.h"
+
+#include "Xml/tinyxml.h"
+
+#include "PhotonLikelihoodData.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+static const std::string SIGNAL_PREFIX("PhotonSig");
+static const std::string BACKGROUND_PREFIX("PhotonBkg");
+
+PhotonLikelihoodData::PhotonLikelihoodData()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodData::ReadXml(const std::string &fileName)
+{
+    this->Clear();
+
+    // ATTN The training file has no root element; tinyxml reads the sequence of top level elements regardless
+    pandora::TiXmlDocument xmlDocument(fileName);
+
+    if (!xmlDocument.LoadFile())
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: unable to parse " << fileName << ", " << xmlDocument.ErrorDesc() << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    const pandora::TiXmlHandle xmlDocumentHandle(&xmlDocument);
+    unsigned int nEnergyBins(0);
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadValue(xmlDocumentHandle, "NEnergyBins", nEnergyBins));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadVectorOfValues(xmlDocumentHandle,
+        "EnergyBinLowerEdges", m_energyBinLowerEdges));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadVectorOfValues(xmlDocumentHandle,
+        "NSignalEvents", m_nSignalEvents));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadVectorOfValues(xmlDocumentHandle,
+        "NBackgroundEvents", m_nBackgroundEvents));
+
+    if (nEnergyBins != m_energyBinLowerEdges.size())
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: " << fileName << " lists " << m_energyBinLowerEdges.size() << " energy bin edges for "
+                             << nEnergyBins << " energy bins" << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    // Collect the pdf elements, named <PhotonSig|PhotonBkg><VariableName>_<EnergyBin>, then lay them out in index order
+    typedef std::map<std::string, pandora::TiXmlElement *> PdfElementMap;
+    PdfElementMap pdfElementMap;
+
+    for (pandora::TiXmlElement *pXmlElement = xmlDocument.FirstChildElement(); NULL != pXmlElement; pXmlElement = pXmlElement->NextSiblingElement())
+    {
+        const std::string tag(pXmlElement->Value());
+        const std::string::size_type separatorPosition(tag.rfind('_'));
+
+        const bool isSignal(0 == tag.compare(0, SIGNAL_PREFIX.size(), SIGNAL_PREFIX));
+        const bool isBackground(0 == tag.compare(0, BACKGROUND_PREFIX.size(), BACKGROUND_PREFIX));
+
+        if ((std::string::npos == separatorPosition) || (!isSignal && !isBackground))
+            continue;
+
+        if (!pdfElementMap.insert(PdfElementMap::value_type(tag, pXmlElement)).second)
+        {
+            streamlog_out(ERROR) << "PhotonLikelihoodData: " << fileName << " repeats pdf " << tag << std::endl;
+            return pandora::STATUS_CODE_INVALID_PARAMETER;
+        }
+
+        if (isSignal && (0 == std::atoi(tag.c_str() + separatorPosition + 1)))
+            m_variableNames.push_back(tag.substr(SIGNAL_PREFIX.size(), separatorPosition - SIGNAL_PREFIX.size()));
+    }
+
+    if (pdfElementMap.size() != 2 * m_variableNames.size() * nEnergyBins)
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: " << fileName << " holds " << pdfElementMap.size() << " pdfs, expected "
+                             << 2 * m_variableNames.size() * nEnergyBins << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    for (StringVector::const_iterator iter = m_variableNames.begin(), iterEnd = m_variableNames.end(); iter != iterEnd; ++iter)
+    {
+        for (unsigned int iEnergyBin = 0; iEnergyBin < nEnergyBins; ++iEnergyBin)
+        {
+            for (unsigned int iSignal = 0; iSignal < 2; ++iSignal)
+            {
+                std::ostringstream tag;
+                tag << ((0 == iSignal) ? SIGNAL_PREFIX : BACKGROUND_PREFIX) << *iter << "_" << iEnergyBin;
+
+                PdfElementMap::const_iterator elementIter = pdfElementMap.find(tag.str());
+
+                if (pdfElementMap.end() == elementIter)
+                {
+                    streamlog_out(ERROR) << "PhotonLikelihoodData: " << fileName << " has no pdf " << tag.str() << std::endl;
+                    return pandora::STATUS_CODE_NOT_FOUND;
+                }
+
+                const pandora::TiXmlHandle pdfHandle(elementIter->second);
+                unsigned int nBins(0);
+                float xLow(0.f), xHigh(0.f);
+                FloatVector binContents;
+
+                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadValue(pdfHandle, "NBinsX", nBins));
+                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadValue(pdfHandle, "XLow", xLow));
+                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadValue(pdfHandle, "XHigh", xHigh));
+                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, pandora::XmlHelper::ReadVectorOfValues(pdfHandle, "BinContents", binContents));
+
+                if (nBins != binContents.size())
+                {
+                    streamlog_out(ERROR) << "PhotonLikelihoodData: " << fileName << " pdf " << tag.str() << " lists " << binContents.size()
+                                         << " bin contents for " << nBins << " bins" << std::endl;
+                    return pandora::STATUS_CODE_INVALID_PARAMETER;
+                }
+
+                Pdf pdf;
+                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->AddPdf(xLow, xHigh, binContents, pdf));
+                m_pdfs.push_back(pdf);
+            }
+        }
+    }
+
+    return this->CheckConsistency();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodData::WriteXml(const std::string &fileName) const
+{
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, this->CheckConsistency());
+
+    std::ofstream outputFile(fileName.c_str(), std::ios::out | std::ios::trunc);
+
+    if (!outputFile.is_open())
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: unable to open " << fileName << " for writing" << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    const unsigned int nEnergyBins(m_energyBinLowerEdges.size());
+    outputFile << "<NEnergyBins>" << nEnergyBins << "</NEnergyBins>" << std::endl;
+
+    outputFile << "<EnergyBinLowerEdges>";
+    for (FloatVector::const_iterator iter = m_energyBinLowerEdges.begin(), iterEnd = m_energyBinLowerEdges.end(); iter != iterEnd; ++iter)
+        outputFile << *iter << " ";
+    outputFile << "</EnergyBinLowerEdges>" << std::endl;
+
+    outputFile << "<NSignalEvents>";
+    for (UIntVector::const_iterator iter = m_nSignalEvents.begin(), iterEnd = m_nSignalEvents.end(); iter != iterEnd; ++iter)
+        outputFile << *iter << " ";
+    outputFile << "</NSignalEvents>" << std::endl;
+
+    outputFile << "<NBackgroundEvents>";
+    for (UIntVector::const_iterator iter = m_nBackgroundEvents.begin(), iterEnd = m_nBackgroundEvents.end(); iter != iterEnd; ++iter)
+        outputFile << *iter << " ";
+    outputFile << "</NBackgroundEvents>" << std::endl;
+
+    for (unsigned int iPdf = 0, nPdfs = m_pdfs.size(); iPdf < nPdfs; ++iPdf)
+    {
+        const Pdf &pdf(m_pdfs[iPdf]);
+        std::ostringstream tag;
+        tag << ((0 == iPdf % 2) ? SIGNAL_PREFIX : BACKGROUND_PREFIX) << m_variableNames[iPdf / (2 * nEnergyBins)] << "_" << (iPdf / 2) % nEnergyBins;
+
+        outputFile << "<" << tag.str() << ">" << std::endl
+                   << "    <NBinsX>" << pdf.m_nBins << "</NBinsX>" << std::endl
+                   << "    <XLow>" << pdf.m_xLow << "</XLow>" << std::endl
+                   << "    <XHigh>" << pdf.m_xHigh << "</XHigh>" << std::endl
+                   << "    <BinContents>";
+
+        for (unsigned int iBin = 0; iBin < pdf.m_nBins; ++iBin)
+            outputFile << m_binContents[pdf.m_offset + iBin] << " ";
+
+        outputFile << "</BinContents>" << std::endl
+                   << "</" << tag.str() << ">" << std::endl;
+    }
+
+    if (!outputFile.good())
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: failed to write " << fileName << std::endl;
+        return pandora::STATUS_CODE_FAILURE;
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodData::SetContents(const UIntVector &nSignalEvents, const UIntVector &nBackgroundEvents, const FloatVector &binContents)
+{
+    if ((nSignalEvents.size() != m_nSignalEvents.size()) || (nBackgroundEvents.size() != m_nBackgroundEvents.size()) ||
+        (binContents.size() != m_binContents.size()))
+    {
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    m_nSignalEvents = nSignalEvents;
+    m_nBackgroundEvents = nBackgroundEvents;
+    m_binContents = binContents;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PhotonLikelihoodData::HasSameBinning(const PhotonLikelihoodData &other) const
+{
+    if ((m_energyBinLowerEdges != other.m_energyBinLowerEdges) || (m_variableNames != other.m_variableNames) || (m_pdfs.size() != other.m_pdfs.size()))
+        return false;
+
+    for (unsigned int iPdf = 0, nPdfs = m_pdfs.size(); iPdf < nPdfs; ++iPdf)
+    {
+        const Pdf &pdf(m_pdfs[iPdf]), &otherPdf(other.m_pdfs[iPdf]);
+
+        if ((pdf.m_nBins != otherPdf.m_nBins) || (pdf.m_xLow != otherPdf.m_xLow) || (pdf.m_xHigh != otherPdf.m_xHigh))
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PhotonLikelihoodData::Clear()
+{
+    m_energyBinLowerEdges.clear();
+    m_nSignalEvents.clear();
+    m_nBackgroundEvents.clear();
+    m_variableNames.clear();
+    m_pdfs.clear();
+    m_binContents.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodData::AddPdf(const float xLow, const float xHigh, const FloatVector &binContents, Pdf &pdf)
+{
+    if (binContents.empty() || (xHigh <= xLow))
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+
+    pdf.m_nBins = binContents.size();
+    pdf.m_xLow = xLow;
+    pdf.m_xHigh = xHigh;
+    pdf.m_offset = m_binContents.size();
+    m_binContents.insert(m_binContents.end(), binContents.begin(), binContents.end());
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodData::CheckConsistency() const
+{
+    const unsigned int nEnergyBins(m_energyBinLowerEdges.size());
+
+    if ((0 == nEnergyBins) || (nEnergyBins != m_nSignalEvents.size()) || (nEnergyBins != m_nBackgroundEvents.size()) ||
+        (m_pdfs.size() != 2 * m_variableNames.size() * nEnergyBins))
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodData: inconsistent numbers of energy bins, training events or pdfs" << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    for (unsigned int iEnergyBin = 1; iEnergyBin < nEnergyBins; ++iEnergyBin)
+    {
+        if (m_energyBinLowerEdges[iEnergyBin] <= m_energyBinLowerEdges[iEnergyBin - 1])
+        {
+            streamlog_out(ERROR) << "PhotonLikelihoodData: energy bin lower edges must increase" << std::endl;
+            return pandora::STATUS_CODE_INVALID_PARAMETER;
+        }
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PhotonLikelihoodSum::PhotonLikelihoodSum() :
+    m_nInputs(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodSum::Add(const PhotonLikelihoodData &likelihoodData)
+{
+    if (0 == m_nInputs)
+    {
+        m_binning = likelihoodData;
+        m_nSignalEvents.assign(likelihoodData.GetNEnergyBins(), 0.);
+        m_nBackgroundEvents.assign(likelihoodData.GetNEnergyBins(), 0.);
+        m_binCounts.assign(m_binning.GetPdfs().empty() ? 0 : m_binning.GetPdfs().back().m_offset + m_binning.GetPdfs().back().m_nBins, 0.);
+    }
+    else if (!m_binning.HasSameBinning(likelihoodData))
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodSum: likelihood data sets have different variables, energy bins or pdf binning" << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    const unsigned int nEnergyBins(likelihoodData.GetNEnergyBins());
+    const PhotonLikelihoodData::UIntVector &nSignalEvents(likelihoodData.GetNSignalEvents());
+    const PhotonLikelihoodData::UIntVector &nBackgroundEvents(likelihoodData.GetNBackgroundEvents());
+    const PhotonLikelihoodData::PdfVector &pdfs(likelihoodData.GetPdfs());
+
+    for (unsigned int iEnergyBin = 0; iEnergyBin < nEnergyBins; ++iEnergyBin)
+    {
+        m_nSignalEvents[iEnergyBin] += nSignalEvents[iEnergyBin];
+        m_nBackgroundEvents[iEnergyBin] += nBackgroundEvents[iEnergyBin];
+    }
+
+    for (unsigned int iPdf = 0, nPdfs = pdfs.size(); iPdf < nPdfs; ++iPdf)
+    {
+        const PhotonLikelihoodData::Pdf &pdf(pdfs[iPdf]);
+        const unsigned int energyBin((iPdf / 2) % nEnergyBins);
+        const double nEvents((0 == iPdf % 2) ? nSignalEvents[energyBin] : nBackgroundEvents[energyBin]);
+        const float *const pBinContents(likelihoodData.GetBinContents(pdf));
+        double *const pBinCounts(&m_binCounts[pdf.m_offset]);
+
+        for (unsigned int iBin = 0; iBin < pdf.m_nBins; ++iBin)
+            pBinCounts[iBin] += std::floor(static_cast<double>(pBinContents[iBin]) * nEvents + 0.5);
+    }
+
+    ++m_nInputs;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodSum::Add(const PhotonLikelihoodSum &likelihoodSum)
+{
+    if (0 == likelihoodSum.m_nInputs)
+        return pandora::STATUS_CODE_SUCCESS;
+
+    if (0 == m_nInputs)
+    {
+        *this = likelihoodSum;
+        return pandora::STATUS_CODE_SUCCESS;
+    }
+
+    if (!m_binning.HasSameBinning(likelihoodSum.m_binning))
+    {
+        streamlog_out(ERROR) << "PhotonLikelihoodSum: likelihood data sets have different variables, energy bins or pdf binning" << std::endl;
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    for (unsigned int iEnergyBin = 0, nEnergyBins = m_nSignalEvents.size(); iEnergyBin < nEnergyBins; ++iEnergyBin)
+    {
+        m_nSignalEvents[iEnergyBin] += likelihoodSum.m_nSignalEvents[iEnergyBin];
+        m_nBackgroundEvents[iEnergyBin] += likelihoodSum.m_nBackgroundEvents[iEnergyBin];
+    }
+
+    for (unsigned int iBin = 0, nBins = m_binCounts.size(); iBin < nBins; ++iBin)
+        m_binCounts[iBin] += likelihoodSum.m_binCounts[iBin];
+
+    m_nInputs += likelihoodSum.m_nInputs;
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode PhotonLikelihoodSum::GetLikelihoodData(PhotonLikelihoodData &likelihoodData) const
+{
+    if (0 == m_nInputs)
+        return pandora::STATUS_CODE_NOT_INITIALIZED;
+
+    const unsigned int nEnergyBins(m_binning.GetNEnergyBins());
+    const PhotonLikelihoodData::PdfVector &pdfs(m_binning.GetPdfs());
+    PhotonLikelihoodData::UIntVector nSignalEvents, nBackgroundEvents;
+    PhotonLikelihoodData::FloatVector binContents(m_binCounts.size(), 0.f);
+
+    for (unsigned int iEnergyBin = 0; iEnergyBin < nEnergyBins; ++iEnergyBin)
+    {
+        nSignalEvents.push_back(static_cast<unsigned int>(m_nSignalEvents[iEnergyBin]));
+        nBackgroundEvents.push_back(static_cast<unsigned int>(m_nBackgroundEvents[iEnergyBin]));
+    }
+
+    // ATTN Pdfs in energy bins without training events are left empty
+    for (unsigned int iPdf = 0, nPdfs = pdfs.size(); iPdf < nPdfs; ++iPdf)
+    {
+        const PhotonLikelihoodData::Pdf &pdf(pdfs[iPdf]);
+        const unsigned int energyBin((iPdf / 2) % nEnergyBins);
+        const double nEvents((0 == iPdf % 2) ? m_nSignalEvents[energyBin] : m_nBackgroundEvents[energyBin]);
+
+        if (nEvents < 1.)
+            continue;
+
+        for (unsigned int iBin = pdf.m_offset, iBinEnd = pdf.m_offset + pdf.m_nBins; iBin < iBinEnd; ++iBin)
+            binContents[iBin] = static_cast<float>(m_binCounts[iBin] / nEvents);
+    }
+
+    likelihoodData = m_binning;
+
+    return likelihoodData.SetContents(nSignalEvents, nBackgroundEvents, binContents);
+}
@@ -0,0 +1,270 @@
+/**
+ *  @file   MarlinPandora/src/ProfilingAlgorithm.cc
+ *
+ *  @brief  Implementation of the profiling algorithm class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "ProfilingAlgorithm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+using namespace pandora;
+
+ProfilingAlgorithm::ProfileTreeMap ProfilingAlgorithm::m_profileTreeMap;
+
+static std::mutex profileTreeMapMutex;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProfilingAlgorithm::PrintProfile(const Pandora &pandora)
+{
+    std::lock_guard<std::mutex> lock(profileTreeMapMutex);
+    ProfileTreeMap::const_iterator iter = m_profileTreeMap.find(&pandora);
+
+    if ((m_profileTreeMap.end() == iter) || iter->second->m_rootNode.m_daughterNodes.empty())
+        return;
+
+    const ProfileNode &rootNode(iter->second->m_rootNode);
+    const bool useHardwareCounters(iter->second->m_useHardwareCounters);
+    double totalSeconds(0.);
+
+    for (ProfileNodeVector::const_iterator nodeIter = rootNode.m_daughterNodes.begin(), nodeIterEnd = rootNode.m_daughterNodes.end();
+        nodeIter != nodeIterEnd; ++nodeIter)
+    {
+        totalSeconds += (*nodeIter)->m_totalSeconds;
+    }
+
+    streamlog_out(MESSAGE) << "ProfilingAlgorithm - Profile for pandora instance " << &pandora << ", times include daughters, list sizes are means per call"
+                           << std::endl
+                           << std::setw(10) << "Calls" << std::setw(14) << "Total [ms]" << std::setw(12) << "Mean [ms]" << std::setw(12) << "Parent [%]"
+                           << std::setw(20) << "Hits in -> out" << std::setw(20) << "Clusters in -> out"
+                           << (useHardwareCounters ? HardwareCounters::GetSummaryHeader() : std::string()) << "   Algorithm" << std::endl;
+
+    for (ProfileNodeVector::const_iterator nodeIter = rootNode.m_daughterNodes.begin(), nodeIterEnd = rootNode.m_daughterNodes.end();
+        nodeIter != nodeIterEnd; ++nodeIter)
+    {
+        (*nodeIter)->Print(0, totalSeconds, useHardwareCounters);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProfilingAlgorithm::EnableHardwareCounters(const Pandora &pandora)
+{
+    ProfilingAlgorithm::GetProfileTree(pandora).m_useHardwareCounters = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProfilingAlgorithm::ResetProfile(const Pandora &pandora)
+{
+    std::lock_guard<std::mutex> lock(profileTreeMapMutex);
+    ProfileTreeMap::iterator iter = m_profileTreeMap.find(&pandora);
+
+    if (m_profileTreeMap.end() == iter)
+        return;
+
+    delete iter->second;
+    m_profileTreeMap.erase(iter);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ProfilingAlgorithm::Run()
+{
+    ProfileTree &profileTree(ProfilingAlgorithm::GetProfileTree(this->GetPandora()));
+    ProfileNode *const pParentNode(profileTree.m_nodeStack.empty() ? &profileTree.m_rootNode : profileTree.m_nodeStack.back());
+
+    for (NameAndLabelVector::const_iterator iter = m_algorithms.begin(), iterEnd = m_algorithms.end(); iter != iterEnd; ++iter)
+    {
+        ProfileNode *const pNode(pParentNode->GetDaughterNode(iter->first, iter->second));
+
+        unsigned int nCaloHitsIn(0), nClustersIn(0);
+        this->GetCurrentListSizes(nCaloHitsIn, nClustersIn);
+
+        profileTree.m_nodeStack.push_back(pNode);
+
+        // ATTN Counts are for the thread running this algorithm, which is the thread running the pandora instance
+        HardwareCounters::Values startValues;
+
+        if (profileTree.m_useHardwareCounters)
+            HardwareCounters::GetThreadInstance().Read(startValues);
+
+        const std::chrono::steady_clock::time_point startTime(std::chrono::steady_clock::now());
+        StatusCode statusCode(STATUS_CODE_SUCCESS);
+
+        try
+        {
+            statusCode = PandoraContentApi::RunDaughterAlgorithm(*this, iter->first);
+        }
+        catch (StatusCodeException &statusCodeException)
+        {
+            statusCode = statusCodeException.GetStatusCode();
+        }
+
+        const std::chrono::steady_clock::time_point endTime(std::chrono::steady_clock::now());
+
+        if (profileTree.m_useHardwareCounters)
+        {
+            HardwareCounters::Values endValues;
+            HardwareCounters::GetThreadInstance().Read(endValues);
+            pNode->m_counterTotals.AddDifference(startValues, endValues);
+        }
+
+        profileTree.m_nodeStack.pop_back();
+
+        unsigned int nCaloHitsOut(0), nClustersOut(0);
+        this->GetCurrentListSizes(nCaloHitsOut, nClustersOut);
+
+        ++(pNode->m_nCalls);
+        pNode->m_totalSeconds += std::chrono::duration<double>(endTime - startTime).count();
+        pNode->m_nCaloHitsIn += nCaloHitsIn;
+        pNode->m_nCaloHitsOut += nCaloHitsOut;
+        pNode->m_nClustersIn += nClustersIn;
+        pNode->m_nClustersOut += nClustersOut;
+
+        if (STATUS_CODE_SUCCESS != statusCode)
+            return statusCode;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ProfilingAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    for (TiXmlElement *pXmlElement = xmlHandle.FirstChild("algorithm").Element(); NULL != pXmlElement;
+        pXmlElement = pXmlElement->NextSiblingElement("algorithm"))
+    {
+        std::string algorithmName;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::CreateDaughterAlgorithm(*this, pXmlElement, algorithmName));
+
+        const char *const pType(pXmlElement->Attribute("type"));
+        const char *const pDescription(pXmlElement->Attribute("description"));
+
+        std::string label((NULL != pType) ? pType : algorithmName);
+
+        if (NULL != pDescription)
+            label += std::string(" (") + pDescription + ")";
+
+        m_algorithms.push_back(NameAndLabel(algorithmName, label));
+    }
+
+    if (m_algorithms.empty())
+    {
+        streamlog_out(ERROR) << "ProfilingAlgorithm - No algorithms to profile" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProfilingAlgorithm::GetCurrentListSizes(unsigned int &nCaloHits, unsigned int &nClusters) const
+{
+    const CaloHitList *pCaloHitList = NULL;
+    nCaloHits = ((STATUS_CODE_SUCCESS == PandoraContentApi::GetCurrentList(*this, pCaloHitList)) && (NULL != pCaloHitList)) ? pCaloHitList->size() : 0;
+
+    const ClusterList *pClusterList = NULL;
+    nClusters = ((STATUS_CODE_SUCCESS == PandoraContentApi::GetCurrentList(*this, pClusterList)) && (NULL != pClusterList)) ? pClusterList->size() : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ProfilingAlgorithm::ProfileTree &ProfilingAlgorithm::GetProfileTree(const Pandora &pandora)
+{
+    std::lock_guard<std::mutex> lock(profileTreeMapMutex);
+    ProfileTreeMap::const_iterator iter = m_profileTreeMap.find(&pandora);
+
+    if (m_profileTreeMap.end() != iter)
+        return *(iter->second);
+
+    ProfileTree *const pProfileTree(new ProfileTree);
+    (void) m_profileTreeMap.insert(ProfileTreeMap::value_type(&pandora, pProfileTree));
+    return *pProfileTree;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ProfilingAlgorithm::ProfileNode::ProfileNode(const std::string &algorithmName, const std::string &label) :
+    m_algorithmName(algorithmName),
+    m_label(label),
+    m_nCalls(0),
+    m_totalSeconds(0.),
+    m_nCaloHitsIn(0.),
+    m_nCaloHitsOut(0.),
+    m_nClustersIn(0.),
+    m_nClustersOut(0.)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ProfilingAlgorithm::ProfileNode::~ProfileNode()
+{
+    for (ProfileNodeVector::const_iterator iter = m_daughterNodes.begin(), iterEnd = m_daughterNodes.end(); iter != iterEnd; ++iter)
+        delete *iter;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ProfilingAlgorithm::ProfileNode *ProfilingAlgorithm::ProfileNode::GetDaughterNode(const std::string &algorithmName, const std::string &label)
+{
+    for (ProfileNodeVector::const_iterator iter = m_daughterNodes.begin(), iterEnd = m_daughterNodes.end(); iter != iterEnd; ++iter)
+    {
+        if (algorithmName == (*iter)->m_algorithmName)
+            return *iter;
+    }
+
+    ProfileNode *const pProfileNode(new ProfileNode(algorithmName, label));
+    m_daughterNodes.push_back(pProfileNode);
+    return pProfileNode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProfilingAlgorithm::ProfileNode::Print(const unsigned int depth, const double parentSeconds, const bool useHardwareCounters) const
+{
+    const double nCalls(std::max(1U, m_nCalls));
+    std::ostringstream hits, clusters;
+    hits << std::fixed << std::setprecision(1) << m_nCaloHitsIn / nCalls << " -> " << m_nCaloHitsOut / nCalls;
+    clusters << std::fixed << std::setprecision(1) << m_nClustersIn / nCalls << " -> " << m_nClustersOut / nCalls;
+
+    // ATTN Formatted locally, as fixed and precision would otherwise persist on the shared streamlog stream
+    std::ostringstream row;
+    row << std::fixed << std::setprecision(3)
+        << std::setw(10) << m_nCalls
+        << std::setw(14) << 1000. * m_totalSeconds
+        << std::setw(12) << 1000. * m_totalSeconds / nCalls
+        << std::setw(12) << std::setprecision(1) << ((parentSeconds > 0.) ? 100. * m_totalSeconds / parentSeconds : 0.)
+        << std::setw(20) << hits.str() << std::setw(20) << clusters.str()
+        << (useHardwareCounters ? HardwareCounters::GetSummary(m_counterTotals, m_nCalls) : std::string())
+        << "   " << std::string(2 * depth, ' ') << m_label;
+
+    streamlog_out(MESSAGE) << row.str() << std::endl;
+
+    for (ProfileNodeVector::const_iterator iter = m_daughterNodes.begin(), iterEnd = m_daughterNodes.end(); iter != iterEnd; ++iter)
+        (*iter)->Print(depth + 1, m_totalSeconds, useHardwareCounters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ProfilingAlgorithm::ProfileTree::ProfileTree() :
+    m_rootNode(std::string(), std::string()),
+    m_useHardwareCounters(false)
+{
+}
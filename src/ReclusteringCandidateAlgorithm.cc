@@ -0,0 +1,184 @@
+/**
+ *  @file   MarlinPandora/src/ReclusteringCandidateAlgorithm.cc
+ *
+ *  @brief  Implementation of the reclustering candidate algorithm class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "ReclusteringCandidateAlgorithm.h"
+
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+using namespace pandora;
+
+ReclusteringCandidateAlgorithm::AlgorithmMap ReclusteringCandidateAlgorithm::m_algorithmMap;
+
+static std::mutex algorithmMapMutex;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ReclusteringCandidateAlgorithm::ReclusteringCandidateAlgorithm() :
+    m_candidateIndex(0),
+    m_hadronicEnergyResolution(0.6f),
+    m_pResult(NULL)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ReclusteringCandidateAlgorithm::~ReclusteringCandidateAlgorithm()
+{
+    std::lock_guard<std::mutex> lock(algorithmMapMutex);
+
+    for (AlgorithmMap::iterator iter = m_algorithmMap.begin(), iterEnd = m_algorithmMap.end(); iter != iterEnd; ++iter)
+    {
+        if (this == iter->second)
+        {
+            m_algorithmMap.erase(iter);
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ReclusteringCandidateAlgorithm *ReclusteringCandidateAlgorithm::GetAlgorithm(const Pandora &pandora)
+{
+    std::lock_guard<std::mutex> lock(algorithmMapMutex);
+    AlgorithmMap::const_iterator iter = m_algorithmMap.find(&pandora);
+
+    return ((m_algorithmMap.end() != iter) ? iter->second : NULL);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float ReclusteringCandidateAlgorithm::GetTrackClusterChi(const Pandora &pandora, const pandora::Cluster *const pCluster, const float hadronicEnergyResolution)
+{
+    const TrackList &trackList(pCluster->GetAssociatedTrackList());
+
+    if (trackList.empty())
+        return 0.f;
+
+    float trackEnergySum(0.f);
+
+    for (TrackList::const_iterator iter = trackList.begin(), iterEnd = trackList.end(); iter != iterEnd; ++iter)
+        trackEnergySum += (*iter)->GetEnergyAtDca();
+
+    const float sigmaE(hadronicEnergyResolution * std::sqrt(trackEnergySum));
+
+    if (sigmaE < std::numeric_limits<float>::epsilon())
+        return 0.f;
+
+    return (pCluster->GetCorrectedHadronicEnergy(pandora) - trackEnergySum) / sigmaE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ReclusteringCandidateAlgorithm::SetCandidate(const unsigned int candidateIndex, const float hadronicEnergyResolution, Result *const pResult)
+{
+    m_candidateIndex = candidateIndex;
+    m_hadronicEnergyResolution = hadronicEnergyResolution;
+    m_pResult = pResult;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ReclusteringCandidateAlgorithm::Run()
+{
+    if (NULL == m_pResult)
+        return STATUS_CODE_SUCCESS;
+
+    if (m_candidateIndex >= m_clusteringAlgorithms.size())
+        return STATUS_CODE_OUT_OF_RANGE;
+
+    const ClusterList *pClusterList = NULL;
+    std::string clusterListName;
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::RunClusteringAlgorithm(*this, m_clusteringAlgorithms[m_candidateIndex],
+        pClusterList, clusterListName));
+
+    if (!m_associationAlgorithmName.empty())
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::RunDaughterAlgorithm(*this, m_associationAlgorithmName));
+
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::RunDaughterAlgorithm(*this, m_trackClusterAssociationAlgName));
+
+    // ATTN The association algorithms may have merged clusters, so reread the current list
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentList(*this, pClusterList));
+
+    Result &result(*m_pResult);
+    result.m_candidateClusters.clear();
+    result.m_chi2 = 0.f;
+    result.m_nDof = 0;
+
+    for (ClusterList::const_iterator iter = pClusterList->begin(), iterEnd = pClusterList->end(); iter != iterEnd; ++iter)
+    {
+        const pandora::Cluster *const pCluster = *iter;
+        CandidateCluster candidateCluster;
+
+        CaloHitList caloHitList;
+        pCluster->GetOrderedCaloHitList().FillCaloHitList(caloHitList);
+
+        for (CaloHitList::const_iterator hitIter = caloHitList.begin(), hitIterEnd = caloHitList.end(); hitIter != hitIterEnd; ++hitIter)
+            candidateCluster.m_caloHitAddresses.push_back((*hitIter)->GetParentAddress());
+
+        const CaloHitList &isolatedCaloHitList(pCluster->GetIsolatedCaloHitList());
+
+        for (CaloHitList::const_iterator hitIter = isolatedCaloHitList.begin(), hitIterEnd = isolatedCaloHitList.end(); hitIter != hitIterEnd; ++hitIter)
+            candidateCluster.m_isolatedCaloHitAddresses.push_back((*hitIter)->GetParentAddress());
+
+        const TrackList &trackList(pCluster->GetAssociatedTrackList());
+
+        for (TrackList::const_iterator trackIter = trackList.begin(), trackIterEnd = trackList.end(); trackIter != trackIterEnd; ++trackIter)
+            candidateCluster.m_trackAddresses.push_back((*trackIter)->GetParentAddress());
+
+        if (!trackList.empty())
+        {
+            const float chi(ReclusteringCandidateAlgorithm::GetTrackClusterChi(this->GetPandora(), pCluster, m_hadronicEnergyResolution));
+            result.m_chi2 += chi * chi;
+            ++result.m_nDof;
+        }
+
+        result.m_candidateClusters.push_back(candidateCluster);
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode ReclusteringCandidateAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, XmlHelper::ProcessAlgorithmList(*this, xmlHandle,
+        "clusteringAlgorithms", m_clusteringAlgorithms));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ProcessAlgorithm(*this, xmlHandle,
+        "ClusterAssociation", m_associationAlgorithmName));
+
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, XmlHelper::ProcessAlgorithm(*this, xmlHandle,
+        "TrackClusterAssociation", m_trackClusterAssociationAlgName));
+
+    std::lock_guard<std::mutex> lock(algorithmMapMutex);
+
+    if (!m_algorithmMap.insert(AlgorithmMap::value_type(&(this->GetPandora()), this)).second)
+    {
+        streamlog_out(ERROR) << "ReclusteringCandidateAlgorithm - Only one instance is allowed per worker pandora instance" << std::endl;
+        return STATUS_CODE_ALREADY_PRESENT;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ReclusteringCandidateAlgorithm::Result::Result() :
+    m_chi2(0.f),
+    m_nDof(0)
+{
+}
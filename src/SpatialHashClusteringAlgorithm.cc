@@ -0,0 +1,269 @@
+/**
+ *  @file   MarlinPandora/src/SpatialHashClusteringAlgorithm.cc
+ * 
+ *  @brief  Implementation of the spatial hash clustering algorithm class.
+ * 
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "SpatialHashClusteringAlgorithm.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace pandora;
+
+SpatialHashClusteringAlgorithm::SpatialHashClusteringAlgorithm() :
+    m_maxSeparationFine(15.f),
+    m_maxSeparationCoarse(45.f),
+    m_minNeighboursForCore(2),
+    m_maxNeighboursPerHit(32),
+    m_minHitsPerCluster(2)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode SpatialHashClusteringAlgorithm::Run()
+{
+    const CaloHitList *pCaloHitList = NULL;
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::GetCurrentList(*this, pCaloHitList));
+
+    CaloHitVector caloHitVector;
+
+    for (CaloHitList::const_iterator iter = pCaloHitList->begin(), iterEnd = pCaloHitList->end(); iter != iterEnd; ++iter)
+    {
+        if (PandoraContentApi::IsAvailable(*this, *iter))
+            caloHitVector.push_back(*iter);
+    }
+
+    const unsigned int nCaloHits(caloHitVector.size());
+
+    if (0 == nCaloHits)
+        return STATUS_CODE_SUCCESS;
+
+    // Bin the hits in cells no smaller than the largest separation, so that all neighbours lie in the 27 surrounding cells
+    const float cellSize(std::max(m_maxSeparationFine, m_maxSeparationCoarse));
+    std::vector<int> cellIndices(3 * nCaloHits);
+    CellToHitIndicesMap cellToHitIndicesMap;
+    cellToHitIndicesMap.reserve(nCaloHits);
+
+    for (unsigned int iHit = 0; iHit < nCaloHits; ++iHit)
+    {
+        const CartesianVector &position(caloHitVector[iHit]->GetPositionVector());
+        cellIndices[3 * iHit] = static_cast<int>(std::floor(position.GetX() / cellSize));
+        cellIndices[3 * iHit + 1] = static_cast<int>(std::floor(position.GetY() / cellSize));
+        cellIndices[3 * iHit + 2] = static_cast<int>(std::floor(position.GetZ() / cellSize));
+        cellToHitIndicesMap[SpatialHashClusteringAlgorithm::GetCellKey(cellIndices[3 * iHit], cellIndices[3 * iHit + 1], cellIndices[3 * iHit + 2])].push_back(iHit);
+    }
+
+    // Find the neighbours of each hit, stored contiguously, with hit iHit owning entries [neighbourOffsets[iHit], neighbourOffsets[iHit + 1])
+    IndexVector neighbourOffsets(nCaloHits + 1, 0);
+    IndexVector neighbourIndices;
+    neighbourIndices.reserve(nCaloHits * std::min(m_maxNeighboursPerHit, 8U));
+
+    for (unsigned int iHit = 0; iHit < nCaloHits; ++iHit)
+    {
+        const CaloHit *const pCaloHit = caloHitVector[iHit];
+        const CartesianVector &position(pCaloHit->GetPositionVector());
+        const float maxSeparation(this->GetMaxSeparation(pCaloHit));
+        unsigned int nNeighbours(0);
+
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    if ((m_maxNeighboursPerHit > 0) && (nNeighbours >= m_maxNeighboursPerHit))
+                        continue;
+
+                    CellToHitIndicesMap::const_iterator cellIter = cellToHitIndicesMap.find(SpatialHashClusteringAlgorithm::GetCellKey(
+                        cellIndices[3 * iHit] + dx, cellIndices[3 * iHit + 1] + dy, cellIndices[3 * iHit + 2] + dz));
+
+                    if (cellToHitIndicesMap.end() == cellIter)
+                        continue;
+
+                    for (IndexVector::const_iterator iter = cellIter->second.begin(), iterEnd = cellIter->second.end(); iter != iterEnd; ++iter)
+                    {
+                        const unsigned int jHit(*iter);
+
+                        // ATTN Different cells may share a hash key, so check the cell indices before the separation
+                        if ((iHit == jHit) || (cellIndices[3 * jHit] != cellIndices[3 * iHit] + dx) ||
+                            (cellIndices[3 * jHit + 1] != cellIndices[3 * iHit + 1] + dy) || (cellIndices[3 * jHit + 2] != cellIndices[3 * iHit + 2] + dz))
+                        {
+                            continue;
+                        }
+
+                        const float separation(std::max(maxSeparation, this->GetMaxSeparation(caloHitVector[jHit])));
+
+                        if ((caloHitVector[jHit]->GetPositionVector() - position).GetMagnitudeSquared() > separation * separation)
+                            continue;
+
+                        neighbourIndices.push_back(jHit);
+
+                        if ((m_maxNeighboursPerHit > 0) && (++nNeighbours >= m_maxNeighboursPerHit))
+                            break;
+                    }
+                }
+            }
+        }
+
+        neighbourOffsets[iHit + 1] = neighbourIndices.size();
+    }
+
+    // Connect neighbouring core hits
+    std::vector<bool> isCoreHit(nCaloHits, false);
+    IndexVector parentVector(nCaloHits);
+
+    for (unsigned int iHit = 0; iHit < nCaloHits; ++iHit)
+    {
+        isCoreHit[iHit] = (neighbourOffsets[iHit + 1] - neighbourOffsets[iHit] >= m_minNeighboursForCore);
+        parentVector[iHit] = iHit;
+    }
+
+    for (unsigned int iHit = 0; iHit < nCaloHits; ++iHit)
+    {
+        if (!isCoreHit[iHit])
+            continue;
+
+        for (unsigned int iNeighbour = neighbourOffsets[iHit]; iNeighbour < neighbourOffsets[iHit + 1]; ++iNeighbour)
+        {
+            const unsigned int jHit(neighbourIndices[iNeighbour]);
+
+            if (!isCoreHit[jHit])
+                continue;
+
+            const unsigned int iRoot(SpatialHashClusteringAlgorithm::FindRoot(iHit, parentVector));
+            const unsigned int jRoot(SpatialHashClusteringAlgorithm::FindRoot(jHit, parentVector));
+
+            if (iRoot != jRoot)
+                parentVector[std::max(iRoot, jRoot)] = std::min(iRoot, jRoot);
+        }
+    }
+
+    // Assign core hits to their sets and other hits to the set of their nearest core neighbour, numbering clusters by first hit
+    const unsigned int unassigned(std::numeric_limits<unsigned int>::max());
+    IndexVector rootToClusterIndex(nCaloHits, unassigned);
+    std::vector<CaloHitList> clusterCaloHitLists;
+
+    for (unsigned int iHit = 0; iHit < nCaloHits; ++iHit)
+    {
+        unsigned int root(unassigned);
+
+        if (isCoreHit[iHit])
+        {
+            root = SpatialHashClusteringAlgorithm::FindRoot(iHit, parentVector);
+        }
+        else
+        {
+            float closestDistanceSquared(std::numeric_limits<float>::max());
+
+            for (unsigned int iNeighbour = neighbourOffsets[iHit]; iNeighbour < neighbourOffsets[iHit + 1]; ++iNeighbour)
+            {
+                const unsigned int jHit(neighbourIndices[iNeighbour]);
+
+                if (!isCoreHit[jHit])
+                    continue;
+
+                const float distanceSquared((caloHitVector[jHit]->GetPositionVector() - caloHitVector[iHit]->GetPositionVector()).GetMagnitudeSquared());
+
+                if (distanceSquared < closestDistanceSquared)
+                {
+                    closestDistanceSquared = distanceSquared;
+                    root = SpatialHashClusteringAlgorithm::FindRoot(jHit, parentVector);
+                }
+            }
+        }
+
+        if (unassigned == root)
+            continue;
+
+        if (unassigned == rootToClusterIndex[root])
+        {
+            rootToClusterIndex[root] = clusterCaloHitLists.size();
+            clusterCaloHitLists.push_back(CaloHitList());
+        }
+
+        clusterCaloHitLists[rootToClusterIndex[root]].push_back(caloHitVector[iHit]);
+    }
+
+    // Create the clusters
+    for (std::vector<CaloHitList>::const_iterator iter = clusterCaloHitLists.begin(), iterEnd = clusterCaloHitLists.end(); iter != iterEnd; ++iter)
+    {
+        if (iter->size() < m_minHitsPerCluster)
+            continue;
+
+        const pandora::Cluster *pCluster = NULL;
+        PandoraContentApi::Cluster::Parameters parameters;
+        parameters.m_caloHitList = *iter;
+        PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraContentApi::Cluster::Create(*this, parameters, pCluster));
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int SpatialHashClusteringAlgorithm::GetCellKey(const int x, const int y, const int z)
+{
+    return ((static_cast<unsigned int>(x) * 73856093U) ^ (static_cast<unsigned int>(y) * 19349663U) ^ (static_cast<unsigned int>(z) * 83492791U));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float SpatialHashClusteringAlgorithm::GetMaxSeparation(const CaloHit *const pCaloHit) const
+{
+    return ((ECAL == pCaloHit->GetHitType()) ? m_maxSeparationFine : m_maxSeparationCoarse);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int SpatialHashClusteringAlgorithm::FindRoot(unsigned int index, IndexVector &parentVector)
+{
+    unsigned int root(index);
+
+    while (parentVector[root] != root)
+        root = parentVector[root];
+
+    while (parentVector[index] != root)
+    {
+        const unsigned int next(parentVector[index]);
+        parentVector[index] = root;
+        index = next;
+    }
+
+    return root;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode SpatialHashClusteringAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MaxSeparationFine", m_maxSeparationFine));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MaxSeparationCoarse", m_maxSeparationCoarse));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinNeighboursForCore", m_minNeighboursForCore));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MaxNeighboursPerHit", m_maxNeighboursPerHit));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "MinHitsPerCluster", m_minHitsPerCluster));
+
+    if ((m_maxSeparationFine <= 0.f) || (m_maxSeparationCoarse <= 0.f))
+    {
+        streamlog_out(ERROR) << "SpatialHashClusteringAlgorithm - Max hit separations must be positive" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
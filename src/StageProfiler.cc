@@ -0,0 +1,343 @@
+/**
+ *  @file   MarlinPandora/src/StageProfiler.cc
+ *
+ *  @brief  Implementation of the stage profiler class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "StageProfiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#ifdef MARLINPANDORA_PROFILE_ALLOCATIONS
+#include <malloc.h>
+#endif
+
+// ATTN Zero initialized, with no constructor, so that it is usable from operator new at any stage of thread start-up
+static thread_local StageProfiler::AllocationCounters threadAllocationCounters;
+
+#ifdef MARLINPANDORA_PROFILE_ALLOCATIONS
+/**
+ *  @brief  Allocate a block and add it to the allocation counters for the current thread
+ *
+ *  @param  size the number of bytes requested
+ *
+ *  @return address of the block, NULL if malloc fails
+ */
+static void *CountedAllocate(const std::size_t size)
+{
+    void *const pAddress(std::malloc((0 == size) ? 1 : size));
+
+    if (NULL != pAddress)
+    {
+        StageProfiler::AllocationCounters &counters(threadAllocationCounters);
+        ++counters.m_nAllocations;
+        counters.m_nBytes += size;
+        counters.m_liveBytes += malloc_usable_size(pAddress);
+        counters.m_peakLiveBytes = std::max(counters.m_peakLiveBytes, counters.m_liveBytes);
+    }
+
+    return pAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  Subtract a block from the allocation counters for the current thread and free it
+ *
+ *  @param  pAddress address of the block, which may have been allocated by any operator new or malloc
+ */
+static void CountedFree(void *const pAddress)
+{
+    if (NULL == pAddress)
+        return;
+
+    // ATTN The block size is taken from malloc rather than a header, so blocks allocated before this operator new was bound are freed safely
+    threadAllocationCounters.m_liveBytes -= malloc_usable_size(pAddress);
+    std::free(pAddress);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  Allocate a block, calling the new handler until the allocation succeeds, as required of operator new
+ *
+ *  @param  size the number of bytes requested
+ *
+ *  @return address of the block
+ */
+static void *CountedNew(const std::size_t size)
+{
+    void *pAddress(NULL);
+
+    while (NULL == (pAddress = CountedAllocate(size)))
+    {
+        const std::new_handler newHandler(std::get_new_handler());
+
+        if (NULL == newHandler)
+            throw std::bad_alloc();
+
+        newHandler();
+    }
+
+    return pAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void *operator new(std::size_t size)
+{
+    return CountedNew(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return CountedNew(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return CountedNew(size);
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return CountedNew(size);
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+void operator delete(void *pAddress) noexcept
+{
+    CountedFree(pAddress);
+}
+
+void operator delete[](void *pAddress) noexcept
+{
+    CountedFree(pAddress);
+}
+
+void operator delete(void *pAddress, const std::nothrow_t &) noexcept
+{
+    CountedFree(pAddress);
+}
+
+void operator delete[](void *pAddress, const std::nothrow_t &) noexcept
+{
+    CountedFree(pAddress);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StageProfiler::Scope::Scope(StageProfiler *const pStageProfiler, const char *const pStageName) :
+    m_pStageProfiler(pStageProfiler),
+    m_stageIndex(0)
+{
+    if (NULL == m_pStageProfiler)
+        return;
+
+    m_stageIndex = m_pStageProfiler->GetStageIndex(pStageName);
+
+    // The peak is tracked from the start of the innermost scope; the enclosing peak is restored when the scope ends
+    if (m_pStageProfiler->m_countAllocations)
+    {
+        AllocationCounters &counters(StageProfiler::GetThreadAllocationCounters());
+        m_startCounters = counters;
+        counters.m_peakLiveBytes = counters.m_liveBytes;
+    }
+
+    if (m_pStageProfiler->m_useHardwareCounters)
+        HardwareCounters::GetThreadInstance().Read(m_startValues);
+
+    m_startTime = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StageProfiler::Scope::~Scope()
+{
+    if (NULL == m_pStageProfiler)
+        return;
+
+    const std::chrono::steady_clock::time_point endTime(std::chrono::steady_clock::now());
+    Stage &stage(m_pStageProfiler->m_stages[m_stageIndex]);
+
+    if (m_pStageProfiler->m_useHardwareCounters)
+    {
+        HardwareCounters::Values endValues;
+        HardwareCounters::GetThreadInstance().Read(endValues);
+        stage.m_counterTotals.AddDifference(m_startValues, endValues);
+    }
+
+    stage.m_seconds.push_back(std::chrono::duration<double>(endTime - m_startTime).count());
+
+    if (!m_pStageProfiler->m_countAllocations)
+        return;
+
+    AllocationCounters &counters(StageProfiler::GetThreadAllocationCounters());
+    const AllocationCounters endCounters(counters);
+    counters.m_peakLiveBytes = std::max(m_startCounters.m_peakLiveBytes, endCounters.m_peakLiveBytes);
+
+    stage.m_nAllocations.push_back(static_cast<double>(endCounters.m_nAllocations - m_startCounters.m_nAllocations));
+    stage.m_nBytes.push_back(static_cast<double>(endCounters.m_nBytes - m_startCounters.m_nBytes));
+    stage.m_peakLiveBytes.push_back(static_cast<double>(endCounters.m_peakLiveBytes - m_startCounters.m_liveBytes));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StageProfiler::StageProfiler(const bool useHardwareCounters) :
+    m_useHardwareCounters(useHardwareCounters),
+    m_countAllocations(StageProfiler::IsAllocationHookCompiled() && StageProfiler::IsAllocationHookBound())
+{
+    if (StageProfiler::IsAllocationHookCompiled() && !m_countAllocations)
+    {
+        streamlog_out(ERROR) << "StageProfiler - The allocation counting operator new is not bound, as the library was loaded via dlopen "
+                             << "(e.g. MARLIN_DLL); allocations will not be counted. List the library in LD_PRELOAD to count them" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StageProfiler::Print() const
+{
+    if (m_stages.empty())
+        return;
+
+    streamlog_out(MESSAGE) << "StageProfiler - Per event distributions for each stage, allocations counted on the processing thread only" << std::endl
+                           << std::setw(20) << "Quantity" << std::setw(14) << "Mean" << std::setw(14) << "Median" << std::setw(14) << "90%"
+                           << std::setw(14) << "Max" << "   Stage (events)" << std::endl;
+
+    for (StageVector::const_iterator iter = m_stages.begin(), iterEnd = m_stages.end(); iter != iterEnd; ++iter)
+    {
+        std::ostringstream stageName;
+        stageName << iter->m_name << " (" << iter->m_seconds.size() << ")";
+
+        StageProfiler::PrintRow("Time [ms]", iter->m_seconds, 1000., stageName.str());
+
+        if (!m_countAllocations)
+            continue;
+
+        StageProfiler::PrintRow("Allocations", iter->m_nAllocations, 1., std::string());
+        StageProfiler::PrintRow("Allocated [kB]", iter->m_nBytes, 1. / 1024., std::string());
+        StageProfiler::PrintRow("Peak growth [kB]", iter->m_peakLiveBytes, 1. / 1024., std::string());
+    }
+
+    if (!StageProfiler::IsAllocationHookCompiled())
+        streamlog_out(MESSAGE) << "StageProfiler - Allocations not counted, build with the cmake option PROFILE_ALLOCATIONS=ON" << std::endl;
+
+    if (!m_useHardwareCounters)
+        return;
+
+    streamlog_out(MESSAGE) << "StageProfiler - Hardware counters summed over the run for each stage, on the processing thread only" << std::endl
+                           << HardwareCounters::GetSummaryHeader() << "   Stage (events)" << std::endl;
+
+    for (StageVector::const_iterator iter = m_stages.begin(), iterEnd = m_stages.end(); iter != iterEnd; ++iter)
+    {
+        streamlog_out(MESSAGE) << HardwareCounters::GetSummary(iter->m_counterTotals, iter->m_seconds.size())
+                               << "   " << iter->m_name << " (" << iter->m_seconds.size() << ")" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StageProfiler::IsAllocationHookCompiled()
+{
+#ifdef MARLINPANDORA_PROFILE_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StageProfiler::IsAllocationHookBound()
+{
+    // ATTN A library loaded via dlopen does not interpose on the operator new already bound by the executable, so check that a new is counted
+    const unsigned long long nAllocations(StageProfiler::GetThreadAllocationCounters().m_nAllocations);
+    char *volatile pTest(new char);
+    delete pTest;
+
+    return (StageProfiler::GetThreadAllocationCounters().m_nAllocations > nAllocations);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int StageProfiler::GetStageIndex(const char *const pStageName)
+{
+    for (unsigned int iStage = 0, nStages = m_stages.size(); iStage < nStages; ++iStage)
+    {
+        if (0 == std::strcmp(pStageName, m_stages[iStage].m_name.c_str()))
+            return iStage;
+    }
+
+    m_stages.push_back(Stage(pStageName));
+    return (m_stages.size() - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StageProfiler::PrintRow(const std::string &quantity, DoubleVector samples, const double scale, const std::string &stageName)
+{
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum(0.);
+
+    for (DoubleVector::const_iterator iter = samples.begin(), iterEnd = samples.end(); iter != iterEnd; ++iter)
+        sum += *iter;
+
+    const unsigned int nSamples(samples.size());
+
+    // ATTN Formatted locally, as fixed and precision would otherwise persist on the shared streamlog stream
+    std::ostringstream row;
+    row << std::fixed << std::setprecision(3)
+        << std::setw(20) << quantity
+        << std::setw(14) << scale * sum / static_cast<double>(nSamples)
+        << std::setw(14) << scale * samples[nSamples / 2]
+        << std::setw(14) << scale * samples[std::min(nSamples - 1, (9 * nSamples) / 10)]
+        << std::setw(14) << scale * samples.back()
+        << "   " << stageName;
+
+    streamlog_out(MESSAGE) << row.str() << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StageProfiler::AllocationCounters &StageProfiler::GetThreadAllocationCounters()
+{
+    return threadAllocationCounters;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StageProfiler::Stage::Stage(const std::string &name) :
+    m_name(name)
+{
+}
@@ -0,0 +1,62 @@
+/**
+ *  @file   MarlinPandora/src/SymmetricSectorGap.cc
+ *
+ *  @brief  Implementation of the symmetric sector gap class.
+ *
+ *  $Log: $
+ */
+
+#include "SymmetricSectorGap.h"
+
+#include <cmath>
+
+SymmetricSectorGap::SymmetricSectorGap(const unsigned int symmetryOrder, const float phi0, const float innerRadius, const float outerRadius,
+        const float minZ, const float maxZ, const float gapWidth, const pandora::CartesianVector &vertexOffset) :
+    m_symmetryOrder(symmetryOrder),
+    m_phi0(phi0),
+    m_innerRadius(innerRadius),
+    m_outerRadius(outerRadius),
+    m_minZ(minZ),
+    m_maxZ(maxZ),
+    m_gapWidth(gapWidth),
+    m_vertexOffset(vertexOffset)
+{
+    if ((0 == m_symmetryOrder) || (m_outerRadius < m_innerRadius) || (m_maxZ < m_minZ) || (m_gapWidth < 0.f))
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    for (unsigned int i = 0; i < m_symmetryOrder; ++i)
+    {
+        const float phi = m_phi0 + (2. * M_PI * static_cast<float>(i) / static_cast<float>(m_symmetryOrder));
+        m_sinPhi.push_back(std::sin(phi));
+        m_cosPhi.push_back(std::cos(phi));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void SymmetricSectorGap::GetBoxGapParameters(BoxGapParametersVector &boxGapParametersVector) const
+{
+    const pandora::CartesianVector basicGapVertex(pandora::CartesianVector(-0.5f * m_gapWidth, m_innerRadius, m_minZ) + m_vertexOffset);
+    const pandora::CartesianVector basicSide1(m_gapWidth, 0, 0);
+    const pandora::CartesianVector basicSide2(0, m_outerRadius - m_innerRadius, 0);
+    const pandora::CartesianVector basicSide3(0, 0, m_maxZ - m_minZ);
+
+    for (unsigned int i = 0; i < m_symmetryOrder; ++i)
+    {
+        const float sinPhi(m_sinPhi[i]);
+        const float cosPhi(m_cosPhi[i]);
+
+        PandoraApi::Geometry::BoxGap::Parameters gapParameters;
+
+        gapParameters.m_vertex = pandora::CartesianVector(cosPhi * basicGapVertex.GetX() + sinPhi * basicGapVertex.GetY(),
+            -sinPhi * basicGapVertex.GetX() + cosPhi * basicGapVertex.GetY(), basicGapVertex.GetZ());
+        gapParameters.m_side1 = pandora::CartesianVector(cosPhi * basicSide1.GetX() + sinPhi * basicSide1.GetY(),
+            -sinPhi * basicSide1.GetX() + cosPhi * basicSide1.GetY(), basicSide1.GetZ());
+        gapParameters.m_side2 = pandora::CartesianVector(cosPhi * basicSide2.GetX() + sinPhi * basicSide2.GetY(),
+            -sinPhi * basicSide2.GetX() + cosPhi * basicSide2.GetY(), basicSide2.GetZ());
+        gapParameters.m_side3 = pandora::CartesianVector(cosPhi * basicSide3.GetX() + sinPhi * basicSide3.GetY(),
+            -sinPhi * basicSide3.GetX() + cosPhi * basicSide3.GetY(), basicSide3.GetZ());
+
+        boxGapParametersVector.push_back(gapParameters);
+    }
+}
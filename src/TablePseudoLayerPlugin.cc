@@ -0,0 +1,260 @@
+/**
+ *  @file   MarlinPandora/src/TablePseudoLayerPlugin.cc
+ *
+ *  @brief  Implementation of the table pseudo layer plugin class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Geometry/SubDetector.h"
+
+#include "Managers/GeometryManager.h"
+
+#include "Pandora/Pandora.h"
+
+#include "TablePseudoLayerPlugin.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace pandora;
+
+TablePseudoLayerPlugin::TablePseudoLayerPlugin() :
+    m_barrelInnerR(0.f),
+    m_endCapInnerZ(0.f),
+    m_barrelOuterR(0.f),
+    m_endCapOuterZ(0.f),
+    m_rCorrection(0.f),
+    m_zCorrection(0.f),
+    m_pseudoLayerAtIp(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int TablePseudoLayerPlugin::GetPseudoLayer(const CartesianVector &positionVector) const
+{
+    const float zCoordinate(std::fabs(positionVector.GetZ()));
+
+    if (zCoordinate > m_endCapOuterZ)
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+    const float rCoordinate(m_eCalBarrelPolygon.GetRadius(positionVector.GetX(), positionVector.GetY()));
+
+    if (m_muonBarrelPolygon.GetRadius(positionVector.GetX(), positionVector.GetY()) > m_barrelOuterR)
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+    unsigned int pseudoLayer(0);
+
+    if (zCoordinate < m_endCapInnerZ)
+    {
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, this->FindMatchingLayer(rCoordinate, m_barrelLayerPositions, pseudoLayer));
+    }
+    else if (rCoordinate < m_barrelInnerR)
+    {
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, this->FindMatchingLayer(zCoordinate, m_endCapLayerPositions, pseudoLayer));
+    }
+    else
+    {
+        // Barrel-endcap overlap region: take the deeper of the corrected barrel and endcap layers
+        unsigned int barrelLayer(0), endCapLayer(0);
+        const StatusCode barrelStatusCode(this->FindMatchingLayer(rCoordinate - m_rCorrection, m_barrelLayerPositions, barrelLayer));
+        const StatusCode endCapStatusCode(this->FindMatchingLayer(zCoordinate - m_zCorrection, m_endCapLayerPositions, endCapLayer));
+
+        if ((STATUS_CODE_SUCCESS != barrelStatusCode) && (STATUS_CODE_SUCCESS != endCapStatusCode))
+            throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+        pseudoLayer = std::max(barrelLayer, endCapLayer);
+    }
+
+    // ATTN Pseudo layer zero is reserved for track projections
+    return (1 + pseudoLayer);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int TablePseudoLayerPlugin::GetPseudoLayerAtIp() const
+{
+    return m_pseudoLayerAtIp;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TablePseudoLayerPlugin::Initialize()
+{
+    try
+    {
+        const GeometryManager *const pGeometryManager(this->GetPandora().GetGeometry());
+        const SubDetector &eCalBarrel(pGeometryManager->GetSubDetector(ECAL_BARREL));
+        const SubDetector &eCalEndCap(pGeometryManager->GetSubDetector(ECAL_ENDCAP));
+        const SubDetector &hCalBarrel(pGeometryManager->GetSubDetector(HCAL_BARREL));
+        const SubDetector &hCalEndCap(pGeometryManager->GetSubDetector(HCAL_ENDCAP));
+        const SubDetector &muonBarrel(pGeometryManager->GetSubDetector(MUON_BARREL));
+        const SubDetector &muonEndCap(pGeometryManager->GetSubDetector(MUON_ENDCAP));
+
+        this->StoreLayerPositions(eCalBarrel, m_barrelLayerPositions);
+        this->StoreLayerPositions(hCalBarrel, m_barrelLayerPositions);
+        this->StoreLayerPositions(muonBarrel, m_barrelLayerPositions);
+        this->StoreLayerPositions(eCalEndCap, m_endCapLayerPositions);
+        this->StoreLayerPositions(hCalEndCap, m_endCapLayerPositions);
+        this->StoreLayerPositions(muonEndCap, m_endCapLayerPositions);
+
+        if (m_barrelLayerPositions.empty() || m_endCapLayerPositions.empty())
+        {
+            streamlog_out(ERROR) << "TablePseudoLayerPlugin - No barrel or endcap layers registered" << std::endl;
+            return STATUS_CODE_NOT_INITIALIZED;
+        }
+
+        m_eCalBarrelPolygon.Fill(eCalBarrel.GetInnerSymmetryOrder(), eCalBarrel.GetInnerPhiCoordinate());
+        m_muonBarrelPolygon.Fill(muonBarrel.GetInnerSymmetryOrder(), muonBarrel.GetInnerPhiCoordinate());
+
+        m_barrelInnerR = eCalBarrel.GetInnerRCoordinate();
+        m_endCapInnerZ = std::fabs(eCalEndCap.GetInnerZCoordinate());
+        m_barrelOuterR = std::max(eCalBarrel.GetOuterRCoordinate(), std::max(hCalBarrel.GetOuterRCoordinate(), muonBarrel.GetOuterRCoordinate()));
+        m_endCapOuterZ = std::max(std::fabs(eCalEndCap.GetOuterZCoordinate()), std::max(std::fabs(hCalEndCap.GetOuterZCoordinate()),
+            std::fabs(muonEndCap.GetOuterZCoordinate())));
+
+        // In the overlap region, scale the barrel (or endcap) position so that layers meet along the line joining the ecal corners
+        const float barrelOuterZ(std::fabs(eCalBarrel.GetOuterZCoordinate()));
+        const float endCapOuterR(eCalEndCap.GetOuterRCoordinate());
+        const bool isEnclosingEndCap(endCapOuterR > m_barrelInnerR);
+
+        if ((barrelOuterZ < std::numeric_limits<float>::epsilon()) || (endCapOuterR < std::numeric_limits<float>::epsilon()))
+            return STATUS_CODE_INVALID_PARAMETER;
+
+        m_rCorrection = isEnclosingEndCap ? m_barrelInnerR * ((m_endCapInnerZ / barrelOuterZ) - 1.f) : 0.f;
+        m_zCorrection = isEnclosingEndCap ? 0.f : m_endCapInnerZ * ((m_barrelInnerR / endCapOuterR) - 1.f);
+
+        m_pseudoLayerAtIp = this->GetPseudoLayer(CartesianVector(0.f, 0.f, 0.f));
+    }
+    catch (StatusCodeException &statusCodeException)
+    {
+        streamlog_out(ERROR) << "TablePseudoLayerPlugin - Failed to initialize: " << statusCodeException.ToString() << std::endl;
+        return statusCodeException.GetStatusCode();
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TablePseudoLayerPlugin::ReadSettings(const TiXmlHandle /*xmlHandle*/)
+{
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float TablePseudoLayerPlugin::GetPseudoAngle(const float x, const float y)
+{
+    const float sum(std::fabs(x) + std::fabs(y));
+
+    if (sum < std::numeric_limits<float>::min())
+        return 0.f;
+
+    const float p(x / sum);
+    return ((y < 0.f) ? 3.f + p : 1.f - p);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void TablePseudoLayerPlugin::StoreLayerPositions(const SubDetector &subDetector, LayerPositionList &layerPositionList) const
+{
+    if (!subDetector.IsMirroredInZ())
+    {
+        streamlog_out(ERROR) << "TablePseudoLayerPlugin - Sub-detectors must be mirrored in z" << std::endl;
+        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    const SubDetector::SubDetectorLayerList &subDetectorLayerList(subDetector.GetSubDetectorLayerList());
+
+    for (SubDetector::SubDetectorLayerList::const_iterator iter = subDetectorLayerList.begin(), iterEnd = subDetectorLayerList.end();
+        iter != iterEnd; ++iter)
+    {
+        const float layerPosition(iter->GetClosestDistanceToIp());
+
+        if (!layerPositionList.empty() && (layerPosition - layerPositionList.back() < std::numeric_limits<float>::epsilon()))
+        {
+            streamlog_out(ERROR) << "TablePseudoLayerPlugin - Layer positions must increase with depth" << std::endl;
+            throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+        }
+
+        layerPositionList.push_back(layerPosition);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TablePseudoLayerPlugin::FindMatchingLayer(const float position, const LayerPositionList &layerPositionList, unsigned int &layer) const
+{
+    LayerPositionList::const_iterator upperIter = std::upper_bound(layerPositionList.begin(), layerPositionList.end(), position);
+
+    if (layerPositionList.end() == upperIter)
+        return STATUS_CODE_NOT_FOUND;
+
+    if (layerPositionList.begin() == upperIter)
+    {
+        layer = 0;
+        return STATUS_CODE_SUCCESS;
+    }
+
+    LayerPositionList::const_iterator lowerIter = upperIter - 1;
+    layer = std::distance(layerPositionList.begin(), (std::fabs(position - *lowerIter) < std::fabs(position - *upperIter)) ? lowerIter : upperIter);
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void TablePseudoLayerPlugin::PolygonTable::Fill(const unsigned int symmetryOrder, const float phi0)
+{
+    m_normals.clear();
+    m_vertexPseudoAngles.clear();
+    m_sectors.clear();
+
+    if (symmetryOrder <= 2)
+        return;
+
+    const float twoPi(static_cast<float>(2. * std::acos(-1.)));
+    const float sectorAngle(twoPi / static_cast<float>(symmetryOrder));
+    std::vector<std::pair<float, unsigned int> > vertexVector;
+
+    for (unsigned int iSide = 0; iSide < symmetryOrder; ++iSide)
+    {
+        const float normalPhi(phi0 + sectorAngle * static_cast<float>(iSide));
+        m_normals.push_back(std::make_pair(std::cos(normalPhi), std::sin(normalPhi)));
+
+        // The vertex half a sector beyond each normal is followed by the next side
+        const float vertexPhi(normalPhi + 0.5f * sectorAngle);
+        vertexVector.push_back(std::make_pair(GetPseudoAngle(std::cos(vertexPhi), std::sin(vertexPhi)), (iSide + 1) % symmetryOrder));
+    }
+
+    std::sort(vertexVector.begin(), vertexVector.end());
+
+    for (std::vector<std::pair<float, unsigned int> >::const_iterator iter = vertexVector.begin(), iterEnd = vertexVector.end(); iter != iterEnd; ++iter)
+    {
+        m_vertexPseudoAngles.push_back(iter->first);
+        m_sectors.push_back(iter->second);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float TablePseudoLayerPlugin::PolygonTable::GetRadius(const float x, const float y) const
+{
+    if (m_normals.empty())
+        return std::sqrt(x * x + y * y);
+
+    // Points before the first vertex, in pseudo angle, lie on the side following the last vertex
+    const PseudoAngleVector::const_iterator upperIter(std::upper_bound(m_vertexPseudoAngles.begin(), m_vertexPseudoAngles.end(),
+        GetPseudoAngle(x, y)));
+    const unsigned int sector((m_vertexPseudoAngles.begin() == upperIter) ? m_sectors.back() :
+        m_sectors[std::distance(m_vertexPseudoAngles.begin(), upperIter) - 1]);
+
+    const std::pair<float, float> &normal(m_normals[sector]);
+    return std::max(0.f, x * normal.first + y * normal.second);
+}
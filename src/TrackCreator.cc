@@ -29,46 +29,22 @@
 #include <cmath>
 #include <limits>
 
-TrackCreator::TrackCreator(const Settings &settings, const pandora::Pandora *const pPandora) :
+TrackCreator::TrackCreator(const Settings &settings, const GeometryProvider &geometryProvider) :
     m_settings(settings),
-    m_pPandora(pPandora),
-    m_bField(marlin::Global::GEAR->getBField().at(gear::Vector3D(0., 0., 0.)).z()),
-    m_tpcInnerR(marlin::Global::GEAR->getTPCParameters().getPadLayout().getPlaneExtent()[0]),
-    m_tpcOuterR(marlin::Global::GEAR->getTPCParameters().getPadLayout().getPlaneExtent()[1]),
-    m_tpcMaxRow(marlin::Global::GEAR->getTPCParameters().getPadLayout().getNRows()),
-    m_tpcZmax(marlin::Global::GEAR->getTPCParameters().getMaxDriftLength()),
-    m_eCalBarrelInnerSymmetry(marlin::Global::GEAR->getEcalBarrelParameters().getSymmetryOrder()),
-    m_eCalBarrelInnerPhi0(marlin::Global::GEAR->getEcalBarrelParameters().getPhi0()),
-    m_eCalBarrelInnerR(marlin::Global::GEAR->getEcalBarrelParameters().getExtent()[0]),
-    m_eCalEndCapInnerZ(marlin::Global::GEAR->getEcalEndcapParameters().getExtent()[2])
+    m_bField(geometryProvider.GetConstant("InnerBField")),
+    m_tpcInnerR(geometryProvider.GetConstant("TPCInnerR")),
+    m_tpcOuterR(geometryProvider.GetConstant("TPCOuterR")),
+    m_tpcMaxRow(geometryProvider.GetConstant("TPCMaxRow")),
+    m_tpcZmax(geometryProvider.GetConstant("TPCZMax")),
+    m_ftdInnerRadii(geometryProvider.GetConstants("FTDInnerRadii")),
+    m_ftdOuterRadii(geometryProvider.GetConstants("FTDOuterRadii")),
+    m_ftdZPositions(geometryProvider.GetConstants("FTDZPositions")),
+    m_nFtdLayers(m_ftdZPositions.size()),
+    m_eCalBarrelInnerSymmetry(geometryProvider.GetConstant("ECalBarrelInnerSymmetry")),
+    m_eCalBarrelInnerPhi0(geometryProvider.GetConstant("ECalBarrelInnerPhi0")),
+    m_eCalBarrelInnerR(geometryProvider.GetConstant("ECalBarrelInnerR")),
+    m_eCalEndCapInnerZ(geometryProvider.GetConstant("ECalEndCapInnerZ"))
 {
-    // fg: FTD description in GEAR has changed ...
-    try
-    {
-        m_ftdInnerRadii = marlin::Global::GEAR->getGearParameters("FTD").getDoubleVals("FTDInnerRadius");
-        m_ftdOuterRadii = marlin::Global::GEAR->getGearParameters("FTD").getDoubleVals("FTDOuterRadius");
-        m_ftdZPositions = marlin::Global::GEAR->getGearParameters("FTD").getDoubleVals("FTDZCoordinate");
-        m_nFtdLayers = m_ftdZPositions.size();
-    }
-    catch (gear::UnknownParameterException &)
-    {
-        const gear::FTDLayerLayout &ftdLayerLayout(marlin::Global::GEAR->getFTDParameters().getFTDLayerLayout());
-        streamlog_out( DEBUG2 ) << " Filling FTD parameters from gear::FTDParameters - n layers: " << ftdLayerLayout.getNLayers() << std::endl;
-
-        for(unsigned int i = 0, N = ftdLayerLayout.getNLayers(); i < N; ++i)
-        {
-            // Create a disk to represent even number petals front side
-            m_ftdInnerRadii.push_back(ftdLayerLayout.getSensitiveRinner(i));
-            m_ftdOuterRadii.push_back(ftdLayerLayout.getMaxRadius(i));
-
-            // Take the mean z position of the staggered petals
-            const double zpos(ftdLayerLayout.getZposition(i));
-            m_ftdZPositions.push_back(zpos);
-            streamlog_out( DEBUG2 ) << "     layer " << i << " - mean z position = " << zpos << std::endl;
-        }
-
-        m_nFtdLayers = m_ftdZPositions.size() ;
-    }
 
     // Check tpc parameters
     if ((std::fabs(m_tpcZmax) < std::numeric_limits<float>::epsilon()) || (std::fabs(m_tpcInnerR) < std::numeric_limits<float>::epsilon())
@@ -98,10 +74,10 @@ TrackCreator::TrackCreator(const Settings &settings, const pandora::Pandora *con
 
     // Calculate etd and set parameters
     // fg: make SET and ETD optional - as they might not be in the model ...
-    try
+    if (geometryProvider.HasConstant("ETDZPositions") && geometryProvider.HasConstant("SETInnerRadii"))
     {
-        const DoubleVector &etdZPositions(marlin::Global::GEAR->getGearParameters("ETD").getDoubleVals("ETDLayerZ"));
-        const DoubleVector &setInnerRadii(marlin::Global::GEAR->getGearParameters("SET").getDoubleVals("SETLayerRadius"));
+        const DoubleVector &etdZPositions(geometryProvider.GetConstants("ETDZPositions"));
+        const DoubleVector &setInnerRadii(geometryProvider.GetConstants("SETInnerRadii"));
 
         if (etdZPositions.empty() || setInnerRadii.empty())
             throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
@@ -109,7 +85,7 @@ TrackCreator::TrackCreator(const Settings &settings, const pandora::Pandora *con
         m_minEtdZPosition = *(std::min_element(etdZPositions.begin(), etdZPositions.end()));
         m_minSetRadius = *(std::min_element(setInnerRadii.begin(), setInnerRadii.end()));
     }
-    catch(gear::UnknownParameterException &)
+    else
     {
         streamlog_out(WARNING) << " ETDLayerZ or SETLayerRadius parameters missing from GEAR parameters!" << std::endl
                                << "     -> both will be set to " << std::numeric_limits<float>::quiet_NaN() << std::endl;
@@ -214,8 +190,7 @@ pandora::StatusCode TrackCreator::ExtractKinks(const EVENT::LCEvent *const pLCEv
                         {
                             for (unsigned int jTrack = iTrack + 1; jTrack < nTracks; ++jTrack)
                             {
-                                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackParentDaughterRelationship(*m_pPandora,
-                                    pTrack, trackVec[jTrack]));
+                                m_parentDaughterTrackPairs.push_back(TrackPair(pTrack, trackVec[jTrack]));
                             }
                         }
 
@@ -224,8 +199,7 @@ pandora::StatusCode TrackCreator::ExtractKinks(const EVENT::LCEvent *const pLCEv
                         {
                             for (unsigned int jTrack = iTrack + 1; jTrack < nTracks; ++jTrack)
                             {
-                                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackSiblingRelationship(*m_pPandora,
-                                    pTrack, trackVec[jTrack]));
+                                m_siblingTrackPairs.push_back(TrackPair(pTrack, trackVec[jTrack]));
                             }
                         }
                     }
@@ -286,8 +260,7 @@ pandora::StatusCode TrackCreator::ExtractProngsAndSplits(const EVENT::LCEvent *c
                         {
                             for (unsigned int jTrack = iTrack + 1; jTrack < nTracks; ++jTrack)
                             {
-                                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackParentDaughterRelationship(*m_pPandora,
-                                    pTrack, trackVec[jTrack]));
+                                m_parentDaughterTrackPairs.push_back(TrackPair(pTrack, trackVec[jTrack]));
                             }
                         }
 
@@ -296,8 +269,7 @@ pandora::StatusCode TrackCreator::ExtractProngsAndSplits(const EVENT::LCEvent *c
                         {
                             for (unsigned int jTrack = iTrack + 1; jTrack < nTracks; ++jTrack)
                             {
-                                PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackSiblingRelationship(*m_pPandora,
-                                    pTrack, trackVec[jTrack]));
+                                m_siblingTrackPairs.push_back(TrackPair(pTrack, trackVec[jTrack]));
                             }
                         }
                     }
@@ -381,8 +353,7 @@ pandora::StatusCode TrackCreator::ExtractV0s(const EVENT::LCEvent *const pLCEven
                         // Make track sibling relationships
                         for (unsigned int jTrack = iTrack + 1; jTrack < nTracks; ++jTrack)
                         {
-                            PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackSiblingRelationship(*m_pPandora,
-                                pTrack, trackVec[jTrack]));
+                            m_siblingTrackPairs.push_back(TrackPair(pTrack, trackVec[jTrack]));
                         }
                     }
                 }
@@ -487,7 +458,7 @@ pandora::StatusCode TrackCreator::CreateTracks(EVENT::LCEvent *pLCEvent)
                     this->TrackReachesECAL(pTrack, trackParameters);
                     this->DefineTrackPfoUsage(pTrack, trackParameters);
 
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Track::Create(*m_pPandora, trackParameters));
+                    m_trackParametersVector.push_back(trackParameters);
                     m_trackVector.push_back(pTrack);
                 }
                 catch (pandora::StatusCodeException &statusCodeException)
@@ -511,6 +482,51 @@ pandora::StatusCode TrackCreator::CreateTracks(EVENT::LCEvent *pLCEvent)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+pandora::StatusCode TrackCreator::CreatePandoraTracks(const pandora::Pandora &pandora) const
+{
+    for (TrackParametersVector::const_iterator iter = m_trackParametersVector.begin(), iterEnd = m_trackParametersVector.end(); iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Track::Create(pandora, *iter));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create pandora track: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (TrackPairVector::const_iterator iter = m_parentDaughterTrackPairs.begin(), iterEnd = m_parentDaughterTrackPairs.end(); iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackParentDaughterRelationship(pandora,
+                iter->first, iter->second));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create track parent-daughter relationship: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    for (TrackPairVector::const_iterator iter = m_siblingTrackPairs.begin(), iterEnd = m_siblingTrackPairs.end(); iter != iterEnd; ++iter)
+    {
+        try
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetTrackSiblingRelationship(pandora,
+                iter->first, iter->second));
+        }
+        catch (pandora::StatusCodeException &statusCodeException)
+        {
+            streamlog_out(ERROR) << "Failed to create track sibling relationship: " << statusCodeException.ToString() << std::endl;
+        }
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void TrackCreator::GetTrackStates(const EVENT::Track *const pTrack, PandoraApi::Track::Parameters &trackParameters) const
 {
     const TrackState *pTrackState = pTrack->getTrackState(TrackState::AtIP);
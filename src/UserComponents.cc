@@ -0,0 +1,82 @@
+/**
+ *  @file   MarlinPandora/src/UserComponents.cc
+ *
+ *  @brief  Implementation of the user components class.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "LCContent.h"
+
+#include "FieldMapBFieldPlugin.h"
+#include "GridNonLinearityCorrectionPlugin.h"
+#include "ParallelReclusteringAlgorithm.h"
+#include "ProfilingAlgorithm.h"
+#include "ReclusteringCandidateAlgorithm.h"
+#include "SpatialHashClusteringAlgorithm.h"
+#include "TablePseudoLayerPlugin.h"
+#include "UserComponents.h"
+
+pandora::StatusCode UserComponents::Register(const pandora::Pandora &pandora, const Settings &settings, const GeometryProvider &geometryProvider)
+{
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterAlgorithms(pandora));
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterBasicPlugins(pandora));
+
+    // ATTN Registered after the basic plugins, so replaces the lc pseudo layer plugin
+    if (settings.m_useTablePseudoLayerPlugin)
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetPseudoLayerPlugin(pandora, new TablePseudoLayerPlugin));
+
+    if (settings.m_useBFieldMap && FieldMapBFieldPlugin::HasBFieldMap(geometryProvider))
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetBFieldPlugin(pandora, new FieldMapBFieldPlugin(geometryProvider)));
+    }
+    else
+    {
+        if (settings.m_useBFieldMap)
+            streamlog_out(WARNING) << "UserComponents - Geometry has no bfield map, using constant bfield regions" << std::endl;
+
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterBFieldPlugin(pandora,
+            settings.m_innerBField, settings.m_muonBarrelBField, settings.m_muonEndCapBField));
+    }
+
+    if (settings.m_nNonLinearityGridPoints > 0)
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterEnergyCorrectionPlugin(pandora, "NonLinearity", pandora::HADRONIC,
+            new GridNonLinearityCorrectionPlugin(settings.m_inputEnergyCorrectionPoints, settings.m_outputEnergyCorrectionPoints,
+            settings.m_nNonLinearityGridPoints)));
+    }
+    else
+    {
+        PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LCContent::RegisterNonLinearityEnergyCorrection(pandora,
+            "NonLinearity", pandora::HADRONIC, settings.m_inputEnergyCorrectionPoints, settings.m_outputEnergyCorrectionPoints));
+    }
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
+        "Profiling", new ProfilingAlgorithm::Factory));
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
+        "SpatialHashClustering", new SpatialHashClusteringAlgorithm::Factory));
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
+        "ParallelReclustering", new ParallelReclusteringAlgorithm::Factory));
+
+    PANDORA_RETURN_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(pandora,
+        "ReclusteringCandidate", new ReclusteringCandidateAlgorithm::Factory));
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+UserComponents::Settings::Settings() :
+    m_innerBField(3.5f),
+    m_muonBarrelBField(-1.5f),
+    m_muonEndCapBField(0.01f),
+    m_useBFieldMap(0),
+    m_useTablePseudoLayerPlugin(0),
+    m_nNonLinearityGridPoints(0)
+{
+}
@@ -0,0 +1,200 @@
+/**
+ *  @file   MarlinPandora/tools/PandoraLikelihoodMerger.cc
+ *
+ *  @brief  Merger, summing the training events of many photon reconstruction likelihood xml files into a single likelihood file.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "PhotonLikelihoodData.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+typedef std::vector<std::string> StringVector;
+
+/**
+ *  @brief  Worker class, reading every nth input file and adding it to its own partial sum
+ */
+class Worker
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  workerIndex the worker index
+     *  @param  nWorkers the total number of workers
+     *  @param  inputFiles the input likelihood xml file names
+     */
+    Worker(const unsigned int workerIndex, const unsigned int nWorkers, const StringVector &inputFiles);
+
+    /**
+     *  @brief  Read and sum the input files assigned to this worker; each file is parsed once and released before the next is read
+     */
+    void Run();
+
+    /**
+     *  @brief  Get the partial sum
+     *
+     *  @return the partial sum
+     */
+    const PhotonLikelihoodSum &GetLikelihoodSum() const;
+
+    /**
+     *  @brief  Whether the worker completed without error
+     *
+     *  @return boolean
+     */
+    bool IsSuccessful() const;
+
+private:
+    const unsigned int      m_workerIndex;                  ///< The worker index
+    const unsigned int      m_nWorkers;                     ///< The total number of workers
+    const StringVector     &m_inputFiles;                   ///< The input likelihood xml file names
+    PhotonLikelihoodSum     m_likelihoodSum;                ///< The partial sum
+    bool                    m_isSuccessful;                 ///< Whether the worker completed without error
+};
+
+/**
+ *  @brief  Print the usage message
+ *
+ *  @param  programName the program name
+ */
+void PrintUsage(const std::string &programName);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    std::string outputFile;
+    unsigned int nWorkers(std::max(1U, std::thread::hardware_concurrency()));
+    int option(0);
+
+    while ((option = getopt(argc, argv, "o:j:h")) != -1)
+    {
+        switch (option)
+        {
+        case 'o':
+            outputFile = optarg;
+            break;
+        case 'j':
+            nWorkers = std::max(1, std::atoi(optarg));
+            break;
+        case 'h':
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const StringVector inputFiles(argv + optind, argv + argc);
+
+    if (outputFile.empty() || inputFiles.empty())
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    streamlog::out.init(std::cout, argv[0]);
+
+    nWorkers = std::min(nWorkers, static_cast<unsigned int>(inputFiles.size()));
+
+    std::vector<Worker> workerVector;
+
+    for (unsigned int iWorker = 0; iWorker < nWorkers; ++iWorker)
+        workerVector.push_back(Worker(iWorker, nWorkers, inputFiles));
+
+    std::vector<std::thread> threadVector;
+
+    for (std::vector<Worker>::iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+        threadVector.push_back(std::thread(&Worker::Run, &(*iter)));
+
+    for (std::vector<std::thread>::iterator iter = threadVector.begin(), iterEnd = threadVector.end(); iter != iterEnd; ++iter)
+        iter->join();
+
+    try
+    {
+        // ATTN Bin counts are whole numbers of events, so the partial sums combine exactly, whatever the assignment of files to workers
+        PhotonLikelihoodSum likelihoodSum;
+
+        for (std::vector<Worker>::const_iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+        {
+            if (!iter->IsSuccessful())
+                throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, likelihoodSum.Add(iter->GetLikelihoodSum()));
+        }
+
+        PhotonLikelihoodData likelihoodData;
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, likelihoodSum.GetLikelihoodData(likelihoodData));
+
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, likelihoodData.WriteXml(outputFile));
+
+        std::cout << "PandoraLikelihoodMerger: merged " << likelihoodSum.GetNInputs() << " files with " << nWorkers << " worker(s) into "
+                  << outputFile << std::endl;
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        std::cout << "PandoraLikelihoodMerger: pandora exception " << statusCodeException.ToString() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PrintUsage(const std::string &programName)
+{
+    std::cout << "Usage: " << programName << " -o output.xml [-j nWorkers] input1.xml [input2.xml ...]" << std::endl
+              << "    -o  merged likelihood file to write" << std::endl
+              << "    -j  number of worker threads reading the input files (default number of hardware threads)" << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Worker::Worker(const unsigned int workerIndex, const unsigned int nWorkers, const StringVector &inputFiles) :
+    m_workerIndex(workerIndex),
+    m_nWorkers(nWorkers),
+    m_inputFiles(inputFiles),
+    m_isSuccessful(true)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Worker::Run()
+{
+    for (unsigned int iFile = m_workerIndex, nFiles = m_inputFiles.size(); iFile < nFiles; iFile += m_nWorkers)
+    {
+        PhotonLikelihoodData likelihoodData;
+
+        if ((pandora::STATUS_CODE_SUCCESS != likelihoodData.ReadXml(m_inputFiles[iFile])) ||
+            (pandora::STATUS_CODE_SUCCESS != m_likelihoodSum.Add(likelihoodData)))
+        {
+            std::cout << "PandoraLikelihoodMerger: unable to add " << m_inputFiles[iFile] << std::endl;
+            m_isSuccessful = false;
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const PhotonLikelihoodSum &Worker::GetLikelihoodSum() const
+{
+    return m_likelihoodSum;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool Worker::IsSuccessful() const
+{
+    return m_isSuccessful;
+}
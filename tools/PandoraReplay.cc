@@ -0,0 +1,247 @@
+/**
+ *  @file   MarlinPandora/tools/PandoraReplay.cc
+ *
+ *  @brief  Replay driver, running pandora over recorded inputs without lcio, gear or marlin.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Processor.h"
+
+#include "Api/PandoraApi.h"
+
+#include "GeometrySnapshot.h"
+#include "InputRecord.h"
+#include "InputRecordFile.h"
+#include "ParallelReclusteringAlgorithm.h"
+#include "ProfilingAlgorithm.h"
+#include "UserComponents.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+
+typedef std::vector<pandora::Pandora *> PandoraVector;
+
+/**
+ *  @brief  Register the user components, with the plugin selections recorded in the input record file header, create the geometry and
+ *          read the settings
+ *
+ *  @param  pandora the pandora instance
+ *  @param  header the input record file header
+ *  @param  geometrySnapshot the geometry snapshot
+ *  @param  settingsXmlFile the settings xml file
+ */
+void InitialisePandoraInstance(const pandora::Pandora &pandora, const InputRecordHeader &header, const GeometrySnapshot &geometrySnapshot,
+    const std::string &settingsXmlFile);
+
+/**
+ *  @brief  Print the usage message
+ *
+ *  @param  programName the program name
+ */
+void PrintUsage(const std::string &programName);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    std::string recordFile, geometrySnapshotFile, settingsXmlFile, reclusteringSettingsXmlFile;
+    int eventIndex(-1), nReclusteringWorkers(4);
+    unsigned int nRepeats(1);
+    bool useHardwareCounters(false);
+    int option(0);
+
+    while ((option = getopt(argc, argv, "i:g:s:w:n:e:r:ch")) != -1)
+    {
+        switch (option)
+        {
+        case 'i':
+            recordFile = optarg;
+            break;
+        case 'g':
+            geometrySnapshotFile = optarg;
+            break;
+        case 's':
+            settingsXmlFile = optarg;
+            break;
+        case 'w':
+            reclusteringSettingsXmlFile = optarg;
+            break;
+        case 'n':
+            nReclusteringWorkers = std::atoi(optarg);
+            break;
+        case 'e':
+            eventIndex = std::atoi(optarg);
+            break;
+        case 'r':
+            nRepeats = std::max(1, std::atoi(optarg));
+            break;
+        case 'c':
+            useHardwareCounters = true;
+            break;
+        case 'h':
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (recordFile.empty() || geometrySnapshotFile.empty() || settingsXmlFile.empty())
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    streamlog::out.init(std::cout, argv[0]);
+
+    pandora::Pandora *pPandora(NULL);
+    PandoraVector reclusteringWorkerVector;
+    ReclusteringWorkerPool *pReclusteringWorkerPool(NULL);
+    int returnCode(0);
+
+    try
+    {
+        InputRecordReader inputRecordReader;
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, inputRecordReader.Open(recordFile));
+
+        const InputRecordHeader &header(inputRecordReader.GetHeader());
+
+        // ATTN The snapshot must have been written for the same detector and geometry settings as the recorded inputs
+        GeometrySnapshot geometrySnapshot(header.m_geometryKey);
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, geometrySnapshot.Read(geometrySnapshotFile));
+
+        pPandora = new pandora::Pandora();
+
+        // ATTN The workers must be passed to the parallel reclustering algorithms before the primary instance reads its settings
+        if (!reclusteringSettingsXmlFile.empty())
+        {
+            if (nReclusteringWorkers <= 0)
+            {
+                std::cout << "PandoraReplay: the reclustering settings xml file requires a positive number of reclustering workers" << std::endl;
+                throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+            }
+
+            ParallelReclusteringAlgorithm::PandoraVector workerVector;
+
+            for (int iWorker = 0; iWorker < nReclusteringWorkers; ++iWorker)
+            {
+                pandora::Pandora *const pWorker = new pandora::Pandora();
+                reclusteringWorkerVector.push_back(pWorker);
+                workerVector.push_back(pWorker);
+                InitialisePandoraInstance(*pWorker, header, geometrySnapshot, reclusteringSettingsXmlFile);
+            }
+
+            pReclusteringWorkerPool = new ReclusteringWorkerPool(workerVector);
+            ParallelReclusteringAlgorithm::SetWorkers(*pPandora, pReclusteringWorkerPool);
+        }
+
+        InitialisePandoraInstance(*pPandora, header, geometrySnapshot, settingsXmlFile);
+
+        if (useHardwareCounters)
+            ProfilingAlgorithm::EnableHardwareCounters(*pPandora);
+
+        const unsigned int nEvents(inputRecordReader.GetNEvents());
+        const unsigned int firstEvent((eventIndex < 0) ? 0 : eventIndex);
+        const unsigned int lastEvent((eventIndex < 0) ? nEvents : eventIndex + 1);
+
+        if (lastEvent > nEvents)
+        {
+            std::cout << "PandoraReplay: event index " << eventIndex << " out of range, file holds " << nEvents << " events" << std::endl;
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_OUT_OF_RANGE);
+        }
+
+        InputRecord inputRecord;
+        double totalInputSeconds(0.), totalSeconds(0.);
+        unsigned int nProcessed(0);
+
+        for (unsigned int iEvent = firstEvent; iEvent < lastEvent; ++iEvent)
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, inputRecordReader.ReadEvent(iEvent, inputRecord));
+
+            for (unsigned int iRepeat = 0; iRepeat < nRepeats; ++iRepeat)
+            {
+                // Input creation is timed separately, so that the processing time is comparable with the pandora algorithm timing
+                const std::chrono::steady_clock::time_point startTime(std::chrono::steady_clock::now());
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, inputRecord.CreatePandoraInputs(*pPandora));
+                const std::chrono::steady_clock::time_point inputTime(std::chrono::steady_clock::now());
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPandora));
+                const std::chrono::steady_clock::time_point endTime(std::chrono::steady_clock::now());
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPandora));
+
+                const double inputSeconds(std::chrono::duration<double>(inputTime - startTime).count());
+                const double seconds(std::chrono::duration<double>(endTime - inputTime).count());
+                totalInputSeconds += inputSeconds;
+                totalSeconds += seconds;
+                ++nProcessed;
+
+                std::cout << "PandoraReplay: run " << inputRecord.GetRunNumber() << " event " << inputRecord.GetEventNumber()
+                          << " (" << inputRecord.GetNTracks() << " tracks, " << inputRecord.GetNCaloHits() << " calo hits, "
+                          << inputRecord.GetNMCParticles() << " mc particles) inputs created in " << 1000. * inputSeconds << " ms, processed in "
+                          << 1000. * seconds << " ms" << std::endl;
+            }
+        }
+
+        if (nProcessed > 0)
+        {
+            std::cout << "PandoraReplay: processed " << nProcessed << " events, mean " << 1000. * totalInputSeconds / static_cast<double>(nProcessed)
+                      << " ms per event creating inputs, " << 1000. * totalSeconds / static_cast<double>(nProcessed) << " ms per event processing"
+                      << std::endl;
+        }
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        std::cout << "PandoraReplay: pandora exception " << statusCodeException.ToString() << std::endl;
+        returnCode = 1;
+    }
+    catch (std::exception &exception)
+    {
+        std::cout << "PandoraReplay: exception " << exception.what() << std::endl;
+        returnCode = 1;
+    }
+
+    if (NULL != pPandora)
+    {
+        ProfilingAlgorithm::PrintProfile(*pPandora);
+        ProfilingAlgorithm::ResetProfile(*pPandora);
+        ParallelReclusteringAlgorithm::ResetWorkers(*pPandora);
+    }
+
+    delete pPandora;
+    delete pReclusteringWorkerPool;
+
+    for (PandoraVector::const_iterator iter = reclusteringWorkerVector.begin(), iterEnd = reclusteringWorkerVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    return returnCode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void InitialisePandoraInstance(const pandora::Pandora &pandora, const InputRecordHeader &header, const GeometrySnapshot &geometrySnapshot,
+    const std::string &settingsXmlFile)
+{
+    // ATTN The ExternalClustering and ExternalTrackClusterAssociation algorithms read lcio collections from the current event, so are unavailable when replaying
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, UserComponents::Register(pandora, header.m_userComponentSettings, geometrySnapshot));
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, geometrySnapshot.CreatePandoraGeometry(pandora));
+    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(pandora, settingsXmlFile));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PrintUsage(const std::string &programName)
+{
+    std::cout << "Usage: " << programName << " -i inputs.bin -g geometry.bin -s PandoraSettings.xml [-w ReclusteringSettings.xml] [-n nWorkers]"
+              << " [-e eventIndex] [-r nRepeats] [-c]" << std::endl
+              << "    -i  input record file, written by the processor RecordInputsFile parameter" << std::endl
+              << "    -g  geometry snapshot file, written by the processor GeometrySnapshotFile parameter" << std::endl
+              << "    -s  pandora settings xml file" << std::endl
+              << "    -w  settings xml file for the reclustering worker pandora instances, as for the processor ReclusteringSettingsXmlFile" << std::endl
+              << "    -n  number of reclustering worker pandora instances (default 4)" << std::endl
+              << "    -e  index of a single event to replay (default all)" << std::endl
+              << "    -r  number of times to replay each event (default 1)" << std::endl
+              << "    -c  add hardware counters to the profile of any algorithms wrapped in a Profiling algorithm" << std::endl;
+}
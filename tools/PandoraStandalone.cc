@@ -0,0 +1,526 @@
+/**
+ *  @file   MarlinPandora/tools/PandoraStandalone.cc
+ *
+ *  @brief  Standalone driver, running the pandora pfa new processor over lcio files without the marlin event loop.
+ *
+ *  $Log: $
+ */
+
+#include "marlin/Global.h"
+#include "marlin/StringParameters.h"
+#include "marlin/XMLParser.h"
+
+#include "gearxml/GearXML.h"
+
+#include "IO/LCWriter.h"
+#include "IOIMPL/LCFactory.h"
+#include "MT/LCReader.h"
+
+#include "PandoraPFANewProcessor.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+/**
+ *  @brief  StandaloneProcessor class, allowing the processor parameters to be set without the marlin processor manager
+ */
+class StandaloneProcessor : public PandoraPFANewProcessor
+{
+public:
+    /**
+     *  @brief  Set the processor parameters, as parsed from a marlin steering file
+     *
+     *  @param  pStringParameters address of the string parameters
+     */
+    void SetStringParameters(marlin::StringParameters *const pStringParameters);
+};
+
+/**
+ *  @brief  EventQueue class, a bounded queue handing the events read by a single reader to the worker threads, which take ownership
+ */
+class EventQueue
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  maxSize the maximum number of events waiting in the queue
+     */
+    EventQueue(const unsigned int maxSize);
+
+    /**
+     *  @brief  Destructor, deleting any events left in the queue
+     */
+    ~EventQueue();
+
+    /**
+     *  @brief  Add an event to the queue, waiting while the queue is full
+     *
+     *  @param  pLCEvent address of the event, owned by the queue if added
+     *
+     *  @return whether the event was added, false if the queue has been closed
+     */
+    bool Push(EVENT::LCEvent *const pLCEvent);
+
+    /**
+     *  @brief  Take an event from the queue, waiting while the queue is empty and open
+     *
+     *  @return address of the event, now owned by the caller, or NULL once the queue is closed and empty
+     */
+    EVENT::LCEvent *Pop();
+
+    /**
+     *  @brief  Close the queue, so that no further events are added and waiting workers finish once the queue is empty
+     */
+    void Close();
+
+private:
+    /**
+     *  @brief  Disallow copying
+     */
+    EventQueue(const EventQueue &);
+    EventQueue &operator=(const EventQueue &);
+
+    typedef std::deque<EVENT::LCEvent *> LCEventDeque;
+
+    const unsigned int              m_maxSize;                  ///< The maximum number of events waiting in the queue
+    LCEventDeque                    m_lcEventDeque;             ///< The events waiting in the queue
+    bool                            m_isClosed;                 ///< Whether the queue has been closed
+    std::mutex                      m_mutex;                    ///< The mutex guarding the queue
+    std::condition_variable         m_notEmpty;                 ///< Signalled when an event is added or the queue is closed
+    std::condition_variable         m_notFull;                  ///< Signalled when an event is taken or the queue is closed
+};
+
+/**
+ *  @brief  Worker class, processing the events taken from the event queue with its own processor and writer
+ */
+class Worker
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  workerIndex the worker index
+     *  @param  pProcessor address of the (initialized) processor owned by this worker
+     *  @param  pEventQueue address of the event queue
+     *  @param  outputFile the output lcio file name, empty if no output is required
+     */
+    Worker(const unsigned int workerIndex, StandaloneProcessor *const pProcessor, EventQueue *const pEventQueue, const std::string &outputFile);
+
+    /**
+     *  @brief  Process events from the queue until it is closed and empty
+     */
+    void Run();
+
+    /**
+     *  @brief  Get the number of events processed
+     *
+     *  @return the number of events processed
+     */
+    unsigned int GetNEventsProcessed() const;
+
+    /**
+     *  @brief  Whether the worker completed without error
+     *
+     *  @return boolean
+     */
+    bool IsSuccessful() const;
+
+private:
+    unsigned int                    m_workerIndex;              ///< The worker index
+    StandaloneProcessor            *m_pProcessor;               ///< Address of the processor owned by this worker
+    EventQueue                     *m_pEventQueue;              ///< Address of the event queue
+    std::string                     m_outputFile;               ///< The output lcio file name
+    unsigned int                    m_nEventsProcessed;         ///< The number of events processed
+    bool                            m_isSuccessful;             ///< Whether the worker completed without error
+};
+
+// ATTN Older sio implementations keep global state, so all lcio writing is serialised; only the reconstruction runs concurrently
+static std::mutex lcioMutex;
+
+// Messages printed by the worker threads themselves, rather than through streamlog
+static std::mutex outputMutex;
+
+/**
+ *  @brief  Read the input files with a single reader, handing the events to the workers, then close the event queue
+ *
+ *  @param  inputFiles the input lcio file names
+ *  @param  maxEvents the maximum number of events to read, negative for no limit
+ *  @param  eventQueue the event queue
+ *
+ *  @return whether the input files were read without error
+ */
+bool ReadEvents(const std::vector<std::string> &inputFiles, const int maxEvents, EventQueue &eventQueue);
+
+/**
+ *  @brief  Print the usage message
+ *
+ *  @param  programName the program name
+ */
+void PrintUsage(const std::string &programName);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    std::string steeringFile, outputFile, processorName("MyPandoraPFANewProcessor");
+    unsigned int nWorkers(1);
+    int maxEvents(-1);
+    int option(0);
+
+    while ((option = getopt(argc, argv, "s:o:p:t:n:h")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            steeringFile = optarg;
+            break;
+        case 'o':
+            outputFile = optarg;
+            break;
+        case 'p':
+            processorName = optarg;
+            break;
+        case 't':
+            nWorkers = std::max(1, std::atoi(optarg));
+            break;
+        case 'n':
+            maxEvents = std::atoi(optarg);
+            break;
+        case 'h':
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<std::string> inputFiles(argv + optind, argv + argc);
+
+    if (steeringFile.empty() || inputFiles.empty())
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    streamlog::out.init(std::cout, argv[0]);
+
+    std::vector<StandaloneProcessor *> processorVector;
+    std::vector<Worker *> workerVector;
+    int returnCode(0);
+
+    try
+    {
+        marlin::XMLParser xmlParser(steeringFile);
+        xmlParser.parse();
+
+        marlin::StringParameters *const pGlobalParameters(xmlParser.getParameters("Global"));
+        marlin::StringParameters *const pProcessorParameters(xmlParser.getParameters(processorName));
+
+        if ((NULL == pGlobalParameters) || (NULL == pProcessorParameters))
+        {
+            std::cout << "PandoraStandalone: steering file " << steeringFile << " has no Global section or no processor " << processorName << std::endl;
+            return 1;
+        }
+
+        gearxml::GearXML gearXML(pGlobalParameters->getStringVal("GearXMLFile"));
+        marlin::Global::GEAR = gearXML.createGearMgr();
+
+        // ATTN Processors are initialized sequentially; the geometry snapshot is derived once and shared between them
+        EventQueue eventQueue(2 * nWorkers);
+
+        for (unsigned int iWorker = 0; iWorker < nWorkers; ++iWorker)
+        {
+            StandaloneProcessor *const pProcessor(new StandaloneProcessor);
+            processorVector.push_back(pProcessor);
+            pProcessor->SetStringParameters(pProcessorParameters);
+            pProcessor->init();
+
+            std::ostringstream workerOutputFile;
+
+            if (!outputFile.empty())
+            {
+                workerOutputFile << outputFile;
+
+                if (nWorkers > 1)
+                    workerOutputFile << "_" << iWorker;
+            }
+
+            workerVector.push_back(new Worker(iWorker, pProcessor, &eventQueue, workerOutputFile.str()));
+        }
+
+        {
+            // ATTN The streamlog stream is not thread safe, so it is silenced while several workers are processing events
+            streamlog::logscope scope(streamlog::out);
+
+            if (nWorkers > 1)
+            {
+                streamlog_out(MESSAGE) << "PandoraStandalone: processor log output is silenced while " << nWorkers << " workers run, "
+                                       << "use a single worker to see it" << std::endl;
+                scope.setLevel<streamlog::SILENT>();
+            }
+
+            std::vector<std::thread> threadVector;
+
+            for (std::vector<Worker *>::const_iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+                threadVector.push_back(std::thread(&Worker::Run, *iter));
+
+            if (!ReadEvents(inputFiles, maxEvents, eventQueue))
+                returnCode = 1;
+
+            for (std::vector<std::thread>::iterator iter = threadVector.begin(), iterEnd = threadVector.end(); iter != iterEnd; ++iter)
+                iter->join();
+        }
+
+        unsigned int nEventsProcessed(0);
+
+        for (std::vector<Worker *>::const_iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+        {
+            nEventsProcessed += (*iter)->GetNEventsProcessed();
+
+            if (!(*iter)->IsSuccessful())
+                returnCode = 1;
+        }
+
+        std::cout << "PandoraStandalone: processed " << nEventsProcessed << " events with " << nWorkers << " worker(s)" << std::endl;
+
+        for (std::vector<StandaloneProcessor *>::const_iterator iter = processorVector.begin(), iterEnd = processorVector.end(); iter != iterEnd; ++iter)
+            (*iter)->end();
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        std::cout << "PandoraStandalone: pandora exception " << statusCodeException.ToString() << std::endl;
+        returnCode = 1;
+    }
+    catch (std::exception &exception)
+    {
+        std::cout << "PandoraStandalone: exception " << exception.what() << std::endl;
+        returnCode = 1;
+    }
+
+    for (std::vector<Worker *>::const_iterator iter = workerVector.begin(), iterEnd = workerVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    for (std::vector<StandaloneProcessor *>::const_iterator iter = processorVector.begin(), iterEnd = processorVector.end(); iter != iterEnd; ++iter)
+        delete *iter;
+
+    delete marlin::Global::GEAR;
+    marlin::Global::GEAR = NULL;
+
+    return returnCode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ReadEvents(const std::vector<std::string> &inputFiles, const int maxEvents, EventQueue &eventQueue)
+{
+    bool isSuccessful(true);
+
+    try
+    {
+        // ATTN Unlike IO::LCReader, which deletes each event when reading the next, the mt reader hands ownership of each event to the caller
+        MT::LCReader lcReader(0);
+        lcReader.open(inputFiles);
+
+        for (int iEvent = 0; (maxEvents < 0) || (iEvent < maxEvents); ++iEvent)
+        {
+            EVENT::LCEvent *const pLCEvent(lcReader.readNextEvent(EVENT::LCIO::UPDATE).release());
+
+            if (NULL == pLCEvent)
+                break;
+
+            if (!eventQueue.Push(pLCEvent))
+            {
+                delete pLCEvent;
+                break;
+            }
+        }
+
+        lcReader.close();
+    }
+    catch (std::exception &exception)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << "PandoraStandalone: reader failed, exception " << exception.what() << std::endl;
+        isSuccessful = false;
+    }
+
+    eventQueue.Close();
+
+    return isSuccessful;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PrintUsage(const std::string &programName)
+{
+    std::cout << "Usage: " << programName << " -s steering.xml [-p processorName] [-o outputFile] [-t nThreads] [-n maxEvents] input.slcio ..."
+              << std::endl
+              << "    -s  marlin steering file, providing the GearXMLFile global parameter and the processor parameters" << std::endl
+              << "    -p  name of the pandora processor in the steering file (default MyPandoraPFANewProcessor)" << std::endl
+              << "    -o  output lcio file; with several threads, each writes its own file, suffixed with the thread index" << std::endl
+              << "    -t  number of worker threads, taking events from a single reader (default 1)" << std::endl
+              << "    -n  maximum number of events to process (default all)" << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StandaloneProcessor::SetStringParameters(marlin::StringParameters *const pStringParameters)
+{
+    this->setParameters(pStringParameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventQueue::EventQueue(const unsigned int maxSize) :
+    m_maxSize(std::max(1U, maxSize)),
+    m_isClosed(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventQueue::~EventQueue()
+{
+    for (LCEventDeque::const_iterator iter = m_lcEventDeque.begin(), iterEnd = m_lcEventDeque.end(); iter != iterEnd; ++iter)
+        delete *iter;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool EventQueue::Push(EVENT::LCEvent *const pLCEvent)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_isClosed && (m_lcEventDeque.size() >= m_maxSize))
+        m_notFull.wait(lock);
+
+    if (m_isClosed)
+        return false;
+
+    m_lcEventDeque.push_back(pLCEvent);
+    m_notEmpty.notify_one();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EVENT::LCEvent *EventQueue::Pop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_isClosed && m_lcEventDeque.empty())
+        m_notEmpty.wait(lock);
+
+    if (m_lcEventDeque.empty())
+        return NULL;
+
+    EVENT::LCEvent *const pLCEvent(m_lcEventDeque.front());
+    m_lcEventDeque.pop_front();
+    m_notFull.notify_one();
+    return pLCEvent;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventQueue::Close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isClosed = true;
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Worker::Worker(const unsigned int workerIndex, StandaloneProcessor *const pProcessor, EventQueue *const pEventQueue,
+        const std::string &outputFile) :
+    m_workerIndex(workerIndex),
+    m_pProcessor(pProcessor),
+    m_pEventQueue(pEventQueue),
+    m_outputFile(outputFile),
+    m_nEventsProcessed(0),
+    m_isSuccessful(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Worker::Run()
+{
+    IO::LCWriter *pLCWriter(NULL);
+    EVENT::LCEvent *pLCEvent(NULL);
+
+    try
+    {
+        if (!m_outputFile.empty())
+        {
+            std::lock_guard<std::mutex> lock(lcioMutex);
+            pLCWriter = IOIMPL::LCFactory::getInstance()->createLCWriter();
+            pLCWriter->open(m_outputFile, EVENT::LCIO::WRITE_NEW);
+        }
+
+        while (NULL != (pLCEvent = m_pEventQueue->Pop()))
+        {
+            m_pProcessor->processEvent(pLCEvent);
+            ++m_nEventsProcessed;
+
+            if (NULL != pLCWriter)
+            {
+                std::lock_guard<std::mutex> lock(lcioMutex);
+                pLCWriter->writeEvent(pLCEvent);
+            }
+
+            delete pLCEvent;
+            pLCEvent = NULL;
+        }
+
+        m_isSuccessful = true;
+    }
+    catch (pandora::StatusCodeException &statusCodeException)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << "PandoraStandalone: worker " << m_workerIndex << " failed, pandora exception " << statusCodeException.ToString() << std::endl;
+    }
+    catch (std::exception &exception)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << "PandoraStandalone: worker " << m_workerIndex << " failed, exception " << exception.what() << std::endl;
+    }
+
+    delete pLCEvent;
+
+    // A failed worker stops the reader; the remaining workers finish the events already queued
+    if (!m_isSuccessful)
+        m_pEventQueue->Close();
+
+    if (NULL != pLCWriter)
+    {
+        std::lock_guard<std::mutex> lock(lcioMutex);
+        pLCWriter->close();
+        delete pLCWriter;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int Worker::GetNEventsProcessed() const
+{
+    return m_nEventsProcessed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool Worker::IsSuccessful() const
+{
+    return m_isSuccessful;
+}